@@ -54,4 +54,16 @@ static void efiarm_cpu_nap ( void ) {
 		__asm__ __volatile__ ( "wfi" );
 }
 
+/**
+ * Sleep until next interrupt or write to wake-up location
+ *
+ * @v wake		Wake-up location
+ */
+static void efiarm_cpu_nap_watch ( const volatile void *wake __unused ) {
+
+	/* We have no way to watch for writes; just sleep */
+	efiarm_cpu_nap();
+}
+
 PROVIDE_NAP ( efiarm, cpu_nap, efiarm_cpu_nap );
+PROVIDE_NAP ( efiarm, cpu_nap_watch, efiarm_cpu_nap_watch );
@@ -0,0 +1,19 @@
+#ifndef _BITS_CRC32C_H
+#define _BITS_CRC32C_H
+
+/** @file
+ *
+ * CRC32C (Castagnoli) checksum
+ *
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+static inline __attribute__ (( always_inline )) uint32_t
+crc32c_le ( uint32_t seed, const void *data, size_t len ) {
+
+	/* Not yet optimised */
+	return generic_crc32c_le ( seed, data, len );
+}
+
+#endif /* _BITS_CRC32C_H */
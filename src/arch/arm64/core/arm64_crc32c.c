@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * ARM64 CRC32C (Castagnoli) checksum
+ *
+ * The ARMv8 CRC32 extension (mandatory from ARMv8.1, optional in
+ * ARMv8.0) provides instructions that calculate exactly the CRC32C
+ * polynomial.
+ *
+ */
+
+#include <ipxe/crc32c.h>
+
+/** ID_AA64ISAR0_EL1 CRC32 field shift */
+#define ARM64_ISAR0_CRC32_SHIFT 16
+
+/** ID_AA64ISAR0_EL1 CRC32 field mask */
+#define ARM64_ISAR0_CRC32_MASK 0xf
+
+/**
+ * Calculate CRC32C checksum using the CRC32 instructions
+ *
+ * @v seed		Initial value
+ * @v data		Data to checksum
+ * @v len		Length of data
+ * @ret crc		CRC32C checksum
+ */
+static uint32_t arm64_crc32c_hw ( uint32_t seed, const void *data,
+				  size_t len ) {
+	const uint8_t *byte = data;
+	const uint64_t *dword;
+	uint32_t crc = seed;
+
+	/* Checksum initial bytes to bring data into alignment */
+	while ( len && ( ( ( intptr_t ) byte ) % sizeof ( *dword ) ) ) {
+		__asm__ ( ".arch_extension crc\n\t"
+			  "crc32cb %w0, %w0, %w1\n\t"
+			  : "+r" ( crc ) : "r" ( *(byte++) ) );
+		len--;
+	}
+
+	/* Checksum whole doublewords */
+	dword = ( ( const void * ) byte );
+	while ( len >= sizeof ( *dword ) ) {
+		__asm__ ( ".arch_extension crc\n\t"
+			  "crc32cx %w0, %w0, %x1\n\t"
+			  : "+r" ( crc ) : "r" ( *(dword++) ) );
+		len -= sizeof ( *dword );
+	}
+
+	/* Checksum trailing bytes */
+	byte = ( ( const void * ) dword );
+	while ( len-- ) {
+		__asm__ ( ".arch_extension crc\n\t"
+			  "crc32cb %w0, %w0, %w1\n\t"
+			  : "+r" ( crc ) : "r" ( *(byte++) ) );
+	}
+
+	return crc;
+}
+
+static uint32_t arm64_crc32c_select ( uint32_t seed, const void *data,
+				      size_t len );
+
+/** Selected CRC32C implementation */
+static uint32_t ( * arm64_crc32c ) ( uint32_t seed, const void *data,
+				     size_t len ) = arm64_crc32c_select;
+
+/**
+ * Select CRC32C implementation and calculate checksum
+ *
+ * @v seed		Initial value
+ * @v data		Data to checksum
+ * @v len		Length of data
+ * @ret crc		CRC32C checksum
+ */
+static uint32_t arm64_crc32c_select ( uint32_t seed, const void *data,
+				      size_t len ) {
+	uint64_t isar0;
+
+	/* Use the CRC32 instructions if available */
+	__asm__ ( "mrs %0, id_aa64isar0_el1" : "=r" ( isar0 ) );
+	if ( ( isar0 >> ARM64_ISAR0_CRC32_SHIFT ) & ARM64_ISAR0_CRC32_MASK ) {
+		DBGC ( &arm64_crc32c, "CRC32C using CRC32 instructions\n" );
+		arm64_crc32c = arm64_crc32c_hw;
+	} else {
+		DBGC ( &arm64_crc32c, "CRC32C using lookup table\n" );
+		arm64_crc32c = generic_crc32c_le;
+	}
+
+	return arm64_crc32c ( seed, data, len );
+}
+
+/**
+ * Calculate 32-bit little-endian CRC32C checksum
+ *
+ * @v seed		Initial value
+ * @v data		Data to checksum
+ * @v len		Length of data
+ * @ret crc		CRC32C checksum
+ */
+uint32_t crc32c_le ( uint32_t seed, const void *data, size_t len ) {
+
+	return arm64_crc32c ( seed, data, len );
+}
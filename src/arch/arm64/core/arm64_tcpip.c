@@ -38,16 +38,19 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 /** Number of steps in each iteration of the unrolled main checksumming loop */
 #define TCPIP_CHKSUM_UNROLL 4
 
+/** Block size used by NEON checksumming loop */
+#define TCPIP_CHKSUM_NEON_BLOCK 64
+
 /**
- * Calculate continued TCP/IP checkum
+ * Calculate continued TCP/IP checkum using general-purpose registers
  *
  * @v sum		Checksum of already-summed data, in network byte order
  * @v data		Data buffer
  * @v len		Length of data buffer
  * @ret sum		Updated checksum, in network byte order
  */
-uint16_t tcpip_continue_chksum ( uint16_t sum, const void *data,
-				 size_t len ) {
+static uint16_t arm64_tcpip_adcs_chksum ( uint16_t sum, const void *data,
+					  size_t len ) {
 	intptr_t start;
 	intptr_t end;
 	intptr_t mid;
@@ -173,3 +176,90 @@ uint16_t tcpip_continue_chksum ( uint16_t sum, const void *data,
 
 	return sum;
 }
+
+/**
+ * Sum 32-bit words using NEON
+ *
+ * @v data		Data buffer (aligned to TCPIP_CHKSUM_ALIGN)
+ * @v len		Length of data buffer (a non-zero multiple of 64)
+ * @ret sum		Sum of 32-bit words
+ */
+static uint64_t arm64_tcpip_neon_sum ( const void *data, size_t len ) {
+	const void *end = ( data + len );
+	uint64_t sum;
+
+	__asm__ ( /* Clear accumulators */
+		  "movi v0.2d, #0\n\t"
+		  "movi v1.2d, #0\n\t"
+		  /* Pairwise add 32-bit words into 64-bit accumulators */
+		  "\n1:\n\t"
+		  "ld1 {v2.4s, v3.4s, v4.4s, v5.4s}, [%1], #64\n\t"
+		  "uadalp v0.2d, v2.4s\n\t"
+		  "uadalp v1.2d, v3.4s\n\t"
+		  "uadalp v0.2d, v4.4s\n\t"
+		  "uadalp v1.2d, v5.4s\n\t"
+		  "cmp %1, %2\n\t"
+		  "b.ne 1b\n\t"
+		  /* Combine accumulators */
+		  "add v0.2d, v0.2d, v1.2d\n\t"
+		  "addp d0, v0.2d\n\t"
+		  "fmov %0, d0\n\t"
+		  : "=r" ( sum ), "+r" ( data )
+		  : "r" ( end )
+		  : "cc", "memory", "v0", "v1", "v2", "v3", "v4", "v5" );
+
+	return sum;
+}
+
+/**
+ * Calculate continued TCP/IP checkum
+ *
+ * @v sum		Checksum of already-summed data, in network byte order
+ * @v data		Data buffer
+ * @v len		Length of data buffer
+ * @ret sum		Updated checksum, in network byte order
+ *
+ * Advanced SIMD is a mandatory part of the ARMv8-A profile (and is
+ * enabled by both UEFI and Linux), so no runtime detection is
+ * required.
+ */
+uint16_t tcpip_continue_chksum ( uint16_t sum, const void *data,
+				 size_t len ) {
+	intptr_t start = ( ( intptr_t ) data );
+	size_t pre = ( ( -start ) & ( TCPIP_CHKSUM_ALIGN - 1 ) );
+	size_t bulk_len;
+	uint64_t total;
+
+	/* Use general-purpose registers for short blocks of data, and
+	 * for data aligned to less than 16 bits (which won't occur in
+	 * practice).
+	 */
+	if ( ( start & 1 ) || ( len < ( pre + TCPIP_CHKSUM_NEON_BLOCK ) ) )
+		return arm64_tcpip_adcs_chksum ( sum, data, len );
+
+	/* Sum pre-alignment data */
+	sum = arm64_tcpip_adcs_chksum ( sum, data, pre );
+	data += pre;
+	len -= pre;
+
+	/* Sum whole aligned blocks using NEON, and fold the result
+	 * down to 16 bits using end-around carries.  Folding a
+	 * non-zero value can never produce zero, so this preserves
+	 * the representation of zero used by the scalar code.
+	 */
+	bulk_len = ( len & ~( TCPIP_CHKSUM_NEON_BLOCK - 1 ) );
+	total = ( ( ( ~sum ) & 0xffff ) +
+		  arm64_tcpip_neon_sum ( data, bulk_len ) );
+	total = ( ( total & 0xffffffffUL ) + ( total >> 32 ) );
+	total = ( ( total & 0xffffffffUL ) + ( total >> 32 ) );
+	total = ( ( total & 0xffff ) + ( total >> 16 ) );
+	total = ( ( total & 0xffff ) + ( total >> 16 ) );
+	sum = ( ( ~total ) & 0xffff );
+	data += bulk_len;
+	len -= bulk_len;
+
+	/* Sum post-alignment data.  This starts at an even offset, so
+	 * no byte swapping is required.
+	 */
+	return arm64_tcpip_adcs_chksum ( sum, data, len );
+}
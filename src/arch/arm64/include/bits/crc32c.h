@@ -0,0 +1,14 @@
+#ifndef _BITS_CRC32C_H
+#define _BITS_CRC32C_H
+
+/** @file
+ *
+ * CRC32C (Castagnoli) checksum
+ *
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+extern uint32_t crc32c_le ( uint32_t seed, const void *data, size_t len );
+
+#endif /* _BITS_CRC32C_H */
@@ -54,4 +54,16 @@ static void efiloong64_cpu_nap ( void ) {
 		__asm__ __volatile__ ( "idle 0" );
 }
 
+/**
+ * Sleep until next interrupt or write to wake-up location
+ *
+ * @v wake		Wake-up location
+ */
+static void efiloong64_cpu_nap_watch ( const volatile void *wake __unused ) {
+
+	/* We have no way to watch for writes; just sleep */
+	efiloong64_cpu_nap();
+}
+
 PROVIDE_NAP ( efiloong64, cpu_nap, efiloong64_cpu_nap );
+PROVIDE_NAP ( efiloong64, cpu_nap_watch, efiloong64_cpu_nap_watch );
@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * x86 address monitoring
+ *
+ */
+
+#include <ipxe/cpuid.h>
+#include <ipxe/monitor.h>
+
+/** MONITOR/MWAIT usability (negative if not yet determined) */
+static int monitor_is_usable = -1;
+
+/**
+ * Check whether or not MONITOR/MWAIT instructions are usable
+ *
+ * @ret usable		MONITOR/MWAIT instructions are usable
+ */
+int monitor_usable ( void ) {
+	struct x86_features features;
+
+	/* Determine usability on first use */
+	if ( monitor_is_usable < 0 ) {
+		x86_features ( &features );
+		monitor_is_usable = ( !! ( features.intel.ecx &
+					   CPUID_FEATURES_INTEL_ECX_MONITOR ) );
+		DBGC ( &monitor_is_usable, "MONITOR/MWAIT is %susable\n",
+		       ( monitor_is_usable ? "" : "not " ) );
+	}
+
+	return monitor_is_usable;
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * x86 CRC32C (Castagnoli) checksum
+ *
+ * The SSE4.2 CRC32 instruction calculates exactly the CRC32C
+ * polynomial.  It operates only on general-purpose registers, and so
+ * may be used even on platforms that do not enable SSE state.
+ *
+ */
+
+#include <ipxe/crc32c.h>
+#include <ipxe/cpuid.h>
+
+/**
+ * Calculate CRC32C checksum using the SSE4.2 CRC32 instruction
+ *
+ * @v seed		Initial value
+ * @v data		Data to checksum
+ * @v len		Length of data
+ * @ret crc		CRC32C checksum
+ */
+static uint32_t x86_crc32c_sse42 ( uint32_t seed, const void *data,
+				   size_t len ) {
+	const uint8_t *byte = data;
+	const unsigned long *word;
+	unsigned long crc = seed;
+
+	/* Checksum initial bytes to bring data into alignment */
+	while ( len && ( ( ( intptr_t ) byte ) % sizeof ( *word ) ) ) {
+		__asm__ ( "crc32b %1, %k0"
+			  : "+r" ( crc ) : "qm" ( *(byte++) ) );
+		len--;
+	}
+
+	/* Checksum whole words */
+	word = ( ( const void * ) byte );
+	while ( len >= sizeof ( *word ) ) {
+		__asm__ ( "crc32%z1 %1, %0"
+			  : "+r" ( crc ) : "rm" ( *(word++) ) );
+		len -= sizeof ( *word );
+	}
+
+	/* Checksum trailing bytes */
+	byte = ( ( const void * ) word );
+	while ( len-- ) {
+		__asm__ ( "crc32b %1, %k0"
+			  : "+r" ( crc ) : "qm" ( *(byte++) ) );
+	}
+
+	return crc;
+}
+
+static uint32_t x86_crc32c_select ( uint32_t seed, const void *data,
+				    size_t len );
+
+/** Selected CRC32C implementation */
+static uint32_t ( * x86_crc32c ) ( uint32_t seed, const void *data,
+				   size_t len ) = x86_crc32c_select;
+
+/**
+ * Select CRC32C implementation and calculate checksum
+ *
+ * @v seed		Initial value
+ * @v data		Data to checksum
+ * @v len		Length of data
+ * @ret crc		CRC32C checksum
+ */
+static uint32_t x86_crc32c_select ( uint32_t seed, const void *data,
+				    size_t len ) {
+	struct x86_features features;
+
+	/* Use the CRC32 instruction if available */
+	x86_features ( &features );
+	if ( features.intel.ecx & CPUID_FEATURES_INTEL_ECX_SSE4_2 ) {
+		DBGC ( &x86_crc32c, "CRC32C using SSE4.2 instruction\n" );
+		x86_crc32c = x86_crc32c_sse42;
+	} else {
+		DBGC ( &x86_crc32c, "CRC32C using lookup table\n" );
+		x86_crc32c = generic_crc32c_le;
+	}
+
+	return x86_crc32c ( seed, data, len );
+}
+
+/**
+ * Calculate 32-bit little-endian CRC32C checksum
+ *
+ * @v seed		Initial value
+ * @v data		Data to checksum
+ * @v len		Length of data
+ * @ret crc		CRC32C checksum
+ */
+uint32_t crc32c_le ( uint32_t seed, const void *data, size_t len ) {
+
+	return x86_crc32c ( seed, data, len );
+}
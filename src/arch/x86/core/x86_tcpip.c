@@ -31,19 +31,38 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 
 #include <limits.h>
 #include <ipxe/tcpip.h>
+#include <ipxe/cpuid.h>
+
+/** Vector checksumming kernels are available
+ *
+ * The SSE and AVX register state is enabled by the firmware on
+ * 64-bit UEFI and by the kernel under Linux, but is not enabled (and
+ * may belong to the real-mode caller) under BIOS.
+ */
+#if defined ( __x86_64__ ) && ! defined ( PLATFORM_pcbios )
+#define X86_TCPIP_VECTOR 1
+#else
+#define X86_TCPIP_VECTOR 0
+#endif
+
+/** Block size used by vector checksumming kernels */
+#define X86_TCPIP_VECTOR_BLOCK 64
 
 extern char x86_tcpip_loop_end[];
 
 /**
- * Calculate continued TCP/IP checkum
+ * Calculate continued TCP/IP checkum using string instructions
  *
  * @v partial		Checksum of already-summed data, in network byte order
  * @v data		Data buffer
  * @v len		Length of data buffer
  * @ret cksum		Updated checksum, in network byte order
+ *
+ * This function must not be inlined, since the unrolled loop uses
+ * global labels.
  */
-uint16_t tcpip_continue_chksum ( uint16_t partial, const void *data,
-				 size_t len ) {
+static __attribute__ (( noinline )) uint16_t
+x86_tcpip_lods_chksum ( uint16_t partial, const void *data, size_t len ) {
 	unsigned long sum = ( ( ~partial ) & 0xffff );
 	unsigned long initial_word_count;
 	unsigned long loop_count;
@@ -171,3 +190,268 @@ uint16_t tcpip_continue_chksum ( uint16_t partial, const void *data,
 
 	return ( ~sum & 0xffff );
 }
+
+#if X86_TCPIP_VECTOR
+
+/**
+ * Sum 32-bit words using SSE2
+ *
+ * @v data		Data buffer
+ * @v len		Length of data buffer (a non-zero multiple of 64)
+ * @ret sum		Sum of 32-bit words
+ *
+ * The compiler is not permitted to use (or to name as clobbered) any
+ * vector registers.  We use only %xmm0-%xmm5, which are volatile
+ * under both the System V and Microsoft calling conventions.
+ */
+static uint64_t x86_tcpip_sse2_sum ( const void *data, size_t len ) {
+	const void *end = ( data + len );
+	uint64_t low;
+	uint64_t high;
+
+	__asm__ ( /* Clear accumulators and zero register */
+		  "pxor %%xmm0, %%xmm0\n\t"
+		  "pxor %%xmm1, %%xmm1\n\t"
+		  "pxor %%xmm5, %%xmm5\n\t"
+		  /* Zero-extend each 32-bit word to 64 bits and sum */
+		  "\n1:\n\t"
+		  "movdqu 0(%2), %%xmm2\n\t"
+		  "movdqu 16(%2), %%xmm3\n\t"
+		  "movdqa %%xmm2, %%xmm4\n\t"
+		  "punpckldq %%xmm5, %%xmm2\n\t"
+		  "punpckhdq %%xmm5, %%xmm4\n\t"
+		  "paddq %%xmm2, %%xmm0\n\t"
+		  "paddq %%xmm4, %%xmm1\n\t"
+		  "movdqa %%xmm3, %%xmm4\n\t"
+		  "punpckldq %%xmm5, %%xmm3\n\t"
+		  "punpckhdq %%xmm5, %%xmm4\n\t"
+		  "paddq %%xmm3, %%xmm0\n\t"
+		  "paddq %%xmm4, %%xmm1\n\t"
+		  "movdqu 32(%2), %%xmm2\n\t"
+		  "movdqu 48(%2), %%xmm3\n\t"
+		  "movdqa %%xmm2, %%xmm4\n\t"
+		  "punpckldq %%xmm5, %%xmm2\n\t"
+		  "punpckhdq %%xmm5, %%xmm4\n\t"
+		  "paddq %%xmm2, %%xmm0\n\t"
+		  "paddq %%xmm4, %%xmm1\n\t"
+		  "movdqa %%xmm3, %%xmm4\n\t"
+		  "punpckldq %%xmm5, %%xmm3\n\t"
+		  "punpckhdq %%xmm5, %%xmm4\n\t"
+		  "paddq %%xmm3, %%xmm0\n\t"
+		  "paddq %%xmm4, %%xmm1\n\t"
+		  "add $64, %2\n\t"
+		  "cmp %3, %2\n\t"
+		  "jne 1b\n\t"
+		  /* Combine accumulators */
+		  "paddq %%xmm1, %%xmm0\n\t"
+		  "movq %%xmm0, %0\n\t"
+		  "psrldq $8, %%xmm0\n\t"
+		  "movq %%xmm0, %1\n\t"
+		  : "=&r" ( low ), "=&r" ( high ), "+r" ( data )
+		  : "r" ( end )
+		  : "cc", "memory" );
+
+	return ( low + high );
+}
+
+/**
+ * Sum 32-bit words using AVX2
+ *
+ * @v data		Data buffer
+ * @v len		Length of data buffer (a non-zero multiple of 64)
+ * @ret sum		Sum of 32-bit words
+ *
+ * As for x86_tcpip_sse2_sum(), we use only %ymm0-%ymm5.
+ */
+static uint64_t x86_tcpip_avx2_sum ( const void *data, size_t len ) {
+	const void *end = ( data + len );
+	uint64_t low;
+	uint64_t high;
+
+	__asm__ ( /* Clear accumulators */
+		  "vpxor %%ymm0, %%ymm0, %%ymm0\n\t"
+		  "vpxor %%ymm1, %%ymm1, %%ymm1\n\t"
+		  /* Zero-extend each 32-bit word to 64 bits and sum */
+		  "\n1:\n\t"
+		  "vpmovzxdq 0(%2), %%ymm2\n\t"
+		  "vpmovzxdq 16(%2), %%ymm3\n\t"
+		  "vpmovzxdq 32(%2), %%ymm4\n\t"
+		  "vpmovzxdq 48(%2), %%ymm5\n\t"
+		  "vpaddq %%ymm2, %%ymm0, %%ymm0\n\t"
+		  "vpaddq %%ymm3, %%ymm1, %%ymm1\n\t"
+		  "vpaddq %%ymm4, %%ymm0, %%ymm0\n\t"
+		  "vpaddq %%ymm5, %%ymm1, %%ymm1\n\t"
+		  "add $64, %2\n\t"
+		  "cmp %3, %2\n\t"
+		  "jne 1b\n\t"
+		  /* Combine accumulators */
+		  "vpaddq %%ymm1, %%ymm0, %%ymm0\n\t"
+		  "vextracti128 $1, %%ymm0, %%xmm1\n\t"
+		  "vpaddq %%xmm1, %%xmm0, %%xmm0\n\t"
+		  "vmovq %%xmm0, %0\n\t"
+		  "vpextrq $1, %%xmm0, %1\n\t"
+		  /* Avoid SSE transition penalties in subsequent code */
+		  "vzeroupper\n\t"
+		  : "=&r" ( low ), "=&r" ( high ), "+r" ( data )
+		  : "r" ( end )
+		  : "cc", "memory" );
+
+	return ( low + high );
+}
+
+/**
+ * Calculate continued TCP/IP checksum using a vector summing kernel
+ *
+ * @v partial		Checksum of already-summed data, in network byte order
+ * @v data		Data buffer
+ * @v len		Length of data buffer
+ * @v sum_words		Vector summing kernel
+ * @ret cksum		Updated checksum, in network byte order
+ */
+static inline __attribute__ (( always_inline )) uint16_t
+x86_tcpip_vector_chksum ( uint16_t partial, const void *data, size_t len,
+			  uint64_t ( * sum_words ) ( const void *data,
+						     size_t len ) ) {
+	size_t bulk_len = ( len & ~( X86_TCPIP_VECTOR_BLOCK - 1 ) );
+	uint64_t sum;
+
+	/* Sum whole blocks using the vector kernel, and fold the
+	 * result down to 16 bits using end-around carries.  Folding a
+	 * non-zero value can never produce zero, so this preserves
+	 * the representation of zero used by the scalar code.
+	 */
+	if ( bulk_len ) {
+		sum = ( ( ( ~partial ) & 0xffff ) +
+			sum_words ( data, bulk_len ) );
+		sum = ( ( sum & 0xffffffffUL ) + ( sum >> 32 ) );
+		sum = ( ( sum & 0xffffffffUL ) + ( sum >> 32 ) );
+		sum = ( ( sum & 0xffff ) + ( sum >> 16 ) );
+		sum = ( ( sum & 0xffff ) + ( sum >> 16 ) );
+		partial = ( ( ~sum ) & 0xffff );
+		data += bulk_len;
+		len -= bulk_len;
+	}
+
+	/* Sum any remaining data using string instructions.  The
+	 * remaining data starts at an even offset, so no byte
+	 * swapping is required.
+	 */
+	return x86_tcpip_lods_chksum ( partial, data, len );
+}
+
+/**
+ * Calculate continued TCP/IP checksum using SSE2
+ *
+ * @v partial		Checksum of already-summed data, in network byte order
+ * @v data		Data buffer
+ * @v len		Length of data buffer
+ * @ret cksum		Updated checksum, in network byte order
+ */
+static uint16_t x86_tcpip_sse2_chksum ( uint16_t partial, const void *data,
+					size_t len ) {
+
+	return x86_tcpip_vector_chksum ( partial, data, len,
+					 x86_tcpip_sse2_sum );
+}
+
+/**
+ * Calculate continued TCP/IP checksum using AVX2
+ *
+ * @v partial		Checksum of already-summed data, in network byte order
+ * @v data		Data buffer
+ * @v len		Length of data buffer
+ * @ret cksum		Updated checksum, in network byte order
+ */
+static uint16_t x86_tcpip_avx2_chksum ( uint16_t partial, const void *data,
+					size_t len ) {
+
+	return x86_tcpip_vector_chksum ( partial, data, len,
+					 x86_tcpip_avx2_sum );
+}
+
+/**
+ * Check whether or not AVX2 instructions are usable
+ *
+ * @v features		x86 CPU features
+ * @ret usable		AVX2 instructions are usable
+ */
+static int x86_tcpip_avx2_usable ( struct x86_features *features ) {
+	uint32_t discard_a;
+	uint32_t discard_c;
+	uint32_t discard_d;
+	uint32_t ebx;
+	uint32_t xcr0;
+
+	/* Check that AVX is supported and enabled by the OS */
+	if ( ! ( features->intel.ecx & CPUID_FEATURES_INTEL_ECX_OSXSAVE ) )
+		return 0;
+	if ( ! ( features->intel.ecx & CPUID_FEATURES_INTEL_ECX_AVX ) )
+		return 0;
+	__asm__ ( "xgetbv" : "=a" ( xcr0 ), "=d" ( discard_d ) : "c" ( 0 ) );
+	if ( ( xcr0 & ( XCR0_SSE | XCR0_AVX ) ) != ( XCR0_SSE | XCR0_AVX ) )
+		return 0;
+
+	/* Check that AVX2 is supported */
+	if ( cpuid_supported ( CPUID_STRUCTURED_FEATURES ) != 0 )
+		return 0;
+	cpuid ( CPUID_STRUCTURED_FEATURES, 0, &discard_a, &ebx, &discard_c,
+		&discard_d );
+	if ( ! ( ebx & CPUID_STRUCTURED_FEATURES_EBX_AVX2 ) )
+		return 0;
+
+	return 1;
+}
+
+#endif /* X86_TCPIP_VECTOR */
+
+static uint16_t x86_tcpip_select_chksum ( uint16_t partial, const void *data,
+					  size_t len );
+
+/** Selected TCP/IP checksum implementation */
+static uint16_t ( * x86_tcpip_chksum ) ( uint16_t partial, const void *data,
+					 size_t len ) = x86_tcpip_select_chksum;
+
+/**
+ * Select TCP/IP checksum implementation and calculate checksum
+ *
+ * @v partial		Checksum of already-summed data, in network byte order
+ * @v data		Data buffer
+ * @v len		Length of data buffer
+ * @ret cksum		Updated checksum, in network byte order
+ */
+static uint16_t x86_tcpip_select_chksum ( uint16_t partial, const void *data,
+					  size_t len ) {
+#if X86_TCPIP_VECTOR
+	struct x86_features features;
+
+	/* Use the widest available vector kernel */
+	x86_features ( &features );
+	if ( x86_tcpip_avx2_usable ( &features ) ) {
+		DBGC ( &x86_tcpip_chksum, "TCPIP using AVX2 checksum\n" );
+		x86_tcpip_chksum = x86_tcpip_avx2_chksum;
+	} else if ( features.intel.edx & CPUID_FEATURES_INTEL_EDX_SSE2 ) {
+		DBGC ( &x86_tcpip_chksum, "TCPIP using SSE2 checksum\n" );
+		x86_tcpip_chksum = x86_tcpip_sse2_chksum;
+	} else
+#endif
+	{
+		DBGC ( &x86_tcpip_chksum, "TCPIP using scalar checksum\n" );
+		x86_tcpip_chksum = x86_tcpip_lods_chksum;
+	}
+
+	return x86_tcpip_chksum ( partial, data, len );
+}
+
+/**
+ * Calculate continued TCP/IP checkum
+ *
+ * @v partial		Checksum of already-summed data, in network byte order
+ * @v data		Data buffer
+ * @v len		Length of data buffer
+ * @ret cksum		Updated checksum, in network byte order
+ */
+uint16_t tcpip_continue_chksum ( uint16_t partial, const void *data,
+				 size_t len ) {
+
+	return x86_tcpip_chksum ( partial, data, len );
+}
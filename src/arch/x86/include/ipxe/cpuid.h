@@ -39,6 +39,18 @@ struct x86_features {
 /** Get standard features */
 #define CPUID_FEATURES 0x00000001UL
 
+/** MONITOR and MWAIT instructions are supported */
+#define CPUID_FEATURES_INTEL_ECX_MONITOR 0x00000008UL
+
+/** SSE4.2 instructions are supported */
+#define CPUID_FEATURES_INTEL_ECX_SSE4_2 0x00100000UL
+
+/** OS has enabled XSAVE-managed state (and XGETBV is available) */
+#define CPUID_FEATURES_INTEL_ECX_OSXSAVE 0x08000000UL
+
+/** AVX instructions are supported */
+#define CPUID_FEATURES_INTEL_ECX_AVX 0x10000000UL
+
 /** RDRAND instruction is supported */
 #define CPUID_FEATURES_INTEL_ECX_RDRAND 0x40000000UL
 
@@ -51,6 +63,21 @@ struct x86_features {
 /** FXSAVE and FXRSTOR are supported */
 #define CPUID_FEATURES_INTEL_EDX_FXSR 0x01000000UL
 
+/** SSE2 instructions are supported */
+#define CPUID_FEATURES_INTEL_EDX_SSE2 0x04000000UL
+
+/** Get structured extended features */
+#define CPUID_STRUCTURED_FEATURES 0x00000007UL
+
+/** AVX2 instructions are supported */
+#define CPUID_STRUCTURED_FEATURES_EBX_AVX2 0x00000020UL
+
+/** Extended control register 0: SSE state enabled */
+#define XCR0_SSE 0x00000002UL
+
+/** Extended control register 0: AVX state enabled */
+#define XCR0_AVX 0x00000004UL
+
 /** Get largest extended function */
 #define CPUID_AMD_MAX_FN 0x80000000UL
 
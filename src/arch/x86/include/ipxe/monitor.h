@@ -0,0 +1,30 @@
+#ifndef _IPXE_MONITOR_H
+#define _IPXE_MONITOR_H
+
+/** @file
+ *
+ * x86 address monitoring
+ *
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+extern int monitor_usable ( void );
+
+/**
+ * Arm address monitoring hardware
+ *
+ * @v addr		Address to monitor
+ *
+ * A subsequent MWAIT instruction will complete when the monitored
+ * cacheline is written to (including by a device DMA write), or when
+ * an interrupt occurs.
+ */
+static inline __attribute__ (( always_inline )) void
+monitor ( const volatile void *addr ) {
+
+	__asm__ __volatile__ ( "monitor"
+			       : : "a" ( addr ), "c" ( 0 ), "d" ( 0 ) );
+}
+
+#endif /* _IPXE_MONITOR_H */
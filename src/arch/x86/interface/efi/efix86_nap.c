@@ -25,6 +25,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 
 #include <ipxe/nap.h>
 #include <ipxe/efi/efi.h>
+#include <ipxe/monitor.h>
 
 /** @file
  *
@@ -54,4 +55,25 @@ static void efix86_cpu_nap ( void ) {
 		__asm__ __volatile__ ( "hlt" );
 }
 
+/**
+ * Sleep until next interrupt or write to wake-up location
+ *
+ * @v wake		Wake-up location
+ */
+static void efix86_cpu_nap_watch ( const volatile void *wake ) {
+
+	/* Fall back to halting if MONITOR/MWAIT is unavailable */
+	if ( ! monitor_usable() ) {
+		efix86_cpu_nap();
+		return;
+	}
+
+	/* Wait for a write to the wake-up location or an interrupt */
+	if ( ! efi_shutdown_in_progress ) {
+		monitor ( wake );
+		__asm__ __volatile__ ( "mwait" : : "a" ( 0 ), "c" ( 0 ) );
+	}
+}
+
 PROVIDE_NAP ( efix86, cpu_nap, efix86_cpu_nap );
+PROVIDE_NAP ( efix86, cpu_nap_watch, efix86_cpu_nap_watch );
@@ -1,4 +1,5 @@
 #include <ipxe/nap.h>
+#include <ipxe/monitor.h>
 #include <realmode.h>
 
 FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
@@ -13,4 +14,27 @@ static void bios_cpu_nap ( void ) {
 			       "cli\n\t" );
 }
 
+/**
+ * Save power by halting the CPU until the next interrupt or a write
+ * to the wake-up location
+ *
+ * @v wake		Wake-up location
+ */
+static void bios_cpu_nap_watch ( const volatile void *wake ) {
+
+	/* Fall back to halting if MONITOR/MWAIT is unavailable */
+	if ( ! monitor_usable() ) {
+		bios_cpu_nap();
+		return;
+	}
+
+	/* Wait for a write to the wake-up location or an interrupt */
+	monitor ( wake );
+	__asm__ __volatile__ ( "sti\n\t"
+			       "mwait\n\t"
+			       "cli\n\t"
+			       : : "a" ( 0 ), "c" ( 0 ) );
+}
+
 PROVIDE_NAP ( pcbios, cpu_nap, bios_cpu_nap );
+PROVIDE_NAP ( pcbios, cpu_nap_watch, bios_cpu_nap_watch );
@@ -134,6 +134,9 @@ REQUIRE_OBJECT ( iscsi );
 #ifdef SANBOOT_PROTO_HTTP
 REQUIRE_OBJECT ( httpblock );
 #endif
+#ifdef SANBOOT_PROTO_NVME_TCP
+REQUIRE_OBJECT ( nvmetcp );
+#endif
 
 /*
  * Drag in all requested resolvers
@@ -287,6 +290,15 @@ REQUIRE_OBJECT ( ipstat_cmd );
 #ifdef PROFSTAT_CMD
 REQUIRE_OBJECT ( profstat_cmd );
 #endif
+#ifdef MEMSTAT_CMD
+REQUIRE_OBJECT ( memstat_cmd );
+#endif
+#ifdef TRACE_CMD
+REQUIRE_OBJECT ( trace_cmd );
+#endif
+#ifdef TIMELINE_CMD
+REQUIRE_OBJECT ( timeline_cmd );
+#endif
 #ifdef NTP_CMD
 REQUIRE_OBJECT ( ntp_cmd );
 #endif
@@ -361,6 +373,9 @@ REQUIRE_OBJECT ( vram_settings );
 #ifdef ACPI_SETTINGS
 REQUIRE_OBJECT ( acpi_settings );
 #endif
+#ifdef TIMELINE_SETTINGS
+REQUIRE_OBJECT ( timeline_settings );
+#endif
 #ifdef EFI_SETTINGS
 REQUIRE_OBJECT ( efi_settings );
 #endif
@@ -72,6 +72,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 //#undef	SANBOOT_PROTO_IB_SRP	/* Infiniband SCSI RDMA protocol */
 //#undef	SANBOOT_PROTO_FCP	/* Fibre Channel protocol */
 //#undef	SANBOOT_PROTO_HTTP	/* HTTP SAN protocol */
+//#define	SANBOOT_PROTO_NVME_TCP	/* NVMe over TCP protocol */
 
 /*
  * HTTP extensions
@@ -165,6 +166,9 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 //#define CONSOLE_CMD		/* Console command */
 //#define IPSTAT_CMD		/* IP statistics commands */
 //#define PROFSTAT_CMD		/* Profiling commands */
+//#define MEMSTAT_CMD		/* Memory allocator statistics command */
+//#define TRACE_CMD		/* Tracepoint commands */
+//#define TIMELINE_CMD		/* Boot timeline command */
 //#define NTP_CMD		/* NTP commands */
 //#define CERT_CMD		/* Certificate management commands */
 //#define IMAGE_MEM_CMD		/* Read memory command */
@@ -205,6 +209,8 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #undef	BUILD_ID		/* Include a custom build ID string,
 				 * e.g "test-foo" */
 #undef	NULL_TRAP		/* Attempt to catch NULL function calls */
+#undef	MALLOC_PROFILE		/* Record heap allocation call sites (see
+				 * the "memstat" command) */
 #undef	GDBSERIAL		/* Remote GDB debugging over serial */
 #undef	GDBUDP			/* Remote GDB debugging over UDP
 				 * (both may be set) */
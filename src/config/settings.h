@@ -17,6 +17,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 //#define	VMWARE_SETTINGS	/* VMware GuestInfo settings */
 //#define	VRAM_SETTINGS	/* Video RAM dump settings */
 //#define	ACPI_SETTINGS	/* ACPI settings */
+//#define	TIMELINE_SETTINGS	/* Boot timeline settings */
 
 #include <config/named.h>
 #include NAMED_CONFIG(settings.h)
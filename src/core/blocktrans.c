@@ -139,7 +139,7 @@ static void blktrans_close ( struct block_translator *blktrans, int rc ) {
 		capacity.blocks =
 			( blktrans->xferbuf.len / blktrans->blksize );
 		capacity.blksize = blktrans->blksize;
-		capacity.max_count = -1U;
+		capacity.max_count = blktrans->max_count;
 
 		/* Report block device capacity */
 		block_capacity ( &blktrans->block, &capacity );
@@ -218,9 +218,15 @@ static struct interface_descriptor blktrans_xfer_desc =
  * @v block		Block device interface
  * @v buffer		Data buffer (or UNULL)
  * @v size		Length of data buffer, or block size
+ * @v max_count		Maximum number of blocks per single transfer
  * @ret rc		Return status code
+ *
+ * The maximum number of blocks per single transfer is reported as
+ * part of the block device capacity, and is ignored unless @c buffer
+ * is UNULL.
  */
-int block_translate ( struct interface *block, userptr_t buffer, size_t size ) {
+int block_translate ( struct interface *block, userptr_t buffer, size_t size,
+		      unsigned int max_count ) {
 	struct block_translator *blktrans;
 	int rc;
 
@@ -239,6 +245,7 @@ int block_translate ( struct interface *block, userptr_t buffer, size_t size ) {
 		blktrans->xferbuf.len = size;
 	} else {
 		blktrans->blksize = size;
+		blktrans->max_count = max_count;
 	}
 
 	/* Attach to interfaces, mortalise self, and return */
@@ -35,6 +35,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/image.h>
 #include <ipxe/xferbuf.h>
 #include <ipxe/downloader.h>
+#include <ipxe/timeline.h>
 
 /** @file
  *
@@ -58,6 +59,12 @@ struct downloader {
 	struct xfer_buffer buffer;
 };
 
+/** Download timeline phase */
+static struct timeline_phase download_timeline
+	__timeline_phase ( TIMELINE_DOWNLOAD ) = {
+	.name = "download",
+};
+
 /**
  * Free downloader object
  *
@@ -79,6 +86,9 @@ static void downloader_free ( struct refcnt *refcnt ) {
  */
 static void downloader_finished ( struct downloader *downloader, int rc ) {
 
+	/* Record end of download phase */
+	timeline_end ( &download_timeline );
+
 	/* Log download status */
 	if ( rc == 0 ) {
 		syslog ( LOG_NOTICE, "Downloaded \"%s\"\n",
@@ -270,6 +280,7 @@ int create_downloader ( struct interface *job, struct image *image ) {
 		    &downloader->refcnt );
 	downloader->image = image_get ( image );
 	xferbuf_umalloc_init ( &downloader->buffer, &image->data );
+	timeline_begin ( &download_timeline );
 
 	/* Instantiate child objects and attach to our interfaces */
 	if ( ( rc = xfer_open_uri ( &downloader->xfer, image->uri ) ) != 0 )
@@ -36,6 +36,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/umalloc.h>
 #include <ipxe/uri.h>
 #include <ipxe/image.h>
+#include <ipxe/timeline.h>
 
 /** @file
  *
@@ -56,6 +57,12 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 /** List of registered images */
 struct list_head images = LIST_HEAD_INIT ( images );
 
+/** Image execution timeline phase */
+static struct timeline_phase exec_timeline
+	__timeline_phase ( TIMELINE_EXEC ) = {
+	.name = "exec",
+};
+
 /** Image selected for execution */
 struct image_tag selected_image __image_tag = {
 	.name = "SELECTED",
@@ -400,7 +407,10 @@ int image_exec ( struct image *image ) {
 	unregister_image ( image );
 
 	/* Try executing the image */
-	if ( ( rc = image->type->exec ( image ) ) != 0 ) {
+	timeline_begin ( &exec_timeline );
+	rc = image->type->exec ( image );
+	timeline_end ( &exec_timeline );
+	if ( rc != 0 ) {
 		DBGC ( image, "IMAGE %s could not execute: %s\n",
 		       image->name, strerror ( rc ) );
 		/* Do not return yet; we still have clean-up to do */
@@ -26,6 +26,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/device.h>
 #include <ipxe/console.h>
 #include <ipxe/init.h>
+#include <ipxe/timeline.h>
 
 /** @file
  *
@@ -36,6 +37,12 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 /** "startup() has been called" flag */
 static int started = 0;
 
+/** Startup timeline phase */
+static struct timeline_phase startup_timeline
+	__timeline_phase ( TIMELINE_STARTUP ) = {
+	.name = "startup",
+};
+
 /** Colour for debug messages */
 #define colour table_start ( INIT_FNS )
 
@@ -69,6 +76,7 @@ void startup ( void ) {
 
 	if ( started )
 		return;
+	timeline_begin ( &startup_timeline );
 
 	/* Call registered startup functions */
 	for_each_table_entry ( startup_fn, STARTUP_FNS ) {
@@ -80,6 +88,7 @@ void startup ( void ) {
 	}
 
 	started = 1;
+	timeline_end ( &startup_timeline );
 	DBGC ( colour, "INIT startup complete\n" );
 }
 
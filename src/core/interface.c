@@ -23,6 +23,7 @@
 
 FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 
+#include <stdint.h>
 #include <string.h>
 #include <ipxe/interface.h>
 
@@ -176,6 +177,68 @@ static struct interface * intf_get_passthru ( struct interface *intf ) {
 	}
 }
 
+/**
+ * Number of entries in the interface operation cache
+ *
+ * Must be a power of two.
+ */
+#define INTF_OP_CACHE_SIZE 64
+
+/** An interface operation cache entry */
+struct interface_op_cache {
+	/** Interface descriptor, or NULL if entry is unused */
+	struct interface_descriptor *desc;
+	/** Operation type */
+	void *type;
+	/** Implementing method, or NULL if not implemented */
+	void *func;
+};
+
+/** Interface operation cache
+ *
+ * Interface descriptors and their operation arrays are static, so a
+ * cached lookup result (including a negative result) never becomes
+ * stale.
+ */
+static struct interface_op_cache intf_op_cache[INTF_OP_CACHE_SIZE];
+
+/**
+ * Find interface operation method
+ *
+ * @v desc		Interface descriptor
+ * @v type		Operation type
+ * @ret func		Implementing method, or NULL
+ */
+static void * intf_find_op ( struct interface_descriptor *desc, void *type ) {
+	struct interface_op_cache *cache;
+	struct interface_operation *op;
+	unsigned int index;
+	unsigned int i;
+	void *func = NULL;
+
+	/* Check cache */
+	index = ( ( ( ( intptr_t ) desc ) / sizeof ( *desc ) ) ^
+		  ( ( ( intptr_t ) type ) >> 4 ) );
+	cache = &intf_op_cache[ index & ( INTF_OP_CACHE_SIZE - 1 ) ];
+	if ( ( cache->desc == desc ) && ( cache->type == type ) )
+		return cache->func;
+
+	/* Search descriptor's operations */
+	for ( i = desc->num_op, op = desc->op ; i ; i--, op++ ) {
+		if ( op->type == type ) {
+			func = op->func;
+			break;
+		}
+	}
+
+	/* Update cache */
+	cache->desc = desc;
+	cache->type = type;
+	cache->func = func;
+
+	return func;
+}
+
 /**
  * Get object interface destination and operation method (without pass-through)
  *
@@ -187,18 +250,9 @@ static struct interface * intf_get_passthru ( struct interface *intf ) {
 void * intf_get_dest_op_no_passthru_untyped ( struct interface *intf,
 					      void *type,
 					      struct interface **dest ) {
-	struct interface_descriptor *desc;
-	struct interface_operation *op;
-	unsigned int i;
 
 	*dest = intf_get ( intf->dest );
-	desc = (*dest)->desc;
-	for ( i = desc->num_op, op = desc->op ; i ; i--, op++ ) {
-		if ( op->type == type )
-			return op->func;
-	}
-
-	return NULL;
+	return intf_find_op ( (*dest)->desc, type );
 }
 
 /**
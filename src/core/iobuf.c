@@ -26,7 +26,9 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <stdint.h>
 #include <strings.h>
 #include <errno.h>
+#include <stdlib.h>
 #include <ipxe/malloc.h>
+#include <ipxe/slab.h>
 #include <ipxe/iobuf.h>
 
 /** @file
@@ -35,6 +37,10 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
  *
  */
 
+/** Detached I/O buffer descriptor cache */
+struct slab_cache iob_slab __slab_cache =
+	SLAB_CACHE_INIT ( "iobuf", sizeof ( struct io_buffer ) );
+
 /**
  * Allocate I/O buffer with specified alignment and offset
  *
@@ -102,7 +108,7 @@ struct io_buffer * alloc_iob_raw ( size_t len, size_t align, size_t offset ) {
 			return NULL;
 
 		/* Allocate memory for descriptor */
-		iobuf = malloc ( sizeof ( *iobuf ) );
+		iobuf = slab_alloc ( &iob_slab );
 		if ( ! iobuf ) {
 			free_phys ( data, len );
 			return NULL;
@@ -113,6 +119,7 @@ struct io_buffer * alloc_iob_raw ( size_t len, size_t align, size_t offset ) {
 	memset ( &iobuf->map, 0, sizeof ( iobuf->map ) );
 	iobuf->head = iobuf->data = iobuf->tail = data;
 	iobuf->end = ( data + len );
+	iobuf->pool = NULL;
 
 	return iobuf;
 }
@@ -138,12 +145,27 @@ struct io_buffer * alloc_iob ( size_t len ) {
 	return alloc_iob_raw ( len, len, 0 );
 }
 
+/**
+ * Check if I/O buffer lies within its pool's DMA region
+ *
+ * @v pool		Receive I/O buffer pool
+ * @v iobuf		I/O buffer
+ * @ret contained	I/O buffer lies within the DMA region
+ */
+static int iob_pool_contains ( struct iob_pool *pool,
+			       struct io_buffer *iobuf ) {
+	void *end = ( pool->data + ( pool->count * pool->stride ) );
+
+	return ( ( iobuf->head >= pool->data ) && ( iobuf->head < end ) );
+}
+
 /**
  * Free I/O buffer
  *
  * @v iobuf	I/O buffer
  */
 void free_iob ( struct io_buffer *iobuf ) {
+	struct iob_pool *pool;
 	size_t len;
 
 	/* Allow free_iob(NULL) to be valid */
@@ -156,6 +178,20 @@ void free_iob ( struct io_buffer *iobuf ) {
 	assert ( iobuf->tail <= iobuf->end );
 	assert ( ! dma_mapped ( &iobuf->map ) );
 
+	/* Return buffer to pool, if applicable */
+	if ( iobuf->pool ) {
+		pool = iobuf->pool;
+		if ( ! iob_pool_contains ( pool, iobuf ) ) {
+			/* Free relocated data */
+			free_phys ( iobuf->head,
+				    ( iobuf->end - iobuf->head ) );
+		}
+		iobuf->data = NULL;
+		list_add ( &iobuf->list, &pool->free );
+		ref_put ( &pool->refcnt );
+		return;
+	}
+
 	/* Free buffer */
 	len = ( iobuf->end - iobuf->head );
 	if ( iobuf->end == iobuf ) {
@@ -167,7 +203,7 @@ void free_iob ( struct io_buffer *iobuf ) {
 
 		/* Descriptor is detached */
 		free_phys ( iobuf->head, len );
-		free ( iobuf );
+		slab_free ( &iob_slab, iobuf );
 	}
 }
 
@@ -207,13 +243,205 @@ struct io_buffer * alloc_rx_iob ( size_t len, struct dma_device *dma ) {
  */
 void free_rx_iob ( struct io_buffer *iobuf ) {
 
-	/* Unmap I/O buffer */
-	iob_unmap ( iobuf );
+	/* Unmap I/O buffer, if not from a (permanently mapped) pool */
+	if ( ! iobuf->pool )
+		iob_unmap ( iobuf );
 
 	/* Free I/O buffer */
 	free_iob ( iobuf );
 }
 
+/**
+ * Free receive I/O buffer pool
+ *
+ * @v refcnt		Reference count
+ */
+static void iob_pool_free ( struct refcnt *refcnt ) {
+	struct iob_pool *pool =
+		container_of ( refcnt, struct iob_pool, refcnt );
+
+	DBGC ( pool, "IOBPOOL %p freed\n", pool );
+	if ( ! pool->freed ) {
+		dma_free ( &pool->map, pool->data,
+			   ( pool->count * pool->stride ) );
+	}
+	free ( pool );
+}
+
+/**
+ * Allocate receive I/O buffer pool
+ *
+ * @v dma		DMA device
+ * @v len		Length of each I/O buffer
+ * @v count		Number of I/O buffers
+ * @ret pool		Receive I/O buffer pool, or NULL on error
+ *
+ * Each buffer will be physically aligned on its own size (rounded up
+ * to the nearest power of two), as for alloc_iob().  The pool will
+ * not be created if it would use up too much of the free heap.
+ */
+struct iob_pool * alloc_iob_pool ( struct dma_device *dma, size_t len,
+				   unsigned int count ) {
+	struct iob_pool *pool;
+	struct io_buffer *iobuf;
+	unsigned int i;
+	size_t size;
+
+	/* Allocate and initialise structure */
+	pool = zalloc ( sizeof ( *pool ) +
+			( count * sizeof ( pool->iobuf[0] ) ) );
+	if ( ! pool )
+		goto err_alloc;
+	ref_init ( &pool->refcnt, iob_pool_free );
+	INIT_LIST_HEAD ( &pool->free );
+	if ( len < IOB_ZLEN )
+		len = IOB_ZLEN;
+	pool->len = len;
+	pool->stride = ( 1UL << fls ( len - 1 ) );
+	pool->count = count;
+	size = ( count * pool->stride );
+
+	/* Do not attempt to allocate a region that would use up a
+	 * large part of the remaining heap.  The pool is only an
+	 * optimisation, and a failed allocation would needlessly
+	 * discard cached data.
+	 */
+	if ( size > ( freemem / IOB_POOL_HEAP_FRACTION ) ) {
+		DBGC ( pool, "IOBPOOL %p will not use %zd of %zd free bytes\n",
+		       pool, size, freemem );
+		goto err_size;
+	}
+
+	/* Allocate buffer region, aligned so that no individual
+	 * buffer crosses its own alignment boundary.
+	 */
+	pool->data = dma_alloc ( dma, &pool->map, size, pool->stride );
+	if ( ! pool->data )
+		goto err_dma;
+
+	/* Populate descriptors and add to free list */
+	for ( i = 0 ; i < count ; i++ ) {
+		iobuf = &pool->iobuf[i];
+		iobuf->head = ( pool->data + ( i * pool->stride ) );
+		iobuf->end = ( iobuf->head + len );
+		iobuf->pool = pool;
+		iobuf->data = NULL;
+		list_add_tail ( &iobuf->list, &pool->free );
+	}
+
+	DBGC ( pool, "IOBPOOL %p has %d x %zd bytes at [%08lx,%08lx)\n",
+	       pool, count, len, virt_to_phys ( pool->data ),
+	       ( virt_to_phys ( pool->data ) + size ) );
+	return pool;
+
+	dma_free ( &pool->map, pool->data, size );
+ err_dma:
+ err_size:
+	free ( pool );
+ err_alloc:
+	return NULL;
+}
+
+/**
+ * Release receive I/O buffer pool
+ *
+ * @v pool		Receive I/O buffer pool, or NULL
+ *
+ * This must be called while the DMA device still exists, typically
+ * when the network device is closed.  Any outstanding I/O buffers
+ * are moved out of the DMA region, and the DMA region is freed.  The
+ * pool descriptor will be freed once all outstanding I/O buffers have
+ * been returned to it.
+ *
+ * If an outstanding I/O buffer cannot be moved, then the DMA region
+ * is leaked rather than being freed while still in use.
+ */
+void free_iob_pool ( struct iob_pool *pool ) {
+	struct io_buffer *iobuf;
+	unsigned int outstanding;
+	unsigned int i;
+	size_t len;
+	void *data;
+	int leak = 0;
+
+	/* Allow free_iob_pool(NULL) to be valid */
+	if ( ! pool )
+		return;
+
+	/* Move any outstanding buffers out of the DMA region */
+	outstanding = 0;
+	for ( i = 0 ; i < pool->count ; i++ ) {
+		iobuf = &pool->iobuf[i];
+		if ( ! iobuf->data )
+			continue;
+		outstanding++;
+		len = ( iobuf->end - iobuf->head );
+		data = malloc_phys ( len, 1 );
+		if ( ! data ) {
+			leak = 1;
+			continue;
+		}
+		memcpy ( data, iobuf->head, len );
+		iobuf->data = ( data + ( iobuf->data - iobuf->head ) );
+		iobuf->tail = ( data + ( iobuf->tail - iobuf->head ) );
+		iobuf->end = ( data + len );
+		iobuf->head = data;
+	}
+	if ( outstanding ) {
+		DBGC ( pool, "IOBPOOL %p released with %d buffers "
+		       "outstanding%s\n", pool, outstanding,
+		       ( leak ? " (leaking region)" : "" ) );
+	}
+
+	/* Free DMA region, unless a buffer still needs it */
+	if ( ! leak ) {
+		dma_free ( &pool->map, pool->data,
+			   ( pool->count * pool->stride ) );
+	}
+	pool->freed = 1;
+
+	/* Drop creator's reference */
+	ref_put ( &pool->refcnt );
+}
+
+/**
+ * Allocate receive I/O buffer from pool
+ *
+ * @v pool		Receive I/O buffer pool, or NULL
+ * @v len		Length of I/O buffer
+ * @v dma		DMA device
+ * @ret iobuf		I/O buffer, or NULL on error
+ *
+ * If the pool is absent, exhausted, or has buffers that are too
+ * small, then this will fall back to alloc_rx_iob().  The caller
+ * must therefore always free the buffer using free_rx_iob() (or hand
+ * it to the network stack).
+ */
+struct io_buffer * iob_pool_alloc ( struct iob_pool *pool, size_t len,
+				    struct dma_device *dma ) {
+	struct io_buffer *iobuf;
+
+	/* Fall back to a mapped I/O buffer if no pooled buffer exists */
+	if ( ( ! pool ) || ( len > pool->len ) ||
+	     ( ! ( iobuf = list_first_entry ( &pool->free, struct io_buffer,
+					      list ) ) ) ) {
+		return alloc_rx_iob ( len, dma );
+	}
+	list_del ( &iobuf->list );
+
+	/* Reset descriptor, since a previous owner may have reused
+	 * the buffer (e.g. for transmission).
+	 */
+	memcpy ( &iobuf->map, &pool->map, sizeof ( iobuf->map ) );
+	iobuf->map.dma = NULL;
+	iobuf->data = iobuf->tail = iobuf->head;
+
+	/* Hold reference to pool on behalf of the buffer */
+	ref_get ( &pool->refcnt );
+
+	return iobuf;
+}
+
 /**
  * Ensure I/O buffer has sufficient headroom
  *
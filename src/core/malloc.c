@@ -33,13 +33,25 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/refcnt.h>
 #include <ipxe/malloc.h>
 #include <valgrind/memcheck.h>
+#include <config/general.h>
 
 /** @file
  *
  * Dynamic memory allocation
  *
+ * If MALLOC_PROFILE is defined in config/general.h, then each
+ * allocation made via malloc(), zalloc() or realloc() records its
+ * call site, and the number of live memory blocks of each size class
+ * is recorded.  The profile may be inspected using mprofile().
  */
 
+/* Enable heap allocation profiling, if applicable */
+#ifdef MALLOC_PROFILE
+#define MALLOC_PROFILING 1
+#else
+#define MALLOC_PROFILING 0
+#endif
+
 /** A free block of memory */
 struct memory_block {
 	/** Size of this block */
@@ -66,6 +78,10 @@ struct memory_block {
 struct autosized_block {
 	/** Size of this block */
 	size_t size;
+#if MALLOC_PROFILING
+	/** Allocation call site */
+	struct malloc_site *site;
+#endif
 	/** Remaining data */
 	char data[0];
 };
@@ -109,6 +125,54 @@ size_t maxusedmem;
 /** The heap itself */
 static char heap[HEAP_SIZE] __attribute__ (( aligned ( __alignof__(void *) )));
 
+#if MALLOC_PROFILING
+
+/** Heap allocation profile */
+static struct malloc_profile profile;
+
+/**
+ * Get size class of memory block
+ *
+ * @v size		Size of memory block
+ * @ret class		Size class
+ */
+static inline unsigned int mprofile_class ( size_t size ) {
+	unsigned int class = flsl ( size - 1 );
+
+	return ( ( class < MALLOC_SIZES ) ? class : ( MALLOC_SIZES - 1 ) );
+}
+
+/**
+ * Find profile entry for allocation call site
+ *
+ * @v caller		Caller address
+ * @ret site		Call site
+ */
+static struct malloc_site * mprofile_site ( void *caller ) {
+	struct malloc_site *site;
+	unsigned int index;
+	unsigned int i;
+
+	/* Probe for matching or unused entry, leaving the final entry
+	 * to accumulate any untracked call sites.
+	 */
+	index = ( ( ( intptr_t ) caller ) % ( MALLOC_SITES - 1 ) );
+	for ( i = 0 ; i < ( MALLOC_SITES - 1 ) ; i++ ) {
+		site = &profile.site[index];
+		if ( site->caller == caller )
+			return site;
+		if ( ! site->caller ) {
+			site->caller = caller;
+			return site;
+		}
+		if ( ++index == ( MALLOC_SITES - 1 ) )
+			index = 0;
+	}
+	return &profile.site[ MALLOC_SITES - 1 ];
+}
+
+#endif /* MALLOC_PROFILING */
+
 /**
  * Mark all blocks in free list as defined
  *
@@ -363,6 +427,9 @@ void * alloc_memblock ( size_t size, size_t align, size_t offset ) {
 			usedmem += actual_size;
 			if ( usedmem > maxusedmem )
 				maxusedmem = usedmem;
+#if MALLOC_PROFILING
+			profile.size[ mprofile_class ( actual_size ) ]++;
+#endif
 			/* Return allocated block */
 			DBGC2 ( &heap, "Allocated [%p,%p)\n", block,
 				( ( ( void * ) block ) + size ) );
@@ -493,32 +560,24 @@ void free_memblock ( void *ptr, size_t size ) {
 	/* Update memory usage statistics */
 	freemem += actual_size;
 	usedmem -= actual_size;
+#if MALLOC_PROFILING
+	profile.size[ mprofile_class ( actual_size ) ]--;
+#endif
 
 	check_blocks();
 	valgrind_make_blocks_noaccess();
 }
 
 /**
- * Reallocate memory
+ * Reallocate memory on behalf of a caller
  *
  * @v old_ptr		Memory previously allocated by malloc(), or NULL
  * @v new_size		Requested size
+ * @v caller		Caller address (used only when profiling)
  * @ret new_ptr		Allocated memory, or NULL
- *
- * Allocates memory with no particular alignment requirement.  @c
- * new_ptr will be aligned to at least a multiple of sizeof(void*).
- * If @c old_ptr is non-NULL, then the contents of the newly allocated
- * memory will be the same as the contents of the previously allocated
- * memory, up to the minimum of the old and new sizes.  The old memory
- * will be freed.
- *
- * If allocation fails the previously allocated block is left
- * untouched and NULL is returned.
- *
- * Calling realloc() with a new size of zero is a valid way to free a
- * memory block.
  */
-void * realloc ( void *old_ptr, size_t new_size ) {
+static void * mrealloc ( void *old_ptr, size_t new_size,
+			 void *caller __unused ) {
 	struct autosized_block *old_block;
 	struct autosized_block *new_block;
 	size_t old_total_size;
@@ -538,8 +597,17 @@ void * realloc ( void *old_ptr, size_t new_size ) {
 		if ( ! new_block )
 			return NULL;
 		new_block->size = new_total_size;
-		VALGRIND_MAKE_MEM_NOACCESS ( &new_block->size,
-					     sizeof ( new_block->size ) );
+#if MALLOC_PROFILING
+		new_block->site = mprofile_site ( caller );
+		new_block->site->count++;
+		new_block->site->len += new_size;
+		new_block->site->total++;
+		if ( new_block->site->len > new_block->site->max )
+			new_block->site->max = new_block->site->len;
+#endif
+		VALGRIND_MAKE_MEM_NOACCESS ( new_block,
+					     offsetof ( struct autosized_block,
+							data ) );
 		new_ptr = &new_block->data;
 		VALGRIND_MALLOCLIKE_BLOCK ( new_ptr, new_size, 0, 0 );
 	}
@@ -552,18 +620,50 @@ void * realloc ( void *old_ptr, size_t new_size ) {
 	if ( old_ptr && ( old_ptr != NOWHERE ) ) {
 		old_block = container_of ( old_ptr, struct autosized_block,
 					   data );
-		VALGRIND_MAKE_MEM_DEFINED ( &old_block->size,
-					    sizeof ( old_block->size ) );
+		VALGRIND_MAKE_MEM_DEFINED ( old_block,
+					    offsetof ( struct autosized_block,
+						       data ) );
 		old_total_size = old_block->size;
 		assert ( old_total_size != 0 );
 		old_size = ( old_total_size -
 			     offsetof ( struct autosized_block, data ) );
+#if MALLOC_PROFILING
+		old_block->site->count--;
+		old_block->site->len -= old_size;
+#endif
 		memcpy ( new_ptr, old_ptr,
 			 ( ( old_size < new_size ) ? old_size : new_size ) );
 		VALGRIND_FREELIKE_BLOCK ( old_ptr, 0 );
 		free_memblock ( old_block, old_total_size );
 	}
 
+	return new_ptr;
+}
+
+/**
+ * Reallocate memory
+ *
+ * @v old_ptr		Memory previously allocated by malloc(), or NULL
+ * @v new_size		Requested size
+ * @ret new_ptr		Allocated memory, or NULL
+ *
+ * Allocates memory with no particular alignment requirement.  @c
+ * new_ptr will be aligned to at least a multiple of sizeof(void*).
+ * If @c old_ptr is non-NULL, then the contents of the newly allocated
+ * memory will be the same as the contents of the previously allocated
+ * memory, up to the minimum of the old and new sizes.  The old memory
+ * will be freed.
+ *
+ * If allocation fails the previously allocated block is left
+ * untouched and NULL is returned.
+ *
+ * Calling realloc() with a new size of zero is a valid way to free a
+ * memory block.
+ */
+void * realloc ( void *old_ptr, size_t new_size ) {
+	void *new_ptr;
+
+	new_ptr = mrealloc ( old_ptr, new_size, __builtin_return_address ( 0 ) );
 	if ( ASSERTED ) {
 		DBGC ( &heap, "Possible memory corruption detected from %p\n",
 		       __builtin_return_address ( 0 ) );
@@ -583,7 +683,7 @@ void * realloc ( void *old_ptr, size_t new_size ) {
 void * malloc ( size_t size ) {
 	void *ptr;
 
-	ptr = realloc ( NULL, size );
+	ptr = mrealloc ( NULL, size, __builtin_return_address ( 0 ) );
 	if ( ASSERTED ) {
 		DBGC ( &heap, "Possible memory corruption detected from %p\n",
 		       __builtin_return_address ( 0 ) );
@@ -603,7 +703,7 @@ void * malloc ( size_t size ) {
  */
 void free ( void *ptr ) {
 
-	realloc ( ptr, 0 );
+	mrealloc ( ptr, 0, NULL );
 	if ( ASSERTED ) {
 		DBGC ( &heap, "Possible memory corruption detected from %p\n",
 		       __builtin_return_address ( 0 ) );
@@ -624,7 +724,7 @@ void free ( void *ptr ) {
 void * zalloc ( size_t size ) {
 	void *data;
 
-	data = malloc ( size );
+	data = mrealloc ( NULL, size, __builtin_return_address ( 0 ) );
 	if ( data )
 		memset ( data, 0, size );
 	if ( ASSERTED ) {
@@ -652,6 +752,13 @@ void mpopulate ( void *start, size_t len ) {
 	 */
 	len &= ~( MIN_MEMBLOCK_SIZE - 1 );
 
+	/* Account for the block in the profile, since free_memblock()
+	 * will treat it as a freed block.
+	 */
+#if MALLOC_PROFILING
+	profile.size[ mprofile_class ( len ) ]++;
+#endif
+
 	/* Add to allocation pool */
 	free_memblock ( start, len );
 
@@ -659,6 +766,39 @@ void mpopulate ( void *start, size_t len ) {
 	usedmem += len;
 }
 
+/**
+ * Get free memory block statistics
+ *
+ * @v count		Number of free memory blocks to fill in
+ * @v largest		Size of largest free memory block to fill in
+ */
+void mfreestat ( unsigned int *count, size_t *largest ) {
+	struct memory_block *block;
+
+	*count = 0;
+	*largest = 0;
+	valgrind_make_blocks_defined();
+	list_for_each_entry ( block, &free_blocks, list ) {
+		( *count )++;
+		if ( block->size > *largest )
+			*largest = block->size;
+	}
+	valgrind_make_blocks_noaccess();
+}
+
+/**
+ * Get heap allocation profile
+ *
+ * @ret profile		Heap allocation profile, or NULL if not profiling
+ */
+struct malloc_profile * mprofile ( void ) {
+#if MALLOC_PROFILING
+	return &profile;
+#else
+	return NULL;
+#endif
+}
+
 /**
  * Initialise the heap
  *
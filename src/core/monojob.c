@@ -32,6 +32,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/job.h>
 #include <ipxe/monojob.h>
 #include <ipxe/timer.h>
+#include <ipxe/netdevice.h>
 
 /** @file
  *
@@ -91,6 +92,7 @@ int monojob_wait ( const char *string, unsigned long timeout ) {
 	unsigned int percentage;
 	size_t clear_len = 0;
 	int ongoing_rc;
+	int idle = 0;
 	int key;
 	int rc;
 
@@ -104,6 +106,12 @@ int monojob_wait ( const char *string, unsigned long timeout ) {
 		step();
 		now = currticks();
 
+		/* Avoid spinning while waiting for the network, unless
+		 * the job made progress during the previous tick
+		 */
+		if ( idle )
+			net_nap();
+
 		/* Continue until a timer tick occurs (to minimise
 		 * time wasted checking for progress and keypresses).
 		 */
@@ -125,7 +133,8 @@ int monojob_wait ( const char *string, unsigned long timeout ) {
 		ongoing_rc = job_progress ( &monojob, &progress );
 
 		/* Reset timeout if progress has been made */
-		if ( completed != progress.completed )
+		idle = ( completed == progress.completed );
+		if ( ! idle )
 			last_progress = now;
 		completed = progress.completed;
 
@@ -23,6 +23,7 @@
 
 FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 
+#include <assert.h>
 #include <ipxe/list.h>
 #include <ipxe/init.h>
 #include <ipxe/process.h>
@@ -33,10 +34,23 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
  *
  * We implement a trivial form of cooperative multitasking, in which
  * all processes share a single stack and address space.
+ *
+ * A process that has no work to do should remove itself from the run
+ * queue using process_del(), and should be woken up again using
+ * process_add() by whichever event (e.g. a timer starting, a network
+ * device opening, or a data transfer window opening) gives it more
+ * work to do.
  */
 
-/** Process run queue */
-static LIST_HEAD ( run_queue );
+/** Process run queues, one per priority class */
+static struct list_head run_queue[PROC_PRIORITIES] = {
+	LIST_HEAD_INIT ( run_queue[PROC_PRIO_NET] ),
+	LIST_HEAD_INIT ( run_queue[PROC_PRIO_NORMAL] ),
+	LIST_HEAD_INIT ( run_queue[PROC_PRIO_BACKGROUND] ),
+};
+
+/** Number of consecutive steps given to each priority class */
+static unsigned int run_burst[PROC_PRIORITIES];
 
 /**
  * Get pointer to object containing process
@@ -60,8 +74,10 @@ void process_add ( struct process *process ) {
 	if ( ! process_running ( process ) ) {
 		DBGC ( PROC_COL ( process ), "PROCESS " PROC_FMT
 		       " starting\n", PROC_DBG ( process ) );
+		assert ( process->desc->priority < PROC_PRIORITIES );
 		ref_get ( process->refcnt );
-		list_add_tail ( &process->list, &run_queue );
+		list_add_tail ( &process->list,
+				&run_queue[process->desc->priority] );
 	} else {
 		DBGC ( PROC_COL ( process ), "PROCESS " PROC_FMT
 		       " already started\n", PROC_DBG ( process ) );
@@ -89,25 +105,68 @@ void process_del ( struct process *process ) {
 	}
 }
 
+/**
+ * Select run queue for next step
+ *
+ * @ret queue		Run queue, or NULL if no processes are runnable
+ *
+ * The highest priority class with runnable processes is selected,
+ * unless it has already been given PROC_BURST consecutive steps while
+ * a lower priority class has been waiting.
+ */
+static struct list_head * run_queue_select ( void ) {
+	unsigned int priority;
+	unsigned int lower;
+
+	for ( priority = 0 ; priority < PROC_PRIORITIES ; priority++ ) {
+
+		/* Skip classes with no runnable processes */
+		if ( list_empty ( &run_queue[priority] ) )
+			continue;
+
+		/* Select this class if it has not used up its burst */
+		if ( run_burst[priority] < PROC_BURST ) {
+			run_burst[priority]++;
+			return &run_queue[priority];
+		}
+
+		/* Select this class if no lower class is waiting */
+		for ( lower = ( priority + 1 ) ; lower < PROC_PRIORITIES ;
+		      lower++ ) {
+			if ( ! list_empty ( &run_queue[lower] ) )
+				break;
+		}
+		if ( lower == PROC_PRIORITIES )
+			return &run_queue[priority];
+
+		/* Yield this step to the lower classes */
+		run_burst[priority] = 0;
+	}
+
+	return NULL;
+}
+
 /**
  * Single-step a single process
  *
- * This executes a single step of the first process in the run queue,
- * and moves the process to the end of the run queue.
+ * This executes a single step of the first process in the selected
+ * run queue, and moves the process to the end of its run queue.
  */
 void step ( void ) {
+	struct list_head *queue;
 	struct process *process;
 	struct process_descriptor *desc;
 	void *object;
 
-	if ( ( process = list_first_entry ( &run_queue, struct process,
+	if ( ( queue = run_queue_select() ) &&
+	     ( process = list_first_entry ( queue, struct process,
 					    list ) ) ) {
 		ref_get ( process->refcnt ); /* Inhibit destruction mid-step */
 		desc = process->desc;
 		object = process_object ( process );
 		if ( desc->reschedule ) {
 			list_del ( &process->list );
-			list_add_tail ( &process->list, &run_queue );
+			list_add_tail ( &process->list, queue );
 		} else {
 			process_del ( process );
 		}
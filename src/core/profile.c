@@ -25,6 +25,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 #include <strings.h>
 #include <limits.h>
 #include <assert.h>
@@ -43,6 +44,9 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
  * The algorithm for updating the mean and variance estimators is from
  * The Art of Computer Programming (via Wikipedia), with adjustments
  * to avoid the use of floating-point instructions.
+ *
+ * Samples are also recorded in a histogram with power-of-two bucket
+ * sizes, from which approximate percentiles may be obtained.
  */
 
 /** Accumulated time excluded from profiling */
@@ -117,12 +121,25 @@ void profile_update ( struct profiler *profiler, unsigned long sample ) {
 	unsigned int accvar_delta_shift;
 	unsigned int accvar_delta_msb;
 	unsigned int accvar_shift;
+	unsigned int bucket;
 
 	/* Our scaling logic assumes that sample values never overflow
 	 * a signed long (i.e. that the high bit is always zero).
 	 */
 	assert ( ( ( signed ) sample ) >= 0 );
 
+	/* Do nothing if profiler is disabled */
+	if ( profiler->disabled )
+		return;
+
+	/* Update histogram and maximum sample value */
+	bucket = flsl ( sample );
+	if ( bucket >= PROFILE_BUCKETS )
+		bucket = ( PROFILE_BUCKETS - 1 );
+	profiler->hist[bucket]++;
+	if ( sample > profiler->max )
+		profiler->max = sample;
+
 	/* Update sample count, limiting to avoid signed overflow */
 	if ( profiler->count < INT_MAX )
 		profiler->count++;
@@ -276,3 +293,76 @@ unsigned long profile_stddev ( struct profiler *profiler ) {
 
 	return isqrt ( profile_variance ( profiler ) );
 }
+
+/**
+ * Get approximate sample percentile
+ *
+ * @v profiler		Profiler
+ * @v percent		Percentile
+ * @ret value		Upper bound on the specified percentile
+ *
+ * The returned value is the upper limit of the histogram bucket
+ * containing the specified percentile (limited to the maximum sample
+ * value), and so may overestimate the true percentile by up to a
+ * factor of two.
+ */
+unsigned long profile_percentile ( struct profiler *profiler,
+				   unsigned int percent ) {
+	unsigned long long total = 0;
+	unsigned long long target;
+	unsigned long long seen = 0;
+	unsigned int bucket;
+
+	/* Count samples */
+	for ( bucket = 0 ; bucket < PROFILE_BUCKETS ; bucket++ )
+		total += profiler->hist[bucket];
+	if ( ! total )
+		return 0;
+
+	/* Find bucket containing percentile */
+	target = ( ( ( total * percent ) + 99 ) / 100 );
+	if ( ! target )
+		target = 1;
+	for ( bucket = 0 ; bucket < ( PROFILE_BUCKETS - 1 ) ; bucket++ ) {
+		seen += profiler->hist[bucket];
+		if ( seen >= target )
+			break;
+	}
+
+	/* Return upper limit of bucket, limited to maximum sample */
+	if ( ( bucket < ( PROFILE_BUCKETS - 1 ) ) &&
+	     ( ( ( 1UL << bucket ) - 1 ) < profiler->max ) ) {
+		return ( ( 1UL << bucket ) - 1 );
+	}
+	return profiler->max;
+}
+
+/**
+ * Reset profiler statistics
+ *
+ * @v profiler		Profiler
+ */
+void profile_reset ( struct profiler *profiler ) {
+	const char *name = profiler->name;
+	int disabled = profiler->disabled;
+
+	memset ( profiler, 0, sizeof ( *profiler ) );
+	profiler->name = name;
+	profiler->disabled = disabled;
+}
+
+/**
+ * Find profiler by name
+ *
+ * @v name		Profiler name
+ * @ret profiler	Profiler, or NULL if not found
+ */
+struct profiler * find_profiler ( const char *name ) {
+	struct profiler *profiler;
+
+	for_each_table_entry ( profiler, PROFILERS ) {
+		if ( strcmp ( profiler->name, name ) == 0 )
+			return profiler;
+	}
+	return NULL;
+}
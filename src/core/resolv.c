@@ -32,6 +32,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/process.h>
 #include <ipxe/socket.h>
 #include <ipxe/resolv.h>
+#include <ipxe/timeline.h>
 
 /** @file
  *
@@ -136,6 +137,12 @@ struct resolver numeric_resolver __resolver ( RESOLV_NUMERIC ) = {
  ***************************************************************************
  */
 
+/** Name resolution timeline phase */
+static struct timeline_phase resolv_timeline
+	__timeline_phase ( TIMELINE_RESOLV ) = {
+	.name = "resolv",
+};
+
 /** A name resolution multiplexer */
 struct resolv_mux {
 	/** Reference counter */
@@ -187,6 +194,9 @@ static int resmux_try ( struct resolv_mux *mux ) {
  */
 static void resmux_close ( struct resolv_mux *mux, int rc ) {
 
+	/* Record end of name resolution phase */
+	timeline_end ( &resolv_timeline );
+
 	/* Shut down all interfaces */
 	intf_shutdown ( &mux->child, rc );
 	intf_shutdown ( &mux->parent, rc );
@@ -280,6 +290,7 @@ int resolv ( struct interface *resolv, const char *name,
 	 */
 	if ( ( rc = resmux_try ( mux ) ) != 0 )
 		goto err;
+	timeline_begin ( &resolv_timeline );
 
 	/* Attach parent interface, mortalise self, and return */
 	intf_plug_plug ( &mux->parent, resolv );
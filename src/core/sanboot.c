@@ -32,8 +32,12 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 
 #include <stdint.h>
 #include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
 #include <errno.h>
 #include <assert.h>
+#include <byteswap.h>
 #include <ipxe/xfer.h>
 #include <ipxe/open.h>
 #include <ipxe/timer.h>
@@ -42,6 +46,8 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/dhcp.h>
 #include <ipxe/settings.h>
 #include <ipxe/quiesce.h>
+#include <ipxe/umalloc.h>
+#include <ipxe/tracepoint.h>
 #include <ipxe/sanboot.h>
 
 /**
@@ -75,12 +81,68 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
  */
 #define SAN_REOPEN_DELAY_SECS 5
 
+/**
+ * Default number of concurrent read/write commands
+ *
+ * Large reads and writes are split into fragments of at most the
+ * underlying device's maximum transfer size.  Allowing several
+ * fragments to be in flight at once hides the network round-trip
+ * time.  The underlying block device's flow control window is
+ * respected, so devices that cannot accept concurrent commands will
+ * simply see one command at a time.
+ */
+#define SAN_DEFAULT_QUEUE_DEPTH 4
+
+/**
+ * Length of a SAN block cache line
+ *
+ * OS loaders tend to issue large numbers of small sequential reads.
+ * Reading an entire cache line on a miss converts these into a much
+ * smaller number of network round trips.
+ */
+#define SAN_CACHE_LINE_LEN ( 64 * 1024 )
+
+/**
+ * Default multipath mode
+ *
+ * By default, additional SAN paths are used only for failover: the
+ * first path to become available is used for all commands, and the
+ * remaining paths are closed.
+ */
+#define SAN_DEFAULT_MULTIPATH 0
+
+/** Number of SAN block cache lines */
+#define SAN_CACHE_LINES 32
+
+/** Maximum number of SAN block cache lines to read ahead */
+#define SAN_CACHE_MAX_AHEAD 8
+
+/**
+ * Length of a SAN memdisk chunk
+ *
+ * A memdisk is filled in units of chunks, each of which is read
+ * using a single command.  Chunks that have not yet been filled in
+ * the background are read on demand.
+ */
+#define SAN_MEMDISK_CHUNK_LEN ( 64 * 1024 )
+
 /** List of SAN devices */
 LIST_HEAD ( san_devices );
 
 /** Number of times to retry commands */
 static unsigned long san_retries = SAN_DEFAULT_RETRIES;
 
+/** Number of concurrent read/write commands */
+static unsigned long san_queue_depth = SAN_DEFAULT_QUEUE_DEPTH;
+
+/** Use all available paths concurrently */
+static unsigned long san_multipath = SAN_DEFAULT_MULTIPATH;
+
+/** SAN device command tracepoint */
+static struct tracepoint sandev_command_tracepoint __tracepoint = {
+	.name = "sandev.command",
+};
+
 /**
  * Find SAN device by drive number
  *
@@ -130,9 +192,109 @@ static void sandev_free ( struct refcnt *refcnt ) {
 		uri_put ( sandev->path[i].uri );
 		assert ( sandev->path[i].desc == NULL );
 	}
+	ufree ( sandev->cache.data );
+	free ( sandev->cache.line );
+	ufree ( sandev->memdisk.data );
+	bitmap_free ( &sandev->memdisk.filled );
 	free ( sandev );
 }
 
+/**
+ * Record SAN device command completion
+ *
+ * @v sandev		SAN device
+ * @v type		Command type
+ * @v started		Time at which command was issued
+ * @v len		Length of data transferred
+ * @v rc		Command status
+ */
+static void sandev_record ( struct san_device *sandev, unsigned int type,
+			    unsigned long started, size_t len, int rc ) {
+	struct san_command_stats *stats = &sandev->stats.command[type];
+	unsigned long latency;
+	unsigned int bucket;
+
+	/* Update counters */
+	if ( rc == 0 ) {
+		stats->good++;
+		stats->bytes += len;
+	} else {
+		stats->bad++;
+	}
+
+	/* Update latency */
+	latency = ( ( ( currticks() - started ) * 1000 ) / TICKS_PER_SEC );
+	stats->latency += latency;
+	if ( latency > stats->max )
+		stats->max = latency;
+
+	/* Update latency histogram */
+	bucket = ( latency ? ( flsl ( latency ) - 1 ) : 0 );
+	if ( bucket >= SAN_LATENCY_BUCKETS )
+		bucket = ( SAN_LATENCY_BUCKETS - 1 );
+	stats->count[bucket]++;
+}
+
+/**
+ * Identify SAN device read/write command type
+ *
+ * @v block_rw		Block read/write method
+ * @ret type		Command type
+ */
+static unsigned int
+sandev_rw_type ( int ( * block_rw ) ( struct interface *control,
+				      struct interface *data,
+				      uint64_t lba, unsigned int count,
+				      userptr_t buffer, size_t len ) ) {
+
+	return ( ( block_rw == block_write ) ? SAN_WRITE : SAN_READ );
+}
+
+/**
+ * Abort queued SAN device commands
+ *
+ * @v sandev		SAN device
+ * @v sanpath		SAN path, or NULL to abort commands on all paths
+ * @v rc		Reason for abort
+ */
+static void sandev_abort ( struct san_device *sandev,
+			   struct san_path *sanpath, int rc ) {
+	struct san_command *sancmd;
+	unsigned int i;
+
+	for ( i = 0 ; i < SAN_MAX_QUEUE_DEPTH ; i++ ) {
+		sancmd = &sandev->queue[i];
+		if ( ( sancmd->rc == -EINPROGRESS ) &&
+		     ( ( ! sanpath ) || ( sancmd->sanpath == sanpath ) ) ) {
+			intf_restart ( &sancmd->block, rc );
+			sancmd->rc = rc;
+		}
+	}
+}
+
+/**
+ * Abort SAN memdisk background fill commands
+ *
+ * @v sandev		SAN device
+ * @v sanpath		SAN path, or NULL to abort commands on all paths
+ * @v rc		Reason for abort
+ */
+static void sandev_memdisk_abort ( struct san_device *sandev,
+				   struct san_path *sanpath, int rc ) {
+	struct san_command *fill;
+	unsigned int i;
+
+	for ( i = 0 ; i < SAN_MAX_QUEUE_DEPTH ; i++ ) {
+		fill = &sandev->memdisk.fill[i];
+		if ( fill->count &&
+		     ( ( ! sanpath ) || ( fill->sanpath == sanpath ) ) ) {
+			intf_restart ( &fill->block, rc );
+			fill->count = 0;
+			fill->rc = rc;
+		}
+	}
+}
+
 /**
  * Close SAN device command
  *
@@ -149,6 +311,9 @@ static void sandev_command_close ( struct san_device *sandev, int rc ) {
 
 	/* Record command status */
 	sandev->command_rc = rc;
+
+	/* Abort any queued commands */
+	sandev_abort ( sandev, NULL, rc );
 }
 
 /**
@@ -175,6 +340,30 @@ static struct interface_operation sandev_command_op[] = {
 static struct interface_descriptor sandev_command_desc =
 	INTF_DESC ( struct san_device, command, sandev_command_op );
 
+/**
+ * Close queued SAN device command
+ *
+ * @v sancmd		Queued SAN device command
+ * @v rc		Reason for close
+ */
+static void sancmd_close ( struct san_command *sancmd, int rc ) {
+
+	/* Restart interface */
+	intf_restart ( &sancmd->block, rc );
+
+	/* Record command status */
+	sancmd->rc = rc;
+}
+
+/** Queued SAN device command interface operations */
+static struct interface_operation sancmd_block_op[] = {
+	INTF_OP ( intf_close, struct san_command *, sancmd_close ),
+};
+
+/** Queued SAN device command interface descriptor */
+static struct interface_descriptor sancmd_block_desc =
+	INTF_DESC ( struct san_command, block, sancmd_block_op );
+
 /**
  * Handle SAN device command timeout
  *
@@ -238,6 +427,7 @@ static int sanpath_open ( struct san_path *sanpath ) {
  */
 static void sanpath_close ( struct san_path *sanpath, int rc ) {
 	struct san_device *sandev = sanpath->sandev;
+	struct san_path *other;
 
 	/* Record status */
 	sanpath->path_rc = rc;
@@ -249,11 +439,29 @@ static void sanpath_close ( struct san_path *sanpath, int rc ) {
 	/* Stop process */
 	process_del ( &sanpath->process );
 
+	/* Abort any queued commands issued via this path */
+	sandev_abort ( sandev, sanpath, rc );
+	sandev_memdisk_abort ( sandev, sanpath, rc );
+
 	/* Restart interfaces, avoiding potential loops */
 	if ( sanpath == sandev->active ) {
 		intfs_restart ( rc, &sandev->command, &sanpath->block, NULL );
 		sandev->active = NULL;
-		sandev_command_close ( sandev, rc );
+
+		/* Fail any outstanding (non-queued) command */
+		stop_timer ( &sandev->timer );
+		sandev->command_rc = rc;
+
+		/* Fail over to any other ready path */
+		list_for_each_entry ( other, &sandev->opened, list ) {
+			if ( other->path_rc == 0 ) {
+				DBGC ( sandev->drive, "SAN %#02x.%d is "
+				       "active\n", sandev->drive,
+				       other->index );
+				sandev->active = other;
+				break;
+			}
+		}
 	} else {
 		intf_restart ( &sanpath->block, rc );
 	}
@@ -304,6 +512,10 @@ static void sanpath_step ( struct san_path *sanpath ) {
 	if ( sanpath == sandev->active )
 		return;
 
+	/* Ignore if we are already ready for multipath use */
+	if ( sanpath->path_rc == 0 )
+		return;
+
 	/* Wait until path has become available */
 	if ( ! xfer_window ( &sanpath->block ) )
 		return;
@@ -311,11 +523,14 @@ static void sanpath_step ( struct san_path *sanpath ) {
 	/* Record status */
 	sanpath->path_rc = 0;
 
-	/* Mark as active path or close as applicable */
+	/* Mark as active path, leave open, or close as applicable */
 	if ( ! sandev->active ) {
 		DBGC ( sandev->drive, "SAN %#02x.%d is active\n",
 		       sandev->drive, sanpath->index );
 		sandev->active = sanpath;
+	} else if ( san_multipath ) {
+		DBGC ( sandev->drive, "SAN %#02x.%d is available for "
+		       "multipath use\n", sandev->drive, sanpath->index );
 	} else {
 		DBGC ( sandev->drive, "SAN %#02x.%d is available\n",
 		       sandev->drive, sanpath->index );
@@ -375,6 +590,9 @@ int sandev_reopen ( struct san_device *sandev ) {
 	/* Unquiesce system */
 	unquiesce();
 
+	/* Record (re)opening attempt */
+	sandev->stats.reopens++;
+
 	/* Close any outstanding command and restart interfaces */
 	sandev_restart ( sandev, -ECONNRESET );
 	assert ( sandev->active == NULL );
@@ -511,17 +729,35 @@ sandev_command ( struct san_device *sandev,
 				     const union san_command_params *params ),
 		 const union san_command_params *params ) {
 	unsigned int retries = 0;
+	unsigned long started;
+	unsigned int type;
+	size_t len;
+	int attempted = 0;
 	int rc;
 
 	/* Sanity check */
 	assert ( ! timer_running ( &sandev->timer ) );
 
+	/* Identify command type for statistics */
+	if ( command == sandev_command_rw ) {
+		type = sandev_rw_type ( params->rw.block_rw );
+		len = ( params->rw.count * sandev->capacity.blksize );
+	} else {
+		type = SAN_CAPACITY;
+		len = 0;
+	}
+	trace ( &sandev_command_tracepoint, len );
+
 	/* Unquiesce system */
 	unquiesce();
 
 	/* (Re)try command */
 	do {
 
+		/* Record retry, if applicable */
+		if ( attempted++ )
+			sandev->stats.retries++;
+
 		/* Reopen block device if applicable */
 		if ( sandev_needs_reopen ( sandev ) &&
 		     ( ( rc = sandev_reopen ( sandev ) ) != 0 ) ) {
@@ -537,6 +773,7 @@ sandev_command ( struct san_device *sandev,
 		}
 
 		/* Initiate command */
+		started = currticks();
 		if ( ( rc = command ( sandev, params ) ) != 0 ) {
 			retries++;
 			continue;
@@ -549,6 +786,10 @@ sandev_command ( struct san_device *sandev,
 		while ( timer_running ( &sandev->timer ) )
 			step();
 
+		/* Record command completion */
+		sandev_record ( sandev, type, started, len,
+				sandev->command_rc );
+
 		/* Check command status */
 		if ( ( rc = sandev->command_rc ) != 0 ) {
 			retries++;
@@ -583,6 +824,269 @@ int sandev_reset ( struct san_device *sandev ) {
 	return 0;
 }
 
+/**
+ * Select SAN path for a new queued read/write command
+ *
+ * @v sandev		SAN device
+ * @v depth		Maximum number of concurrent commands
+ * @ret sanpath		SAN path, or NULL if no path is ready
+ *
+ * In active-active multipath mode, commands are spread over all
+ * ready paths by choosing the path with the fewest outstanding
+ * commands.  Paths are rotated to the end of the list of opened paths
+ * when chosen, so that ties are broken in round-robin order.
+ * Otherwise, all commands are issued via the active path.
+ */
+static struct san_path * sandev_select_path ( struct san_device *sandev,
+					      unsigned int depth ) {
+	struct san_path *sanpath;
+	struct san_path *best = NULL;
+	unsigned int best_outstanding = 0;
+	unsigned int outstanding;
+	unsigned int i;
+
+	/* Use active path unless multipath is enabled */
+	if ( ! san_multipath ) {
+		sanpath = sandev->active;
+		return ( xfer_window ( &sanpath->block ) ? sanpath : NULL );
+	}
+
+	/* Find least busy ready path */
+	list_for_each_entry ( sanpath, &sandev->opened, list ) {
+
+		/* Skip paths that are not ready */
+		if ( ( sanpath->path_rc != 0 ) ||
+		     ( ! xfer_window ( &sanpath->block ) ) )
+			continue;
+
+		/* Count outstanding commands, including background
+		 * memdisk fill commands
+		 */
+		outstanding = 0;
+		for ( i = 0 ; i < depth ; i++ ) {
+			if ( ( sandev->queue[i].rc == -EINPROGRESS ) &&
+			     ( sandev->queue[i].sanpath == sanpath ) )
+				outstanding++;
+			if ( ( sandev->memdisk.fill[i].rc == -EINPROGRESS ) &&
+			     ( sandev->memdisk.fill[i].sanpath == sanpath ) )
+				outstanding++;
+		}
+
+		/* Record least busy path */
+		if ( ( ! best ) || ( outstanding < best_outstanding ) ) {
+			best = sanpath;
+			best_outstanding = outstanding;
+		}
+	}
+
+	/* Rotate chosen path to end of list */
+	if ( best ) {
+		list_del ( &best->list );
+		list_add_tail ( &best->list, &sandev->opened );
+	}
+
+	return best;
+}
+
+/**
+ * Read from or write to SAN device using multiple concurrent commands
+ *
+ * @v sandev		SAN device
+ * @v lba		Starting underlying block address
+ * @v count		Number of underlying blocks
+ * @v buffer		Data buffer
+ * @v block_rw		Block read/write method
+ * @v depth		Maximum number of concurrent commands
+ * @ret rc		Return status code
+ *
+ * Fragments are issued in ascending order.  If any fragment fails,
+ * then that fragment alone is reissued (possibly via a different
+ * path), leaving any other outstanding fragments undisturbed.
+ */
+static int sandev_rw_queue ( struct san_device *sandev, uint64_t lba,
+			     unsigned int count, userptr_t buffer,
+			     int ( * block_rw ) ( struct interface *control,
+						  struct interface *data,
+						  uint64_t lba,
+						  unsigned int count,
+						  userptr_t buffer,
+						  size_t len ),
+			     unsigned int depth ) {
+	size_t blksize = sandev->capacity.blksize;
+	unsigned int type = sandev_rw_type ( block_rw );
+	uint64_t end = ( lba + count );
+	uint64_t next = lba;
+	struct san_command *sancmd;
+	struct san_path *sanpath;
+	unsigned int retries = 0;
+	unsigned int active;
+	unsigned int pending;
+	unsigned int i;
+	int retried;
+	int rc = 0;
+
+	/* Sanity check */
+	assert ( ! timer_running ( &sandev->timer ) );
+
+	/* Unquiesce system */
+	unquiesce();
+
+	while ( 1 ) {
+
+		/* Reap completed commands */
+		active = 0;
+		pending = 0;
+		for ( i = 0 ; i < depth ; i++ ) {
+			sancmd = &sandev->queue[i];
+			if ( ! sancmd->count )
+				continue;
+			if ( sancmd->rc == -EINPROGRESS ) {
+				active++;
+			} else if ( sancmd->rc == 0 ) {
+				sandev_record ( sandev, type, sancmd->started,
+						( sancmd->count * blksize ), 0 );
+				sancmd->count = 0;
+				/* Restart timer to measure lack of progress */
+				if ( timer_running ( &sandev->timer ) ) {
+					start_timer_fixed ( &sandev->timer,
+							    SAN_COMMAND_TIMEOUT );
+				}
+				continue;
+			}
+			pending++;
+		}
+
+		/* Stop when all fragments are complete */
+		if ( ( next == end ) && ( pending == 0 ) )
+			break;
+
+		/* Reopen block device if applicable */
+		if ( sandev_needs_reopen ( sandev ) ) {
+			assert ( active == 0 );
+			if ( ( rc = sandev_reopen ( sandev ) ) != 0 ) {
+
+				/* Delay reopening attempts */
+				sleep_fixed ( SAN_REOPEN_DELAY_SECS );
+
+				/* Retry indefinitely for multipath devices */
+				if ( ( sandev->paths <= 1 ) &&
+				     ( ++retries > san_retries ) )
+					goto err;
+				continue;
+			}
+		}
+
+		/* Issue as many commands as the device will accept */
+		retried = 0;
+		for ( i = 0 ; i < depth ; i++ ) {
+
+			/* Skip commands in progress, and unused command
+			 * slots if there are no more new fragments.
+			 */
+			sancmd = &sandev->queue[i];
+			if ( sancmd->rc == -EINPROGRESS )
+				continue;
+			if ( ( ! sancmd->count ) && ( next == end ) )
+				continue;
+
+			/* Stop if no path is ready */
+			sanpath = sandev_select_path ( sandev, depth );
+			if ( ! sanpath )
+				break;
+
+			/* Retry failed fragment, or start a new fragment.
+			 * Fragments that failed together (e.g. due to a
+			 * path closing) count as a single retry.
+			 */
+			if ( sancmd->count ) {
+				rc = sancmd->rc;
+				DBGC ( sandev->drive, "SAN %#02x queued command "
+				       "failed: %s\n", sandev->drive,
+				       strerror ( rc ) );
+				sandev_record ( sandev, type, sancmd->started,
+						0, rc );
+				if ( ( ! retried++ ) &&
+				     ( ++retries > san_retries ) )
+					goto err;
+				sandev->stats.retries++;
+			} else {
+				sancmd->lba = next;
+				sancmd->count = sandev->capacity.max_count;
+				if ( sancmd->count > ( end - next ) )
+					sancmd->count = ( end - next );
+				next += sancmd->count;
+			}
+
+			/* Initiate read/write command */
+			sancmd->sanpath = sanpath;
+			sancmd->rc = -EINPROGRESS;
+			sancmd->started = currticks();
+			if ( ( rc = block_rw ( &sanpath->block, &sancmd->block,
+					       sancmd->lba, sancmd->count,
+					       userptr_add ( buffer,
+							     ( ( sancmd->lba -
+								 lba ) *
+							       blksize ) ),
+					       ( sancmd->count *
+						 blksize ) ) ) != 0 ) {
+				DBGC ( sandev->drive, "SAN %#02x.%d could not "
+				       "initiate read/write: %s\n",
+				       sandev->drive, sanpath->index,
+				       strerror ( rc ) );
+				intf_restart ( &sancmd->block, rc );
+				sancmd->rc = rc;
+				break;
+			}
+
+			/* Start expiry timer, if not already running */
+			if ( ! timer_running ( &sandev->timer ) ) {
+				start_timer_fixed ( &sandev->timer,
+						    SAN_COMMAND_TIMEOUT );
+			}
+		}
+
+		/* Wait for progress */
+		step();
+	}
+
+	/* Stop timer */
+	stop_timer ( &sandev->timer );
+
+	return 0;
+
+ err:
+	sandev_command_close ( sandev, rc );
+	for ( i = 0 ; i < depth ; i++ ) {
+		sandev->queue[i].count = 0;
+		sandev->queue[i].rc = 0;
+	}
+	return rc;
+}
+
+/**
+ * Get maximum number of concurrent read/write commands
+ *
+ * @v sandev		SAN device
+ * @ret depth		Maximum number of concurrent commands
+ *
+ * In multipath mode, allow for the configured number of concurrent
+ * commands on each path.  At least one command is always allowed, so
+ * that a configured depth of zero does not prevent background memdisk
+ * filling.
+ */
+static unsigned int sandev_queue_depth ( struct san_device *sandev ) {
+	unsigned int depth;
+
+	depth = san_queue_depth;
+	if ( ! depth )
+		depth = 1;
+	if ( san_multipath )
+		depth *= sandev->paths;
+	if ( depth > SAN_MAX_QUEUE_DEPTH )
+		depth = SAN_MAX_QUEUE_DEPTH;
+	return depth;
+}
+
 /**
  * Read from or write to SAN device
  *
@@ -601,9 +1105,21 @@ static int sandev_rw ( struct san_device *sandev, uint64_t lba,
 					    userptr_t buffer, size_t len ) ) {
 	union san_command_params params;
 	unsigned int remaining;
+	unsigned int depth;
 	size_t frag_len;
 	int rc;
 
+	/* Use concurrent commands if permitted and worthwhile */
+	depth = sandev_queue_depth ( sandev );
+	if ( ( depth > 1 ) &&
+	     ( ( count << sandev->blksize_shift ) >
+	       sandev->capacity.max_count ) ) {
+		return sandev_rw_queue ( sandev,
+					 ( lba << sandev->blksize_shift ),
+					 ( count << sandev->blksize_shift ),
+					 buffer, block_rw, depth );
+	}
+
 	/* Initialise command parameters */
 	params.rw.block_rw = block_rw;
 	params.rw.buffer = buffer;
@@ -633,6 +1149,630 @@ static int sandev_rw ( struct san_device *sandev, uint64_t lba,
 	return 0;
 }
 
+/**
+ * Free SAN block cache
+ *
+ * @v sandev		SAN device
+ */
+static void sandev_cache_free ( struct san_device *sandev ) {
+	struct san_cache *cache = &sandev->cache;
+
+	ufree ( cache->data );
+	free ( cache->line );
+	memset ( cache, 0, sizeof ( *cache ) );
+}
+
+/**
+ * Allocate SAN block cache
+ *
+ * @v sandev		SAN device
+ * @ret rc		Return status code
+ *
+ * The cache geometry depends upon the logical block size, which will
+ * change if the device is subsequently found to be a CD-ROM.  Any
+ * cache allocated using a different logical block size is discarded.
+ */
+static int sandev_cache_alloc ( struct san_device *sandev ) {
+	struct san_cache *cache = &sandev->cache;
+	size_t blksize = sandev_blksize ( sandev );
+	unsigned int i;
+
+	/* Discard cache if logical block size has changed */
+	if ( cache->blksize != blksize )
+		sandev_cache_free ( sandev );
+
+	/* Do nothing if already allocated */
+	if ( cache->data )
+		return 0;
+
+	/* Do not retry a failed allocation */
+	if ( cache->failed )
+		return -ENOMEM;
+	cache->failed = 1;
+	cache->blksize = blksize;
+
+	/* Calculate cache geometry */
+	cache->blocks = ( SAN_CACHE_LINE_LEN / blksize );
+	if ( ! cache->blocks )
+		return -ENOTSUP;
+
+	/* Allocate cache lines */
+	cache->line = zalloc ( SAN_CACHE_LINES * sizeof ( cache->line[0] ) );
+	if ( ! cache->line )
+		return -ENOMEM;
+	cache->data = umalloc ( SAN_CACHE_LINES * cache->blocks * blksize );
+	if ( ! cache->data ) {
+		free ( cache->line );
+		cache->line = NULL;
+		return -ENOMEM;
+	}
+	cache->lines = SAN_CACHE_LINES;
+	INIT_LIST_HEAD ( &cache->lru );
+	for ( i = 0 ; i < cache->lines ; i++ )
+		list_add_tail ( &cache->line[i].list, &cache->lru );
+	cache->failed = 0;
+
+	DBGC ( sandev->drive, "SAN %#02x using %d x %zd-byte block cache\n",
+	       sandev->drive, cache->lines, ( cache->blocks * blksize ) );
+	return 0;
+}
+
+/**
+ * Invalidate SAN block cache
+ *
+ * @v sandev		SAN device
+ * @v lba		Starting logical block address
+ * @v count		Number of logical blocks
+ */
+static void sandev_cache_invalidate ( struct san_device *sandev, uint64_t lba,
+				      unsigned int count ) {
+	struct san_cache *cache = &sandev->cache;
+	struct san_cache_line *line;
+	unsigned int i;
+
+	/* Invalidate any overlapping lines */
+	for ( i = 0 ; i < cache->lines ; i++ ) {
+		line = &cache->line[i];
+		if ( line->count && ( lba < ( line->lba + line->count ) ) &&
+		     ( line->lba < ( lba + count ) ) ) {
+			line->count = 0;
+		}
+	}
+
+	/* Reset sequential read detection */
+	cache->next = 0;
+	cache->ahead = 0;
+}
+
+/**
+ * Fill SAN block cache line(s)
+ *
+ * @v sandev		SAN device
+ * @v lba		Starting logical block address (aligned to a line)
+ * @ret line		Cache line, or NULL on error
+ * @ret rc		Return status code
+ *
+ * The requested line and any read-ahead lines are read using a
+ * single contiguous read, allowing the fragments to be pipelined.
+ * To allow this, a contiguous run of lines starting at the least
+ * recently used line is evicted.
+ */
+static int sandev_cache_fill ( struct san_device *sandev, uint64_t lba,
+			       struct san_cache_line **line ) {
+	struct san_cache *cache = &sandev->cache;
+	size_t stride = ( cache->blocks * sandev_blksize ( sandev ) );
+	uint64_t capacity = sandev_capacity ( sandev );
+	struct san_cache_line *victim;
+	struct san_cache_line *fill;
+	unsigned int first;
+	unsigned int count;
+	unsigned int lines;
+	unsigned int i;
+	int rc;
+
+	/* Calculate number of lines to read, limited by device size */
+	lines = cache->ahead;
+	if ( ! lines )
+		lines = 1;
+	if ( ( capacity - lba ) < ( ( ( uint64_t ) lines ) * cache->blocks ) )
+		count = ( capacity - lba );
+	else
+		count = ( lines * cache->blocks );
+	lines = ( ( count + cache->blocks - 1 ) / cache->blocks );
+
+	/* Select a contiguous run starting at the least recently used line */
+	victim = list_last_entry ( &cache->lru, struct san_cache_line, list );
+	first = ( victim - cache->line );
+	if ( ( first + lines ) > cache->lines )
+		first = ( cache->lines - lines );
+
+	/* Invalidate the run, and any stale copies of the lines to be read */
+	sandev_cache_invalidate ( sandev, lba, count );
+	for ( i = 0 ; i < lines ; i++ )
+		cache->line[ first + i ].count = 0;
+
+	/* Read data */
+	if ( ( rc = sandev_rw ( sandev, lba, count,
+				userptr_add ( cache->data, ( first * stride ) ),
+				block_read ) ) != 0 )
+		return rc;
+
+	/* Record lines, leaving the first line as the most recently
+	 * used and the read-ahead lines just behind it.
+	 */
+	for ( i = lines ; i-- ; ) {
+		fill = &cache->line[ first + i ];
+		fill->lba = ( lba + ( i * cache->blocks ) );
+		fill->count = ( count - ( i * cache->blocks ) );
+		if ( fill->count > cache->blocks )
+			fill->count = cache->blocks;
+		list_del ( &fill->list );
+		list_add ( &fill->list, &cache->lru );
+	}
+	*line = &cache->line[first];
+
+	return 0;
+}
+
+/**
+ * Read from SAN device via block cache
+ *
+ * @v sandev		SAN device
+ * @v lba		Starting logical block address
+ * @v count		Number of logical blocks
+ * @v buffer		Data buffer
+ * @ret rc		Return status code
+ */
+static int sandev_cache_read ( struct san_device *sandev, uint64_t lba,
+			       unsigned int count, userptr_t buffer ) {
+	struct san_cache *cache = &sandev->cache;
+	size_t blksize = sandev_blksize ( sandev );
+	size_t stride = ( cache->blocks * blksize );
+	struct san_cache_line *line;
+	uint64_t start;
+	unsigned int offset;
+	unsigned int frag;
+	int rc;
+
+	/* Detect sequential reads, and increase read-ahead accordingly */
+	if ( lba == cache->next ) {
+		if ( cache->ahead < SAN_CACHE_MAX_AHEAD )
+			cache->ahead = ( cache->ahead ? ( cache->ahead * 2 ) : 1);
+	} else {
+		cache->ahead = 0;
+	}
+	cache->next = ( lba + count );
+
+	while ( count ) {
+
+		/* Find cache line, filling it if necessary */
+		start = ( lba - ( lba % cache->blocks ) );
+		offset = ( lba - start );
+		list_for_each_entry ( line, &cache->lru, list ) {
+			if ( line->count && ( line->lba == start ) )
+				goto found;
+		}
+		if ( ( rc = sandev_cache_fill ( sandev, start, &line ) ) != 0 )
+			return rc;
+	found:
+		if ( offset >= line->count )
+			return -ERANGE;
+
+		/* Copy data from cache line */
+		frag = ( line->count - offset );
+		if ( frag > count )
+			frag = count;
+		memcpy_user ( buffer, 0, cache->data,
+			      ( ( ( line - cache->line ) * stride ) +
+				( offset * blksize ) ), ( frag * blksize ) );
+
+		/* Mark line as most recently used */
+		list_del ( &line->list );
+		list_add ( &line->list, &cache->lru );
+
+		/* Move to next line */
+		buffer = userptr_add ( buffer, ( frag * blksize ) );
+		lba += frag;
+		count -= frag;
+	}
+
+	return 0;
+}
+
+/**
+ * Wait for SAN memdisk background fill commands to complete
+ *
+ * @v sandev		SAN device
+ *
+ * Any commands that fail to complete within the command timeout are
+ * aborted.  The caller must have paused background filling.
+ */
+static void sandev_memdisk_drain ( struct san_device *sandev ) {
+	struct san_memdisk *memdisk = &sandev->memdisk;
+	unsigned long start = currticks();
+	unsigned int i;
+
+	/* Sanity check */
+	assert ( memdisk->paused );
+
+	/* Wait for outstanding commands */
+	for ( i = 0 ; i < SAN_MAX_QUEUE_DEPTH ; i++ ) {
+		while ( memdisk->fill[i].count ) {
+			if ( ( currticks() - start ) >= SAN_COMMAND_TIMEOUT ) {
+				DBGC ( sandev->drive, "SAN %#02x memdisk fill "
+				       "timed out\n", sandev->drive );
+				sandev_memdisk_abort ( sandev, NULL,
+						       -ETIMEDOUT );
+				return;
+			}
+			step();
+		}
+	}
+}
+
+/**
+ * Check if SAN memdisk chunk is being filled in the background
+ *
+ * @v sandev		SAN device
+ * @v chunk		Chunk index
+ * @ret in_progress	Chunk is being filled
+ */
+static int sandev_memdisk_filling ( struct san_device *sandev,
+				    unsigned int chunk ) {
+	struct san_memdisk *memdisk = &sandev->memdisk;
+	struct san_command *fill;
+	unsigned int i;
+
+	for ( i = 0 ; i < SAN_MAX_QUEUE_DEPTH ; i++ ) {
+		fill = &memdisk->fill[i];
+		if ( fill->count &&
+		     ( fill->lba == ( ( ( uint64_t ) chunk ) *
+				      memdisk->blocks ) ) ) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/**
+ * Record SAN memdisk chunks as filled
+ *
+ * @v sandev		SAN device
+ * @v chunk		First chunk index
+ * @v count		Number of chunks
+ */
+static void sandev_memdisk_filled ( struct san_device *sandev,
+				    unsigned int chunk, unsigned int count ) {
+	struct san_memdisk *memdisk = &sandev->memdisk;
+
+	/* Mark chunks as filled */
+	while ( count-- )
+		bitmap_set ( &memdisk->filled, chunk++ );
+
+	/* Stop background filling once the whole device is in RAM */
+	if ( bitmap_full ( &memdisk->filled ) &&
+	     process_running ( &memdisk->process ) ) {
+		DBGC ( sandev->drive, "SAN %#02x memdisk is complete\n",
+		       sandev->drive );
+		process_del ( &memdisk->process );
+	}
+}
+
+/**
+ * Close SAN memdisk background fill command
+ *
+ * @v fill		Background fill command
+ * @v rc		Reason for close
+ */
+static void sandev_memdisk_fill_close ( struct san_command *fill, int rc ) {
+	struct san_device *sandev = fill->sandev;
+	struct san_memdisk *memdisk = &sandev->memdisk;
+
+	/* Restart interface */
+	intf_restart ( &fill->block, rc );
+	fill->rc = rc;
+
+	/* Record command completion */
+	sandev_record ( sandev, SAN_READ, fill->started,
+			( fill->count * sandev_blksize ( sandev ) ), rc );
+	fill->count = 0;
+
+	/* Pause background filling on error.  Filling will resume
+	 * after the next successful on-demand read or write, which
+	 * will also take care of reopening the device if needed.
+	 */
+	if ( rc != 0 ) {
+		DBGC ( sandev->drive, "SAN %#02x memdisk fill at %#08llx "
+		       "failed: %s\n", sandev->drive, fill->lba,
+		       strerror ( rc ) );
+		memdisk->paused = 1;
+		return;
+	}
+
+	/* Record chunk as filled */
+	sandev_memdisk_filled ( sandev, ( fill->lba / memdisk->blocks ), 1 );
+}
+
+/**
+ * SAN memdisk background fill process
+ *
+ * @v sandev		SAN device
+ */
+static void sandev_memdisk_step ( struct san_device *sandev ) {
+	struct san_memdisk *memdisk = &sandev->memdisk;
+	size_t blksize = sandev_blksize ( sandev );
+	uint64_t capacity = sandev_capacity ( sandev );
+	unsigned int shift = sandev->blksize_shift;
+	struct san_command *fill;
+	struct san_path *sanpath;
+	unsigned int depth;
+	unsigned int chunk;
+	unsigned int i;
+	unsigned int n;
+	int rc;
+
+	/* Do nothing while paused or while the device is unavailable */
+	if ( memdisk->paused || sandev_needs_reopen ( sandev ) )
+		return;
+
+	/* Start as many fill commands as the device will accept */
+	depth = sandev_queue_depth ( sandev );
+	if ( memdisk->next < bitmap_first_gap ( &memdisk->filled ) )
+		memdisk->next = bitmap_first_gap ( &memdisk->filled );
+	for ( i = 0 ; i < depth ; i++ ) {
+
+		/* Skip commands in progress */
+		fill = &memdisk->fill[i];
+		if ( fill->count )
+			continue;
+
+		/* Find next chunk that is neither filled nor filling */
+		for ( n = memdisk->chunks ; n ; n-- ) {
+			chunk = memdisk->next;
+			if ( ++memdisk->next >= memdisk->chunks )
+				memdisk->next = 0;
+			if ( ! ( bitmap_test ( &memdisk->filled, chunk ) ||
+				 sandev_memdisk_filling ( sandev, chunk ) ) )
+				break;
+		}
+		if ( ! n )
+			return;
+
+		/* Stop if no path is ready */
+		sanpath = sandev_select_path ( sandev, depth );
+		if ( ! sanpath ) {
+			memdisk->next = chunk;
+			return;
+		}
+
+		/* Initiate read command */
+		fill->sanpath = sanpath;
+		fill->lba = ( ( ( uint64_t ) chunk ) * memdisk->blocks );
+		fill->count = memdisk->blocks;
+		if ( fill->count > ( capacity - fill->lba ) )
+			fill->count = ( capacity - fill->lba );
+		fill->rc = -EINPROGRESS;
+		fill->started = currticks();
+		if ( ( rc = block_read ( &sanpath->block, &fill->block,
+					 ( fill->lba << shift ),
+					 ( fill->count << shift ),
+					 userptr_add ( memdisk->data,
+						       ( fill->lba * blksize ) ),
+					 ( fill->count * blksize ) ) ) != 0 ) {
+			DBGC ( sandev->drive, "SAN %#02x.%d could not initiate "
+			       "memdisk fill: %s\n", sandev->drive,
+			       sanpath->index, strerror ( rc ) );
+			intf_restart ( &fill->block, rc );
+			fill->count = 0;
+			fill->rc = rc;
+			memdisk->next = chunk;
+			return;
+		}
+	}
+}
+
+/** SAN memdisk background fill command interface operations */
+static struct interface_operation sandev_memdisk_fill_op[] = {
+	INTF_OP ( intf_close, struct san_command *, sandev_memdisk_fill_close ),
+};
+
+/** SAN memdisk background fill command interface descriptor */
+static struct interface_descriptor sandev_memdisk_fill_desc =
+	INTF_DESC ( struct san_command, block, sandev_memdisk_fill_op );
+
+/** SAN memdisk background fill process descriptor */
+static struct process_descriptor sandev_memdisk_process_desc =
+	PROC_DESC_PRIO ( struct san_device, memdisk.process,
+			 sandev_memdisk_step, PROC_PRIO_BACKGROUND );
+
+/**
+ * Allocate SAN memdisk
+ *
+ * @v sandev		SAN device
+ * @ret rc		Return status code
+ *
+ * The memdisk is filled in the background, with reads of
+ * not-yet-filled chunks being satisfied on demand.  This allows the
+ * device to be used immediately.
+ */
+static int sandev_memdisk_alloc ( struct san_device *sandev ) {
+	struct san_memdisk *memdisk = &sandev->memdisk;
+	size_t blksize = sandev_blksize ( sandev );
+	uint64_t capacity = sandev_capacity ( sandev );
+	unsigned int max_blocks;
+	int rc;
+
+	/* Check that device will fit within the address space */
+	if ( capacity > ( ( ~( ( size_t ) 0 ) ) / blksize ) ) {
+		DBGC ( sandev->drive, "SAN %#02x is too large for a "
+		       "memdisk\n", sandev->drive );
+		return -EFBIG;
+	}
+
+	/* Calculate chunk size, limited by the maximum transfer size */
+	memdisk->blocks = ( SAN_MEMDISK_CHUNK_LEN / blksize );
+	max_blocks = ( sandev->capacity.max_count >> sandev->blksize_shift );
+	if ( memdisk->blocks > max_blocks )
+		memdisk->blocks = max_blocks;
+	if ( ! memdisk->blocks )
+		memdisk->blocks = 1;
+	memdisk->chunks = ( ( capacity + memdisk->blocks - 1 ) /
+			    memdisk->blocks );
+
+	/* Allocate device contents and fill bitmap */
+	memdisk->data = umalloc ( capacity * blksize );
+	if ( ! memdisk->data ) {
+		DBGC ( sandev->drive, "SAN %#02x could not allocate %llu-byte "
+		       "memdisk\n", sandev->drive,
+		       ( ( unsigned long long ) ( capacity * blksize ) ) );
+		return -ENOMEM;
+	}
+	if ( ( rc = bitmap_resize ( &memdisk->filled,
+				    memdisk->chunks ) ) != 0 )
+		return rc;
+
+	/* Start background filling */
+	process_add ( &memdisk->process );
+	DBGC ( sandev->drive, "SAN %#02x using %d x %zd-byte memdisk\n",
+	       sandev->drive, memdisk->chunks, ( memdisk->blocks * blksize ) );
+
+	return 0;
+}
+
+/**
+ * Read from SAN device via memdisk
+ *
+ * @v sandev		SAN device
+ * @v lba		Starting logical block address
+ * @v count		Number of logical blocks
+ * @v buffer		Data buffer
+ * @ret rc		Return status code
+ *
+ * Any runs of chunks that have not yet been filled are read on
+ * demand using concurrent commands.
+ */
+static int sandev_memdisk_read ( struct san_device *sandev, uint64_t lba,
+				 unsigned int count, userptr_t buffer ) {
+	struct san_memdisk *memdisk = &sandev->memdisk;
+	size_t blksize = sandev_blksize ( sandev );
+	uint64_t capacity = sandev_capacity ( sandev );
+	unsigned int first = ( lba / memdisk->blocks );
+	unsigned int last = ( ( lba + count - 1 ) / memdisk->blocks );
+	unsigned int chunk;
+	unsigned int end;
+	uint64_t start;
+	uint64_t len;
+	int fetched = 0;
+	int rc = 0;
+
+	/* Fill any missing chunks */
+	for ( chunk = first ; chunk <= last ; chunk = end ) {
+
+		/* Skip filled chunks */
+		end = ( chunk + 1 );
+		if ( bitmap_test ( &memdisk->filled, chunk ) )
+			continue;
+
+		/* Pause background filling and wait for any
+		 * outstanding fill commands, which may well include
+		 * this chunk.
+		 */
+		if ( ! fetched ) {
+			fetched = 1;
+			memdisk->paused = 1;
+			sandev_memdisk_drain ( sandev );
+			end = chunk;
+			continue;
+		}
+
+		/* Read run of missing chunks */
+		while ( ( end <= last ) &&
+			( ! bitmap_test ( &memdisk->filled, end ) ) )
+			end++;
+		start = ( ( ( uint64_t ) chunk ) * memdisk->blocks );
+		len = ( ( ( ( uint64_t ) end ) * memdisk->blocks ) - start );
+		if ( len > ( capacity - start ) )
+			len = ( capacity - start );
+		if ( ( rc = sandev_rw ( sandev, start, len,
+					userptr_add ( memdisk->data,
+						      ( start * blksize ) ),
+					block_read ) ) != 0 ) {
+			break;
+		}
+		sandev_memdisk_filled ( sandev, chunk, ( end - chunk ) );
+	}
+
+	/* Resume background filling unless the device is failing */
+	if ( fetched )
+		memdisk->paused = ( rc != 0 );
+	if ( rc != 0 )
+		return rc;
+
+	/* Copy data from memdisk */
+	memcpy_user ( buffer, 0, memdisk->data, ( lba * blksize ),
+		      ( count * blksize ) );
+
+	/* Allow background filling to progress */
+	if ( ! bitmap_full ( &memdisk->filled ) )
+		step();
+
+	return 0;
+}
+
+/**
+ * Write to SAN device via memdisk
+ *
+ * @v sandev		SAN device
+ * @v lba		Starting logical block address
+ * @v count		Number of logical blocks
+ * @v buffer		Data buffer
+ * @ret rc		Return status code
+ *
+ * Writes are passed through to the device.  Background filling is
+ * paused for the duration, to prevent an outstanding fill command
+ * from overwriting the memdisk with stale data.
+ */
+static int sandev_memdisk_write ( struct san_device *sandev, uint64_t lba,
+				  unsigned int count, userptr_t buffer ) {
+	struct san_memdisk *memdisk = &sandev->memdisk;
+	size_t blksize = sandev_blksize ( sandev );
+	int rc;
+
+	/* Pause background filling */
+	memdisk->paused = 1;
+	sandev_memdisk_drain ( sandev );
+
+	/* Write to device */
+	rc = sandev_rw ( sandev, lba, count, buffer, block_write );
+
+	/* Resume background filling unless the device is failing */
+	memdisk->paused = ( rc != 0 );
+	if ( rc != 0 )
+		return rc;
+
+	/* Update memdisk */
+	memcpy_user ( memdisk->data, ( lba * blksize ), buffer, 0,
+		      ( count * blksize ) );
+
+	return 0;
+}
+
+/**
+ * Check if SAN device access may use memdisk
+ *
+ * @v sandev		SAN device
+ * @v lba		Starting logical block address
+ * @v count		Number of logical blocks
+ * @ret use_memdisk	Access may use memdisk
+ */
+static int sandev_use_memdisk ( struct san_device *sandev, uint64_t lba,
+				unsigned int count ) {
+	uint64_t capacity = sandev_capacity ( sandev );
+
+	return ( sandev->memdisk.data && count && ( lba < capacity ) &&
+		 ( count <= ( capacity - lba ) ) );
+}
+
 /**
  * Read from SAN device
  *
@@ -646,6 +1786,21 @@ int sandev_read ( struct san_device *sandev, uint64_t lba,
 		  unsigned int count, userptr_t buffer ) {
 	int rc;
 
+	/* Read via memdisk, if applicable */
+	if ( sandev_use_memdisk ( sandev, lba, count ) )
+		return sandev_memdisk_read ( sandev, lba, count, buffer );
+
+	/* Read small requests via the block cache, if available.
+	 * Large requests gain nothing from the cache, and reads
+	 * beyond the end of the device are left to fail normally.
+	 */
+	if ( ( sandev_cache_alloc ( sandev ) == 0 ) &&
+	     ( count < sandev->cache.blocks ) &&
+	     ( lba < sandev_capacity ( sandev ) ) &&
+	     ( count <= ( sandev_capacity ( sandev ) - lba ) ) ) {
+		return sandev_cache_read ( sandev, lba, count, buffer );
+	}
+
 	/* Read from device */
 	if ( ( rc = sandev_rw ( sandev, lba, count, buffer, block_read ) ) != 0 )
 		return rc;
@@ -666,8 +1821,16 @@ int sandev_write ( struct san_device *sandev, uint64_t lba,
 		   unsigned int count, userptr_t buffer ) {
 	int rc;
 
-	/* Write to device */
-	if ( ( rc = sandev_rw ( sandev, lba, count, buffer, block_write ) ) != 0 )
+	/* Invalidate any cached copies of the blocks being written */
+	sandev_cache_invalidate ( sandev, lba, count );
+
+	/* Write to device, via memdisk if applicable */
+	if ( sandev_use_memdisk ( sandev, lba, count ) ) {
+		rc = sandev_memdisk_write ( sandev, lba, count, buffer );
+	} else {
+		rc = sandev_rw ( sandev, lba, count, buffer, block_write );
+	}
+	if ( rc != 0 )
 		return rc;
 
 	/* Quiesce system.  This is a heuristic designed to ensure
@@ -823,6 +1986,179 @@ static int sandev_parse_iso9660 ( struct san_device *sandev ) {
 	return rc;
 }
 
+/** SAN device settings scope */
+const struct settings_scope san_settings_scope;
+
+/** SAN read commands setting */
+const struct setting san_reads_setting __setting ( SETTING_SANBOOT_EXTRA,
+						   reads ) = {
+	.name = "reads",
+	.description = "SAN read commands",
+	.type = &setting_type_uint32,
+	.scope = &san_settings_scope,
+};
+
+/** SAN read bytes setting */
+const struct setting san_readbytes_setting __setting ( SETTING_SANBOOT_EXTRA,
+						       readbytes ) = {
+	.name = "readbytes",
+	.description = "SAN bytes read",
+	.type = &setting_type_uint32,
+	.scope = &san_settings_scope,
+};
+
+/** SAN read errors setting */
+const struct setting san_readerrs_setting __setting ( SETTING_SANBOOT_EXTRA,
+						      readerrs ) = {
+	.name = "readerrs",
+	.description = "SAN read errors",
+	.type = &setting_type_uint32,
+	.scope = &san_settings_scope,
+};
+
+/** SAN read latency setting */
+const struct setting san_readlat_setting __setting ( SETTING_SANBOOT_EXTRA,
+						     readlat ) = {
+	.name = "readlat",
+	.description = "SAN mean read latency (ms)",
+	.type = &setting_type_uint32,
+	.scope = &san_settings_scope,
+};
+
+/** SAN write commands setting */
+const struct setting san_writes_setting __setting ( SETTING_SANBOOT_EXTRA,
+						    writes ) = {
+	.name = "writes",
+	.description = "SAN write commands",
+	.type = &setting_type_uint32,
+	.scope = &san_settings_scope,
+};
+
+/** SAN write bytes setting */
+const struct setting san_writebytes_setting __setting ( SETTING_SANBOOT_EXTRA,
+							writebytes ) = {
+	.name = "writebytes",
+	.description = "SAN bytes written",
+	.type = &setting_type_uint32,
+	.scope = &san_settings_scope,
+};
+
+/** SAN write errors setting */
+const struct setting san_writeerrs_setting __setting ( SETTING_SANBOOT_EXTRA,
+						       writeerrs ) = {
+	.name = "writeerrs",
+	.description = "SAN write errors",
+	.type = &setting_type_uint32,
+	.scope = &san_settings_scope,
+};
+
+/** SAN write latency setting */
+const struct setting san_writelat_setting __setting ( SETTING_SANBOOT_EXTRA,
+						      writelat ) = {
+	.name = "writelat",
+	.description = "SAN mean write latency (ms)",
+	.type = &setting_type_uint32,
+	.scope = &san_settings_scope,
+};
+
+/** SAN command retries setting */
+const struct setting san_retries_count_setting __setting ( SETTING_SANBOOT_EXTRA,
+							   retries ) = {
+	.name = "retries",
+	.description = "SAN command retries",
+	.type = &setting_type_uint32,
+	.scope = &san_settings_scope,
+};
+
+/** SAN device reopens setting */
+const struct setting san_reopens_setting __setting ( SETTING_SANBOOT_EXTRA,
+						     reopens ) = {
+	.name = "reopens",
+	.description = "SAN device (re)opening attempts",
+	.type = &setting_type_uint32,
+	.scope = &san_settings_scope,
+};
+
+/**
+ * Calculate mean SAN device command latency
+ *
+ * @v stats		Command statistics
+ * @ret latency		Mean latency (in milliseconds)
+ */
+static unsigned long long sandev_mean_latency ( struct san_command_stats
+						*stats ) {
+	unsigned int total = ( stats->good + stats->bad );
+
+	return ( total ? ( stats->latency / total ) : 0 );
+}
+
+/**
+ * Check applicability of SAN device setting
+ *
+ * @v settings		Settings block
+ * @v setting		Setting
+ * @ret applies		Setting applies within this settings block
+ */
+static int sandev_applies ( struct settings *settings __unused,
+			    const struct setting *setting ) {
+
+	return ( setting->scope == &san_settings_scope );
+}
+
+/**
+ * Fetch value of SAN device setting
+ *
+ * @v settings		Settings block
+ * @v setting		Setting to fetch
+ * @v data		Buffer to fill with setting data
+ * @v len		Length of buffer
+ * @ret len		Length of setting data, or negative error
+ */
+static int sandev_fetch ( struct settings *settings, struct setting *setting,
+			  void *data, size_t len ) {
+	struct san_device *sandev =
+		container_of ( settings, struct san_device, settings );
+	struct san_device_stats *stats = &sandev->stats;
+	struct san_command_stats *read = &stats->command[SAN_READ];
+	struct san_command_stats *write = &stats->command[SAN_WRITE];
+	unsigned long counter;
+
+	/* Identify counter */
+	if ( setting_cmp ( setting, &san_reads_setting ) == 0 ) {
+		counter = read->good;
+	} else if ( setting_cmp ( setting, &san_readbytes_setting ) == 0 ) {
+		counter = read->bytes;
+	} else if ( setting_cmp ( setting, &san_readerrs_setting ) == 0 ) {
+		counter = read->bad;
+	} else if ( setting_cmp ( setting, &san_readlat_setting ) == 0 ) {
+		counter = sandev_mean_latency ( read );
+	} else if ( setting_cmp ( setting, &san_writes_setting ) == 0 ) {
+		counter = write->good;
+	} else if ( setting_cmp ( setting, &san_writebytes_setting ) == 0 ) {
+		counter = write->bytes;
+	} else if ( setting_cmp ( setting, &san_writeerrs_setting ) == 0 ) {
+		counter = write->bad;
+	} else if ( setting_cmp ( setting, &san_writelat_setting ) == 0 ) {
+		counter = sandev_mean_latency ( write );
+	} else if ( setting_cmp ( setting,
+				  &san_retries_count_setting ) == 0 ) {
+		counter = stats->retries;
+	} else if ( setting_cmp ( setting, &san_reopens_setting ) == 0 ) {
+		counter = stats->reopens;
+	} else {
+		return -ENOENT;
+	}
+
+	/* Fill in value */
+	return setting_denumerate ( &setting_type_uint32, counter, data, len );
+}
+
+/** SAN device settings operations */
+static struct settings_operations sandev_settings_operations = {
+	.applies = sandev_applies,
+	.fetch = sandev_fetch,
+};
+
 /**
  * Allocate SAN device
  *
@@ -846,6 +2182,18 @@ struct san_device * alloc_sandev ( struct uri **uris, unsigned int count,
 	ref_init ( &sandev->refcnt, sandev_free );
 	intf_init ( &sandev->command, &sandev_command_desc, &sandev->refcnt );
 	timer_init ( &sandev->timer, sandev_command_expired, &sandev->refcnt );
+	for ( i = 0 ; i < SAN_MAX_QUEUE_DEPTH ; i++ ) {
+		sandev->queue[i].sandev = sandev;
+		intf_init ( &sandev->queue[i].block, &sancmd_block_desc,
+			    &sandev->refcnt );
+		sandev->memdisk.fill[i].sandev = sandev;
+		intf_init ( &sandev->memdisk.fill[i].block,
+			    &sandev_memdisk_fill_desc, &sandev->refcnt );
+	}
+	process_init_stopped ( &sandev->memdisk.process,
+			       &sandev_memdisk_process_desc, &sandev->refcnt );
+	settings_init ( &sandev->settings, &sandev_settings_operations,
+			&sandev->refcnt, &san_settings_scope );
 	sandev->priv = ( ( ( void * ) sandev ) + size );
 	sandev->paths = count;
 	INIT_LIST_HEAD ( &sandev->opened );
@@ -910,6 +2258,21 @@ int register_sandev ( struct san_device *sandev, unsigned int drive,
 	if ( ( rc = sandev_parse_iso9660 ( sandev ) ) != 0 )
 		goto err_iso9660;
 
+	/* Copy to RAM, if applicable */
+	if ( ( flags & SAN_MEMDISK ) &&
+	     ( ( rc = sandev_memdisk_alloc ( sandev ) ) != 0 ) )
+		goto err_memdisk;
+
+	/* Register settings */
+	snprintf ( sandev->settings_name, sizeof ( sandev->settings_name ),
+		   "san%02x", sandev->drive );
+	if ( ( rc = register_settings ( &sandev->settings, NULL,
+					sandev->settings_name ) ) != 0 ) {
+		DBGC ( sandev->drive, "SAN %#02x could not register settings: "
+		       "%s\n", sandev->drive, strerror ( rc ) );
+		goto err_settings;
+	}
+
 	/* Add to list of SAN devices, in drive order */
 	for_each_sandev ( before ) {
 		if ( before->drive > sandev->drive )
@@ -921,6 +2284,10 @@ int register_sandev ( struct san_device *sandev, unsigned int drive,
 	return 0;
 
 	list_del ( &sandev->list );
+	unregister_settings ( &sandev->settings );
+ err_settings:
+ err_memdisk:
+	process_del ( &sandev->memdisk.process );
  err_iso9660:
  err_capacity:
  err_describe:
@@ -944,6 +2311,12 @@ void unregister_sandev ( struct san_device *sandev ) {
 	/* Remove from list of SAN devices */
 	list_del ( &sandev->list );
 
+	/* Unregister settings */
+	unregister_settings ( &sandev->settings );
+
+	/* Stop background filling */
+	process_del ( &sandev->memdisk.process );
+
 	/* Shut down interfaces */
 	sandev_restart ( sandev, 0 );
 
@@ -987,6 +2360,22 @@ const struct setting san_retries_setting __setting ( SETTING_SANBOOT_EXTRA,
 	.type = &setting_type_int8,
 };
 
+/** The "san-queue-depth" setting */
+const struct setting san_queue_depth_setting __setting ( SETTING_SANBOOT_EXTRA,
+							 san-queue-depth ) = {
+	.name = "san-queue-depth",
+	.description = "SAN concurrent command count",
+	.type = &setting_type_uint8,
+};
+
+/** The "san-multipath" setting */
+const struct setting san_multipath_setting __setting ( SETTING_SANBOOT_EXTRA,
+						       san-multipath ) = {
+	.name = "san-multipath",
+	.description = "SAN active-active multipath",
+	.type = &setting_type_uint8,
+};
+
 /**
  * Apply SAN boot settings
  *
@@ -1000,6 +2389,18 @@ static int sandev_apply ( void ) {
 		san_retries = SAN_DEFAULT_RETRIES;
 	}
 
+	/* Apply "san-queue-depth" setting */
+	if ( fetch_uint_setting ( NULL, &san_queue_depth_setting,
+				  &san_queue_depth ) < 0 ) {
+		san_queue_depth = SAN_DEFAULT_QUEUE_DEPTH;
+	}
+
+	/* Apply "san-multipath" setting */
+	if ( fetch_uint_setting ( NULL, &san_multipath_setting,
+				  &san_multipath ) < 0 ) {
+		san_multipath = SAN_DEFAULT_MULTIPATH;
+	}
+
 	return 0;
 }
 
@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <ipxe/malloc.h>
+#include <ipxe/slab.h>
+
+/** @file
+ *
+ * Fixed-size object caches
+ *
+ * Frequently allocated objects of a fixed size (such as detached I/O
+ * buffer descriptors) may be allocated from an object cache.  Freed
+ * objects are retained on a per-cache free list (up to a fixed
+ * limit), so that most allocations are satisfied by removing the
+ * first entry from the free list.  Retained objects are returned to
+ * the heap by the cache discarder when memory runs short.
+ */
+
+/**
+ * Allocate object from cache
+ *
+ * @v cache		Object cache
+ * @ret ptr		Object, or NULL on failure
+ */
+void * slab_alloc ( struct slab_cache *cache ) {
+	struct slab_object *object;
+
+	/* Update statistics */
+	cache->stats.allocs++;
+
+	/* Use first free object, if any */
+	if ( ( object = cache->free ) ) {
+		cache->free = object->next;
+		cache->count--;
+		cache->used++;
+		cache->stats.hits++;
+		return object;
+	}
+
+	/* Otherwise, allocate a new object */
+	object = malloc ( cache->size );
+	if ( ! object ) {
+		DBGC ( cache, "SLAB %s could not allocate %zd bytes\n",
+		       cache->name, cache->size );
+		cache->stats.fails++;
+		return NULL;
+	}
+	cache->used++;
+
+	return object;
+}
+
+/**
+ * Allocate zeroed object from cache
+ *
+ * @v cache		Object cache
+ * @ret ptr		Object, or NULL on failure
+ */
+void * slab_zalloc ( struct slab_cache *cache ) {
+	void *ptr;
+
+	ptr = slab_alloc ( cache );
+	if ( ptr )
+		memset ( ptr, 0, cache->size );
+	return ptr;
+}
+
+/**
+ * Return object to cache
+ *
+ * @v cache		Object cache
+ * @v ptr		Object, or NULL
+ *
+ * If @c ptr is NULL, no action is taken.
+ */
+void slab_free ( struct slab_cache *cache, void *ptr ) {
+	struct slab_object *object = ptr;
+
+	/* Allow slab_free(cache,NULL) to be valid */
+	if ( ! object )
+		return;
+
+	/* Update statistics */
+	assert ( cache->used > 0 );
+	cache->used--;
+	cache->stats.frees++;
+
+	/* Return object to heap if cache already holds enough */
+	if ( cache->count >= SLAB_MAX_FREE ) {
+		free ( object );
+		return;
+	}
+
+	/* Otherwise, add to free list */
+	object->next = cache->free;
+	cache->free = object;
+	cache->count++;
+}
+
+/**
+ * Discard free objects
+ *
+ * @ret discarded	Number of cached items discarded
+ */
+static unsigned int slab_discard ( void ) {
+	struct slab_cache *cache;
+	struct slab_object *object;
+	unsigned int discarded = 0;
+
+	for_each_table_entry ( cache, SLAB_CACHES ) {
+		while ( ( object = cache->free ) ) {
+			cache->free = object->next;
+			cache->count--;
+			cache->stats.discards++;
+			free ( object );
+			discarded++;
+		}
+	}
+
+	return discarded;
+}
+
+/** Object cache discarder */
+struct cache_discarder slab_discarder __cache_discarder ( CACHE_CHEAP ) = {
+	.discard = slab_discard,
+};
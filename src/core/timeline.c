@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+#include <string.h>
+#include <ipxe/timer.h>
+#include <ipxe/timeline.h>
+
+/** @file
+ *
+ * Boot timeline
+ *
+ * The boot timeline records when each boot phase (e.g. DHCP or image
+ * download) was first reached, and the total time for which it was
+ * active.  A phase may have several concurrently active instances
+ * (e.g. DHCP on several network devices), in which case it is
+ * treated as active while any instance is active.
+ *
+ * All times are relative to the first activation of any phase, which
+ * is normally the start of the startup phase.
+ */
+
+/** Timeline start time (in ticks) */
+static unsigned long timeline_epoch;
+
+/** Timeline has started */
+static int timeline_started;
+
+/**
+ * Convert ticks to milliseconds
+ *
+ * @v ticks		Time (in ticks)
+ * @ret ms		Time (in milliseconds)
+ */
+static unsigned long timeline_ms ( unsigned long ticks ) {
+
+	return ( ( ticks * 1000ULL ) / TICKS_PER_SEC );
+}
+
+/**
+ * Begin boot timeline phase instance
+ *
+ * @v phase		Boot timeline phase
+ */
+void timeline_begin ( struct timeline_phase *phase ) {
+	unsigned long now = currticks();
+
+	/* Start timeline, if applicable */
+	if ( ! timeline_started ) {
+		timeline_epoch = now;
+		timeline_started = 1;
+	}
+
+	/* Record first activation, if applicable */
+	if ( ! timeline_reached ( phase ) )
+		phase->first = ( now - timeline_epoch );
+
+	/* Record activation, if applicable */
+	if ( ! phase->active++ ) {
+		DBGC ( phase, "TIMELINE %s active at %ldms\n",
+		       phase->name, timeline_ms ( now - timeline_epoch ) );
+		phase->since = now;
+	}
+}
+
+/**
+ * End boot timeline phase instance
+ *
+ * @v phase		Boot timeline phase
+ */
+void timeline_end ( struct timeline_phase *phase ) {
+	unsigned long now = currticks();
+
+	/* Ignore unmatched ends */
+	if ( ! phase->active )
+		return;
+
+	/* Record completion */
+	phase->count++;
+	if ( ! --phase->active ) {
+		phase->elapsed += ( now - phase->since );
+		DBGC ( phase, "TIMELINE %s inactive at %ldms (%ldms elapsed)\n",
+		       phase->name, timeline_ms ( now - timeline_epoch ),
+		       timeline_ms ( phase->elapsed ) );
+	}
+}
+
+/**
+ * Get time at which boot timeline phase was first reached
+ *
+ * @v phase		Boot timeline phase
+ * @ret start		Start time (in milliseconds since timeline start)
+ */
+unsigned long timeline_start ( struct timeline_phase *phase ) {
+
+	return timeline_ms ( phase->first );
+}
+
+/**
+ * Get total time for which boot timeline phase has been active
+ *
+ * @v phase		Boot timeline phase
+ * @ret elapsed		Elapsed time (in milliseconds)
+ *
+ * The elapsed time includes any currently active period.
+ */
+unsigned long timeline_elapsed ( struct timeline_phase *phase ) {
+	unsigned long elapsed = phase->elapsed;
+
+	if ( phase->active )
+		elapsed += ( currticks() - phase->since );
+	return timeline_ms ( elapsed );
+}
+
+/**
+ * Find boot timeline phase by name
+ *
+ * @v name		Phase name
+ * @ret phase		Boot timeline phase, or NULL if not found
+ */
+struct timeline_phase * find_timeline_phase ( const char *name ) {
+	struct timeline_phase *phase;
+
+	for_each_table_entry ( phase, TIMELINE_PHASES ) {
+		if ( strcmp ( phase->name, name ) == 0 )
+			return phase;
+	}
+	return NULL;
+}
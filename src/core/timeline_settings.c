@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+#include <string.h>
+#include <errno.h>
+#include <byteswap.h>
+#include <ipxe/init.h>
+#include <ipxe/settings.h>
+#include <ipxe/timeline.h>
+
+/** @file
+ *
+ * Boot timeline settings
+ *
+ * The setting "timeline/<phase>" gives the total time (in
+ * milliseconds) for which the boot timeline phase has been active,
+ * and the setting "timeline/<phase>.start" gives the time (in
+ * milliseconds) at which the phase was first reached.
+ */
+
+/** Boot timeline settings scope */
+static const struct settings_scope timeline_settings_scope;
+
+/** Suffix for boot timeline phase start time settings */
+#define TIMELINE_START_SUFFIX ".start"
+
+/**
+ * Check applicability of boot timeline setting
+ *
+ * @v settings		Settings block
+ * @v setting		Setting
+ * @ret applies		Setting applies within this settings block
+ */
+static int timeline_settings_applies ( struct settings *settings __unused,
+				       const struct setting *setting ) {
+
+	return ( setting->scope == &timeline_settings_scope );
+}
+
+/**
+ * Fetch value of boot timeline setting
+ *
+ * @v settings		Settings block
+ * @v setting		Setting to fetch
+ * @v data		Buffer to fill with setting data
+ * @v len		Length of buffer
+ * @ret len		Length of setting data, or negative error
+ */
+static int timeline_settings_fetch ( struct settings *settings,
+				     struct setting *setting,
+				     void *data, size_t len ) {
+	struct timeline_phase *phase;
+	size_t name_len = strlen ( setting->name );
+	size_t suffix_len = ( sizeof ( TIMELINE_START_SUFFIX ) - 1 );
+	char name[ name_len + 1 /* NUL */ ];
+	int start = 0;
+	int32_t value;
+
+	/* Identify phase and value */
+	memcpy ( name, setting->name, sizeof ( name ) );
+	if ( ( name_len > suffix_len ) &&
+	     ( strcmp ( &name[ name_len - suffix_len ],
+			TIMELINE_START_SUFFIX ) == 0 ) ) {
+		name[ name_len - suffix_len ] = '\0';
+		start = 1;
+	}
+	phase = find_timeline_phase ( name );
+	if ( ! phase ) {
+		DBGC ( settings, "TIMELINE has no phase \"%s\"\n", name );
+		return -ENOENT;
+	}
+	if ( ! timeline_reached ( phase ) )
+		return -ENOENT;
+
+	/* Return result */
+	value = cpu_to_be32 ( start ? timeline_start ( phase ) :
+			      timeline_elapsed ( phase ) );
+	if ( len > sizeof ( value ) )
+		len = sizeof ( value );
+	memcpy ( data, &value, len );
+
+	/* Set type if not already specified */
+	if ( ! setting->type )
+		setting->type = &setting_type_int32;
+
+	return sizeof ( value );
+}
+
+/** Boot timeline settings operations */
+static struct settings_operations timeline_settings_operations = {
+	.applies = timeline_settings_applies,
+	.fetch = timeline_settings_fetch,
+};
+
+/** Boot timeline settings */
+static struct settings timeline_settings = {
+	.refcnt = NULL,
+	.siblings = LIST_HEAD_INIT ( timeline_settings.siblings ),
+	.children = LIST_HEAD_INIT ( timeline_settings.children ),
+	.op = &timeline_settings_operations,
+	.default_scope = &timeline_settings_scope,
+};
+
+/** Initialise boot timeline settings */
+static void timeline_settings_init ( void ) {
+	int rc;
+
+	if ( ( rc = register_settings ( &timeline_settings, NULL,
+					"timeline" ) ) != 0 ) {
+		DBG ( "TIMELINE could not register settings: %s\n",
+		      strerror ( rc ) );
+		return;
+	}
+}
+
+/** Boot timeline settings initialiser */
+struct init_fn timeline_settings_init_fn __init_fn ( INIT_NORMAL ) = {
+	.initialise = timeline_settings_init,
+};
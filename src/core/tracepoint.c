@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+#include <stdlib.h>
+#include <errno.h>
+#include <ipxe/tracepoint.h>
+
+/** @file
+ *
+ * Tracepoints
+ *
+ * Trace records are written into a ring which is allocated only when
+ * tracing is started.  Once the ring is full, each new record
+ * overwrites the oldest record, so that the ring always holds the
+ * most recent events.  The ring is retained when tracing is stopped,
+ * so that it may be inspected afterwards.
+ */
+
+/** Tracing is active */
+int trace_active;
+
+/** Trace ring */
+struct trace_ring trace_ring;
+
+/**
+ * Record tracepoint event
+ *
+ * @v tracepoint	Tracepoint
+ * @v value		Event-specific value
+ */
+void trace_record ( struct tracepoint *tracepoint, unsigned long value ) {
+	struct trace_record *record;
+
+	/* Fill in next record */
+	record = trace_record_at ( &trace_ring, trace_ring.prod++ );
+	record->timestamp = profile_timestamp();
+	record->tracepoint = tracepoint;
+	record->value = value;
+}
+
+/**
+ * Start tracing
+ *
+ * @v count		Number of trace records (must be a power of two)
+ * @ret rc		Return status code
+ *
+ * Any existing trace records are discarded.
+ */
+int trace_start ( unsigned int count ) {
+	struct trace_record *records;
+
+	/* Sanity checks */
+	if ( ( count == 0 ) || ( count & ( count - 1 ) ) ) {
+		DBGC ( &trace_ring, "TRACE invalid record count %d\n", count );
+		return -EINVAL;
+	}
+	if ( count > TRACE_MAX_COUNT ) {
+		DBGC ( &trace_ring, "TRACE record count %d too large\n",
+		       count );
+		return -EINVAL;
+	}
+
+	/* Stop any existing trace */
+	trace_stop();
+
+	/* Allocate new ring, if required */
+	if ( count != trace_ring.count ) {
+		records = calloc ( count, sizeof ( records[0] ) );
+		if ( ! records ) {
+			DBGC ( &trace_ring, "TRACE could not allocate %d "
+			       "records\n", count );
+			return -ENOMEM;
+		}
+		free ( trace_ring.records );
+		trace_ring.records = records;
+		trace_ring.count = count;
+	}
+
+	/* Start tracing */
+	trace_ring.prod = 0;
+	trace_active = 1;
+	DBGC ( &trace_ring, "TRACE started with %d records\n", count );
+
+	return 0;
+}
+
+/**
+ * Stop tracing
+ *
+ */
+void trace_stop ( void ) {
+
+	/* Stop tracing */
+	trace_active = 0;
+}
@@ -119,7 +119,8 @@ static char * format_hex ( char *end, unsigned long long num, int width,
  * Format a decimal number
  *
  * @v end		End of buffer to contain number
- * @v num		Number to format
+ * @v num		Magnitude of number to format
+ * @v negative		Number is negative
  * @v width		Minimum field width
  * @v flags		Format flags
  * @ret ptr		End of buffer
@@ -130,18 +131,13 @@ static char * format_hex ( char *end, unsigned long long num, int width,
  * There must be enough space in the buffer to contain the largest
  * number that this function can format.
  */
-static char * format_decimal ( char *end, signed long num, int width,
-			       int flags ) {
+static char * format_decimal ( char *end, unsigned long long num,
+			       int negative, int width, int flags ) {
 	char *ptr = end;
-	int negative = 0;
 	int zpad = ( flags & ZPAD );
 	int pad = ( zpad | ' ' );
 
 	/* Generate the number */
-	if ( num < 0 ) {
-		negative = 1;
-		num = -num;
-	}
 	do {
 		*(--ptr) = '0' + ( num % 10 );
 		num /= 10;
@@ -290,7 +286,20 @@ size_t vcprintf ( struct printf_context *ctx, const char *fmt, va_list args ) {
 			} else {
 				decimal = va_arg ( args, signed int );
 			}
-			ptr = format_decimal ( ptr, decimal, width, flags );
+			ptr = format_decimal ( ptr, ( ( decimal < 0 ) ?
+						      -decimal : decimal ),
+					       ( decimal < 0 ), width, flags );
+		} else if ( *fmt == 'u' ) {
+			unsigned long long decimal;
+
+			if ( *length >= sizeof ( unsigned long long ) ) {
+				decimal = va_arg ( args, unsigned long long );
+			} else if ( *length >= sizeof ( unsigned long ) ) {
+				decimal = va_arg ( args, unsigned long );
+			} else {
+				decimal = va_arg ( args, unsigned int );
+			}
+			ptr = format_decimal ( ptr, decimal, 0, width, flags );
 		} else {
 			*(--ptr) = *fmt;
 		}
@@ -30,6 +30,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/iobuf.h>
 #include <ipxe/xfer.h>
 #include <ipxe/open.h>
+#include <ipxe/tracepoint.h>
 
 /** @file
  *
@@ -45,6 +46,11 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
  */
 static struct xfer_metadata dummy_metadata;
 
+/** Delivery tracepoint */
+static struct tracepoint xfer_deliver_tracepoint __tracepoint = {
+	.name = "xfer.deliver",
+};
+
 /*****************************************************************************
  *
  * Data transfer interface operations
@@ -202,6 +208,7 @@ int xfer_deliver ( struct interface *intf,
 
 	DBGC ( INTF_COL ( intf ), "INTF " INTF_INTF_FMT " deliver %zd\n",
 	       INTF_INTF_DBG ( intf, dest ), iob_len ( iobuf ) );
+	trace ( &xfer_deliver_tracepoint, iob_len ( iobuf ) );
 
 	if ( op ) {
 		rc = op ( object, iobuf, meta );
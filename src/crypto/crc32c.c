@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * CRC32C (Castagnoli) checksum
+ *
+ */
+
+#include <ipxe/crc32c.h>
+
+/** CRC32C polynomial (bit-reversed) */
+#define CRC32C_POLY 0x82f63b78UL
+
+/** CRC32C lookup table */
+static uint32_t crc32c_table[256];
+
+/**
+ * Construct CRC32C lookup table
+ *
+ */
+static void crc32c_init_table ( void ) {
+	uint32_t crc;
+	unsigned int i;
+	unsigned int j;
+
+	for ( i = 0 ; i < ( sizeof ( crc32c_table ) /
+			    sizeof ( crc32c_table[0] ) ) ; i++ ) {
+		crc = i;
+		for ( j = 0 ; j < 8 ; j++ ) {
+			if ( crc & 1 ) {
+				crc = ( ( crc >> 1 ) ^ CRC32C_POLY );
+			} else {
+				crc = ( crc >> 1 );
+			}
+		}
+		crc32c_table[i] = crc;
+	}
+}
+
+/**
+ * Calculate 32-bit little-endian CRC32C checksum
+ *
+ * @v seed		Initial value
+ * @v data		Data to checksum
+ * @v len		Length of data
+ * @ret crc		CRC32C checksum
+ *
+ * As with crc32_le(), no inversion is applied: protocols such as
+ * iSCSI will use an initial value of all one bits and invert the
+ * result.  To continue a checksum over multiple calls, pass the
+ * return value from one call as the @a seed parameter to the next.
+ */
+uint32_t generic_crc32c_le ( uint32_t seed, const void *data, size_t len ) {
+	const uint8_t *byte = data;
+	uint32_t crc = seed;
+	unsigned int index;
+
+	/* Construct lookup table on first use (entry 0 is always zero) */
+	if ( ! crc32c_table[1] )
+		crc32c_init_table();
+
+	/* Calculate checksum */
+	while ( len-- ) {
+		index = ( ( crc ^ *(byte++) ) & 0xff );
+		crc = ( ( crc >> 8 ) ^ crc32c_table[index] );
+	}
+
+	return crc;
+}
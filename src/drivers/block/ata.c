@@ -75,6 +75,30 @@ int ata_command ( struct interface *control, struct interface *data,
 	return tag;
 }
 
+/**
+ * Get maximum number of blocks per ATA command
+ *
+ * @v control		ATA control interface
+ * @ret max_count	Maximum number of blocks, or zero if unspecified
+ */
+unsigned int ata_max_count ( struct interface *control ) {
+	struct interface *dest;
+	ata_max_count_TYPE ( void * ) *op =
+		intf_get_dest_op ( control, ata_max_count, &dest );
+	void *object = intf_object ( dest );
+	unsigned int max_count;
+
+	if ( op ) {
+		max_count = op ( object );
+	} else {
+		/* Default is to use the limit specified when opening */
+		max_count = 0;
+	}
+
+	intf_put ( dest );
+	return max_count;
+}
+
 /******************************************************************************
  *
  * ATA devices and commands
@@ -379,6 +403,7 @@ static void atacmd_identify_done ( struct ata_command *atacmd, int rc ) {
 	struct ata_identify_private *priv = atacmd_priv ( atacmd );
 	struct ata_identity *identity = &priv->identity;
 	struct block_device_capacity capacity;
+	unsigned int max_count;
 
 	/* Close if command failed */
 	if ( rc != 0 ) {
@@ -394,7 +419,8 @@ static void atacmd_identify_done ( struct ata_command *atacmd, int rc ) {
 		capacity.blocks = le32_to_cpu ( identity->lba_sectors );
 	}
 	capacity.blksize = ATA_SECTOR_SIZE;
-	capacity.max_count = atadev->max_count;
+	max_count = ata_max_count ( &atadev->ata );
+	capacity.max_count = ( max_count ? max_count : atadev->max_count );
 	DBGC ( atadev, "ATA %p is a %s\n", atadev, ata_model ( identity ) );
 	DBGC ( atadev, "ATA %p has %#llx blocks (%ld MB) and uses %s\n",
 	       atadev, capacity.blocks,
@@ -658,6 +684,9 @@ static struct interface_descriptor atadev_ata_desc =
  * @v device		ATA device number
  * @v max_count		Maximum number of blocks per single transfer
  * @ret rc		Return status code
+ *
+ * The underlying device may override @c max_count (e.g. once it has
+ * discovered the link MTU) by implementing ata_max_count().
  */
 int ata_open ( struct interface *block, struct interface *ata,
 	       unsigned int device, unsigned int max_count ) {
@@ -1152,6 +1152,9 @@ static void gve_close ( struct net_device *netdev ) {
 	/* Stop reset recovery timer */
 	stop_timer ( &gve->watchdog );
 
+	/* Stop watching for receive completions */
+	netdev->wake = NULL;
+
 	/* Terminate startup process */
 	process_del ( &gve->startup );
 
@@ -1383,6 +1386,7 @@ static void gve_refill_rx ( struct net_device *netdev ) {
  * @v netdev		Network device
  */
 static void gve_poll ( struct net_device *netdev ) {
+	struct gve_nic *gve = netdev->priv;
 
 	/* Do nothing if queues are not yet set up */
 	if ( ! netdev_link_ok ( netdev ) )
@@ -1396,6 +1400,11 @@ static void gve_poll ( struct net_device *netdev ) {
 
 	/* Refill receive queue */
 	gve_refill_rx ( netdev );
+
+	/* Allow CPU to sleep until the next receive completion is written */
+	netdev->wake = user_to_virt ( gve->rx.cmplt,
+				      ( ( gve->rx.cons & ( gve->rx.count - 1 ) )
+					* sizeof ( struct gve_rx_completion ) ) );
 }
 
 /** GVE network device operations */
@@ -838,6 +838,9 @@ static int ice_probe ( struct pci_device *pci ) {
 					  INTELXL_MSIX_VECTOR ) ) != 0 )
 		goto err_msix;
 
+	/* Allow CPU to sleep until the dummy interrupt is written */
+	netdev->wake = &intelxl->msix.msg;
+
 	/* Open admin queues */
 	if ( ( rc = intelxl_open_admin ( intelxl ) ) != 0 )
 		goto err_open_admin;
@@ -584,11 +584,23 @@ void intel_refill_rx ( struct intel_nic *intel ) {
 	unsigned int rx_tail;
 	unsigned int refilled = 0;
 
+	/* Create receive buffer pool, if not already attempted.  The
+	 * pool is an optimisation; we can continue without it.  A
+	 * failure is not retried until the device is next opened,
+	 * to avoid a failing allocation on every poll.
+	 */
+	if ( ! intel->rx_pool_tried ) {
+		intel->rx_pool = alloc_iob_pool ( intel->dma, intel->rx_max_len,
+						  INTEL_RX_POOL );
+		intel->rx_pool_tried = 1;
+	}
+
 	/* Refill ring */
 	while ( ( intel->rx.prod - intel->rx.cons ) < INTEL_RX_FILL ) {
 
 		/* Allocate I/O buffer */
-		iobuf = alloc_rx_iob ( INTEL_RX_MAX_LEN, intel->dma );
+		iobuf = iob_pool_alloc ( intel->rx_pool, intel->rx_max_len,
+					 intel->dma );
 		if ( ! iobuf ) {
 			/* Wait for next refill */
 			break;
@@ -607,7 +619,7 @@ void intel_refill_rx ( struct intel_nic *intel ) {
 
 		DBGC2 ( intel, "INTEL %p RX %d is [%lx,%lx)\n",
 			intel, rx_idx, virt_to_phys ( iobuf->data ),
-			( virt_to_phys ( iobuf->data ) + INTEL_RX_MAX_LEN ) );
+			( virt_to_phys ( iobuf->data ) + intel->rx_max_len ) );
 		refilled++;
 	}
 
@@ -636,6 +648,11 @@ void intel_empty_rx ( struct intel_nic *intel ) {
 			free_rx_iob ( intel->rx_iobuf[i] );
 		intel->rx_iobuf[i] = NULL;
 	}
+
+	/* Release receive buffer pool */
+	free_iob_pool ( intel->rx_pool );
+	intel->rx_pool = NULL;
+	intel->rx_pool_tried = 0;
 }
 
 /**
@@ -650,6 +667,8 @@ static int intel_open ( struct net_device *netdev ) {
 	uint32_t fextnvm11;
 	uint32_t tctl;
 	uint32_t rctl;
+	uint32_t bsize;
+	size_t max_len;
 	int rc;
 
 	/* Set undocumented bit in FEXTNVM11 to work around an errata
@@ -686,11 +705,26 @@ static int intel_open ( struct net_device *netdev ) {
 		  INTEL_TCTL_COLD_DEFAULT );
 	writel ( tctl, intel->regs + INTEL_TCTL );
 
+	/* Select receive buffer size.  The MTU can exceed a standard
+	 * Ethernet frame only if jumbo frames are supported.
+	 */
+	max_len = ( netdev->mtu + netdev->ll_protocol->ll_header_len );
+	if ( max_len > ETH_FRAME_LEN ) {
+		assert ( intel->flags & INTEL_JUMBO );
+		intel->rx_max_len = INTEL_RX_JUMBO_LEN;
+		bsize = ( INTEL_RCTL_BSIZE_16384 | INTEL_RCTL_LPE );
+	} else {
+		intel->rx_max_len = INTEL_RX_MAX_LEN;
+		bsize = INTEL_RCTL_BSIZE_2048;
+	}
+	DBGC ( intel, "INTEL %p using %zd-byte receive buffers\n",
+	       intel, intel->rx_max_len );
+
 	/* Enable receiver */
 	rctl = readl ( intel->regs + INTEL_RCTL );
-	rctl &= ~( INTEL_RCTL_BSIZE_BSEX_MASK );
+	rctl &= ~( INTEL_RCTL_BSIZE_BSEX_MASK | INTEL_RCTL_LPE );
 	rctl |= ( INTEL_RCTL_EN | INTEL_RCTL_UPE | INTEL_RCTL_MPE |
-		  INTEL_RCTL_BAM | INTEL_RCTL_BSIZE_2048 | INTEL_RCTL_SECRC );
+		  INTEL_RCTL_BAM | bsize | INTEL_RCTL_SECRC );
 	writel ( rctl, intel->regs + INTEL_RCTL );
 
 	/* Fill receive ring */
@@ -964,6 +998,16 @@ static int intel_probe ( struct pci_device *pci ) {
 			  intel_describe_tx );
 	intel_init_ring ( &intel->rx, INTEL_NUM_RX_DESC, INTEL_RD,
 			  intel_describe_rx );
+	intel->rx_max_len = INTEL_RX_MAX_LEN;
+
+	/* Allow jumbo frames if supported, but default to a standard
+	 * MTU unless a larger MTU is explicitly configured (e.g. via
+	 * DHCP option 26), since jumbo receive buffers are expensive.
+	 */
+	if ( intel->flags & INTEL_JUMBO ) {
+		netdev->max_pkt_len = INTEL_JUMBO_MAX_PKT_LEN;
+		netdev->mtu = ETH_MAX_MTU;
+	}
 
 	/* Fix up PCI device */
 	adjust_pci_device ( pci );
@@ -1051,8 +1095,9 @@ static struct pci_device_id intel_nics[] = {
 	PCI_ROM ( 0x8086, 0x1009, "82544ei-f", "82544EI (Fiber)", 0 ),
 	PCI_ROM ( 0x8086, 0x100c, "82544gc", "82544GC (Copper)", 0 ),
 	PCI_ROM ( 0x8086, 0x100d, "82544gc-l", "82544GC (LOM)", 0 ),
-	PCI_ROM ( 0x8086, 0x100e, "82540em", "82540EM", 0 ),
-	PCI_ROM ( 0x8086, 0x100f, "82545em", "82545EM (Copper)", INTEL_VMWARE ),
+	PCI_ROM ( 0x8086, 0x100e, "82540em", "82540EM", INTEL_JUMBO ),
+	PCI_ROM ( 0x8086, 0x100f, "82545em", "82545EM (Copper)",
+		  ( INTEL_VMWARE | INTEL_JUMBO ) ),
 	PCI_ROM ( 0x8086, 0x1010, "82546eb", "82546EB (Copper)", 0 ),
 	PCI_ROM ( 0x8086, 0x1011, "82545em-f", "82545EM (Fiber)", 0 ),
 	PCI_ROM ( 0x8086, 0x1012, "82546eb-f", "82546EB (Fiber)", 0 ),
@@ -1116,7 +1161,7 @@ static struct pci_device_id intel_nics[] = {
 	PCI_ROM ( 0x8086, 0x10cc, "82567lm-2", "82567LM-2", 0 ),
 	PCI_ROM ( 0x8086, 0x10cd, "82567lf-2", "82567LF-2", 0 ),
 	PCI_ROM ( 0x8086, 0x10ce, "82567v-2", "82567V-2", 0 ),
-	PCI_ROM ( 0x8086, 0x10d3, "82574l", "82574L", 0 ),
+	PCI_ROM ( 0x8086, 0x10d3, "82574l", "82574L", INTEL_JUMBO ),
 	PCI_ROM ( 0x8086, 0x10d5, "82571pt", "82571PT PT Quad", 0 ),
 	PCI_ROM ( 0x8086, 0x10d6, "82575gb", "82575GB", 0 ),
 	PCI_ROM ( 0x8086, 0x10d9, "82571eb-d", "82571EB Dual Mezzanine", 0 ),
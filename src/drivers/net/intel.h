@@ -114,10 +114,12 @@ struct intel_descriptor {
 #define INTEL_RCTL_EN		0x00000002UL	/**< Receive enable */
 #define INTEL_RCTL_UPE		0x00000008UL	/**< Unicast promiscuous mode */
 #define INTEL_RCTL_MPE		0x00000010UL	/**< Multicast promiscuous */
+#define INTEL_RCTL_LPE		0x00000020UL	/**< Long packet enable */
 #define INTEL_RCTL_BAM		0x00008000UL	/**< Broadcast accept mode */
 #define INTEL_RCTL_BSIZE_BSEX(bsex,bsize) \
 	( ( (bsize) << 16 ) | ( (bsex) << 25 ) ) /**< Buffer size */
 #define INTEL_RCTL_BSIZE_2048	INTEL_RCTL_BSIZE_BSEX ( 0, 0 )
+#define INTEL_RCTL_BSIZE_16384	INTEL_RCTL_BSIZE_BSEX ( 1, 1 )
 #define INTEL_RCTL_BSIZE_BSEX_MASK INTEL_RCTL_BSIZE_BSEX ( 1, 3 )
 #define INTEL_RCTL_SECRC	0x04000000UL	/**< Strip CRC */
 
@@ -158,6 +160,19 @@ struct intel_descriptor {
 /** Receive buffer length */
 #define INTEL_RX_MAX_LEN 2048
 
+/** Receive buffer length for jumbo frames */
+#define INTEL_RX_JUMBO_LEN 16384
+
+/** Maximum packet length for jumbo frames (excluding CRC) */
+#define INTEL_JUMBO_MAX_PKT_LEN ( 9018 - 4 /* CRC */ )
+
+/** Number of buffers in receive buffer pool
+ *
+ * This must be at least the receive descriptor ring fill level, so
+ * that the pool can cover the whole ring.
+ */
+#define INTEL_RX_POOL ( 2 * INTEL_RX_FILL )
+
 /** Transmit packet buffer size */
 #define INTEL_TXPBS 0x03404UL
 #define INTEL_TXPBS_I210	0x04000014UL	/**< I210 power-up default */
@@ -313,6 +328,12 @@ struct intel_nic {
 	struct intel_ring rx;
 	/** Receive I/O buffers */
 	struct io_buffer *rx_iobuf[INTEL_NUM_RX_DESC];
+	/** Receive buffer length */
+	size_t rx_max_len;
+	/** Receive I/O buffer pool */
+	struct iob_pool *rx_pool;
+	/** Receive I/O buffer pool creation has been attempted */
+	int rx_pool_tried;
 };
 
 /** Driver flags */
@@ -329,6 +350,8 @@ enum intel_flags {
 	INTEL_RST_HANG = 0x0010,
 	/** PBSIZE registers must be explicitly reset */
 	INTEL_PBSIZE_RST = 0x0020,
+	/** Jumbo frames are supported via RCTL buffer sizing */
+	INTEL_JUMBO = 0x0040,
 };
 
 /** The i219 has a seriously broken reset mechanism */
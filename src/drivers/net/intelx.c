@@ -399,6 +399,7 @@ static int intelx_probe ( struct pci_device *pci ) {
 			  intel_describe_tx );
 	intel_init_ring ( &intel->rx, INTEL_NUM_RX_DESC, INTELX_RD,
 			  intel_describe_rx );
+	intel->rx_max_len = INTEL_RX_MAX_LEN;
 
 	/* Fix up PCI device */
 	adjust_pci_device ( pci );
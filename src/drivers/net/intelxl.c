@@ -1340,11 +1340,23 @@ static void intelxl_refill_rx ( struct intelxl_nic *intelxl ) {
 	unsigned int rx_tail;
 	unsigned int refilled = 0;
 
+	/* Create receive buffer pool, if not already attempted.  The
+	 * pool is an optimisation; we can continue without it.  A
+	 * failure is not retried until the device is next opened,
+	 * to avoid a failing allocation on every poll.
+	 */
+	if ( ! intelxl->rx_pool_tried ) {
+		intelxl->rx_pool = alloc_iob_pool ( intelxl->dma, intelxl->mfs,
+						    INTELXL_RX_POOL );
+		intelxl->rx_pool_tried = 1;
+	}
+
 	/* Refill ring */
 	while ( ( intelxl->rx.prod - intelxl->rx.cons ) < INTELXL_RX_FILL ) {
 
 		/* Allocate I/O buffer */
-		iobuf = alloc_rx_iob ( intelxl->mfs, intelxl->dma );
+		iobuf = iob_pool_alloc ( intelxl->rx_pool, intelxl->mfs,
+					 intelxl->dma );
 		if ( ! iobuf ) {
 			/* Wait for next refill */
 			break;
@@ -1390,6 +1402,11 @@ void intelxl_empty_rx ( struct intelxl_nic *intelxl ) {
 			free_rx_iob ( intelxl->rx_iobuf[i] );
 		intelxl->rx_iobuf[i] = NULL;
 	}
+
+	/* Release receive buffer pool */
+	free_iob_pool ( intelxl->rx_pool );
+	intelxl->rx_pool = NULL;
+	intelxl->rx_pool_tried = 0;
 }
 
 /******************************************************************************
@@ -1757,6 +1774,9 @@ static int intelxl_probe ( struct pci_device *pci ) {
 					  INTELXL_MSIX_VECTOR ) ) != 0 )
 		goto err_msix;
 
+	/* Allow CPU to sleep until the dummy interrupt is written */
+	netdev->wake = &intelxl->msix.msg;
+
 	/* Open admin queues */
 	if ( ( rc = intelxl_open_admin ( intelxl ) ) != 0 )
 		goto err_open_admin;
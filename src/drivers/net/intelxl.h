@@ -817,6 +817,9 @@ intelxl_init_ring ( struct intelxl_ring *ring, unsigned int count, size_t len,
  */
 #define INTELXL_RX_FILL 16
 
+/** Number of buffers in receive buffer pool */
+#define INTELXL_RX_POOL ( 2 * INTELXL_RX_FILL )
+
 /** Maximum packet length (excluding CRC) */
 #define INTELXL_MAX_PKT_LEN ( 9728 - 4 /* CRC */ )
 
@@ -950,6 +953,10 @@ struct intelxl_nic {
 	struct intelxl_ring rx;
 	/** Receive I/O buffers */
 	struct io_buffer *rx_iobuf[INTELXL_RX_NUM_DESC];
+	/** Receive I/O buffer pool */
+	struct iob_pool *rx_pool;
+	/** Receive I/O buffer pool creation has been attempted */
+	int rx_pool_tried;
 
 	/**
 	 * Handle admin event
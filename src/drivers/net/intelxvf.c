@@ -451,6 +451,7 @@ static int intelxvf_probe ( struct pci_device *pci ) {
 			  intel_describe_tx_adv );
 	intel_init_ring ( &intel->rx, INTEL_NUM_RX_DESC, INTELXVF_RD(0),
 			  intel_describe_rx );
+	intel->rx_max_len = INTEL_RX_MAX_LEN;
 
 	/* Fix up PCI device */
 	adjust_pci_device ( pci );
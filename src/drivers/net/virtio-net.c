@@ -311,12 +311,20 @@ static int virtnet_open_modern ( struct net_device *netdev ) {
  */
 static int virtnet_open ( struct net_device *netdev ) {
 	struct virtnet_nic *virtnet = netdev->priv;
+	int rc;
 
 	if ( virtnet->virtio_version ) {
-		return virtnet_open_modern ( netdev );
+		rc = virtnet_open_modern ( netdev );
 	} else {
-		return virtnet_open_legacy ( netdev );
+		rc = virtnet_open_legacy ( netdev );
 	}
+	if ( rc != 0 )
+		return rc;
+
+	/* Allow CPU to sleep until the device updates the RX used ring */
+	netdev->wake = &virtnet->virtqueue[RX_INDEX].vring.used->idx;
+
+	return 0;
 }
 
 /** Close network device
@@ -335,6 +343,7 @@ static void virtnet_close ( struct net_device *netdev ) {
 	}
 
 	/* Virtqueues can be freed now that NIC is reset */
+	netdev->wake = NULL;
 	virtnet_free_virtqueues ( netdev );
 
 	/* Free rx iobufs */
@@ -55,11 +55,26 @@ static int autoboot_payload ( struct net_device *netdev,
 	return netboot ( netdev );
 }
 
+/**
+ * "autoboot" parallel payload
+ *
+ * @v netdevs		Network devices
+ * @v count		Number of network devices
+ * @v opts		Command options
+ * @ret rc		Return status code
+ */
+static int autoboot_parallel_payload ( struct net_device **netdevs,
+				       unsigned int count,
+				       struct autoboot_options *opts __unused ) {
+	return netboot_any ( netdevs, count );
+}
+
 /** "autoboot" command descriptor */
 static struct ifcommon_command_descriptor autoboot_cmd =
-	IFCOMMON_COMMAND_DESC ( struct autoboot_options, autoboot_opts,
-				0, MAX_ARGUMENTS, "[<interface>...]",
-				autoboot_payload, 0 );
+	IFCOMMON_PARALLEL_COMMAND_DESC ( struct autoboot_options,
+					 autoboot_opts, 0, MAX_ARGUMENTS,
+					 "[<interface>...]", autoboot_payload,
+					 autoboot_parallel_payload );
 
 /**
  * "autoboot" command
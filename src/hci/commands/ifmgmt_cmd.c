@@ -38,6 +38,59 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
  *
  */
 
+/**
+ * Execute if<xxx> command payload in parallel across interfaces
+ *
+ * @v argc		Argument count
+ * @v argv		Argument list
+ * @v ifcmd		Command descriptor
+ * @v opts		Command options
+ * @ret rc		Return status code
+ */
+static int ifcommon_parallel ( int argc, char **argv,
+			       struct ifcommon_command_descriptor *ifcmd,
+			       void *opts ) {
+	struct net_device *netdev;
+	unsigned int count = 0;
+	unsigned int max = 0;
+	int rc = -ENODEV;
+	int i;
+
+	/* Count candidate interfaces */
+	if ( optind != argc ) {
+		max = ( argc - optind );
+	} else {
+		for_each_netdev ( netdev )
+			max++;
+	}
+
+	{
+		struct net_device *netdevs[ max ? max : 1 ];
+
+		/* Construct list of candidate interfaces */
+		if ( optind != argc ) {
+			for ( i = optind ; i < argc ; i++ ) {
+				if ( ( rc = parse_netdev ( argv[i],
+							   &netdev ) ) != 0 )
+					continue;
+				netdevs[count++] = netdev;
+			}
+		} else {
+			for_each_netdev ( netdev )
+				netdevs[count++] = netdev;
+		}
+
+		/* Try all candidate interfaces */
+		if ( count > 1 ) {
+			rc = ifcmd->parallel ( netdevs, count, opts );
+		} else if ( count == 1 ) {
+			rc = ifcmd->payload ( netdevs[0], opts );
+		}
+	}
+
+	return rc;
+}
+
 /**
  * Execute if<xxx> command
  *
@@ -60,6 +113,10 @@ int ifcommon_exec ( int argc, char **argv,
 	if ( ( rc = parse_options ( argc, argv, cmd, opts ) ) != 0 )
 		return rc;
 
+	/* Use parallel payload, if applicable */
+	if ( ifcmd->parallel )
+		return ifcommon_parallel ( argc, argv, ifcmd, opts );
+
 	if ( optind != argc ) {
 		/* Treat arguments as a list of interfaces to try */
 		for ( i = optind ; i < argc ; i++ ) {
@@ -233,11 +290,29 @@ static int ifconf_payload ( struct net_device *netdev,
 	return 0;
 }
 
+/**
+ * "ifconf" parallel payload
+ *
+ * @v netdevs		Network devices
+ * @v count		Number of network devices
+ * @v opts		Command options
+ * @ret rc		Return status code
+ */
+static int ifconf_parallel_payload ( struct net_device **netdevs,
+				     unsigned int count,
+				     struct ifconf_options *opts ) {
+	struct net_device *netdev;
+
+	return ifconf_parallel ( netdevs, count, opts->configurator,
+				 opts->timeout, &netdev );
+}
+
 /** "ifconf" command descriptor */
 static struct ifcommon_command_descriptor ifconf_cmd =
-	IFCOMMON_COMMAND_DESC ( struct ifconf_options, ifconf_opts,
-				0, MAX_ARGUMENTS, "[<interface>...]",
-				ifconf_payload, 1 );
+	IFCOMMON_PARALLEL_COMMAND_DESC ( struct ifconf_options, ifconf_opts,
+					 0, MAX_ARGUMENTS, "[<interface>...]",
+					 ifconf_payload,
+					 ifconf_parallel_payload );
 
 /**
  * The "ifconf" command
@@ -285,11 +360,29 @@ static int iflinkwait_payload ( struct net_device *netdev,
 	return 0;
 }
 
+/**
+ * "iflinkwait" parallel payload
+ *
+ * @v netdevs		Network devices
+ * @v count		Number of network devices
+ * @v opts		Command options
+ * @ret rc		Return status code
+ */
+static int iflinkwait_parallel_payload ( struct net_device **netdevs,
+					 unsigned int count,
+					 struct iflinkwait_options *opts ) {
+	struct net_device *netdev;
+
+	return iflinkwait_parallel ( netdevs, count, opts->timeout, &netdev );
+}
+
 /** "iflinkwait" command descriptor */
 static struct ifcommon_command_descriptor iflinkwait_cmd =
-	IFCOMMON_COMMAND_DESC ( struct iflinkwait_options, iflinkwait_opts,
-				0, MAX_ARGUMENTS, "[<interface>...]",
-				iflinkwait_payload, 1 );
+	IFCOMMON_PARALLEL_COMMAND_DESC ( struct iflinkwait_options,
+					 iflinkwait_opts, 0, MAX_ARGUMENTS,
+					 "[<interface>...]",
+					 iflinkwait_payload,
+					 iflinkwait_parallel_payload );
 
 /**
  * The "iflinkwait" command
@@ -24,7 +24,9 @@
 FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 
 #include <stdio.h>
+#include <errno.h>
 #include <getopt.h>
+#include <ipxe/profile.h>
 #include <ipxe/command.h>
 #include <ipxe/parseopt.h>
 #include <usr/profstat.h>
@@ -36,14 +38,50 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
  */
 
 /** "profstat" options */
-struct profstat_options {};
+struct profstat_options {
+	/** Print as comma-separated values */
+	int csv;
+	/** Enable profilers */
+	int enable;
+	/** Disable profilers */
+	int disable;
+	/** Reset profilers */
+	int reset;
+};
 
 /** "profstat" option list */
-static struct option_descriptor profstat_opts[] = {};
+static struct option_descriptor profstat_opts[] = {
+	OPTION_DESC ( "csv", 'c', no_argument,
+		      struct profstat_options, csv, parse_flag ),
+	OPTION_DESC ( "enable", 'e', no_argument,
+		      struct profstat_options, enable, parse_flag ),
+	OPTION_DESC ( "disable", 'd', no_argument,
+		      struct profstat_options, disable, parse_flag ),
+	OPTION_DESC ( "reset", 'r', no_argument,
+		      struct profstat_options, reset, parse_flag ),
+};
 
 /** "profstat" command descriptor */
 static struct command_descriptor profstat_cmd =
-	COMMAND_DESC ( struct profstat_options, profstat_opts, 0, 0, NULL );
+	COMMAND_DESC ( struct profstat_options, profstat_opts, 0, MAX_ARGUMENTS,
+		       "[--csv] [--enable|--disable|--reset] [<name>...]" );
+
+/**
+ * Control profiler
+ *
+ * @v profiler		Profiler
+ * @v opts		Options
+ */
+static void profstat_control ( struct profiler *profiler,
+			       struct profstat_options *opts ) {
+
+	if ( opts->enable )
+		profiler->disabled = 0;
+	if ( opts->disable )
+		profiler->disabled = 1;
+	if ( opts->reset )
+		profile_reset ( profiler );
+}
 
 /**
  * The "profstat" command
@@ -54,13 +92,36 @@ static struct command_descriptor profstat_cmd =
  */
 static int profstat_exec ( int argc, char **argv ) {
 	struct profstat_options opts;
+	struct profiler *profiler;
+	int i;
 	int rc;
 
 	/* Parse options */
 	if ( ( rc = parse_options ( argc, argv, &profstat_cmd, &opts ) ) != 0 )
 		return rc;
 
-	profstat();
+	/* Print statistics, if no control options are specified */
+	if ( ! ( opts.enable || opts.disable || opts.reset ) ) {
+		profstat ( opts.csv );
+		return 0;
+	}
+
+	/* Control all profilers, if no names are specified */
+	if ( optind == argc ) {
+		for_each_table_entry ( profiler, PROFILERS )
+			profstat_control ( profiler, &opts );
+		return 0;
+	}
+
+	/* Control named profilers */
+	for ( i = optind ; i < argc ; i++ ) {
+		profiler = find_profiler ( argv[i] );
+		if ( ! profiler ) {
+			printf ( "Could not find profiler \"%s\"\n", argv[i] );
+			return -ENOENT;
+		}
+		profstat_control ( profiler, &opts );
+	}
 
 	return 0;
 }
@@ -30,6 +30,7 @@
 #include <ipxe/uri.h>
 #include <ipxe/sanboot.h>
 #include <usr/autoboot.h>
+#include <usr/saninfo.h>
 
 FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 
@@ -45,6 +46,8 @@ struct sanboot_options {
 	unsigned int drive;
 	/** Do not describe SAN device */
 	int no_describe;
+	/** Copy SAN device to RAM */
+	int memdisk;
 	/** Keep SAN device */
 	int keep;
 	/** Boot filename */
@@ -60,9 +63,9 @@ struct sanboot_options {
 /** "sanboot" option list */
 static union {
 	/* "sanboot" takes all options */
-	struct option_descriptor sanboot[7];
-	/* "sanhook" takes only --drive and --no-describe */
-	struct option_descriptor sanhook[2];
+	struct option_descriptor sanboot[8];
+	/* "sanhook" takes only --drive, --no-describe and --memdisk */
+	struct option_descriptor sanhook[3];
 	/* "sanunhook" takes only --drive */
 	struct option_descriptor sanunhook[1];
 } opts = {
@@ -71,6 +74,8 @@ static union {
 			      struct sanboot_options, drive, parse_integer ),
 		OPTION_DESC ( "no-describe", 'n', no_argument,
 			      struct sanboot_options, no_describe, parse_flag ),
+		OPTION_DESC ( "memdisk", 'm', no_argument,
+			      struct sanboot_options, memdisk, parse_flag ),
 		OPTION_DESC ( "keep", 'k', no_argument,
 			      struct sanboot_options, keep, parse_flag ),
 		OPTION_DESC ( "filename", 'f', required_argument,
@@ -146,6 +151,8 @@ static int sanboot_core_exec ( int argc, char **argv,
 	flags = default_flags;
 	if ( opts.no_describe )
 		flags |= URIBOOT_NO_SAN_DESCRIBE;
+	if ( opts.memdisk )
+		flags |= URIBOOT_SAN_MEMDISK;
 	if ( opts.keep )
 		flags |= URIBOOT_NO_SAN_UNHOOK;
 	if ( ! count )
@@ -203,6 +210,60 @@ static int sanunhook_exec ( int argc, char **argv ) {
 				     URIBOOT_NO_SAN_BOOT ), 0 );
 }
 
+/** "saninfo" options */
+struct saninfo_options {
+	/** Drive number */
+	unsigned int drive;
+};
+
+/** "saninfo" option list */
+static struct option_descriptor saninfo_opts[] = {
+	OPTION_DESC ( "drive", 'd', required_argument,
+		      struct saninfo_options, drive, parse_integer ),
+};
+
+/** "saninfo" command descriptor */
+static struct command_descriptor saninfo_cmd =
+	COMMAND_DESC ( struct saninfo_options, saninfo_opts, 0, 0, NULL );
+
+/**
+ * The "saninfo" command
+ *
+ * @v argc		Argument count
+ * @v argv		Argument list
+ * @ret rc		Return status code
+ */
+static int saninfo_exec ( int argc, char **argv ) {
+	struct saninfo_options opts;
+	struct san_device *sandev;
+	int rc;
+
+	/* Initialise options */
+	memset ( &opts, 0, sizeof ( opts ) );
+	opts.drive = -1U;
+
+	/* Parse options */
+	if ( ( rc = reparse_options ( argc, argv, &saninfo_cmd, &opts ) ) != 0 )
+		return rc;
+
+	/* Show specified drive, if applicable */
+	if ( opts.drive != -1U ) {
+		sandev = sandev_find ( opts.drive );
+		if ( ! sandev ) {
+			printf ( "%#02x: no such drive\n", opts.drive );
+			return -ENODEV;
+		}
+		saninfo ( sandev );
+		return 0;
+	}
+
+	/* Otherwise, show all drives */
+	for_each_sandev ( sandev )
+		saninfo ( sandev );
+
+	return 0;
+}
+
 /** SAN commands */
 struct command sanboot_commands[] __command = {
 	{
@@ -217,4 +278,8 @@ struct command sanboot_commands[] __command = {
 		.name = "sanunhook",
 		.exec = sanunhook_exec,
 	},
+	{
+		.name = "saninfo",
+		.exec = saninfo_exec,
+	},
 };
@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+#include <stdio.h>
+#include <string.h>
+#include <getopt.h>
+#include <ipxe/command.h>
+#include <ipxe/parseopt.h>
+#include <ipxe/tracepoint.h>
+#include <usr/tracemgmt.h>
+
+/** @file
+ *
+ * Tracepoint commands
+ *
+ */
+
+/** "trace" options */
+struct trace_options {
+	/** Start tracing */
+	int start;
+	/** Stop tracing */
+	int stop;
+	/** Number of trace records */
+	unsigned int records;
+	/** Image name */
+	char *image;
+};
+
+/** "trace" option list */
+static struct option_descriptor trace_opts[] = {
+	OPTION_DESC ( "start", 's', no_argument,
+		      struct trace_options, start, parse_flag ),
+	OPTION_DESC ( "stop", 'x', no_argument,
+		      struct trace_options, stop, parse_flag ),
+	OPTION_DESC ( "records", 'r', required_argument,
+		      struct trace_options, records, parse_integer ),
+	OPTION_DESC ( "image", 'i', required_argument,
+		      struct trace_options, image, parse_string ),
+};
+
+/** "trace" command descriptor */
+static struct command_descriptor trace_cmd =
+	COMMAND_DESC ( struct trace_options, trace_opts, 0, 0,
+		       "[--start [--records <count>]] [--stop] "
+		       "[--image <name>]" );
+
+/**
+ * The "trace" command
+ *
+ * @v argc		Argument count
+ * @v argv		Argument list
+ * @ret rc		Return status code
+ */
+static int trace_exec ( int argc, char **argv ) {
+	struct trace_options opts;
+	unsigned int records;
+	int rc;
+
+	/* Parse options */
+	if ( ( rc = parse_options ( argc, argv, &trace_cmd, &opts ) ) != 0 )
+		return rc;
+
+	/* Print trace, if no other action is specified */
+	if ( ! ( opts.start || opts.stop || opts.image ) )
+		return tracestat();
+
+	/* Stop tracing, if applicable */
+	if ( opts.stop )
+		trace_stop();
+
+	/* Start tracing, if applicable */
+	if ( opts.start ) {
+		records = ( opts.records ? opts.records : TRACE_DEFAULT_COUNT );
+		if ( ( rc = trace_start ( records ) ) != 0 ) {
+			printf ( "Could not start tracing: %s\n",
+				 strerror ( rc ) );
+			return rc;
+		}
+	}
+
+	/* Export trace as image, if applicable */
+	if ( opts.image &&
+	     ( ( rc = traceimage ( opts.image ) ) != 0 ) )
+		return rc;
+
+	return 0;
+}
+
+/** Tracepoint commands */
+struct command trace_commands[] __command = {
+	{
+		.name = "trace",
+		.exec = trace_exec,
+	},
+};
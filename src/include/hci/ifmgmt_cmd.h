@@ -41,6 +41,19 @@ struct ifcommon_command_descriptor {
 	 * @ret rc		Return status code
 	 */
 	int ( * payload ) ( struct net_device *netdev, void *opts );
+	/** Parallel payload (if applicable)
+	 *
+	 * @v netdevs		Network devices
+	 * @v count		Number of network devices
+	 * @v opts		Command options
+	 * @ret rc		Return status code
+	 *
+	 * If present, this is used in place of the payload whenever
+	 * there is more than one network device to try, and the
+	 * command completes once the parallel payload returns.
+	 */
+	int ( * parallel ) ( struct net_device **netdevs, unsigned int count,
+			     void *opts );
 	/** Stop on first success */
 	int stop_on_first_success;
 };
@@ -69,6 +82,38 @@ struct ifcommon_command_descriptor {
 		.stop_on_first_success = _stop_on_first_success,	\
 	}
 
+/**
+ * Construct "if<xxx>" command descriptor with a parallel payload
+ *
+ * @v _struct		Options structure type
+ * @v _options		Option descriptor array
+ * @v _check_args	Remaining argument checker
+ * @v _usage		Command usage
+ * @v _parallel		Parallel payload
+ * @ret _command	Command descriptor
+ */
+#define IFCOMMON_PARALLEL_COMMAND_DESC( _struct, _options, _min_args,	\
+					_max_args, _usage, _payload,	\
+					_parallel )			\
+	{								\
+		.cmd = COMMAND_DESC ( _struct, _options, _min_args,	\
+				      _max_args, _usage ),		\
+		.payload = ( ( int ( * ) ( struct net_device *netdev,	\
+					   void *opts ) )		\
+			     ( ( ( ( int ( * ) ( struct net_device *,	\
+						 _struct * ) ) NULL )	\
+				 == ( typeof ( _payload ) * ) NULL )	\
+			       ? _payload : _payload ) ),		\
+		.parallel = ( ( int ( * ) ( struct net_device **netdevs, \
+					    unsigned int count,		\
+					    void *opts ) )		\
+			      ( ( ( ( int ( * ) ( struct net_device **,	\
+						  unsigned int,		\
+						  _struct * ) ) NULL )	\
+				  == ( typeof ( _parallel ) * ) NULL )	\
+				? _parallel : _parallel ) ),		\
+	}
+
 extern int ifcommon_exec (  int argc, char **argv,
 			    struct ifcommon_command_descriptor *cmd );
 extern int ifconf_exec ( int argc, char **argv );
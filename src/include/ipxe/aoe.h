@@ -108,9 +108,15 @@ struct aoehdr {
 /** AoE tag magic marker */
 #define AOE_TAG_MAGIC 0x18ae0000
 
-/** Maximum number of sectors per packet */
+/** Maximum number of sectors per packet for a standard Ethernet frame */
 #define AOE_MAX_COUNT 2
 
+/** Maximum number of sectors per packet (limited by ATA sector count) */
+#define AOE_MAX_SCNT 255
+
+/** Maximum number of outstanding ATA commands per device */
+#define AOE_MAX_WINDOW 16
+
 /** An AoE device */
 struct aoe_device {
 	/** Reference counter */
@@ -135,6 +141,12 @@ struct aoe_device {
 	struct interface config;
 	/** Device is configued */
 	int configured;
+	/** Maximum number of sectors per ATA command */
+	unsigned int max_count;
+	/** Maximum number of outstanding ATA commands */
+	unsigned int window;
+	/** Number of outstanding ATA commands */
+	unsigned int outstanding;
 
 	/** ACPI descriptor */
 	struct acpi_descriptor desc;
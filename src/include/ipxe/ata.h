@@ -198,6 +198,10 @@ extern int ata_command ( struct interface *control, struct interface *data,
 	typeof ( int ( object_type, struct interface *data,		\
 		       struct ata_cmd *command ) )
 
+extern unsigned int ata_max_count ( struct interface *control );
+#define ata_max_count_TYPE( object_type )				\
+	typeof ( unsigned int ( object_type ) )
+
 extern int ata_open ( struct interface *block, struct interface *ata,
 		      unsigned int device, unsigned int max_count );
 
@@ -30,9 +30,11 @@ struct block_translator {
 	userptr_t buffer;
 	/** Block size */
 	size_t blksize;
+	/** Maximum number of blocks per single transfer */
+	unsigned int max_count;
 };
 
-extern int block_translate ( struct interface *block,
-			     userptr_t buffer, size_t size );
+extern int block_translate ( struct interface *block, userptr_t buffer,
+			     size_t size, unsigned int max_count );
 
 #endif /* _IPXE_BLOCKTRANS_H */
@@ -13,6 +13,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <assert.h>
 #include <ipxe/list.h>
 #include <ipxe/dma.h>
+#include <ipxe/refcnt.h>
 
 /**
  * Minimum I/O buffer length
@@ -50,6 +51,48 @@ struct io_buffer {
 	void *tail;
 	/** End of the buffer */
         void *end;
+	/** Receive buffer pool, or NULL if not from a pool */
+	struct iob_pool *pool;
+};
+
+/** Maximum fraction of the free heap that a receive I/O buffer pool
+ * may use
+ */
+#define IOB_POOL_HEAP_FRACTION 4
+
+/**
+ * A receive I/O buffer pool
+ *
+ * A receive buffer pool is a single DMA-coherent region carved into
+ * fixed-size buffers, allowing a driver to refill its receive ring
+ * without mapping and unmapping every individual packet.  Buffers
+ * return to the pool when freed via free_iob().
+ *
+ * The DMA region is freed when the pool is released by its creator,
+ * so that it is never freed after the DMA device has gone away.  The
+ * contents of any buffers still outstanding at that point are first
+ * moved into ordinary memory.  The pool descriptor itself is freed
+ * once all outstanding buffers have been returned.
+ */
+struct iob_pool {
+	/** Reference count */
+	struct refcnt refcnt;
+	/** DMA mapping */
+	struct dma_mapping map;
+	/** Buffer region */
+	void *data;
+	/** Buffer region has been freed */
+	int freed;
+	/** Length of each buffer */
+	size_t len;
+	/** Spacing between buffers */
+	size_t stride;
+	/** Number of buffers */
+	unsigned int count;
+	/** List of free buffers */
+	struct list_head free;
+	/** Buffer descriptors */
+	struct io_buffer iobuf[0];
 };
 
 /**
@@ -283,6 +326,11 @@ extern void free_iob ( struct io_buffer *iobuf );
 extern struct io_buffer * __malloc alloc_rx_iob ( size_t len,
 						  struct dma_device *dma );
 extern void free_rx_iob ( struct io_buffer *iobuf );
+extern struct iob_pool * alloc_iob_pool ( struct dma_device *dma, size_t len,
+					  unsigned int count );
+extern void free_iob_pool ( struct iob_pool *pool );
+extern struct io_buffer * iob_pool_alloc ( struct iob_pool *pool, size_t len,
+					   struct dma_device *dma );
 extern void iob_pad ( struct io_buffer *iobuf, size_t min_len );
 extern int iob_ensure_headroom ( struct io_buffer *iobuf, size_t len );
 extern struct io_buffer * iob_concatenate ( struct list_head *list );
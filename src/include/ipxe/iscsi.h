@@ -28,8 +28,29 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 /** Default iSCSI maximum burst length */
 #define ISCSI_MAX_BURST_LEN 262144
 
-/** Default iSCSI maximum receive data segment length */
-#define ISCSI_MAX_RECV_DATA_SEG_LEN 8192
+/** iSCSI maximum receive data segment length
+ *
+ * Received data segments are processed as they arrive rather than
+ * being buffered, so there is no reason to restrict the target to
+ * small PDUs.
+ */
+#define ISCSI_MAX_RECV_DATA_SEG_LEN 262144
+
+/** Default target maximum receive data segment length (as per RFC7143) */
+#define ISCSI_DEFAULT_MAX_SEND_DATA_SEG_LEN 8192
+
+/** Maximum length of data segments that we will send
+ *
+ * This limits the size of the I/O buffers allocated for data-out
+ * PDUs, regardless of the length that the target will accept.
+ */
+#define ISCSI_MAX_SEND_DATA_SEG_LEN 65536
+
+/** Maximum number of outstanding R2Ts per task */
+#define ISCSI_MAX_OUTSTANDING_R2T 4
+
+/** Maximum number of concurrent tasks (i.e. tagged SCSI commands) */
+#define ISCSI_MAX_TASKS 8
 
 /**
  * iSCSI segment lengths
@@ -130,8 +151,10 @@ struct iscsi_bhs_common_response {
 	uint32_t statsn;
 	/** Expected command sequence number */
 	uint32_t expcmdsn;
+	/** Maximum command sequence number */
+	uint32_t maxcmdsn;
 	/** Fields specific to the PDU type */
-	uint8_t other_d[16];
+	uint8_t other_d[12];
 };
 
 /**
@@ -534,12 +557,74 @@ enum iscsi_rx_state {
 	ISCSI_RX_BHS = 0,
 	/** Receiving the additional header segment */
 	ISCSI_RX_AHS,
+	/** Receiving the header digest */
+	ISCSI_RX_HEADER_DIGEST,
 	/** Receiving the data segment */
 	ISCSI_RX_DATA,
 	/** Receiving the data segment padding */
 	ISCSI_RX_DATA_PADDING,
+	/** Receiving the data digest */
+	ISCSI_RX_DATA_DIGEST,
+};
+
+/** Length of an iSCSI header or data digest */
+#define ISCSI_DIGEST_LEN 4
+
+/** An iSCSI data-out transfer */
+struct iscsi_transfer {
+	/** Target transfer tag
+	 *
+	 * This is the tag from the R2T which requested the transfer,
+	 * or ISCSI_TAG_RESERVED for unsolicited data.
+	 */
+	uint32_t ttt;
+	/** Buffer offset */
+	uint32_t offset;
+	/** Length */
+	uint32_t len;
+};
+
+/** Maximum number of queued data-out transfers per task
+ *
+ * This allows for an unsolicited transfer in addition to the maximum
+ * number of outstanding R2Ts.
+ */
+#define ISCSI_MAX_TRANSFERS ( ISCSI_MAX_OUTSTANDING_R2T + 1 )
+
+/** An iSCSI task
+ *
+ * A task represents a single tagged SCSI command in progress.
+ */
+struct iscsi_task {
+	/** iSCSI session */
+	struct iscsi_session *iscsi;
+	/** SCSI command interface */
+	struct interface data;
+	/** SCSI command */
+	struct scsi_cmd command;
+	/** Task flags */
+	unsigned int flags;
+	/** Initiator task tag */
+	uint32_t itt;
+
+	/** Queued data-out transfers */
+	struct iscsi_transfer transfer[ISCSI_MAX_TRANSFERS];
+	/** Data-out transfer producer index */
+	unsigned int transfer_prod;
+	/** Data-out transfer consumer index */
+	unsigned int transfer_cons;
+	/** Length of data already sent within the current transfer */
+	uint32_t transfer_sent;
+	/** Data sequence number within the current transfer */
+	uint32_t datasn;
 };
 
+/** iSCSI task is in use */
+#define ISCSI_TASK_ACTIVE 0x0001
+
+/** iSCSI task needs to send the SCSI command PDU */
+#define ISCSI_TASK_TX_COMMAND 0x0002
+
 /** An iSCSI session */
 struct iscsi_session {
 	/** Reference counter */
@@ -547,8 +632,6 @@ struct iscsi_session {
 
 	/** SCSI command-issuing interface */
 	struct interface control;
-	/** SCSI command interface */
-	struct interface data;
 	/** Transport-layer socket */
 	struct interface socket;
 
@@ -588,6 +671,10 @@ struct iscsi_session {
 
 	/** Maximum burst length */
 	size_t max_burst_len;
+	/** First burst length */
+	size_t first_burst_len;
+	/** Maximum length of data segments that we may send */
+	size_t max_send_len;
 
 	/** Initiator session ID (IANA format) qualifier
 	 *
@@ -597,36 +684,26 @@ struct iscsi_session {
 	uint16_t isid_iana_qual;
 	/** Initiator task tag
 	 *
-	 * This is the tag of the current command.  It is incremented
-	 * whenever a new command is started.
+	 * This is the tag of the current login request.  Each task
+	 * is assigned its own tag.
 	 */
 	uint32_t itt;
-	/** Target transfer tag
-	 *
-	 * This is the tag attached to a sequence of data-out PDUs in
-	 * response to an R2T.
-	 */
-	uint32_t ttt;
-	/** Transfer offset
-	 *
-	 * This is the offset for an in-progress sequence of data-out
-	 * PDUs in response to an R2T.
-	 */
-	uint32_t transfer_offset;
-	/** Transfer length
-	 *
-	 * This is the length for an in-progress sequence of data-out
-	 * PDUs in response to an R2T.
-	 */
-	uint32_t transfer_len;
 	/** Command sequence number
 	 *
-	 * This is the sequence number of the current command, used to
-	 * fill out the CmdSN field in iSCSI request PDUs.  It is
-	 * updated with the value of the ExpCmdSN field whenever we
-	 * receive an iSCSI response PDU containing such a field.
+	 * This is the sequence number of the next command, used to
+	 * fill out the CmdSN field in iSCSI request PDUs.  During
+	 * login, it is updated with the value of the ExpCmdSN field
+	 * whenever we receive an iSCSI response PDU containing such a
+	 * field.  In the full feature phase, it is incremented
+	 * whenever we send a SCSI command PDU.
 	 */
 	uint32_t cmdsn;
+	/** Maximum command sequence number
+	 *
+	 * This is the highest CmdSN that the target is currently
+	 * prepared to accept.
+	 */
+	uint32_t max_cmdsn;
 	/** Status sequence number
 	 *
 	 * This is the most recent status sequence number present in
@@ -638,8 +715,16 @@ struct iscsi_session {
 	
 	/** Basic header segment for current TX PDU */
 	union iscsi_bhs tx_bhs;
+	/** Task owning the current TX PDU, if any */
+	struct iscsi_task *tx_task;
 	/** State of the TX engine */
 	enum iscsi_tx_state tx_state;
+	/** Digests in use for current TX PDU
+	 *
+	 * This is the bitwise-OR of zero or more
+	 * ISCSI_STATUS_XXX_DIGEST constants.
+	 */
+	unsigned int tx_digests;
 	/** TX process */
 	struct process process;
 
@@ -651,11 +736,21 @@ struct iscsi_session {
 	size_t rx_offset;
 	/** Length of the current RX state */
 	size_t rx_len;
+	/** Digests in use for current RX PDU
+	 *
+	 * This is the bitwise-OR of zero or more
+	 * ISCSI_STATUS_XXX_DIGEST constants.
+	 */
+	unsigned int rx_digests;
+	/** Running CRC32C of current RX header or data segment */
+	uint32_t rx_crc;
+	/** Received header or data digest */
+	uint32_t rx_digest;
 	/** Buffer for received data (not always used) */
 	void *rx_buffer;
 
-	/** Current SCSI command, if any */
-	struct scsi_cmd *command;
+	/** Tasks */
+	struct iscsi_task task[ISCSI_MAX_TASKS];
 
 	/** Target socket address (for boot firmware table) */
 	struct sockaddr target_sockaddr;
@@ -710,6 +805,18 @@ struct iscsi_session {
 /** Target authenticated itself correctly */
 #define ISCSI_STATUS_AUTH_REVERSE_OK 0x00040000
 
+/** Target has agreed to accept immediate data */
+#define ISCSI_STATUS_IMMEDIATE_DATA 0x00080000
+
+/** Target has agreed to accept unsolicited data-out PDUs */
+#define ISCSI_STATUS_NO_INITIAL_R2T 0x00100000
+
+/** Target has agreed to use header digests */
+#define ISCSI_STATUS_HEADER_DIGEST 0x00200000
+
+/** Target has agreed to use data digests */
+#define ISCSI_STATUS_DATA_DIGEST 0x00400000
+
 /** Default initiator IQN prefix */
 #define ISCSI_DEFAULT_IQN_PREFIX "iqn.2010-04.org.ipxe"
 
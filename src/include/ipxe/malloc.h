@@ -25,10 +25,48 @@ extern size_t freemem;
 extern size_t usedmem;
 extern size_t maxusedmem;
 
+/** Number of heap allocation call sites recorded when profiling */
+#define MALLOC_SITES 64
+
+/** Number of memory block size classes recorded when profiling */
+#define MALLOC_SIZES 20
+
+/** A heap allocation call site */
+struct malloc_site {
+	/** Caller address, or NULL for the untracked call sites entry */
+	void *caller;
+	/** Number of live allocations */
+	unsigned int count;
+	/** Number of live bytes */
+	size_t len;
+	/** Maximum number of live bytes */
+	size_t max;
+	/** Total number of allocations */
+	unsigned long total;
+};
+
+/** A heap allocation profile */
+struct malloc_profile {
+	/** Call sites of malloc(), zalloc() and realloc()
+	 *
+	 * Once all other entries are in use, the final entry
+	 * accumulates the allocations from any further call sites.
+	 */
+	struct malloc_site site[MALLOC_SITES];
+	/** Number of live memory blocks, by size class
+	 *
+	 * Size class @c n covers blocks of up to 2^n bytes.  The final
+	 * class also covers all larger blocks.
+	 */
+	unsigned int size[MALLOC_SIZES];
+};
+
 extern void * __malloc alloc_memblock ( size_t size, size_t align,
 					size_t offset );
 extern void free_memblock ( void *ptr, size_t size );
 extern void mpopulate ( void *start, size_t len );
+extern void mfreestat ( unsigned int *count, size_t *largest );
+extern struct malloc_profile * mprofile ( void );
 extern void mdumpfree ( void );
 
 /**
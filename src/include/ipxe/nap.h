@@ -54,4 +54,16 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
  */
 void cpu_nap ( void );
 
+/**
+ * Sleep until next CPU interrupt or write to wake-up location
+ *
+ * @v wake		Wake-up location
+ *
+ * The wake-up location is a memory location to which a device will
+ * write (e.g. via an MSI-X message or a descriptor writeback) when
+ * it has new work available.  Implementations that are unable to
+ * watch for such writes will simply sleep until the next interrupt.
+ */
+void cpu_nap_watch ( const volatile void *wake );
+
 #endif /* _IPXE_NAP_H */
@@ -97,6 +97,19 @@ struct ndp_dnssl_option {
 	uint8_t names[0];
 } __attribute__ (( packed ));
 
+/** NDP MTU option */
+#define NDP_OPT_MTU 5
+
+/** NDP MTU option */
+struct ndp_mtu_option {
+	/** NDP option header */
+	struct ndp_option_header header;
+	/** Reserved */
+	uint16_t reserved;
+	/** MTU */
+	uint32_t mtu;
+} __attribute__ (( packed ));
+
 /** An NDP option */
 union ndp_option {
 	/** Option header */
@@ -105,6 +118,8 @@ union ndp_option {
 	struct ndp_ll_addr_option ll_addr;
 	/** Prefix information option */
 	struct ndp_prefix_information_option prefix;
+	/** MTU option */
+	struct ndp_mtu_option mtu;
 	/** Recursive DNS server option */
 	struct ndp_rdnss_option rdnss;
 	/** DNS search list option */
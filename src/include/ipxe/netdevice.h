@@ -293,10 +293,32 @@ struct net_device_stats {
 	unsigned int good;
 	/** Count of error completions */
 	unsigned int bad;
+	/** Total length of successful completions */
+	unsigned long long bytes;
+	/** Count of completions that failed due to a full ring
+	 *
+	 * Drivers report a full descriptor ring (or lack of buffer
+	 * space) using -ENOBUFS.
+	 */
+	unsigned int full;
 	/** Error breakdowns */
 	struct net_device_error errors[NETDEV_MAX_UNIQUE_ERRORS];
 };
 
+/** Number of network device latency histogram buckets */
+#define NETDEV_LATENCY_BUCKETS 24
+
+/** Network device latency histogram
+ *
+ * Bucket @c n counts samples for which the most significant set bit
+ * of the latency (in profiling timestamp units) is bit @c n.  The
+ * final bucket also counts all larger samples.
+ */
+struct net_device_latency {
+	/** Histogram buckets */
+	unsigned int count[NETDEV_LATENCY_BUCKETS];
+};
+
 /** A network device configuration */
 struct net_device_configuration {
 	/** Network device */
@@ -419,10 +441,28 @@ struct net_device {
 	struct list_head tx_deferred;
 	/** RX packet queue */
 	struct list_head rx_queue;
+	/** Wake-up location
+	 *
+	 * If non-NULL, this is a memory location to which the device
+	 * will write when new work becomes available (e.g. an MSI-X
+	 * message target, or the next receive completion).  The
+	 * driver may update this value each time the device is
+	 * polled.
+	 */
+	const volatile void *wake;
 	/** TX statistics */
 	struct net_device_stats tx_stats;
 	/** RX statistics */
 	struct net_device_stats rx_stats;
+	/** RX processing time
+	 *
+	 * This records the time between the device being polled and
+	 * each received packet having been processed by the network
+	 * stack, including any time spent queued behind earlier
+	 * packets.  It does not include the time for which a packet
+	 * waited within the device before being polled.
+	 */
+	struct net_device_latency rx_processing;
 
 	/** Configuration settings applicable to this device */
 	struct generic_settings settings;
@@ -733,11 +773,13 @@ extern int net_rx ( struct io_buffer *iobuf, struct net_device *netdev,
 		    uint16_t net_proto, const void *ll_dest,
 		    const void *ll_source, unsigned int flags );
 extern void net_poll ( void );
+extern void net_nap ( void );
 extern struct net_device_configurator *
 find_netdev_configurator ( const char *name );
 extern int netdev_configure ( struct net_device *netdev,
 			      struct net_device_configurator *configurator );
 extern int netdev_configure_all ( struct net_device *netdev );
+extern void netdev_configure_cancel ( struct net_device *netdev );
 extern int netdev_configuration_in_progress ( struct net_device *netdev );
 extern int netdev_configuration_ok ( struct net_device *netdev );
 
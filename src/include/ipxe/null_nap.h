@@ -20,4 +20,9 @@ NAP_INLINE ( null, cpu_nap ) ( void ) {
 	/* Do nothing */
 }
 
+static inline __always_inline void
+NAP_INLINE ( null, cpu_nap_watch ) ( const volatile void *wake __unused ) {
+	/* Do nothing */
+}
+
 #endif /* _IPXE_NULL_NAP_H */
@@ -0,0 +1,577 @@
+#ifndef _IPXE_NVMETCP_H
+#define _IPXE_NVMETCP_H
+
+/** @file
+ *
+ * NVMe over TCP protocol
+ *
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+#include <stdint.h>
+#include <ipxe/refcnt.h>
+#include <ipxe/interface.h>
+#include <ipxe/process.h>
+#include <ipxe/retry.h>
+#include <ipxe/uuid.h>
+#include <ipxe/uaccess.h>
+
+/** Default NVMe/TCP port */
+#define NVMETCP_PORT 4420
+
+/******************************************************************************
+ *
+ * NVMe commands
+ *
+ ******************************************************************************
+ */
+
+/** An NVMe scatter-gather list descriptor */
+struct nvme_sgl {
+	/** Address */
+	uint64_t addr;
+	/** Length */
+	uint32_t len;
+	/** Reserved */
+	uint8_t reserved[3];
+	/** Descriptor type */
+	uint8_t type;
+} __attribute__ (( packed ));
+
+/** SGL data block descriptor with offset (i.e. in-capsule data) */
+#define NVME_SGL_DATA_OFFSET 0x01
+
+/** SGL transport data block descriptor (i.e. data transferred via PDUs) */
+#define NVME_SGL_TRANSPORT 0x5a
+
+/** A generic NVMe command */
+struct nvme_generic_command {
+	/** Opcode */
+	uint8_t opcode;
+	/** Flags */
+	uint8_t flags;
+	/** Command identifier */
+	uint16_t cid;
+	/** Namespace identifier */
+	uint32_t nsid;
+	/** Reserved */
+	uint8_t reserved[16];
+	/** Data pointer */
+	struct nvme_sgl sgl;
+	/** Command dwords 10-15 */
+	uint32_t cdw[6];
+} __attribute__ (( packed ));
+
+/** Command uses SGLs for data transfer */
+#define NVME_CMD_SGL 0x40
+
+/** NVMe write command */
+#define NVME_WRITE 0x01
+
+/** NVMe read command */
+#define NVME_READ 0x02
+
+/** NVMe identify command */
+#define NVME_IDENTIFY 0x06
+
+/** Identify namespace */
+#define NVME_IDENTIFY_NS 0x00
+
+/** Identify controller */
+#define NVME_IDENTIFY_CTRL 0x01
+
+/** NVMe set features command */
+#define NVME_SET_FEATURES 0x09
+
+/** Number of queues feature */
+#define NVME_FEAT_NUM_QUEUES 0x07
+
+/** NVMe fabrics command */
+#define NVME_FABRICS 0x7f
+
+/** Fabrics property set command */
+#define NVMF_PROPERTY_SET 0x00
+
+/** Fabrics connect command */
+#define NVMF_CONNECT 0x01
+
+/** Fabrics property get command */
+#define NVMF_PROPERTY_GET 0x04
+
+/** An NVMe fabrics connect command */
+struct nvmf_connect_command {
+	/** Opcode */
+	uint8_t opcode;
+	/** Reserved */
+	uint8_t reserved_a;
+	/** Command identifier */
+	uint16_t cid;
+	/** Fabrics command type */
+	uint8_t fctype;
+	/** Reserved */
+	uint8_t reserved_b[19];
+	/** Data pointer */
+	struct nvme_sgl sgl;
+	/** Record format */
+	uint16_t recfmt;
+	/** Queue identifier */
+	uint16_t qid;
+	/** Submission queue size (zero-based) */
+	uint16_t sqsize;
+	/** Connect attributes */
+	uint8_t cattr;
+	/** Reserved */
+	uint8_t reserved_c;
+	/** Keep alive timeout */
+	uint32_t kato;
+	/** Reserved */
+	uint8_t reserved_d[12];
+} __attribute__ (( packed ));
+
+/** NVMe fabrics connect command data */
+struct nvmf_connect_data {
+	/** Host identifier */
+	union uuid hostid;
+	/** Controller identifier */
+	uint16_t cntlid;
+	/** Reserved */
+	uint8_t reserved_a[238];
+	/** Subsystem NQN */
+	char subnqn[256];
+	/** Host NQN */
+	char hostnqn[256];
+	/** Reserved */
+	uint8_t reserved_b[256];
+} __attribute__ (( packed ));
+
+/** Dynamic controller identifier */
+#define NVMF_CNTLID_DYNAMIC 0xffff
+
+/** An NVMe fabrics property get or set command */
+struct nvmf_property_command {
+	/** Opcode */
+	uint8_t opcode;
+	/** Reserved */
+	uint8_t reserved_a;
+	/** Command identifier */
+	uint16_t cid;
+	/** Fabrics command type */
+	uint8_t fctype;
+	/** Reserved */
+	uint8_t reserved_b[35];
+	/** Attributes */
+	uint8_t attrib;
+	/** Reserved */
+	uint8_t reserved_c[3];
+	/** Property offset */
+	uint32_t offset;
+	/** Property value */
+	uint64_t value;
+	/** Reserved */
+	uint8_t reserved_d[8];
+} __attribute__ (( packed ));
+
+/** Property is 8 bytes wide */
+#define NVMF_PROPERTY_64BIT 0x01
+
+/** Controller capabilities property */
+#define NVME_REG_CAP 0x00
+
+/** Maximum queue entries supported (zero-based) */
+#define NVME_CAP_MQES( cap ) ( ( (cap) >> 0 ) & 0xffff )
+
+/** Controller ready timeout (in units of 500ms) */
+#define NVME_CAP_TO( cap ) ( ( (cap) >> 24 ) & 0xff )
+
+/** Minimum memory page size (as a power of two above 4kB) */
+#define NVME_CAP_MPSMIN( cap ) ( ( (cap) >> 48 ) & 0xf )
+
+/** Controller configuration property */
+#define NVME_REG_CC 0x14
+
+/** Controller enable */
+#define NVME_CC_EN 0x00000001UL
+
+/** I/O submission queue entry size (64 bytes) */
+#define NVME_CC_IOSQES 0x00060000UL
+
+/** I/O completion queue entry size (16 bytes) */
+#define NVME_CC_IOCQES 0x00400000UL
+
+/** Controller status property */
+#define NVME_REG_CSTS 0x1c
+
+/** Controller ready */
+#define NVME_CSTS_RDY 0x00000001UL
+
+/** Controller fatal status */
+#define NVME_CSTS_CFS 0x00000002UL
+
+/** An NVMe command */
+union nvme_command {
+	/** Generic command */
+	struct nvme_generic_command common;
+	/** Fabrics connect command */
+	struct nvmf_connect_command connect;
+	/** Fabrics property get or set command */
+	struct nvmf_property_command property;
+};
+
+/** An NVMe completion */
+struct nvme_completion {
+	/** Command specific result */
+	uint64_t result;
+	/** Submission queue head pointer */
+	uint16_t sqhd;
+	/** Submission queue identifier */
+	uint16_t sqid;
+	/** Command identifier */
+	uint16_t cid;
+	/** Status and phase tag */
+	uint16_t status;
+} __attribute__ (( packed ));
+
+/** Extract status code type and status code from completion status */
+#define NVME_STATUS( status ) ( ( (status) >> 1 ) & 0x7ff )
+
+/** An NVMe identify controller data structure */
+struct nvme_identify_controller {
+	/** PCI vendor ID */
+	uint16_t vid;
+	/** PCI subsystem vendor ID */
+	uint16_t ssvid;
+	/** Serial number */
+	char sn[20];
+	/** Model number */
+	char mn[40];
+	/** Firmware revision */
+	char fr[8];
+	/** Recommended arbitration burst */
+	uint8_t rab;
+	/** IEEE OUI identifier */
+	uint8_t ieee[3];
+	/** Multi-path I/O and namespace sharing capabilities */
+	uint8_t cmic;
+	/** Maximum data transfer size (as a power of two pages) */
+	uint8_t mdts;
+} __attribute__ (( packed ));
+
+/** An NVMe identify namespace data structure */
+struct nvme_identify_namespace {
+	/** Namespace size (in logical blocks) */
+	uint64_t nsze;
+	/** Namespace capacity */
+	uint64_t ncap;
+	/** Namespace utilisation */
+	uint64_t nuse;
+	/** Namespace features */
+	uint8_t nsfeat;
+	/** Number of LBA formats (zero-based) */
+	uint8_t nlbaf;
+	/** Formatted LBA size */
+	uint8_t flbas;
+	/** Reserved */
+	uint8_t reserved[101];
+	/** LBA formats */
+	uint32_t lbaf[16];
+} __attribute__ (( packed ));
+
+/** Index of current LBA format */
+#define NVME_FLBAS_INDEX( flbas ) ( (flbas) & 0x0f )
+
+/** LBA data size (as a power of two) */
+#define NVME_LBAF_LBADS( lbaf ) ( ( (lbaf) >> 16 ) & 0xff )
+
+/** Length of identify data */
+#define NVME_IDENTIFY_LEN 4096
+
+/** NVMe identify data */
+union nvme_identify {
+	/** Controller */
+	struct nvme_identify_controller ctrl;
+	/** Namespace */
+	struct nvme_identify_namespace ns;
+	/** Raw data */
+	uint8_t raw[NVME_IDENTIFY_LEN];
+};
+
+/******************************************************************************
+ *
+ * NVMe/TCP PDUs
+ *
+ ******************************************************************************
+ */
+
+/** An NVMe/TCP PDU common header */
+struct nvmetcp_header {
+	/** PDU type */
+	uint8_t type;
+	/** Flags */
+	uint8_t flags;
+	/** PDU header length */
+	uint8_t hlen;
+	/** PDU data offset */
+	uint8_t pdo;
+	/** PDU length */
+	uint32_t plen;
+} __attribute__ (( packed ));
+
+/** Initialize connection request */
+#define NVMETCP_ICREQ 0x00
+
+/** Initialize connection response */
+#define NVMETCP_ICRESP 0x01
+
+/** Controller to host termination request */
+#define NVMETCP_C2H_TERM 0x03
+
+/** Command capsule */
+#define NVMETCP_CAPSULE_CMD 0x04
+
+/** Response capsule */
+#define NVMETCP_CAPSULE_RESP 0x05
+
+/** Host to controller data */
+#define NVMETCP_H2C_DATA 0x06
+
+/** Controller to host data */
+#define NVMETCP_C2H_DATA 0x07
+
+/** Ready to transfer */
+#define NVMETCP_R2T 0x09
+
+/** Last PDU of a data transfer */
+#define NVMETCP_FL_LAST 0x04
+
+/** Command completed successfully without a response capsule */
+#define NVMETCP_FL_SUCCESS 0x08
+
+/** An NVMe/TCP initialize connection request or response PDU */
+struct nvmetcp_ic {
+	/** Common header */
+	struct nvmetcp_header hdr;
+	/** PDU format version */
+	uint16_t pfv;
+	/** Host or controller PDU data alignment */
+	uint8_t pda;
+	/** Digest types enabled */
+	uint8_t dgst;
+	/** Maximum outstanding R2Ts or maximum H2C data length */
+	uint32_t max;
+	/** Reserved */
+	uint8_t reserved[112];
+} __attribute__ (( packed ));
+
+/** An NVMe/TCP command capsule PDU header */
+struct nvmetcp_capsule_cmd {
+	/** Common header */
+	struct nvmetcp_header hdr;
+	/** Command */
+	union nvme_command cmd;
+} __attribute__ (( packed ));
+
+/** An NVMe/TCP response capsule PDU */
+struct nvmetcp_capsule_resp {
+	/** Common header */
+	struct nvmetcp_header hdr;
+	/** Completion */
+	struct nvme_completion cqe;
+} __attribute__ (( packed ));
+
+/** An NVMe/TCP data or R2T PDU header */
+struct nvmetcp_data {
+	/** Common header */
+	struct nvmetcp_header hdr;
+	/** Command capsule identifier */
+	uint16_t cccid;
+	/** Transfer tag */
+	uint16_t ttag;
+	/** Data offset */
+	uint32_t offset;
+	/** Data length */
+	uint32_t len;
+	/** Reserved */
+	uint8_t reserved[4];
+} __attribute__ (( packed ));
+
+/** An NVMe/TCP termination request PDU header */
+struct nvmetcp_term {
+	/** Common header */
+	struct nvmetcp_header hdr;
+	/** Fatal error status */
+	uint16_t fes;
+	/** Fatal error information */
+	uint32_t fei;
+	/** Reserved */
+	uint8_t reserved[10];
+} __attribute__ (( packed ));
+
+/** A received NVMe/TCP PDU header */
+union nvmetcp_rx_header {
+	/** Common header */
+	struct nvmetcp_header hdr;
+	/** Initialize connection response */
+	struct nvmetcp_ic ic;
+	/** Response capsule */
+	struct nvmetcp_capsule_resp resp;
+	/** Data or R2T */
+	struct nvmetcp_data data;
+	/** Termination request */
+	struct nvmetcp_term term;
+};
+
+/******************************************************************************
+ *
+ * NVMe/TCP session
+ *
+ ******************************************************************************
+ */
+
+struct nvmetcp_session;
+struct nvmetcp_queue;
+struct nvmetcp_command;
+
+/** Maximum number of commands outstanding on a queue */
+#define NVMETCP_MAX_COMMANDS 16
+
+/** Admin queue size (zero-based) */
+#define NVMETCP_ADMIN_SQSIZE 31
+
+/** Maximum data length per transfer */
+#define NVMETCP_MAX_TRANSFER_LEN ( 256 * 1024 )
+
+/** Maximum data length per H2C data PDU */
+#define NVMETCP_MAX_H2C_LEN ( 64 * 1024 )
+
+/** An NVMe/TCP command */
+struct nvmetcp_command {
+	/** Owning queue */
+	struct nvmetcp_queue *queue;
+	/** Block data interface (if any) */
+	struct interface block;
+	/** Command state flags */
+	unsigned int flags;
+	/** Command */
+	union nvme_command cmd;
+	/** Data buffer */
+	userptr_t buffer;
+	/** Data length */
+	size_t len;
+	/** In-capsule data (if any) */
+	const void *capsule;
+	/** In-capsule data length */
+	size_t capsule_len;
+	/** Transfer tag of current R2T */
+	uint16_t ttag;
+	/** Offset of next H2C data */
+	size_t h2c_offset;
+	/** End offset of current R2T */
+	size_t h2c_end;
+	/** Handle command completion
+	 *
+	 * @v command		NVMe/TCP command
+	 * @v rc		Return status code
+	 * @v result		Command specific result
+	 */
+	void ( * complete ) ( struct nvmetcp_command *command, int rc,
+			      uint64_t result );
+};
+
+/** Command is in use */
+#define NVMETCP_CMD_ACTIVE 0x0001
+
+/** Command capsule is waiting to be transmitted */
+#define NVMETCP_CMD_TX_CAPSULE 0x0002
+
+/** Command transfers data from the controller */
+#define NVMETCP_CMD_READ 0x0004
+
+/** Command transfers data to the controller */
+#define NVMETCP_CMD_WRITE 0x0008
+
+/** NVMe/TCP queue states */
+enum nvmetcp_queue_state {
+	/** Waiting to send initialize connection request */
+	NVMETCP_QUEUE_ICREQ = 0,
+	/** Waiting for initialize connection response */
+	NVMETCP_QUEUE_ICRESP,
+	/** Waiting for fabrics connect to complete */
+	NVMETCP_QUEUE_CONNECT,
+	/** Queue is ready */
+	NVMETCP_QUEUE_READY,
+};
+
+/** An NVMe/TCP queue (i.e. a TCP connection) */
+struct nvmetcp_queue {
+	/** Owning session */
+	struct nvmetcp_session *session;
+	/** Queue identifier */
+	unsigned int qid;
+	/** Number of usable command slots */
+	unsigned int depth;
+	/** Queue state */
+	enum nvmetcp_queue_state state;
+	/** Transport-layer socket */
+	struct interface socket;
+	/** Transmit process */
+	struct process process;
+	/** Controller PDU data alignment */
+	size_t align;
+	/** Maximum H2C data PDU length */
+	size_t maxh2cdata;
+
+	/** Received PDU header */
+	union nvmetcp_rx_header rx;
+	/** Offset within received PDU */
+	size_t rx_offset;
+	/** Command to which received data belongs (if any) */
+	struct nvmetcp_command *rx_command;
+	/** Offset of received data within command buffer */
+	size_t rx_data_offset;
+
+	/** Commands */
+	struct nvmetcp_command command[NVMETCP_MAX_COMMANDS];
+};
+
+/** An NVMe/TCP session */
+struct nvmetcp_session {
+	/** Reference counter */
+	struct refcnt refcnt;
+	/** Block control interface */
+	struct interface block;
+	/** URI */
+	struct uri *uri;
+
+	/** Target address */
+	char *target_address;
+	/** Target port */
+	unsigned int target_port;
+	/** Namespace identifier */
+	unsigned int nsid;
+
+	/** Admin queue */
+	struct nvmetcp_queue admin;
+	/** I/O queue */
+	struct nvmetcp_queue io;
+
+	/** Fabrics connect data */
+	struct nvmf_connect_data connect;
+	/** Controller capabilities */
+	uint64_t cap;
+	/** Maximum data transfer size */
+	size_t mdts;
+	/** Controller ready timer */
+	struct retry_timer timer;
+	/** Controller ready deadline */
+	unsigned long deadline;
+	/** Session is ready for I/O */
+	int ready;
+	/** Session has been closed */
+	int closed;
+
+	/** Identify data buffer */
+	union nvme_identify identify;
+};
+
+#endif /* _IPXE_NVMETCP_H */
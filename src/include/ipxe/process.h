@@ -27,6 +27,29 @@ struct process {
 	struct refcnt *refcnt;
 };
 
+/** Process priority classes
+ *
+ * Runnable processes in a higher priority class are stepped in
+ * preference to those in a lower priority class.  A lower priority
+ * class will still be given a step after every PROC_BURST steps of
+ * the next higher class, so that no class can be starved completely.
+ */
+enum process_priority {
+	/** Network data path (e.g. NIC polling, TCP transmission) */
+	PROC_PRIO_NET = 0,
+	/** Normal processes */
+	PROC_PRIO_NORMAL,
+	/** Background processes (e.g. speculative prefetching) */
+	PROC_PRIO_BACKGROUND,
+	/** Number of priority classes */
+	PROC_PRIORITIES
+};
+
+/** Maximum number of consecutive steps given to a priority class
+ * while any lower priority class has runnable processes
+ */
+#define PROC_BURST 8
+
 /** A process descriptor */
 struct process_descriptor {
 	/** Process name */
@@ -43,6 +66,8 @@ struct process_descriptor {
 	void ( * step ) ( void *object );
 	/** Automatically reschedule the process */
 	int reschedule;
+	/** Priority class */
+	unsigned int priority;
 };
 
 /**
@@ -72,50 +97,91 @@ struct process_descriptor {
 	  : offsetof ( object_type, name ) )
 
 /**
- * Define a process descriptor
+ * Define a process descriptor with a specified priority class
  *
  * @v object_type	Containing object data type
  * @v process		Process name (i.e. field within object data type)
  * @v step		Process' step() method
+ * @v priority		Priority class
  * @ret desc		Object interface descriptor
  */
-#define PROC_DESC( object_type, process, _step ) {			      \
+#define PROC_DESC_PRIO( object_type, process, _step, _priority ) {	      \
 		.name = #_step,						      \
 		.offset = process_offset ( object_type, process ),	      \
 		.step = PROC_STEP ( object_type, _step ),		      \
 		.reschedule = 1,					      \
+		.priority = _priority,					      \
 	}
 
 /**
- * Define a process descriptor for a process that runs only once
+ * Define a process descriptor
  *
  * @v object_type	Containing object data type
  * @v process		Process name (i.e. field within object data type)
  * @v step		Process' step() method
  * @ret desc		Object interface descriptor
  */
-#define PROC_DESC_ONCE( object_type, process, _step ) {			      \
+#define PROC_DESC( object_type, process, _step )			      \
+	PROC_DESC_PRIO ( object_type, process, _step, PROC_PRIO_NORMAL )
+
+/**
+ * Define a process descriptor for a process that runs only once, with
+ * a specified priority class
+ *
+ * @v object_type	Containing object data type
+ * @v process		Process name (i.e. field within object data type)
+ * @v step		Process' step() method
+ * @v priority		Priority class
+ * @ret desc		Object interface descriptor
+ */
+#define PROC_DESC_ONCE_PRIO( object_type, process, _step, _priority ) {      \
 		.name = #_step,						      \
 		.offset = process_offset ( object_type, process ),	      \
 		.step = PROC_STEP ( object_type, _step ),		      \
 		.reschedule = 0,					      \
+		.priority = _priority,					      \
 	}
 
 /**
- * Define a process descriptor for a pure process
+ * Define a process descriptor for a process that runs only once
+ *
+ * @v object_type	Containing object data type
+ * @v process		Process name (i.e. field within object data type)
+ * @v step		Process' step() method
+ * @ret desc		Object interface descriptor
+ */
+#define PROC_DESC_ONCE( object_type, process, _step )			      \
+	PROC_DESC_ONCE_PRIO ( object_type, process, _step, PROC_PRIO_NORMAL )
+
+/**
+ * Define a process descriptor for a pure process, with a specified
+ * priority class
  *
  * A pure process is a process that does not have a containing object.
  *
  * @v step		Process' step() method
+ * @v priority		Priority class
  * @ret desc		Object interface descriptor
  */
-#define PROC_DESC_PURE( _step ) {					      \
+#define PROC_DESC_PURE_PRIO( _step, _priority ) {			      \
 		.name = #_step,						      \
 		.offset = 0,						      \
 		.step = PROC_STEP ( struct process, _step ),		      \
 		.reschedule = 1,					      \
+		.priority = _priority,					      \
 	}
 
+/**
+ * Define a process descriptor for a pure process
+ *
+ * A pure process is a process that does not have a containing object.
+ *
+ * @v step		Process' step() method
+ * @ret desc		Object interface descriptor
+ */
+#define PROC_DESC_PURE( _step )						      \
+	PROC_DESC_PURE_PRIO ( _step, PROC_PRIO_NORMAL )
+
 extern void * __attribute__ (( pure ))
 process_object ( struct process *process );
 extern void process_add ( struct process *process );
@@ -187,12 +253,19 @@ process_running ( struct process *process ) {
  */
 #define __permanent_process __table_entry ( PERMANENT_PROCESSES, 01 )
 
+/** Define a permanent process with a specified priority class
+ *
+ */
+#define PERMANENT_PROCESS_PRIO( name, step, priority )			      \
+static struct process_descriptor name ## _desc =			      \
+	PROC_DESC_PURE_PRIO ( step, priority );				      \
+struct process name __permanent_process = PROC_INIT ( name, & name ## _desc );
+
 /** Define a permanent process
  *
  */
 #define PERMANENT_PROCESS( name, step )					      \
-static struct process_descriptor name ## _desc = PROC_DESC_PURE ( step );     \
-struct process name __permanent_process = PROC_INIT ( name, & name ## _desc );
+	PERMANENT_PROCESS_PRIO ( name, step, PROC_PRIO_NORMAL )
 
 /**
  * Find debugging colourisation for a process
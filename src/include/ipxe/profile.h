@@ -20,6 +20,9 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #endif
 #endif
 
+/** Number of profiler histogram buckets */
+#define PROFILE_BUCKETS 32
+
 /**
  * A data structure for storing profiling information
  */
@@ -48,6 +51,17 @@ struct profiler {
 	 * (i.e. one less than would be returned by flsll(raw_accvar)).
 	 */
 	unsigned int accvar_msb;
+	/** Maximum sample value */
+	unsigned long max;
+	/** Sample histogram
+	 *
+	 * Bucket 0 counts zero-valued samples.  Bucket @c n counts
+	 * samples in the range [2^(n-1),2^n).  The final bucket also
+	 * counts all larger samples.
+	 */
+	unsigned int hist[PROFILE_BUCKETS];
+	/** Profiler is disabled */
+	int disabled;
 };
 
 /** Profiler table */
@@ -66,6 +80,10 @@ extern void profile_update ( struct profiler *profiler, unsigned long sample );
 extern unsigned long profile_mean ( struct profiler *profiler );
 extern unsigned long profile_variance ( struct profiler *profiler );
 extern unsigned long profile_stddev ( struct profiler *profiler );
+extern unsigned long profile_percentile ( struct profiler *profiler,
+					  unsigned int percent );
+extern void profile_reset ( struct profiler *profiler );
+extern struct profiler * find_profiler ( const char *name );
 
 /**
  * Get start time
@@ -20,6 +20,9 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/blockdev.h>
 #include <ipxe/acpi.h>
 #include <ipxe/uuid.h>
+#include <ipxe/uaccess.h>
+#include <ipxe/bitmap.h>
+#include <ipxe/settings.h>
 #include <config/sanboot.h>
 
 /**
@@ -54,6 +57,126 @@ struct san_path {
 	struct acpi_descriptor *desc;
 };
 
+/** Maximum number of concurrent SAN device read/write commands */
+#define SAN_MAX_QUEUE_DEPTH 16
+
+/** A queued SAN device read/write command */
+struct san_command {
+	/** Containing SAN device */
+	struct san_device *sandev;
+	/** Data interface */
+	struct interface block;
+	/** SAN path used for this command */
+	struct san_path *sanpath;
+	/** Starting LBA */
+	uint64_t lba;
+	/** Block count, or zero if this command is unused */
+	unsigned int count;
+	/** Command status */
+	int rc;
+	/** Time at which command was issued */
+	unsigned long started;
+};
+
+/** SAN device command types */
+enum san_command_type {
+	/** Read command */
+	SAN_READ = 0,
+	/** Write command */
+	SAN_WRITE,
+	/** Read capacity command */
+	SAN_CAPACITY,
+	/** Number of command types */
+	SAN_NUM_COMMAND_TYPES
+};
+
+/** Number of SAN device latency histogram buckets */
+#define SAN_LATENCY_BUCKETS 16
+
+/** SAN device command statistics
+ *
+ * Latency histogram bucket @c n counts commands for which the most
+ * significant set bit of the latency (in milliseconds) is bit @c n.
+ * Bucket zero also counts commands completing in under a
+ * millisecond, and the final bucket also counts all slower commands.
+ */
+struct san_command_stats {
+	/** Count of successful commands */
+	unsigned int good;
+	/** Count of failed commands */
+	unsigned int bad;
+	/** Total length of successful commands */
+	unsigned long long bytes;
+	/** Total latency of all commands (in milliseconds) */
+	unsigned long long latency;
+	/** Maximum latency (in milliseconds) */
+	unsigned long max;
+	/** Latency histogram */
+	unsigned int count[SAN_LATENCY_BUCKETS];
+};
+
+/** SAN device statistics */
+struct san_device_stats {
+	/** Per-command type statistics */
+	struct san_command_stats command[SAN_NUM_COMMAND_TYPES];
+	/** Count of command retries */
+	unsigned int retries;
+	/** Count of device (re)opening attempts */
+	unsigned int reopens;
+};
+
+/** A SAN block cache line */
+struct san_cache_line {
+	/** List of cache lines, most recently used first */
+	struct list_head list;
+	/** Starting logical block address */
+	uint64_t lba;
+	/** Number of valid logical blocks (or zero if line is empty) */
+	unsigned int count;
+};
+
+/** A SAN block cache */
+struct san_cache {
+	/** Cache data */
+	userptr_t data;
+	/** Cache lines */
+	struct san_cache_line *line;
+	/** Number of cache lines */
+	unsigned int lines;
+	/** Logical block size */
+	size_t blksize;
+	/** Number of logical blocks per cache line */
+	unsigned int blocks;
+	/** List of cache lines, most recently used first */
+	struct list_head lru;
+	/** Logical block address expected for a sequential read */
+	uint64_t next;
+	/** Number of cache lines to read ahead */
+	unsigned int ahead;
+	/** Cache allocation has failed */
+	int failed;
+};
+
+/** A SAN memdisk (copy of the entire device held in RAM) */
+struct san_memdisk {
+	/** Device contents */
+	userptr_t data;
+	/** Number of logical blocks per chunk */
+	unsigned int blocks;
+	/** Number of chunks */
+	unsigned int chunks;
+	/** Chunks that have been filled */
+	struct bitmap filled;
+	/** Next chunk to be considered for background filling */
+	unsigned int next;
+	/** Background fill process */
+	struct process process;
+	/** Background fill commands */
+	struct san_command fill[SAN_MAX_QUEUE_DEPTH];
+	/** Background filling is paused following an error */
+	int paused;
+};
+
 /** A SAN device */
 struct san_device {
 	/** Reference count */
@@ -72,6 +195,8 @@ struct san_device {
 	struct retry_timer timer;
 	/** Command status */
 	int command_rc;
+	/** Queued read/write commands */
+	struct san_command queue[SAN_MAX_QUEUE_DEPTH];
 
 	/** Raw block device capacity */
 	struct block_device_capacity capacity;
@@ -84,13 +209,28 @@ struct san_device {
 	unsigned int blksize_shift;
 	/** Drive is a CD-ROM */
 	int is_cdrom;
+	/** Block cache */
+	struct san_cache cache;
+	/** Memdisk (if applicable) */
+	struct san_memdisk memdisk;
+	/** Statistics */
+	struct san_device_stats stats;
+
+	/** Settings block */
+	struct settings settings;
+	/** Settings block name */
+	char settings_name[16];
 
 	/** Driver private data */
 	void *priv;
 
 	/** Number of paths */
 	unsigned int paths;
-	/** Current active path */
+	/** Current active path
+	 *
+	 * In active-active multipath mode, queued read/write commands
+	 * may also be issued via any other ready path.
+	 */
 	struct san_path *active;
 	/** List of opened SAN paths */
 	struct list_head opened;
@@ -104,6 +244,8 @@ struct san_device {
 enum san_device_flags {
 	/** Device should not be included in description tables */
 	SAN_NO_DESCRIBE = 0x0001,
+	/** Device contents should be copied to RAM */
+	SAN_MEMDISK = 0x0002,
 };
 
 /** SAN boot configuration parameters */
@@ -256,6 +398,9 @@ static inline int sandev_needs_reopen ( struct san_device *sandev ) {
 	return ( sandev->active == NULL );
 }
 
+/** SAN device settings scope */
+extern const struct settings_scope san_settings_scope;
+
 extern struct san_device * sandev_find ( unsigned int drive );
 extern struct san_device * sandev_next ( unsigned int drive );
 extern int sandev_reopen ( struct san_device *sandev );
@@ -0,0 +1,76 @@
+#ifndef _IPXE_SLAB_H
+#define _IPXE_SLAB_H
+
+/** @file
+ *
+ * Fixed-size object caches
+ *
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+#include <stddef.h>
+#include <ipxe/tables.h>
+
+/** Maximum number of free objects retained by a cache */
+#define SLAB_MAX_FREE 64
+
+/** A free object within a cache */
+struct slab_object {
+	/** Next free object */
+	struct slab_object *next;
+};
+
+/** Object cache statistics */
+struct slab_statistics {
+	/** Number of allocations */
+	unsigned long allocs;
+	/** Number of allocations satisfied from the free list */
+	unsigned long hits;
+	/** Number of allocation failures */
+	unsigned long fails;
+	/** Number of frees */
+	unsigned long frees;
+	/** Number of free objects released by the cache discarder */
+	unsigned long discards;
+};
+
+/** A fixed-size object cache */
+struct slab_cache {
+	/** Name */
+	const char *name;
+	/** Object size */
+	size_t size;
+	/** Free objects */
+	struct slab_object *free;
+	/** Number of free objects */
+	unsigned int count;
+	/** Number of objects currently allocated */
+	unsigned int used;
+	/** Statistics */
+	struct slab_statistics stats;
+};
+
+/** Object cache table */
+#define SLAB_CACHES __table ( struct slab_cache, "slab_caches" )
+
+/** Declare an object cache */
+#define __slab_cache __table_entry ( SLAB_CACHES, 01 )
+
+/**
+ * Initialise an object cache
+ *
+ * @v _name		Name
+ * @v _size		Object size
+ */
+#define SLAB_CACHE_INIT( _name, _size ) {				      \
+		.name = (_name),					      \
+		.size = ( ( (_size) > sizeof ( struct slab_object ) ) ?	      \
+			  (_size) : sizeof ( struct slab_object ) ),	      \
+	}
+
+extern void * slab_alloc ( struct slab_cache *cache );
+extern void * slab_zalloc ( struct slab_cache *cache );
+extern void slab_free ( struct slab_cache *cache, void *ptr );
+
+#endif /* _IPXE_SLAB_H */
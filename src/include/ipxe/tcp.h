@@ -140,6 +140,8 @@ struct tcp_timestamp_padded_option {
 
 /** Parsed TCP options */
 struct tcp_options {
+	/** MSS option, if present */
+	const struct tcp_mss_option *mssopt;
 	/** Window scale option, if present */
 	const struct tcp_window_scale_option *wsopt;
 	/** SACK permitted option, if present */
@@ -362,21 +364,36 @@ struct tcp_options {
 #define TCP_MAX_WINDOW_SIZE	( 2048 * 1024 )
 
 /**
- * Path MTU
+ * Default transmitted maximum segment size
  *
  * IPv6 requires all data link layers to support a datagram size of
  * 1280 bytes.  We choose to use this as our maximum transmitted
- * datagram size, on the assumption that any practical link layer we
- * encounter will allow this size.  This is a very conservative
- * assumption in practice, but the impact of making such a
- * conservative assumption is insignificant since the amount of data
- * that we transmit (rather than receive) is negligible.
- *
- * We allow space within this 1280 bytes for an IPv6 header, a TCP
- * header, and a (padded) TCP timestamp option.
+ * datagram size if the peer does not advertise an MSS, on the
+ * assumption that any practical link layer we encounter will allow
+ * this size.
+ *
+ * We allow space within this 1280 bytes for an IPv6 header and a TCP
+ * header.  Space for TCP options is deducted when calculating the
+ * transmission window.
+ */
+#define TCP_DEFAULT_MSS ( 1280 - 40 /* IPv6 */ - 20 /* TCP */ )
+
+/** Minimum transmitted maximum segment size
+ *
+ * Any smaller MSS advertised by the peer will be ignored, to ensure
+ * that there is always space for our TCP options.
+ */
+#define TCP_MIN_MSS 128
+
+/**
+ * Number of consecutive retransmission timeouts before reducing MSS
+ *
+ * We do not process ICMP "packet too big" messages.  If a segment
+ * larger than TCP_DEFAULT_MSS repeatedly fails to be acknowledged,
+ * we assume that it is being silently discarded somewhere on the
+ * path and fall back to TCP_DEFAULT_MSS.
  */
-#define TCP_PATH_MTU							\
-	( 1280 - 40 /* IPv6 */ - 20 /* TCP */ - 12 /* TCP timestamp */ )
+#define TCP_MSS_FALLBACK_RETRIES 2
 
 /** TCP maximum segment lifetime
  *
@@ -0,0 +1,68 @@
+#ifndef _IPXE_TIMELINE_H
+#define _IPXE_TIMELINE_H
+
+/** @file
+ *
+ * Boot timeline
+ *
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+#include <ipxe/tables.h>
+
+/** A boot timeline phase */
+struct timeline_phase {
+	/** Name */
+	const char *name;
+	/** Number of active instances */
+	unsigned int active;
+	/** Number of completed instances */
+	unsigned int count;
+	/** Time of first activation (in ticks since timeline start) */
+	unsigned long first;
+	/** Time of most recent activation (in ticks) */
+	unsigned long since;
+	/** Total time for which phase has been active (in ticks) */
+	unsigned long elapsed;
+};
+
+/** Boot timeline phase table */
+#define TIMELINE_PHASES __table ( struct timeline_phase, "timeline_phases" )
+
+/** Declare a boot timeline phase */
+#define __timeline_phase( order ) __table_entry ( TIMELINE_PHASES, order )
+
+/** @defgroup timelineorder Boot timeline phase ordering
+ * @{
+ */
+
+#define TIMELINE_STARTUP	01	/**< Startup (including device probing) */
+#define TIMELINE_LINK		02	/**< Waiting for link-up */
+#define TIMELINE_DHCP		03	/**< DHCP */
+#define TIMELINE_RESOLV		04	/**< Name resolution */
+#define TIMELINE_TLS		05	/**< TLS negotiation */
+#define TIMELINE_DOWNLOAD	06	/**< Image download */
+#define TIMELINE_VERIFY		07	/**< Image verification */
+#define TIMELINE_EXEC		08	/**< Image execution */
+
+/** @} */
+
+/**
+ * Check if boot timeline phase has been reached
+ *
+ * @v phase		Boot timeline phase
+ * @ret reached		Phase has been reached
+ */
+static inline __attribute__ (( always_inline )) int
+timeline_reached ( struct timeline_phase *phase ) {
+	return ( phase->active || phase->count );
+}
+
+extern void timeline_begin ( struct timeline_phase *phase );
+extern void timeline_end ( struct timeline_phase *phase );
+extern unsigned long timeline_start ( struct timeline_phase *phase );
+extern unsigned long timeline_elapsed ( struct timeline_phase *phase );
+extern struct timeline_phase * find_timeline_phase ( const char *name );
+
+#endif /* _IPXE_TIMELINE_H */
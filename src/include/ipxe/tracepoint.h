@@ -0,0 +1,105 @@
+#ifndef _IPXE_TRACEPOINT_H
+#define _IPXE_TRACEPOINT_H
+
+/** @file
+ *
+ * Tracepoints
+ *
+ * A tracepoint records a timestamped event into a fixed-size ring of
+ * binary trace records.  Tracepoints are present in all builds.  When
+ * tracing is not active, the cost of a tracepoint is a single test
+ * of a global flag.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+#include <stdint.h>
+#include <bits/profile.h>
+#include <ipxe/tables.h>
+
+/** Default number of trace records */
+#define TRACE_DEFAULT_COUNT 1024
+
+/** Maximum number of trace records */
+#define TRACE_MAX_COUNT 0x100000
+
+/** A tracepoint */
+struct tracepoint {
+	/** Name */
+	const char *name;
+};
+
+/** Tracepoint table */
+#define TRACEPOINTS __table ( struct tracepoint, "tracepoints" )
+
+/** Declare a tracepoint */
+#define __tracepoint __table_entry ( TRACEPOINTS, 01 )
+
+/** A trace record */
+struct trace_record {
+	/** Timestamp */
+	uint64_t timestamp;
+	/** Tracepoint */
+	struct tracepoint *tracepoint;
+	/** Event-specific value */
+	unsigned long value;
+};
+
+/** A trace ring */
+struct trace_ring {
+	/** Trace records */
+	struct trace_record *records;
+	/** Number of records (must be a power of two) */
+	unsigned int count;
+	/** Producer index (free-running) */
+	unsigned long prod;
+};
+
+extern int trace_active;
+extern struct trace_ring trace_ring;
+
+extern void trace_record ( struct tracepoint *tracepoint,
+			   unsigned long value );
+extern int trace_start ( unsigned int count );
+extern void trace_stop ( void );
+
+/**
+ * Record tracepoint event
+ *
+ * @v tracepoint	Tracepoint
+ * @v value		Event-specific value
+ */
+static inline __attribute__ (( always_inline )) void
+trace ( struct tracepoint *tracepoint, unsigned long value ) {
+
+	if ( trace_active )
+		trace_record ( tracepoint, value );
+}
+
+/**
+ * Get index of oldest retained trace record
+ *
+ * @v ring		Trace ring
+ * @ret index		Index of oldest retained trace record
+ */
+static inline __attribute__ (( always_inline )) unsigned long
+trace_first ( struct trace_ring *ring ) {
+
+	return ( ( ring->prod > ring->count ) ?
+		 ( ring->prod - ring->count ) : 0 );
+}
+
+/**
+ * Get trace record
+ *
+ * @v ring		Trace ring
+ * @v index		Record index
+ * @ret record		Trace record
+ */
+static inline __attribute__ (( always_inline )) struct trace_record *
+trace_record_at ( struct trace_ring *ring, unsigned long index ) {
+
+	return &ring->records[ index & ( ring->count - 1 ) ];
+}
+
+#endif /* _IPXE_TRACEPOINT_H */
@@ -20,14 +20,15 @@
  *		- 'z'		- Signed / unsigned size_t
  *	- Conversion specifiers
  *		- 'd'		- Signed decimal
+ *		- 'u'		- Unsigned decimal
  *		- 'x','X'	- Unsigned hexadecimal
  *		- 'c'		- Character
  *		- 's'		- String
  *		- 'p'		- Pointer
  *
  * Hexadecimal numbers are always zero-padded to the specified field
- * width (if any); decimal numbers are always space-padded.  Decimal
- * long longs are not supported.
+ * width (if any); decimal numbers are always space-padded.  Signed
+ * decimal long longs are not supported.
  *
  */
 
@@ -21,6 +21,7 @@ enum uriboot_flags {
 	URIBOOT_NO_SAN_DESCRIBE = 0x0001,
 	URIBOOT_NO_SAN_BOOT = 0x0002,
 	URIBOOT_NO_SAN_UNHOOK = 0x0004,
+	URIBOOT_SAN_MEMDISK = 0x0008,
 };
 
 #define URIBOOT_NO_SAN ( URIBOOT_NO_SAN_DESCRIBE | \
@@ -38,6 +39,7 @@ extern int uriboot ( struct uri *filename, struct uri **root_paths,
 extern struct uri *
 fetch_next_server_and_filename ( struct settings *settings );
 extern int netboot ( struct net_device *netdev );
+extern int netboot_any ( struct net_device **netdevs, unsigned int count );
 extern int ipxe ( struct net_device *netdev );
 
 extern int pxe_menu_boot ( struct net_device *netdev );
@@ -20,5 +20,12 @@ extern void ifclose ( struct net_device *netdev );
 extern void ifstat ( struct net_device *netdev );
 extern int iflinkwait ( struct net_device *netdev, unsigned long timeout,
 			int verbose );
+extern int iflinkwait_parallel ( struct net_device **netdevs,
+				 unsigned int count, unsigned long timeout,
+				 struct net_device **netdev );
+extern int ifconf_parallel ( struct net_device **netdevs, unsigned int count,
+			     struct net_device_configurator *configurator,
+			     unsigned long timeout,
+			     struct net_device **netdev );
 
 #endif /* _USR_IFMGMT_H */
@@ -9,6 +9,6 @@
 
 FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 
-extern void profstat ( void );
+extern void profstat ( int csv );
 
 #endif /* _USR_PROFSTAT_H */
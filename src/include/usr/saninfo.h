@@ -0,0 +1,16 @@
+#ifndef _USR_SANINFO_H
+#define _USR_SANINFO_H
+
+/** @file
+ *
+ * SAN device information
+ *
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+#include <ipxe/sanboot.h>
+
+extern void saninfo ( struct san_device *sandev );
+
+#endif /* _USR_SANINFO_H */
@@ -0,0 +1,14 @@
+#ifndef _USR_TIMELINEMGMT_H
+#define _USR_TIMELINEMGMT_H
+
+/** @file
+ *
+ * Boot timeline management
+ *
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+extern void timelinestat ( void );
+
+#endif /* _USR_TIMELINEMGMT_H */
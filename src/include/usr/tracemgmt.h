@@ -0,0 +1,15 @@
+#ifndef _USR_TRACEMGMT_H
+#define _USR_TRACEMGMT_H
+
+/** @file
+ *
+ * Tracepoint management
+ *
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+extern int tracestat ( void );
+extern int traceimage ( const char *name );
+
+#endif /* _USR_TRACEMGMT_H */
@@ -38,4 +38,15 @@ static void linux_cpu_nap(void)
 	linux_usleep(0);
 }
 
+/**
+ * Sleep until next CPU interrupt or write to wake-up location
+ *
+ * @v wake		Wake-up location
+ */
+static void linux_cpu_nap_watch(const volatile void *wake __unused)
+{
+	linux_cpu_nap();
+}
+
 PROVIDE_NAP(linux, cpu_nap, linux_cpu_nap);
+PROVIDE_NAP(linux, cpu_nap_watch, linux_cpu_nap_watch);
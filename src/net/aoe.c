@@ -55,6 +55,7 @@ FEATURE ( FEATURE_PROTOCOL, "AoE", DHCP_EB_FEATURE_AOE, 1 );
 
 struct net_protocol aoe_protocol __net_protocol;
 struct acpi_model abft_model __acpi_model;
+static struct aoe_command_type aoecmd_ata;
 
 /******************************************************************************
  *
@@ -204,6 +205,7 @@ static void aoecmd_free ( struct refcnt *refcnt ) {
  */
 static void aoecmd_close ( struct aoe_command *aoecmd, int rc ) {
 	struct aoe_device *aoedev = aoecmd->aoedev;
+	int window_changed = 0;
 
 	/* Stop timer */
 	stop_timer ( &aoecmd->timer );
@@ -215,11 +217,20 @@ static void aoecmd_close ( struct aoe_command *aoecmd, int rc ) {
 	if ( ! list_empty ( &aoecmd->list ) ) {
 		list_del ( &aoecmd->list );
 		INIT_LIST_HEAD ( &aoecmd->list );
+		if ( aoecmd->type == &aoecmd_ata ) {
+			assert ( aoedev->outstanding > 0 );
+			aoedev->outstanding--;
+			window_changed = 1;
+		}
 		aoecmd_put ( aoecmd );
 	}
 
 	/* Shut down interfaces */
 	intf_shutdown ( &aoecmd->ata, rc );
+
+	/* Allow another command to be issued */
+	if ( window_changed )
+		xfer_window_changed ( &aoedev->ata );
 }
 
 /**
@@ -511,9 +522,13 @@ static void aoecmd_cfg_cmd ( struct aoe_command *aoecmd,
 static int aoecmd_cfg_rsp ( struct aoe_command *aoecmd, const void *data,
 			    size_t len, const void *ll_source ) {
 	struct aoe_device *aoedev = aoecmd->aoedev;
-	struct ll_protocol *ll_protocol = aoedev->netdev->ll_protocol;
+	struct net_device *netdev = aoedev->netdev;
+	struct ll_protocol *ll_protocol = netdev->ll_protocol;
 	const struct aoehdr *aoehdr = data;
 	const struct aoecfg *aoecfg = &aoehdr->payload[0].cfg;
+	size_t max_data_len;
+	unsigned int max_count;
+	unsigned int window;
 
 	/* Sanity check */
 	if ( len < ( sizeof ( *aoehdr ) + sizeof ( *aoecfg ) ) ) {
@@ -531,6 +546,28 @@ static int aoecmd_cfg_rsp ( struct aoe_command *aoecmd, const void *data,
 	DBGC ( aoedev, "AoE %s has MAC address %s\n",
 	       aoedev_name ( aoedev ), ll_protocol->ntoa ( aoedev->target ) );
 
+	/* Fit as many sectors into each frame as both the link MTU
+	 * and the target will allow.
+	 */
+	max_data_len = ( sizeof ( *aoehdr ) + sizeof ( struct aoeata ) );
+	max_data_len = ( ( netdev->mtu > max_data_len ) ?
+			 ( netdev->mtu - max_data_len ) : 0 );
+	max_count = ( max_data_len / ATA_SECTOR_SIZE );
+	if ( aoecfg->scnt && ( max_count > aoecfg->scnt ) )
+		max_count = aoecfg->scnt;
+	if ( max_count > AOE_MAX_SCNT )
+		max_count = AOE_MAX_SCNT;
+	aoedev->max_count = ( max_count ? max_count : 1 );
+
+	/* Allow as many outstanding commands as the target can buffer */
+	window = ntohs ( aoecfg->bufcnt );
+	if ( window > AOE_MAX_WINDOW )
+		window = AOE_MAX_WINDOW;
+	aoedev->window = ( window ? window : 1 );
+	DBGC ( aoedev, "AoE %s using %d sectors per frame with %d commands "
+	       "outstanding\n", aoedev_name ( aoedev ), aoedev->max_count,
+	       aoedev->window );
+
 	return 0;
 }
 
@@ -640,11 +677,19 @@ static int aoedev_ata_command ( struct aoe_device *aoedev,
 		return -EWOULDBLOCK;
 	}
 
+	/* Fail if too many commands are already outstanding */
+	if ( aoedev->outstanding >= aoedev->window ) {
+		DBGC ( aoedev, "AoE %s cannot handle further concurrent "
+		       "commands\n", aoedev_name ( aoedev ) );
+		return -EBUSY;
+	}
+
 	/* Create command */
 	aoecmd = aoecmd_create ( aoedev, &aoecmd_ata );
 	if ( ! aoecmd )
 		return -ENOMEM;
 	memcpy ( &aoecmd->command, command, sizeof ( aoecmd->command ) );
+	aoedev->outstanding++;
 
 	/* Attempt to send command.  Allow failures to be handled by
 	 * the retry timer.
@@ -730,7 +775,23 @@ static void aoedev_close ( struct aoe_device *aoedev, int rc ) {
  * @ret len		Length of window
  */
 static size_t aoedev_window ( struct aoe_device *aoedev ) {
-	return ( aoedev->configured ? ~( ( size_t ) 0 ) : 0 );
+
+	/* Cannot accept commands until configuration is complete */
+	if ( ! aoedev->configured )
+		return 0;
+
+	return ( ( aoedev->outstanding < aoedev->window ) ?
+		 ( aoedev->window - aoedev->outstanding ) : 0 );
+}
+
+/**
+ * Get maximum number of sectors per AoE ATA command
+ *
+ * @v aoedev		AoE device
+ * @ret max_count	Maximum number of sectors
+ */
+static unsigned int aoedev_max_count ( struct aoe_device *aoedev ) {
+	return aoedev->max_count;
 }
 
 /**
@@ -779,6 +840,7 @@ static struct acpi_descriptor * aoedev_describe ( struct aoe_device *aoedev ) {
 static struct interface_operation aoedev_ata_op[] = {
 	INTF_OP ( ata_command, struct aoe_device *, aoedev_ata_command ),
 	INTF_OP ( xfer_window, struct aoe_device *, aoedev_window ),
+	INTF_OP ( ata_max_count, struct aoe_device *, aoedev_max_count ),
 	INTF_OP ( intf_close, struct aoe_device *, aoedev_close ),
 	INTF_OP ( acpi_describe, struct aoe_device *, aoedev_describe ),
 	INTF_OP ( identify_device, struct aoe_device *,
@@ -825,6 +887,8 @@ static int aoedev_open ( struct interface *parent, struct net_device *netdev,
 	aoedev->netdev = netdev_get ( netdev );
 	aoedev->major = major;
 	aoedev->minor = minor;
+	aoedev->max_count = AOE_MAX_COUNT;
+	aoedev->window = 1;
 	memcpy ( aoedev->target, netdev->ll_broadcast,
 		 netdev->ll_protocol->ll_addr_len );
 	acpi_init ( &aoedev->desc, &abft_model, &aoedev->refcnt );
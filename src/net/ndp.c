@@ -674,7 +674,8 @@ static const struct settings_scope ndp_settings_scope;
 static int ndp_applies ( struct settings *settings __unused,
 			 const struct setting *setting ) {
 
-	return ( setting->scope == &ndp_settings_scope );
+	return ( ( setting->scope == &ndp_settings_scope ) ||
+		 ( setting_cmp ( setting, &mtu_setting ) == 0 ) );
 }
 
 /**
@@ -702,12 +703,21 @@ static int ndp_fetch ( struct settings *settings,
 	size_t offset;
 	size_t option_len;
 	void *option_data;
+	unsigned int tag;
+
+	/* Use MTU option (if present) to provide the link MTU */
+	tag = setting->tag;
+	if ( setting_cmp ( setting, &mtu_setting ) == 0 ) {
+		tag = NDP_TAG ( NDP_OPT_MTU, offsetof ( struct ndp_mtu_option,
+							 mtu ),
+				sizeof ( option->mtu.mtu ) );
+	}
 
 	/* Parse setting tag */
-	tag_type = NDP_TAG_TYPE ( setting->tag );
-	tag_offset = NDP_TAG_OFFSET ( setting->tag );
-	tag_len = NDP_TAG_LEN ( setting->tag );
-	tag_instance = NDP_TAG_INSTANCE ( setting->tag );
+	tag_type = NDP_TAG_TYPE ( tag );
+	tag_offset = NDP_TAG_OFFSET ( tag );
+	tag_len = NDP_TAG_LEN ( tag );
+	tag_instance = NDP_TAG_INSTANCE ( tag );
 
 	/* Scan through NDP options for requested type.  We can assume
 	 * that the options are well-formed, otherwise they would have
@@ -31,6 +31,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/retry.h>
 #include <ipxe/timer.h>
 #include <ipxe/malloc.h>
+#include <ipxe/slab.h>
 #include <ipxe/neighbour.h>
 
 /** @file
@@ -51,6 +52,10 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 /** The neighbour cache */
 struct list_head neighbours = LIST_HEAD_INIT ( neighbours );
 
+/** Neighbour cache entry object cache */
+struct slab_cache neighbour_slab __slab_cache =
+	SLAB_CACHE_INIT ( "neighbour", sizeof ( struct neighbour ) );
+
 static void neighbour_expired ( struct retry_timer *timer, int over );
 
 /**
@@ -69,7 +74,7 @@ static void neighbour_free ( struct refcnt *refcnt ) {
 	netdev_put ( neighbour->netdev );
 
 	/* Free neighbour */
-	free ( neighbour );
+	slab_free ( &neighbour_slab, neighbour );
 }
 
 /**
@@ -86,7 +91,7 @@ static struct neighbour * neighbour_create ( struct net_device *netdev,
 	struct neighbour *neighbour;
 
 	/* Allocate and initialise entry */
-	neighbour = zalloc ( sizeof ( *neighbour ) );
+	neighbour = slab_zalloc ( &neighbour_slab );
 	if ( ! neighbour )
 		return NULL;
 	ref_init ( &neighbour->refcnt, neighbour_free );
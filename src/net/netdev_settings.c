@@ -86,6 +86,42 @@ const struct setting mtu_setting __setting ( SETTING_NETDEV, mtu ) = {
 	.type = &setting_type_int16,
 	.tag = DHCP_MTU,
 };
+const struct setting txpkts_setting __setting ( SETTING_NETDEV_EXTRA,
+						     txpkts ) = {
+	.name = "txpkts",
+	.description = "Transmitted packets",
+	.type = &setting_type_uint32,
+};
+const struct setting txbytes_setting __setting ( SETTING_NETDEV_EXTRA,
+						     txbytes ) = {
+	.name = "txbytes",
+	.description = "Transmitted bytes (modulo 2^32)",
+	.type = &setting_type_uint32,
+};
+const struct setting txerrs_setting __setting ( SETTING_NETDEV_EXTRA,
+						     txerrs ) = {
+	.name = "txerrs",
+	.description = "Transmit errors",
+	.type = &setting_type_uint32,
+};
+const struct setting rxpkts_setting __setting ( SETTING_NETDEV_EXTRA,
+						     rxpkts ) = {
+	.name = "rxpkts",
+	.description = "Received packets",
+	.type = &setting_type_uint32,
+};
+const struct setting rxbytes_setting __setting ( SETTING_NETDEV_EXTRA,
+						     rxbytes ) = {
+	.name = "rxbytes",
+	.description = "Received bytes (modulo 2^32)",
+	.type = &setting_type_uint32,
+};
+const struct setting rxerrs_setting __setting ( SETTING_NETDEV_EXTRA,
+						     rxerrs ) = {
+	.name = "rxerrs",
+	.description = "Receive errors",
+	.type = &setting_type_uint32,
+};
 
 /**
  * Store link-layer address setting
@@ -272,6 +308,102 @@ static int netdev_fetch_ifname ( struct net_device *netdev, void *data,
 	return strlen ( ifname );
 }
 
+/**
+ * Fetch transmitted packets setting
+ *
+ * @v netdev		Network device
+ * @v data		Buffer to fill with setting data
+ * @v len		Length of buffer
+ * @ret len		Length of setting data, or negative error
+ */
+static int netdev_fetch_txpkts ( struct net_device *netdev, void *data,
+				 size_t len ) {
+
+	return setting_denumerate ( &setting_type_uint32, netdev->tx_stats.good,
+				    data, len );
+}
+
+/**
+ * Fetch transmitted bytes setting
+ *
+ * @v netdev		Network device
+ * @v data		Buffer to fill with setting data
+ * @v len		Length of buffer
+ * @ret len		Length of setting data, or negative error
+ *
+ * Numeric settings are at most 32 bits wide, so the value wraps
+ * around every 4GB.  The full 64-bit count is shown by "ifstat".
+ */
+static int netdev_fetch_txbytes ( struct net_device *netdev, void *data,
+				  size_t len ) {
+
+	return setting_denumerate ( &setting_type_uint32, netdev->tx_stats.bytes,
+				    data, len );
+}
+
+/**
+ * Fetch transmit errors setting
+ *
+ * @v netdev		Network device
+ * @v data		Buffer to fill with setting data
+ * @v len		Length of buffer
+ * @ret len		Length of setting data, or negative error
+ */
+static int netdev_fetch_txerrs ( struct net_device *netdev, void *data,
+				 size_t len ) {
+
+	return setting_denumerate ( &setting_type_uint32, netdev->tx_stats.bad,
+				    data, len );
+}
+
+/**
+ * Fetch received packets setting
+ *
+ * @v netdev		Network device
+ * @v data		Buffer to fill with setting data
+ * @v len		Length of buffer
+ * @ret len		Length of setting data, or negative error
+ */
+static int netdev_fetch_rxpkts ( struct net_device *netdev, void *data,
+				 size_t len ) {
+
+	return setting_denumerate ( &setting_type_uint32, netdev->rx_stats.good,
+				    data, len );
+}
+
+/**
+ * Fetch received bytes setting
+ *
+ * @v netdev		Network device
+ * @v data		Buffer to fill with setting data
+ * @v len		Length of buffer
+ * @ret len		Length of setting data, or negative error
+ *
+ * Numeric settings are at most 32 bits wide, so the value wraps
+ * around every 4GB.  The full 64-bit count is shown by "ifstat".
+ */
+static int netdev_fetch_rxbytes ( struct net_device *netdev, void *data,
+				  size_t len ) {
+
+	return setting_denumerate ( &setting_type_uint32, netdev->rx_stats.bytes,
+				    data, len );
+}
+
+/**
+ * Fetch receive errors setting
+ *
+ * @v netdev		Network device
+ * @v data		Buffer to fill with setting data
+ * @v len		Length of buffer
+ * @ret len		Length of setting data, or negative error
+ */
+static int netdev_fetch_rxerrs ( struct net_device *netdev, void *data,
+				 size_t len ) {
+
+	return setting_denumerate ( &setting_type_uint32, netdev->rx_stats.bad,
+				    data, len );
+}
+
 /** A network device setting operation */
 struct netdev_setting_operation {
 	/** Setting */
@@ -305,6 +437,12 @@ static struct netdev_setting_operation netdev_setting_operations[] = {
 	{ &linktype_setting, NULL, netdev_fetch_linktype },
 	{ &chip_setting, NULL, netdev_fetch_chip },
 	{ &ifname_setting, NULL, netdev_fetch_ifname },
+	{ &txpkts_setting, NULL, netdev_fetch_txpkts },
+	{ &txbytes_setting, NULL, netdev_fetch_txbytes },
+	{ &txerrs_setting, NULL, netdev_fetch_txerrs },
+	{ &rxpkts_setting, NULL, netdev_fetch_rxpkts },
+	{ &rxbytes_setting, NULL, netdev_fetch_rxbytes },
+	{ &rxerrs_setting, NULL, netdev_fetch_rxerrs },
 };
 
 /**
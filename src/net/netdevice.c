@@ -28,17 +28,22 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <stdio.h>
 #include <byteswap.h>
 #include <string.h>
+#include <strings.h>
 #include <errno.h>
 #include <config/general.h>
 #include <ipxe/if_ether.h>
 #include <ipxe/iobuf.h>
 #include <ipxe/tables.h>
 #include <ipxe/process.h>
+#include <ipxe/timer.h>
+#include <ipxe/nap.h>
 #include <ipxe/init.h>
 #include <ipxe/malloc.h>
 #include <ipxe/device.h>
 #include <ipxe/errortab.h>
 #include <ipxe/profile.h>
+#include <ipxe/tracepoint.h>
+#include <ipxe/timeline.h>
 #include <ipxe/fault.h>
 #include <ipxe/vlan.h>
 #include <ipxe/netdevice.h>
@@ -55,6 +60,36 @@ struct list_head net_devices = LIST_HEAD_INIT ( net_devices );
 /** List of open network devices, in reverse order of opening */
 static struct list_head open_net_devices = LIST_HEAD_INIT ( open_net_devices );
 
+/**
+ * Single-step the network stack
+ *
+ * @v process		Network stack process
+ *
+ * The network stack process sleeps while no network devices are
+ * open, and is woken up when a device is opened or when a packet is
+ * received.
+ */
+static void net_step ( struct process *process ) {
+	net_poll();
+	if ( list_empty ( &open_net_devices ) )
+		process_del ( process );
+}
+
+/** Networking stack process */
+PERMANENT_PROCESS_PRIO ( net_process, net_step, PROC_PRIO_NET );
+
+/** Minimum idle time before the CPU may sleep, in ticks
+ *
+ * Sleeping may delay the processing of a newly received packet until
+ * the next timer interrupt.  We therefore sleep only once the network
+ * has been idle for long enough that this extra latency is
+ * insignificant.
+ */
+#define NET_NAP_IDLE_TICKS ( TICKS_PER_SEC / 10 )
+
+/** Time of most recent network activity */
+static unsigned long net_activity;
+
 /** Network polling profiler */
 static struct profiler net_poll_profiler __profiler = { .name = "net.poll" };
 
@@ -64,6 +99,22 @@ static struct profiler net_rx_profiler __profiler = { .name = "net.rx" };
 /** Network transmit profiler */
 static struct profiler net_tx_profiler __profiler = { .name = "net.tx" };
 
+/** Network receive tracepoint */
+static struct tracepoint net_rx_tracepoint __tracepoint = { .name = "net.rx" };
+
+/** Network transmit tracepoint */
+static struct tracepoint net_tx_tracepoint __tracepoint = { .name = "net.tx" };
+
+/** Link-up timeline phase
+ *
+ * This phase is active while any open network device is waiting for
+ * link-up.
+ */
+static struct timeline_phase link_timeline
+	__timeline_phase ( TIMELINE_LINK ) = {
+	.name = "link",
+};
+
 /** Default unknown link status code */
 #define EUNKNOWN_LINK_STATUS __einfo_error ( EINFO_EUNKNOWN_LINK_STATUS )
 #define EINFO_EUNKNOWN_LINK_STATUS \
@@ -205,12 +256,20 @@ void netdev_rx_unfreeze ( struct net_device *netdev ) {
  * @v rc		Link status code
  */
 void netdev_link_err ( struct net_device *netdev, int rc ) {
+	int was_ok = netdev_link_ok ( netdev );
 
 	/* Stop link block timer */
 	stop_timer ( &netdev->link_block );
 
 	/* Record link state */
 	netdev->link_rc = rc;
+	if ( netdev_is_open ( netdev ) && ( was_ok != ( rc == 0 ) ) ) {
+		if ( rc == 0 ) {
+			timeline_end ( &link_timeline );
+		} else {
+			timeline_begin ( &link_timeline );
+		}
+	}
 	if ( netdev->link_rc == 0 ) {
 		DBGC ( netdev, "NETDEV %s link is up\n", netdev->name );
 	} else {
@@ -301,6 +360,8 @@ static void netdev_record_stat ( struct net_device_stats *stats, int rc ) {
 
 	/* Update the bad counter */
 	stats->bad++;
+	if ( rc == -ENOBUFS )
+		stats->full++;
 
 	/* Locate the appropriate error record */
 	least_common_error = &stats->errors[0];
@@ -321,6 +382,25 @@ static void netdev_record_stat ( struct net_device_stats *stats, int rc ) {
 	least_common_error->count = 1;
 }
 
+/**
+ * Record network device latency sample
+ *
+ * @v latency		Network device latency histogram
+ * @v sample		Latency sample, in profiling timestamp units
+ */
+static void netdev_record_latency ( struct net_device_latency *latency,
+				    unsigned long sample ) {
+	unsigned int bucket;
+
+	/* Identify bucket */
+	bucket = ( sample ? ( flsl ( sample ) - 1 ) : 0 );
+	if ( bucket >= NETDEV_LATENCY_BUCKETS )
+		bucket = ( NETDEV_LATENCY_BUCKETS - 1 );
+
+	/* Update bucket */
+	latency->count[bucket]++;
+}
+
 /**
  * Transmit raw packet via network device
  *
@@ -336,6 +416,7 @@ int netdev_tx ( struct net_device *netdev, struct io_buffer *iobuf ) {
 
 	DBGC2 ( netdev, "NETDEV %s transmitting %p (%p+%zx)\n",
 		netdev->name, iobuf, iobuf->data, iob_len ( iobuf ) );
+	trace ( &net_tx_tracepoint, iob_len ( iobuf ) );
 	profile_start ( &net_tx_profiler );
 
 	/* Enqueue packet */
@@ -442,6 +523,8 @@ void netdev_tx_err ( struct net_device *netdev,
 
 	/* Update statistics counter */
 	netdev_record_stat ( &netdev->tx_stats, rc );
+	if ( ( rc == 0 ) && iobuf )
+		netdev->tx_stats.bytes += iob_len ( iobuf );
 	if ( rc == 0 ) {
 		DBGC2 ( netdev, "NETDEV %s transmission %p complete\n",
 			netdev->name, iobuf );
@@ -550,6 +633,7 @@ void netdev_rx ( struct net_device *netdev, struct io_buffer *iobuf ) {
 
 	DBGC2 ( netdev, "NETDEV %s received %p (%p+%zx)\n",
 		netdev->name, iobuf, iobuf->data, iob_len ( iobuf ) );
+	trace ( &net_rx_tracepoint, iob_len ( iobuf ) );
 
 	/* Discard packet (for test purposes) if applicable */
 	if ( ( rc = inject_fault ( NETDEV_DISCARD_RATE ) ) != 0 ) {
@@ -564,8 +648,13 @@ void netdev_rx ( struct net_device *netdev, struct io_buffer *iobuf ) {
 	/* Enqueue packet */
 	list_add_tail ( &iobuf->list, &netdev->rx_queue );
 
+	/* Wake up network stack process, if sleeping */
+	if ( ! process_running ( &net_process ) )
+		process_add ( &net_process );
+
 	/* Update statistics counter */
 	netdev_record_stat ( &netdev->rx_stats, 0 );
+	netdev->rx_stats.bytes += iob_len ( iobuf );
 }
 
 /**
@@ -869,6 +958,8 @@ int netdev_open ( struct net_device *netdev ) {
 
 	/* Mark as opened */
 	netdev->state |= NETDEV_OPEN;
+	if ( ! netdev_link_ok ( netdev ) )
+		timeline_begin ( &link_timeline );
 
 	/* Open the device */
 	if ( ( rc = netdev->op->open ( netdev ) ) != 0 )
@@ -877,12 +968,17 @@ int netdev_open ( struct net_device *netdev ) {
 	/* Add to head of open devices list */
 	list_add ( &netdev->open_list, &open_net_devices );
 
+	/* Wake up network stack process */
+	process_add ( &net_process );
+
 	/* Notify drivers of device state change */
 	netdev_notify ( netdev );
 
 	return 0;
 
  err:
+	if ( ! netdev_link_ok ( netdev ) )
+		timeline_end ( &link_timeline );
 	netdev->state &= ~NETDEV_OPEN;
 	return rc;
 }
@@ -893,8 +989,6 @@ int netdev_open ( struct net_device *netdev ) {
  * @v netdev		Network device
  */
 void netdev_close ( struct net_device *netdev ) {
-	unsigned int num_configs;
-	unsigned int i;
 
 	/* Do nothing if device is already closed */
 	if ( ! ( netdev->state & NETDEV_OPEN ) )
@@ -902,19 +996,15 @@ void netdev_close ( struct net_device *netdev ) {
 
 	DBGC ( netdev, "NETDEV %s closing\n", netdev->name );
 
-	/* Terminate any ongoing configurations.  Use intf_close()
-	 * rather than intf_restart() to allow the cancellation to be
-	 * reported back to us if a configuration is actually in
-	 * progress.
-	 */
-	num_configs = table_num_entries ( NET_DEVICE_CONFIGURATORS );
-	for ( i = 0 ; i < num_configs ; i++ )
-		intf_close ( &netdev->configs[i].job, -ECANCELED );
+	/* Terminate any ongoing configurations */
+	netdev_configure_cancel ( netdev );
 
 	/* Remove from open devices list */
 	list_del ( &netdev->open_list );
 
 	/* Mark as closed */
+	if ( ! netdev_link_ok ( netdev ) )
+		timeline_end ( &link_timeline );
 	netdev->state &= ~NETDEV_OPEN;
 
 	/* Notify drivers of device state change */
@@ -1131,15 +1221,27 @@ void net_poll ( void ) {
 	const void *ll_source;
 	uint16_t net_proto;
 	unsigned int flags;
+	unsigned int completions;
+	unsigned long polled;
+	int active = 0;
 	int rc;
 
 	/* Poll and process each network device */
 	list_for_each_entry ( netdev, &net_devices, list ) {
 
 		/* Poll for new packets */
+		completions = ( netdev->rx_stats.good + netdev->rx_stats.bad +
+				netdev->tx_stats.good + netdev->tx_stats.bad );
 		profile_start ( &net_poll_profiler );
 		netdev_poll ( netdev );
 		profile_stop ( &net_poll_profiler );
+		if ( completions != ( netdev->rx_stats.good +
+				      netdev->rx_stats.bad +
+				      netdev->tx_stats.good +
+				      netdev->tx_stats.bad ) ) {
+			active = 1;
+		}
+		polled = profile_timestamp();
 
 		/* Leave received packets on the queue if receive
 		 * queue processing is currently frozen.  This will
@@ -1175,18 +1277,61 @@ void net_poll ( void ) {
 				/* Record error for diagnosis */
 				netdev_rx_err ( netdev, NULL, rc );
 			}
+			netdev_record_latency ( &netdev->rx_processing,
+						( profile_timestamp() -
+						  polled ) );
 			profile_stop ( &net_rx_profiler );
 		}
 	}
+
+	/* Record time of network activity */
+	if ( active )
+		net_activity = currticks();
 }
 
 /**
- * Single-step the network stack
- *
- * @v process		Network stack process
+ * Sleep until network activity is likely, if the network is idle
+ *
+ * This may be called from within a loop that is waiting for network
+ * I/O, in order to avoid spinning at 100% CPU.  It must not be called
+ * while the caller is making progress on other (e.g. local) work.
+ * The CPU will sleep only if the network has been idle for a while,
+ * so that bulk transfers are never delayed.  Any packet completion,
+ * including a failed transmission or reception, counts as network
+ * activity.  The CPU will not sleep at all while no network device
+ * is open, since the caller must then be waiting for something other
+ * than the network.
+ *
+ * If exactly one network device is open and it provides a wake-up
+ * location, then the CPU will be woken as soon as the device writes
+ * to that location.  Otherwise, the CPU will sleep until the next
+ * timer interrupt.
  */
-static void net_step ( struct process *process __unused ) {
-	net_poll();
+void net_nap ( void ) {
+	struct net_device *netdev;
+	const volatile void *wake = NULL;
+	unsigned int count = 0;
+
+	/* Continue polling while the network is busy */
+	if ( ( currticks() - net_activity ) < NET_NAP_IDLE_TICKS )
+		return;
+
+	/* Identify wake-up location, if applicable */
+	list_for_each_entry ( netdev, &open_net_devices, open_list ) {
+		wake = netdev->wake;
+		count++;
+	}
+
+	/* Do not sleep unless the network is in use */
+	if ( ! count )
+		return;
+
+	/* Sleep */
+	if ( wake && ( count == 1 ) ) {
+		cpu_nap_watch ( wake );
+	} else {
+		cpu_nap();
+	}
 }
 
 /**
@@ -1231,9 +1376,6 @@ __weak void vlan_netdev_rx_err ( struct net_device *netdev,
 	netdev_rx_err ( netdev, iobuf, rc );
 }
 
-/** Networking stack process */
-PERMANENT_PROCESS ( net_process, net_step );
-
 /**
  * Discard some cached network device data
  *
@@ -1351,6 +1493,24 @@ int netdev_configure_all ( struct net_device *netdev ) {
 	return 0;
 }
 
+/**
+ * Cancel any ongoing network device configurations
+ *
+ * @v netdev		Network device
+ */
+void netdev_configure_cancel ( struct net_device *netdev ) {
+	unsigned int num_configs;
+	unsigned int i;
+
+	/* Use intf_close() rather than intf_restart() to allow the
+	 * cancellation to be reported back to us if a configuration
+	 * is actually in progress.
+	 */
+	num_configs = table_num_entries ( NET_DEVICE_CONFIGURATORS );
+	for ( i = 0 ; i < num_configs ; i++ )
+		intf_close ( &netdev->configs[i].job, -ECANCELED );
+}
+
 /**
  * Check if network device has a configuration with a specified status code
  *
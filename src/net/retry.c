@@ -29,6 +29,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/process.h>
 #include <ipxe/init.h>
 #include <ipxe/retry.h>
+#include <ipxe/tracepoint.h>
 
 /** @file
  *
@@ -39,7 +40,11 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
  *
  * This implementation of the timer is designed to satisfy RFC 2988
  * and therefore be usable as a TCP retransmission timer.
- * 
+ *
+ * Running timers are held in a hashed timing wheel, indexed by
+ * expiry time.  Starting and stopping a timer is O(1), and each poll
+ * needs to examine only the wheel slots for the ticks that have
+ * elapsed since the previous poll.
  */
 
 /* The theoretical minimum that the algorithm in stop_timer() can
@@ -48,8 +53,80 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
  */
 #define MIN_TIMEOUT 7
 
-/** List of running timers */
-static LIST_HEAD ( timers );
+/** Number of slots in the timing wheel (must be a power of two) */
+#define RETRY_WHEEL_SLOTS 64
+
+/** Timing wheel of running timers, indexed by expiry time
+ *
+ * A slot may also contain timers that will expire only after one or
+ * more further rotations of the wheel.
+ */
+static struct list_head retry_wheel[RETRY_WHEEL_SLOTS];
+
+/** Time at which the timing wheel was last advanced */
+static unsigned long retry_tick;
+
+/** List of running timers that were already due when started */
+static LIST_HEAD ( retry_due );
+
+/** Number of running timers */
+static unsigned int retry_running;
+
+/** Timer expiry tracepoint
+ *
+ * The recorded value is the address of the expiry callback, which
+ * identifies the type of the expired timer.
+ */
+static struct tracepoint timer_expired_tracepoint __tracepoint = {
+	.name = "timer.expired",
+};
+
+/**
+ * Single-step the retry timer list
+ *
+ * @v process		Retry timer process
+ *
+ * The retry timer process sleeps while no timers are running, and is
+ * woken up when a timer is started.
+ */
+static void retry_step ( struct process *process ) {
+	retry_poll();
+	if ( ! retry_running )
+		process_del ( process );
+}
+
+/** Retry timer process */
+PERMANENT_PROCESS_PRIO ( retry_process, retry_step, PROC_PRIO_NET );
+
+/**
+ * Get timing wheel slot
+ *
+ * @v tick		Time
+ * @ret slot		Timing wheel slot
+ *
+ * Slots are initialised on first use, since timers may be started
+ * before any initialisation functions have run.
+ */
+static struct list_head * retry_slot ( unsigned long tick ) {
+	struct list_head *slot =
+		&retry_wheel[ tick & ( RETRY_WHEEL_SLOTS - 1 ) ];
+
+	if ( ! slot->next )
+		INIT_LIST_HEAD ( slot );
+	return slot;
+}
+
+/**
+ * Check if timer has expired
+ *
+ * @v timer		Retry timer
+ * @v now		Current time
+ * @ret expired		Timer has expired
+ */
+static inline int timer_has_expired ( struct retry_timer *timer,
+				      unsigned long now ) {
+	return ( ( now - timer->start ) >= timer->timeout );
+}
 
 /**
  * Start timer with a specified timeout
@@ -63,11 +140,16 @@ static LIST_HEAD ( timers );
  */
 void start_timer_fixed ( struct retry_timer *timer, unsigned long timeout ) {
 
-	/* Add to list of running timers (if applicable) */
-	if ( ! timer->running ) {
-		list_add ( &timer->list, &timers );
+	unsigned long expiry;
+
+	/* Remove from timing wheel, or mark as running, as applicable */
+	if ( timer->running ) {
+		list_del ( &timer->list );
+	} else {
 		ref_get ( timer->refcnt );
 		timer->running = 1;
+		if ( ! retry_running++ )
+			process_add ( &retry_process );
 	}
 
 	/* Record start time */
@@ -76,6 +158,16 @@ void start_timer_fixed ( struct retry_timer *timer, unsigned long timeout ) {
 	/* Record timeout */
 	timer->timeout = timeout;
 
+	/* Add to timing wheel slot, or to the list of due timers if
+	 * the wheel has already advanced beyond the expiry time.
+	 */
+	expiry = ( timer->start + timer->timeout );
+	if ( ( ( signed long ) ( expiry - retry_tick ) ) <= 0 ) {
+		list_add_tail ( &timer->list, &retry_due );
+	} else {
+		list_add_tail ( &timer->list, retry_slot ( expiry ) );
+	}
+
 	DBGC2 ( timer, "Timer %p started at time %ld (expires at %ld)\n",
 		timer, timer->start, ( timer->start + timer->timeout ) );
 }
@@ -126,6 +218,7 @@ void stop_timer ( struct retry_timer *timer ) {
 	list_del ( &timer->list );
 	runtime = ( now - timer->start );
 	timer->running = 0;
+	retry_running--;
 	DBGC2 ( timer, "Timer %p stopped at time %ld (ran for %ld)\n",
 		timer, now, runtime );
 
@@ -174,6 +267,7 @@ static void timer_expired ( struct retry_timer *timer ) {
 	assert ( timer->running );
 	list_del ( &timer->list );
 	timer->running = 0;
+	retry_running--;
 	timer->count++;
 
 	/* Back off the timeout value */
@@ -184,6 +278,8 @@ static void timer_expired ( struct retry_timer *timer ) {
 	       timer, timer->timeout );
 
 	/* Call expiry callback */
+	trace ( &timer_expired_tracepoint,
+		( ( unsigned long ) timer->expired ) );
 	timer->expired ( timer, fail );
 	/* If refcnt is NULL, then timer may already have been freed */
 
@@ -191,36 +287,44 @@ static void timer_expired ( struct retry_timer *timer ) {
 }
 
 /**
- * Poll the retry timer list
+ * Poll the retry timers
  *
  */
 void retry_poll ( void ) {
 	struct retry_timer *timer;
+	struct retry_timer *tmp;
+	struct list_head *slot;
 	unsigned long now = currticks();
-	unsigned long used;
+	unsigned long elapsed = ( now - retry_tick );
+	LIST_HEAD ( expired );
 
-	/* Process at most one timer expiry.  We cannot process
-	 * multiple expiries in one pass, because one timer expiring
-	 * may end up triggering another timer's deletion from the
-	 * list.
+	/* Advance the timing wheel, collecting expired timers.  If
+	 * more than a full rotation has elapsed, then each slot need
+	 * be examined only once.
 	 */
-	list_for_each_entry ( timer, &timers, list ) {
-		used = ( now - timer->start );
-		if ( used >= timer->timeout ) {
-			timer_expired ( timer );
-			break;
+	if ( elapsed > RETRY_WHEEL_SLOTS )
+		elapsed = RETRY_WHEEL_SLOTS;
+	while ( elapsed-- ) {
+		slot = retry_slot ( ++retry_tick );
+		list_for_each_entry_safe ( timer, tmp, slot, list ) {
+			if ( timer_has_expired ( timer, now ) ) {
+				list_del ( &timer->list );
+				list_add_tail ( &timer->list, &expired );
+			}
 		}
 	}
-}
+	retry_tick = now;
 
-/**
- * Single-step the retry timer list
- *
- * @v process		Retry timer process
- */
-static void retry_step ( struct process *process __unused ) {
-	retry_poll();
-}
+	/* Collect timers that were already due when started */
+	list_splice_tail_init ( &retry_due, &expired );
 
-/** Retry timer process */
-PERMANENT_PROCESS ( retry_process, retry_step );
+	/* Process expired timers.  An expiry callback may stop (or
+	 * restart) any other timer, which will remove it from the
+	 * list of expired timers.  Timers started by an expiry
+	 * callback will not expire until the next poll.
+	 */
+	while ( ( timer = list_first_entry ( &expired, struct retry_timer,
+					     list ) ) ) {
+		timer_expired ( timer );
+	}
+}
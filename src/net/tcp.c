@@ -16,6 +16,7 @@
 #include <ipxe/uri.h>
 #include <ipxe/netdevice.h>
 #include <ipxe/profile.h>
+#include <ipxe/tracepoint.h>
 #include <ipxe/process.h>
 #include <ipxe/job.h>
 #include <ipxe/tcpip.h>
@@ -48,6 +49,12 @@ struct tcp_connection {
 	unsigned int local_port;
 	/** Maximum segment size */
 	size_t mss;
+	/** Maximum transmitted segment size
+	 *
+	 * Equivalent to SMSS in RFC 5681 terminology (excluding the
+	 * length of any TCP options).
+	 */
+	size_t snd_mss;
 
 	/** Current TCP state */
 	unsigned int tcp_state;
@@ -176,6 +183,12 @@ static struct profiler tcp_rx_profiler __profiler = { .name = "tcp.rx" };
 /** Data transfer profiler */
 static struct profiler tcp_xfer_profiler __profiler = { .name = "tcp.xfer" };
 
+/** Transmit tracepoint */
+static struct tracepoint tcp_tx_tracepoint __tracepoint = { .name = "tcp.tx" };
+
+/** Receive tracepoint */
+static struct tracepoint tcp_rx_tracepoint __tracepoint = { .name = "tcp.rx" };
+
 /* Forward declarations */
 static struct process_descriptor tcp_process_desc;
 static struct interface_descriptor tcp_xfer_desc;
@@ -307,6 +320,9 @@ static int tcp_open ( struct interface *xfer, struct sockaddr *peer,
 		goto err;
 	}
 	tcp->mss = ( mtu - sizeof ( struct tcp_header ) );
+	tcp->snd_mss = tcp->mss;
+	if ( tcp->snd_mss > TCP_DEFAULT_MSS )
+		tcp->snd_mss = TCP_DEFAULT_MSS;
 
 	/* Bind to local port */
 	port = tcpip_bind ( st_local, tcp_port_available );
@@ -430,16 +446,29 @@ static void tcp_close ( struct tcp_connection *tcp, int rc ) {
  * @ret len		Maximum length that can be sent in a single packet
  */
 static size_t tcp_xmit_win ( struct tcp_connection *tcp ) {
+	size_t mss;
 	size_t len;
 
 	/* Not ready if we're not in a suitable connection state */
 	if ( ! TCP_CAN_SEND_DATA ( tcp->tcp_state ) )
 		return 0;
 
-	/* Length is the minimum of the receiver's window and the path MTU */
+	/* Calculate maximum payload length, allowing space for any
+	 * TCP options that may be added to the segment.
+	 */
+	mss = tcp->snd_mss;
+	if ( tcp->flags & TCP_TS_ENABLED )
+		mss -= sizeof ( struct tcp_timestamp_padded_option );
+	if ( ( tcp->flags & TCP_SACK_ENABLED ) &&
+	     ( ! list_empty ( &tcp->rx_queue ) ) ) {
+		mss -= ( sizeof ( struct tcp_sack_padded_option ) +
+			 ( TCP_SACK_MAX * sizeof ( struct tcp_sack_block ) ) );
+	}
+
+	/* Length is the minimum of the receiver's window and the MSS */
 	len = tcp->snd_win;
-	if ( len > TCP_PATH_MTU )
-		len = TCP_PATH_MTU;
+	if ( len > mss )
+		len = mss;
 
 	return len;
 }
@@ -652,6 +681,7 @@ static void tcp_xmit_sack ( struct tcp_connection *tcp, uint32_t sack_seq ) {
 	/* If we have nothing to transmit, stop now */
 	if ( ( seq_len == 0 ) && ! ( tcp->flags & TCP_ACK_PENDING ) )
 		return;
+	trace ( &tcp_tx_tracepoint, len );
 
 	/* If we are transmitting anything that requires
 	 * acknowledgement (i.e. consumes sequence space), start the
@@ -774,7 +804,8 @@ static void tcp_xmit ( struct tcp_connection *tcp ) {
 
 /** TCP process descriptor */
 static struct process_descriptor tcp_process_desc =
-	PROC_DESC_ONCE ( struct tcp_connection, process, tcp_xmit );
+	PROC_DESC_ONCE_PRIO ( struct tcp_connection, process, tcp_xmit,
+			     PROC_PRIO_NET );
 
 /**
  * Retransmission timer expired
@@ -805,6 +836,16 @@ static void tcp_expired ( struct retry_timer *timer, int over ) {
 		tcp_dump_state ( tcp );
 		tcp_close ( tcp, -ETIMEDOUT );
 	} else {
+		/* Fall back to the default MSS if large segments
+		 * appear to be disappearing into a black hole.
+		 */
+		if ( ( timer->count >= TCP_MSS_FALLBACK_RETRIES ) &&
+		     ( tcp->snd_mss > TCP_DEFAULT_MSS ) ) {
+			DBGC ( tcp, "TCP %p reducing MSS from %zd to %d\n",
+			       tcp, tcp->snd_mss, TCP_DEFAULT_MSS );
+			tcp->snd_mss = TCP_DEFAULT_MSS;
+		}
+
 		/* Otherwise, retransmit the packet */
 		tcp_xmit ( tcp );
 	}
@@ -978,7 +1019,8 @@ static int tcp_rx_opts ( struct tcp_connection *tcp,
 		min = sizeof ( *option );
 		switch ( kind ) {
 		case TCP_OPTION_MSS:
-			/* Ignore received MSS */
+			options->mssopt = data;
+			min = sizeof ( *options->mssopt );
 			break;
 		case TCP_OPTION_WS:
 			options->wsopt = data;
@@ -1070,6 +1112,7 @@ static void tcp_rx_seq ( struct tcp_connection *tcp, uint32_t seq_len ) {
  */
 static int tcp_rx_syn ( struct tcp_connection *tcp, uint32_t seq,
 			struct tcp_options *options ) {
+	size_t mss;
 
 	/* Synchronise sequence numbers on first SYN */
 	if ( ! ( tcp->tcp_state & TCP_STATE_RCVD ( TCP_SYN ) ) ) {
@@ -1082,12 +1125,19 @@ static int tcp_rx_syn ( struct tcp_connection *tcp, uint32_t seq,
 			tcp->snd_win_scale = options->wsopt->scale;
 			tcp->rcv_win_scale = TCP_RX_WINDOW_SCALE;
 		}
+		if ( options->mssopt ) {
+			mss = ntohs ( options->mssopt->mss );
+			if ( mss > tcp->mss )
+				mss = tcp->mss;
+			if ( mss >= TCP_MIN_MSS )
+				tcp->snd_mss = mss;
+		}
 		DBGC ( tcp, "TCP %p using %stimestamps, %sSACK, TX window "
-		       "x%d, RX window x%d\n", tcp,
+		       "x%d, RX window x%d, MSS %zd\n", tcp,
 		       ( ( tcp->flags & TCP_TS_ENABLED ) ? "" : "no " ),
 		       ( ( tcp->flags & TCP_SACK_ENABLED ) ? "" : "no " ),
 		       ( 1 << tcp->snd_win_scale ),
-		       ( 1 << tcp->rcv_win_scale ) );
+		       ( 1 << tcp->rcv_win_scale ), tcp->snd_mss );
 	}
 
 	/* Ignore duplicate SYN */
@@ -1414,6 +1464,7 @@ static int tcp_rx ( struct io_buffer *iobuf,
 
 	/* Start profiling */
 	profile_start ( &tcp_rx_profiler );
+	trace ( &tcp_rx_tracepoint, iob_len ( iobuf ) );
 
 	/* Sanity check packet */
 	if ( iob_len ( iobuf ) < sizeof ( *tcphdr ) ) {
@@ -40,6 +40,18 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 /** Block size used for HTTP block device requests */
 #define HTTP_BLKSIZE 512
 
+/**
+ * Maximum length of a single HTTP block device range request
+ *
+ * Larger SAN reads (such as cache fills with read-ahead) are split
+ * into multiple range requests of at most this length, which the SAN
+ * device may then issue concurrently.  Each concurrent request
+ * reuses an idle keepalive connection from the HTTP connection pool
+ * where one is available, so a sequential read proceeds as a small
+ * number of parallel streams rather than as a series of round trips.
+ */
+#define HTTP_BLOCK_MAX_LEN ( 128 * 1024 )
+
 /**
  * Read from block device
  *
@@ -70,7 +82,7 @@ int http_block_read ( struct http_transaction *http, struct interface *data,
 		goto err_open;
 
 	/* Insert block device translator */
-	if ( ( rc = block_translate ( data, buffer, len ) ) != 0 ) {
+	if ( ( rc = block_translate ( data, buffer, len, 0 ) ) != 0 ) {
 		DBGC ( http, "HTTP %p could not insert block translator: %s\n",
 		       http, strerror ( rc ) );
 		goto err_translate;
@@ -101,7 +113,9 @@ int http_block_read_capacity ( struct http_transaction *http,
 		goto err_open;
 
 	/* Insert block device translator */
-	if ( ( rc = block_translate ( data, UNULL, HTTP_BLKSIZE ) ) != 0 ) {
+	if ( ( rc = block_translate ( data, UNULL, HTTP_BLKSIZE,
+				      ( HTTP_BLOCK_MAX_LEN /
+					HTTP_BLKSIZE ) ) ) != 0 ) {
 		DBGC ( http, "HTTP %p could not insert block translator: %s\n",
 		       http, strerror ( rc ) );
 		goto err_translate;
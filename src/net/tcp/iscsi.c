@@ -48,6 +48,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/ibft.h>
 #include <ipxe/blockdev.h>
 #include <ipxe/efi/efi_path.h>
+#include <ipxe/crc32c.h>
 #include <ipxe/iscsi.h>
 
 /** @file
@@ -91,6 +92,15 @@ FEATURE ( FEATURE_PROTOCOL, "iSCSI", DHCP_EB_FEATURE_ISCSI, 1 );
 	__einfo_error ( EINFO_EINVAL_MAXBURSTLENGTH )
 #define EINFO_EINVAL_MAXBURSTLENGTH \
 	__einfo_uniqify ( EINFO_EINVAL, 0x06, "Invalid MaxBurstLength" )
+#define EINVAL_FIRSTBURSTLENGTH				\
+	__einfo_error ( EINFO_EINVAL_FIRSTBURSTLENGTH )
+#define EINFO_EINVAL_FIRSTBURSTLENGTH \
+	__einfo_uniqify ( EINFO_EINVAL, 0x07, "Invalid FirstBurstLength" )
+#define EINVAL_MAXRECVDATASEGMENTLENGTH			\
+	__einfo_error ( EINFO_EINVAL_MAXRECVDATASEGMENTLENGTH )
+#define EINFO_EINVAL_MAXRECVDATASEGMENTLENGTH \
+	__einfo_uniqify ( EINFO_EINVAL, 0x08,				\
+			  "Invalid MaxRecvDataSegmentLength" )
 #define EIO_TARGET_UNAVAILABLE \
 	__einfo_error ( EINFO_EIO_TARGET_UNAVAILABLE )
 #define EINFO_EIO_TARGET_UNAVAILABLE \
@@ -99,6 +109,14 @@ FEATURE ( FEATURE_PROTOCOL, "iSCSI", DHCP_EB_FEATURE_ISCSI, 1 );
 	__einfo_error ( EINFO_EIO_TARGET_NO_RESOURCES )
 #define EINFO_EIO_TARGET_NO_RESOURCES \
 	__einfo_uniqify ( EINFO_EIO, 0x02, "Target out of resources" )
+#define EIO_HEADER_DIGEST \
+	__einfo_error ( EINFO_EIO_HEADER_DIGEST )
+#define EINFO_EIO_HEADER_DIGEST \
+	__einfo_uniqify ( EINFO_EIO, 0x03, "Header digest mismatch" )
+#define EIO_DATA_DIGEST \
+	__einfo_error ( EINFO_EIO_DATA_DIGEST )
+#define EINFO_EIO_DATA_DIGEST \
+	__einfo_uniqify ( EINFO_EIO, 0x04, "Data digest mismatch" )
 #define ENOTSUP_INITIATOR_STATUS \
 	__einfo_error ( EINFO_ENOTSUP_INITIATOR_STATUS )
 #define EINFO_ENOTSUP_INITIATOR_STATUS \
@@ -150,8 +168,37 @@ FEATURE ( FEATURE_PROTOCOL, "iSCSI", DHCP_EB_FEATURE_ISCSI, 1 );
 
 static void iscsi_start_tx ( struct iscsi_session *iscsi );
 static void iscsi_start_login ( struct iscsi_session *iscsi );
-static void iscsi_start_data_out ( struct iscsi_session *iscsi,
-				   unsigned int datasn );
+static void iscsi_tx_next ( struct iscsi_session *iscsi );
+
+/**
+ * Get digests in use for a new PDU
+ *
+ * @v iscsi		iSCSI session
+ * @ret digests		Digests in use (ISCSI_STATUS_XXX_DIGEST)
+ *
+ * Negotiated digests take effect from the first PDU following the
+ * final login response.
+ */
+static unsigned int iscsi_digests ( struct iscsi_session *iscsi ) {
+
+	if ( ( iscsi->status & ISCSI_STATUS_PHASE_MASK ) !=
+	     ISCSI_STATUS_FULL_FEATURE_PHASE )
+		return 0;
+	return ( iscsi->status & ( ISCSI_STATUS_HEADER_DIGEST |
+				   ISCSI_STATUS_DATA_DIGEST ) );
+}
+
+/**
+ * Calculate iSCSI header or data digest
+ *
+ * @v data		Data
+ * @v len		Length of data
+ * @ret digest		Digest, in wire byte order
+ */
+static uint32_t iscsi_digest ( const void *data, size_t len ) {
+
+	return cpu_to_le32 ( ~crc32c_le ( 0xffffffffUL, data, len ) );
+}
 
 /**
  * Finish receiving PDU data into buffer
@@ -211,7 +258,6 @@ static void iscsi_free ( struct refcnt *refcnt ) {
 	free ( iscsi->target_password );
 	chap_finish ( &iscsi->chap );
 	iscsi_rx_buffered_data_done ( iscsi );
-	free ( iscsi->command );
 	free ( iscsi );
 }
 
@@ -222,6 +268,7 @@ static void iscsi_free ( struct refcnt *refcnt ) {
  * @v rc		Reason for close
  */
 static void iscsi_close ( struct iscsi_session *iscsi, int rc ) {
+	unsigned int i;
 
 	/* A TCP graceful close is still an error from our point of view */
 	if ( rc == 0 )
@@ -233,19 +280,20 @@ static void iscsi_close ( struct iscsi_session *iscsi, int rc ) {
 	process_del ( &iscsi->process );
 
 	/* Shut down interfaces */
-	intfs_shutdown ( rc, &iscsi->socket, &iscsi->control, &iscsi->data,
-			 NULL );
+	for ( i = 0 ; i < ISCSI_MAX_TASKS ; i++ )
+		intf_shutdown ( &iscsi->task[i].data, rc );
+	intfs_shutdown ( rc, &iscsi->socket, &iscsi->control, NULL );
 }
 
 /**
  * Assign new iSCSI initiator task tag
  *
- * @v iscsi		iSCSI session
+ * @ret itt		Initiator task tag
  */
-static void iscsi_new_itt ( struct iscsi_session *iscsi ) {
+static uint32_t iscsi_new_itt ( void ) {
 	static uint16_t itt_idx;
 
-	iscsi->itt = ( ISCSI_TAG_MAGIC | (++itt_idx) );
+	return ( ISCSI_TAG_MAGIC | (++itt_idx) );
 }
 
 /**
@@ -284,10 +332,12 @@ static int iscsi_open_connection ( struct iscsi_session *iscsi ) {
 	iscsi->isid_iana_qual = ( random() & 0xffff );
 
 	/* Assign fresh initiator task tag */
-	iscsi_new_itt ( iscsi );
+	iscsi->itt = iscsi_new_itt();
 
 	/* Set default operational parameters */
 	iscsi->max_burst_len = ISCSI_MAX_BURST_LEN;
+	iscsi->first_burst_len = ISCSI_FIRST_BURST_LEN;
+	iscsi->max_send_len = ISCSI_DEFAULT_MAX_SEND_DATA_SEG_LEN;
 
 	/* Initiate login */
 	iscsi_start_login ( iscsi );
@@ -314,6 +364,7 @@ static void iscsi_close_connection ( struct iscsi_session *iscsi, int rc ) {
 
 	/* Reset TX and RX state machines */
 	iscsi->tx_state = ISCSI_TX_IDLE;
+	iscsi->tx_task = NULL;
 	iscsi->rx_state = ISCSI_RX_BHS;
 	iscsi->rx_offset = 0;
 
@@ -323,39 +374,114 @@ static void iscsi_close_connection ( struct iscsi_session *iscsi, int rc ) {
 }
 
 /**
- * Mark iSCSI SCSI operation as complete
+ * Identify iSCSI task for current RX PDU
  *
  * @v iscsi		iSCSI session
+ * @ret task		iSCSI task, or NULL if not found
+ */
+static struct iscsi_task * iscsi_rx_task ( struct iscsi_session *iscsi ) {
+	uint32_t itt = ntohl ( iscsi->rx_bhs.common.itt );
+	struct iscsi_task *task;
+	unsigned int i;
+
+	for ( i = 0 ; i < ISCSI_MAX_TASKS ; i++ ) {
+		task = &iscsi->task[i];
+		if ( ( task->flags & ISCSI_TASK_ACTIVE ) &&
+		     ( task->itt == itt ) )
+			return task;
+	}
+
+	DBGC ( iscsi, "iSCSI %p received PDU for unknown ITT %08x\n",
+	       iscsi, itt );
+	return NULL;
+}
+
+/**
+ * Mark iSCSI task as complete
+ *
+ * @v task		iSCSI task
  * @v rc		Return status code
  * @v rsp		SCSI response, if any
+ * @ret rc		Return status code
  *
- * Note that iscsi_scsi_done() will not close the connection, and must
- * therefore be called only when the internal state machines are in an
- * appropriate state, otherwise bad things may happen on the next call
- * to iscsi_scsi_command().  The general rule is to call
- * iscsi_scsi_done() only at the end of receiving a PDU; at this point
- * the TX and RX engines should both be idle.
+ * Note that iscsi_task_done() will not close the connection, and
+ * must therefore be called only at the end of receiving a PDU.  A
+ * task cannot be completed while one of its PDUs is partway through
+ * transmission, since the target has by definition not yet received
+ * the whole of that PDU.
  */
-static void iscsi_scsi_done ( struct iscsi_session *iscsi, int rc,
-			      struct scsi_rsp *rsp ) {
-	uint32_t itt = iscsi->itt;
-
-	assert ( iscsi->tx_state == ISCSI_TX_IDLE );
+static int iscsi_task_done ( struct iscsi_task *task, int rc,
+			     struct scsi_rsp *rsp ) {
+	struct iscsi_session *iscsi = task->iscsi;
+	uint32_t itt = task->itt;
+
+	/* Refuse to complete a task which is still transmitting */
+	if ( ( task == iscsi->tx_task ) &&
+	     ( iscsi->tx_state != ISCSI_TX_IDLE ) ) {
+		DBGC ( iscsi, "iSCSI %p ITT %08x completed during "
+		       "transmission\n", iscsi, itt );
+		return -EPROTO;
+	}
 
-	/* Clear command */
-	free ( iscsi->command );
-	iscsi->command = NULL;
+	/* Free task, discarding any untransmitted data-out transfers */
+	task->flags = 0;
+	task->transfer_cons = task->transfer_prod;
 
 	/* Send SCSI response, if any */
 	if ( rsp )
-		scsi_response ( &iscsi->data, rsp );
+		scsi_response ( &task->data, rsp );
 
 	/* Close SCSI command, if this is still the same command.  (It
 	 * is possible that the command interface has already been
-	 * closed as a result of the SCSI response we sent.)
+	 * closed, and the task reused, as a result of the SCSI
+	 * response we sent.)
 	 */
-	if ( iscsi->itt == itt )
-		intf_restart ( &iscsi->data, rc );
+	if ( task->itt == itt )
+		intf_restart ( &task->data, rc );
+
+	return 0;
+}
+
+/**
+ * Queue iSCSI data-out transfer
+ *
+ * @v task		iSCSI task
+ * @v ttt		Target transfer tag
+ * @v offset		Buffer offset
+ * @v len		Length
+ * @ret rc		Return status code
+ */
+static int iscsi_queue_transfer ( struct iscsi_task *task, uint32_t ttt,
+				  uint32_t offset, uint32_t len ) {
+	struct iscsi_session *iscsi = task->iscsi;
+	struct iscsi_transfer *transfer;
+
+	/* Sanity checks */
+	if ( ( task->transfer_prod - task->transfer_cons ) >=
+	     ISCSI_MAX_TRANSFERS ) {
+		DBGC ( iscsi, "iSCSI %p ITT %08x too many outstanding R2Ts\n",
+		       iscsi, task->itt );
+		return -ENOBUFS;
+	}
+	if ( ( ! task->command.data_out ) ||
+	     ( offset > task->command.data_out_len ) ||
+	     ( len > ( task->command.data_out_len - offset ) ) ) {
+		DBGC ( iscsi, "iSCSI %p ITT %08x invalid transfer %#x+%#x\n",
+		       iscsi, task->itt, offset, len );
+		return -EPROTO;
+	}
+
+	/* Record transfer */
+	transfer = &task->transfer[ task->transfer_prod++ %
+				    ISCSI_MAX_TRANSFERS ];
+	transfer->ttt = ttt;
+	transfer->offset = offset;
+	transfer->len = len;
+
+	/* Start transmitting, if idle */
+	iscsi_tx_next ( iscsi );
+
+	return 0;
 }
 
 /****************************************************************************
@@ -368,41 +494,68 @@ static void iscsi_scsi_done ( struct iscsi_session *iscsi, int rc,
  * Build iSCSI SCSI command BHS
  *
  * @v iscsi		iSCSI session
+ * @v task		iSCSI task
  *
  * We don't currently support bidirectional commands (i.e. with both
  * Data-In and Data-Out segments); these would require providing code
  * to generate an AHS, and there doesn't seem to be any need for it at
  * the moment.
+ *
+ * Where the target permits, the first burst of data for a write
+ * command is sent as immediate data within the command PDU and as
+ * unsolicited data-out PDUs, without waiting for an R2T.
  */
-static void iscsi_start_command ( struct iscsi_session *iscsi ) {
+static void iscsi_start_command ( struct iscsi_session *iscsi,
+				  struct iscsi_task *task ) {
 	struct iscsi_bhs_scsi_command *command = &iscsi->tx_bhs.scsi_command;
+	struct scsi_cmd *cmd = &task->command;
+	size_t burst_len;
+	size_t immediate_len = 0;
 
-	assert ( ! ( iscsi->command->data_in && iscsi->command->data_out ) );
+	assert ( ! ( cmd->data_in && cmd->data_out ) );
+
+	/* Calculate length of unsolicited first burst, if any */
+	burst_len = cmd->data_out_len;
+	if ( burst_len > iscsi->first_burst_len )
+		burst_len = iscsi->first_burst_len;
+	if ( iscsi->status & ISCSI_STATUS_IMMEDIATE_DATA ) {
+		immediate_len = burst_len;
+		if ( immediate_len > iscsi->max_send_len )
+			immediate_len = iscsi->max_send_len;
+	}
 
 	/* Construct BHS and initiate transmission */
 	iscsi_start_tx ( iscsi );
+	iscsi->tx_task = task;
+	task->flags &= ~ISCSI_TASK_TX_COMMAND;
 	command->opcode = ISCSI_OPCODE_SCSI_COMMAND;
 	command->flags = ( ISCSI_FLAG_FINAL |
 			   ISCSI_COMMAND_ATTR_SIMPLE );
-	if ( iscsi->command->data_in )
+	if ( cmd->data_in )
 		command->flags |= ISCSI_COMMAND_FLAG_READ;
-	if ( iscsi->command->data_out )
+	if ( cmd->data_out )
 		command->flags |= ISCSI_COMMAND_FLAG_WRITE;
-	/* lengths left as zero */
-	memcpy ( &command->lun, &iscsi->command->lun,
-		 sizeof ( command->lun ) );
-	command->itt = htonl ( iscsi->itt );
-	command->exp_len = htonl ( iscsi->command->data_in_len |
-				   iscsi->command->data_out_len );
-	command->cmdsn = htonl ( iscsi->cmdsn );
+	ISCSI_SET_LENGTHS ( command->lengths, 0, immediate_len );
+	memcpy ( &command->lun, &cmd->lun, sizeof ( command->lun ) );
+	command->itt = htonl ( task->itt );
+	command->exp_len = htonl ( cmd->data_in_len | cmd->data_out_len );
+	command->cmdsn = htonl ( iscsi->cmdsn++ );
 	command->expstatsn = htonl ( iscsi->statsn + 1 );
-	memcpy ( &command->cdb, &iscsi->command->cdb, sizeof ( command->cdb ));
-	DBGC2 ( iscsi, "iSCSI %p start " SCSI_CDB_FORMAT " %s %#zx\n",
-		iscsi, SCSI_CDB_DATA ( command->cdb ),
-		( iscsi->command->data_in ? "in" : "out" ),
-		( iscsi->command->data_in ?
-		  iscsi->command->data_in_len :
-		  iscsi->command->data_out_len ) );
+	memcpy ( &command->cdb, &cmd->cdb, sizeof ( command->cdb ));
+	DBGC2 ( iscsi, "iSCSI %p ITT %08x start " SCSI_CDB_FORMAT " %s %#zx\n",
+		iscsi, task->itt, SCSI_CDB_DATA ( command->cdb ),
+		( cmd->data_in ? "in" : "out" ),
+		( cmd->data_in ? cmd->data_in_len : cmd->data_out_len ) );
+
+	/* Queue remainder of first burst as unsolicited data, if
+	 * permitted.  This cannot fail, since the transfer queue is
+	 * empty and the transfer lies within the data-out buffer.
+	 */
+	if ( ( iscsi->status & ISCSI_STATUS_NO_INITIAL_R2T ) &&
+	     ( burst_len > immediate_len ) ) {
+		iscsi_queue_transfer ( task, ISCSI_TAG_RESERVED, immediate_len,
+				       ( burst_len - immediate_len ) );
+	}
 }
 
 /**
@@ -419,6 +572,7 @@ static int iscsi_rx_scsi_response ( struct iscsi_session *iscsi,
 				    size_t remaining ) {
 	struct iscsi_bhs_scsi_response *response
 		= &iscsi->rx_bhs.scsi_response;
+	struct iscsi_task *task;
 	struct scsi_rsp rsp;
 	uint32_t residual_count;
 	size_t data_len;
@@ -453,9 +607,13 @@ static int iscsi_rx_scsi_response ( struct iscsi_session *iscsi,
 	if ( response->response != ISCSI_RESPONSE_COMMAND_COMPLETE )
 		return -EIO;
 
+	/* Identify task */
+	task = iscsi_rx_task ( iscsi );
+	if ( ! task )
+		return -EPROTO;
+
 	/* Mark as completed */
-	iscsi_scsi_done ( iscsi, 0, &rsp );
-	return 0;
+	return iscsi_task_done ( task, 0, &rsp );
 }
 
 /**
@@ -471,14 +629,19 @@ static int iscsi_rx_data_in ( struct iscsi_session *iscsi,
 			      const void *data, size_t len,
 			      size_t remaining ) {
 	struct iscsi_bhs_data_in *data_in = &iscsi->rx_bhs.data_in;
+	struct iscsi_task *task;
 	unsigned long offset;
 
+	/* Identify task */
+	task = iscsi_rx_task ( iscsi );
+	if ( ! task )
+		return -EPROTO;
+
 	/* Copy data to data-in buffer */
 	offset = ntohl ( data_in->offset ) + iscsi->rx_offset;
-	assert ( iscsi->command != NULL );
-	assert ( iscsi->command->data_in );
-	assert ( ( offset + len ) <= iscsi->command->data_in_len );
-	copy_to_user ( iscsi->command->data_in, offset, data, len );
+	assert ( task->command.data_in );
+	assert ( ( offset + len ) <= task->command.data_in_len );
+	copy_to_user ( task->command.data_in, offset, data, len );
 
 	/* Wait for whole SCSI response to arrive */
 	if ( remaining )
@@ -486,10 +649,10 @@ static int iscsi_rx_data_in ( struct iscsi_session *iscsi,
 
 	/* Mark as completed if status is present */
 	if ( data_in->flags & ISCSI_DATA_FLAG_STATUS ) {
-		assert ( ( offset + len ) == iscsi->command->data_in_len );
+		assert ( ( offset + len ) == task->command.data_in_len );
 		assert ( data_in->flags & ISCSI_FLAG_FINAL );
 		/* iSCSI cannot return an error status via a data-in */
-		iscsi_scsi_done ( iscsi, 0, NULL );
+		return iscsi_task_done ( task, 0, NULL );
 	}
 
 	return 0;
@@ -508,53 +671,58 @@ static int iscsi_rx_r2t ( struct iscsi_session *iscsi,
 			  const void *data __unused, size_t len __unused,
 			  size_t remaining __unused ) {
 	struct iscsi_bhs_r2t *r2t = &iscsi->rx_bhs.r2t;
+	struct iscsi_task *task;
 
-	/* Record transfer parameters and trigger first data-out */
-	iscsi->ttt = ntohl ( r2t->ttt );
-	iscsi->transfer_offset = ntohl ( r2t->offset );
-	iscsi->transfer_len = ntohl ( r2t->len );
-	iscsi_start_data_out ( iscsi, 0 );
+	/* Identify task */
+	task = iscsi_rx_task ( iscsi );
+	if ( ! task )
+		return -EPROTO;
 
-	return 0;
+	/* Queue transfer */
+	return iscsi_queue_transfer ( task, ntohl ( r2t->ttt ),
+				      ntohl ( r2t->offset ),
+				      ntohl ( r2t->len ) );
 }
 
 /**
  * Build iSCSI data-out BHS
  *
  * @v iscsi		iSCSI session
- * @v datasn		Data sequence number within the transfer
+ * @v task		iSCSI task
  *
+ * Data-out PDUs are sized to fit the target's maximum receive data
+ * segment length.
  */
 static void iscsi_start_data_out ( struct iscsi_session *iscsi,
-				   unsigned int datasn ) {
+				   struct iscsi_task *task ) {
 	struct iscsi_bhs_data_out *data_out = &iscsi->tx_bhs.data_out;
-	unsigned long offset;
-	unsigned long remaining;
-	unsigned long len;
+	struct iscsi_transfer *transfer;
+	size_t remaining;
+	size_t len;
 
-	/* We always send 512-byte Data-Out PDUs; this removes the
-	 * need to worry about the target's MaxRecvDataSegmentLength.
-	 */
-	offset = datasn * 512;
-	remaining = iscsi->transfer_len - offset;
+	/* Calculate length of this PDU within the current transfer */
+	assert ( task->transfer_cons != task->transfer_prod );
+	transfer = &task->transfer[ task->transfer_cons % ISCSI_MAX_TRANSFERS ];
+	remaining = ( transfer->len - task->transfer_sent );
 	len = remaining;
-	if ( len > 512 )
-		len = 512;
+	if ( len > iscsi->max_send_len )
+		len = iscsi->max_send_len;
 
 	/* Construct BHS and initiate transmission */
 	iscsi_start_tx ( iscsi );
+	iscsi->tx_task = task;
 	data_out->opcode = ISCSI_OPCODE_DATA_OUT;
 	if ( len == remaining )
 		data_out->flags = ( ISCSI_FLAG_FINAL );
 	ISCSI_SET_LENGTHS ( data_out->lengths, 0, len );
-	data_out->lun = iscsi->command->lun;
-	data_out->itt = htonl ( iscsi->itt );
-	data_out->ttt = htonl ( iscsi->ttt );
+	data_out->lun = task->command.lun;
+	data_out->itt = htonl ( task->itt );
+	data_out->ttt = htonl ( transfer->ttt );
 	data_out->expstatsn = htonl ( iscsi->statsn + 1 );
-	data_out->datasn = htonl ( datasn );
-	data_out->offset = htonl ( iscsi->transfer_offset + offset );
-	DBGC ( iscsi, "iSCSI %p start data out DataSN %#x len %#lx\n",
-	       iscsi, datasn, len );
+	data_out->datasn = htonl ( task->datasn );
+	data_out->offset = htonl ( transfer->offset + task->transfer_sent );
+	DBGC2 ( iscsi, "iSCSI %p ITT %08x start data out DataSN %#x len "
+		"%#zx\n", iscsi, task->itt, task->datasn, len );
 }
 
 /**
@@ -565,46 +733,93 @@ static void iscsi_start_data_out ( struct iscsi_session *iscsi,
  */
 static void iscsi_data_out_done ( struct iscsi_session *iscsi ) {
 	struct iscsi_bhs_data_out *data_out = &iscsi->tx_bhs.data_out;
+	struct iscsi_task *task = iscsi->tx_task;
+
+	/* Record progress through the current transfer */
+	task->transfer_sent += ISCSI_DATA_LEN ( data_out->lengths );
+	task->datasn++;
 
-	/* If we haven't reached the end of the sequence, start
-	 * sending the next data-out PDU.
+	/* Move to next transfer if we have reached the end of the
+	 * sequence.
 	 */
-	if ( ! ( data_out->flags & ISCSI_FLAG_FINAL ) )
-		iscsi_start_data_out ( iscsi, ntohl ( data_out->datasn ) + 1 );
+	if ( data_out->flags & ISCSI_FLAG_FINAL ) {
+		task->transfer_cons++;
+		task->transfer_sent = 0;
+		task->datasn = 0;
+	}
 }
 
 /**
- * Send iSCSI data-out data segment
+ * Send iSCSI write data segment
  *
  * @v iscsi		iSCSI session
+ * @v offset		Offset within data-out buffer
  * @ret rc		Return status code
  */
-static int iscsi_tx_data_out ( struct iscsi_session *iscsi ) {
-	struct iscsi_bhs_data_out *data_out = &iscsi->tx_bhs.data_out;
+static int iscsi_tx_write_data ( struct iscsi_session *iscsi,
+				 size_t offset ) {
+	struct iscsi_bhs_common *common = &iscsi->tx_bhs.common;
+	struct iscsi_task *task = iscsi->tx_task;
 	struct io_buffer *iobuf;
-	unsigned long offset;
+	uint32_t digest;
 	size_t len;
 	size_t pad_len;
 
-	offset = ntohl ( data_out->offset );
-	len = ISCSI_DATA_LEN ( data_out->lengths );
-	pad_len = ISCSI_DATA_PAD_LEN ( data_out->lengths );
+	len = ISCSI_DATA_LEN ( common->lengths );
+	pad_len = ISCSI_DATA_PAD_LEN ( common->lengths );
 
-	assert ( iscsi->command != NULL );
-	assert ( iscsi->command->data_out );
-	assert ( ( offset + len ) <= iscsi->command->data_out_len );
+	assert ( task != NULL );
+	assert ( task->command.data_out );
+	assert ( ( offset + len ) <= task->command.data_out_len );
 
-	iobuf = xfer_alloc_iob ( &iscsi->socket, ( len + pad_len ) );
+	iobuf = xfer_alloc_iob ( &iscsi->socket,
+				 ( len + pad_len + ISCSI_DIGEST_LEN ) );
 	if ( ! iobuf )
 		return -ENOMEM;
 	
 	copy_from_user ( iob_put ( iobuf, len ),
-			 iscsi->command->data_out, offset, len );
+			 task->command.data_out, offset, len );
 	memset ( iob_put ( iobuf, pad_len ), 0, pad_len );
 
+	/* Append data digest, if applicable */
+	if ( iscsi->tx_digests & ISCSI_STATUS_DATA_DIGEST ) {
+		digest = iscsi_digest ( iobuf->data, iob_len ( iobuf ) );
+		memcpy ( iob_put ( iobuf, sizeof ( digest ) ), &digest,
+			 sizeof ( digest ) );
+	}
+
 	return xfer_deliver_iob ( &iscsi->socket, iobuf );
 }
 
+/**
+ * Send iSCSI data-out data segment
+ *
+ * @v iscsi		iSCSI session
+ * @ret rc		Return status code
+ */
+static int iscsi_tx_data_out ( struct iscsi_session *iscsi ) {
+	struct iscsi_bhs_data_out *data_out = &iscsi->tx_bhs.data_out;
+
+	return iscsi_tx_write_data ( iscsi, ntohl ( data_out->offset ) );
+}
+
+/**
+ * Send iSCSI SCSI command immediate data segment
+ *
+ * @v iscsi		iSCSI session
+ * @ret rc		Return status code
+ */
+static int iscsi_tx_command ( struct iscsi_session *iscsi ) {
+	struct iscsi_bhs_scsi_command *command = &iscsi->tx_bhs.scsi_command;
+
+	/* Do nothing unless there is immediate data */
+	if ( ! ISCSI_DATA_LEN ( command->lengths ) )
+		return 0;
+
+	/* Immediate data always starts at the beginning of the buffer */
+	return iscsi_tx_write_data ( iscsi, 0 );
+}
+
 /**
  * Receive data segment of an iSCSI NOP-In
  *
@@ -651,24 +866,27 @@ static int iscsi_rx_nop_in ( struct iscsi_session *iscsi,
  * These are the initial set of strings sent in the first login
  * request PDU.  We want the following settings:
  *
- *     HeaderDigest=None
- *     DataDigest=None
+ *     HeaderDigest=None,CRC32C [6]
+ *     DataDigest=None,CRC32C [6]
  *     MaxConnections=1 (irrelevant; we make only one connection anyway) [4]
- *     InitialR2T=Yes [1]
- *     ImmediateData=No (irrelevant; we never send immediate data) [4]
- *     MaxRecvDataSegmentLength=8192 (default; we don't care) [3]
+ *     InitialR2T=No [1]
+ *     ImmediateData=Yes [1]
+ *     MaxRecvDataSegmentLength=262144 [5]
  *     MaxBurstLength=262144 (default; we don't care) [3]
- *     FirstBurstLength=65536 (irrelevant due to other settings) [5]
+ *     FirstBurstLength=65536 (default; we don't care) [3]
  *     DefaultTime2Wait=0 [2]
  *     DefaultTime2Retain=0 [2]
- *     MaxOutstandingR2T=1
+ *     MaxOutstandingR2T=4 [1]
  *     DataPDUInOrder=Yes
  *     DataSequenceInOrder=Yes
  *     ErrorRecoveryLevel=0
  *
- * [1] InitialR2T has an OR resolution function, so the target may
- * force us to use it.  We therefore simplify our logic by always
- * using it.
+ * [1] These allow the first burst of write data to be sent without
+ * waiting for an R2T, and allow the target to request the remaining
+ * data in several concurrent bursts.  InitialR2T has an OR resolution
+ * function and ImmediateData has an AND resolution function, so the
+ * target may force us to wait for R2Ts.  We therefore send unsolicited
+ * data only if the target explicitly agrees.
  *
  * [2] These ensure that we can safely start a new task once we have
  * reconnected after a failure, without having to manually tidy up
@@ -684,10 +902,15 @@ static int iscsi_rx_nop_in ( struct iscsi_session *iscsi,
  * unless they are supplied, so we explicitly specify the default
  * values.
  *
- * [5] FirstBurstLength is defined to be irrelevant since we already
- * force InitialR2T=Yes and ImmediateData=No, but some targets
- * (notably LIO as of kernel 4.11) fail unless it is specified, so we
- * explicitly specify the default value.
+ * [5] We process received data segments as they arrive, so we can
+ * accept much larger data-in PDUs than the default 8192 bytes.  This
+ * is a declarative value, and is independent of the target's own
+ * MaxRecvDataSegmentLength (which limits the size of the data-out
+ * PDUs that we send).
+ *
+ * [6] We prefer not to use digests, but will use CRC32C digests if
+ * the target requires them.  Digests are calculated using hardware
+ * CRC32C instructions where available.
  */
 static int iscsi_build_login_request_strings ( struct iscsi_session *iscsi,
 					       void *data, size_t len ) {
@@ -739,17 +962,17 @@ static int iscsi_build_login_request_strings ( struct iscsi_session *iscsi,
 
 	if ( iscsi->status & ISCSI_STATUS_STRINGS_OPERATIONAL ) {
 		used += ssnprintf ( data + used, len - used,
-				    "HeaderDigest=None%c"
-				    "DataDigest=None%c"
+				    "HeaderDigest=None,CRC32C%c"
+				    "DataDigest=None,CRC32C%c"
 				    "MaxConnections=1%c"
-				    "InitialR2T=Yes%c"
-				    "ImmediateData=No%c"
+				    "InitialR2T=No%c"
+				    "ImmediateData=Yes%c"
 				    "MaxRecvDataSegmentLength=%d%c"
 				    "MaxBurstLength=%d%c"
 				    "FirstBurstLength=%d%c"
 				    "DefaultTime2Wait=0%c"
 				    "DefaultTime2Retain=0%c"
-				    "MaxOutstandingR2T=1%c"
+				    "MaxOutstandingR2T=%d%c"
 				    "DataPDUInOrder=Yes%c"
 				    "DataSequenceInOrder=Yes%c"
 				    "ErrorRecoveryLevel=0%c",
@@ -757,7 +980,8 @@ static int iscsi_build_login_request_strings ( struct iscsi_session *iscsi,
 				    ISCSI_MAX_RECV_DATA_SEG_LEN, 0,
 				    ISCSI_MAX_BURST_LEN, 0,
 				    ISCSI_FIRST_BURST_LEN, 0,
-				    0, 0, 0, 0, 0, 0 );
+				    0, 0, ISCSI_MAX_OUTSTANDING_R2T, 0,
+				    0, 0, 0 );
 	}
 
 	return used;
@@ -945,6 +1169,154 @@ static int iscsi_handle_maxburstlength_value ( struct iscsi_session *iscsi,
 	return 0;
 }
 
+/**
+ * Handle iSCSI FirstBurstLength text value
+ *
+ * @v iscsi		iSCSI session
+ * @v value		FirstBurstLength value
+ * @ret rc		Return status code
+ */
+static int iscsi_handle_firstburstlength_value ( struct iscsi_session *iscsi,
+						 const char *value ) {
+	unsigned long first_burst_len;
+	char *end;
+
+	/* Update first burst length */
+	first_burst_len = strtoul ( value, &end, 0 );
+	if ( *end ) {
+		DBGC ( iscsi, "iSCSI %p invalid FirstBurstLength \"%s\"\n",
+		       iscsi, value );
+		return -EINVAL_FIRSTBURSTLENGTH;
+	}
+	if ( first_burst_len < iscsi->first_burst_len )
+		iscsi->first_burst_len = first_burst_len;
+
+	return 0;
+}
+
+/**
+ * Handle iSCSI MaxRecvDataSegmentLength text value
+ *
+ * @v iscsi		iSCSI session
+ * @v value		MaxRecvDataSegmentLength value
+ * @ret rc		Return status code
+ *
+ * This is a declarative value describing the largest data segment
+ * that the target is prepared to receive.
+ */
+static int
+iscsi_handle_maxrecvdatasegmentlength_value ( struct iscsi_session *iscsi,
+					      const char *value ) {
+	unsigned long max_send_len;
+	char *end;
+
+	/* Update maximum data segment length that we may send */
+	max_send_len = strtoul ( value, &end, 0 );
+	if ( *end || ( ! max_send_len ) ) {
+		DBGC ( iscsi, "iSCSI %p invalid MaxRecvDataSegmentLength "
+		       "\"%s\"\n", iscsi, value );
+		return -EINVAL_MAXRECVDATASEGMENTLENGTH;
+	}
+	if ( max_send_len > ISCSI_MAX_SEND_DATA_SEG_LEN )
+		max_send_len = ISCSI_MAX_SEND_DATA_SEG_LEN;
+	iscsi->max_send_len = max_send_len;
+
+	return 0;
+}
+
+/**
+ * Handle iSCSI InitialR2T text value
+ *
+ * @v iscsi		iSCSI session
+ * @v value		InitialR2T value
+ * @ret rc		Return status code
+ */
+static int iscsi_handle_initialr2t_value ( struct iscsi_session *iscsi,
+					   const char *value ) {
+
+	/* Allow unsolicited data-out PDUs only if explicitly agreed */
+	if ( strcmp ( value, "No" ) == 0 ) {
+		iscsi->status |= ISCSI_STATUS_NO_INITIAL_R2T;
+	} else {
+		iscsi->status &= ~ISCSI_STATUS_NO_INITIAL_R2T;
+	}
+
+	return 0;
+}
+
+/**
+ * Handle iSCSI ImmediateData text value
+ *
+ * @v iscsi		iSCSI session
+ * @v value		ImmediateData value
+ * @ret rc		Return status code
+ */
+static int iscsi_handle_immediatedata_value ( struct iscsi_session *iscsi,
+					      const char *value ) {
+
+	/* Allow immediate data only if explicitly agreed */
+	if ( strcmp ( value, "Yes" ) == 0 ) {
+		iscsi->status |= ISCSI_STATUS_IMMEDIATE_DATA;
+	} else {
+		iscsi->status &= ~ISCSI_STATUS_IMMEDIATE_DATA;
+	}
+
+	return 0;
+}
+
+/**
+ * Handle iSCSI HeaderDigest or DataDigest text value
+ *
+ * @v iscsi		iSCSI session
+ * @v value		Digest value
+ * @v flag		Digest status flag
+ * @ret rc		Return status code
+ */
+static int iscsi_handle_digest_value ( struct iscsi_session *iscsi,
+				       const char *value, unsigned int flag ) {
+
+	/* Check for a digest that we offered */
+	if ( strcmp ( value, "CRC32C" ) == 0 ) {
+		iscsi->status |= flag;
+	} else if ( strcmp ( value, "None" ) == 0 ) {
+		iscsi->status &= ~flag;
+	} else {
+		DBGC ( iscsi, "iSCSI %p invalid digest \"%s\"\n",
+		       iscsi, value );
+		return -EPROTO;
+	}
+
+	return 0;
+}
+
+/**
+ * Handle iSCSI HeaderDigest text value
+ *
+ * @v iscsi		iSCSI session
+ * @v value		HeaderDigest value
+ * @ret rc		Return status code
+ */
+static int iscsi_handle_headerdigest_value ( struct iscsi_session *iscsi,
+					     const char *value ) {
+
+	return iscsi_handle_digest_value ( iscsi, value,
+					   ISCSI_STATUS_HEADER_DIGEST );
+}
+
+/**
+ * Handle iSCSI DataDigest text value
+ *
+ * @v iscsi		iSCSI session
+ * @v value		DataDigest value
+ * @ret rc		Return status code
+ */
+static int iscsi_handle_datadigest_value ( struct iscsi_session *iscsi,
+					   const char *value ) {
+
+	return iscsi_handle_digest_value ( iscsi, value,
+					   ISCSI_STATUS_DATA_DIGEST );
+}
+
 /**
  * Handle iSCSI CHAP_A text value
  *
@@ -1186,6 +1558,13 @@ struct iscsi_string_type {
 static struct iscsi_string_type iscsi_string_types[] = {
 	{ "TargetAddress", iscsi_handle_targetaddress_value },
 	{ "MaxBurstLength", iscsi_handle_maxburstlength_value },
+	{ "FirstBurstLength", iscsi_handle_firstburstlength_value },
+	{ "MaxRecvDataSegmentLength",
+	  iscsi_handle_maxrecvdatasegmentlength_value },
+	{ "InitialR2T", iscsi_handle_initialr2t_value },
+	{ "ImmediateData", iscsi_handle_immediatedata_value },
+	{ "HeaderDigest", iscsi_handle_headerdigest_value },
+	{ "DataDigest", iscsi_handle_datadigest_value },
 	{ "AuthMethod", iscsi_handle_authmethod_value },
 	{ "CHAP_A", iscsi_handle_chap_a_value },
 	{ "CHAP_I", iscsi_handle_chap_i_value },
@@ -1443,6 +1822,9 @@ static void iscsi_start_tx ( struct iscsi_session *iscsi ) {
 	/* Initialise TX BHS */
 	memset ( &iscsi->tx_bhs, 0, sizeof ( iscsi->tx_bhs ) );
 
+	/* Record digests in use for this PDU */
+	iscsi->tx_digests = iscsi_digests ( iscsi );
+
 	/* Flag TX engine to start transmitting */
 	iscsi->tx_state = ISCSI_TX_BHS;
 
@@ -1467,8 +1849,20 @@ static int iscsi_tx_nothing ( struct iscsi_session *iscsi __unused ) {
  * @ret rc		Return status code
  */
 static int iscsi_tx_bhs ( struct iscsi_session *iscsi ) {
-	return xfer_deliver_raw ( &iscsi->socket,  &iscsi->tx_bhs,
-				  sizeof ( iscsi->tx_bhs ) );
+	struct {
+		union iscsi_bhs bhs;
+		uint32_t digest;
+	} __attribute__ (( packed )) hdr;
+	size_t len = sizeof ( hdr.bhs );
+
+	/* Append header digest, if applicable */
+	memcpy ( &hdr.bhs, &iscsi->tx_bhs, sizeof ( hdr.bhs ) );
+	if ( iscsi->tx_digests & ISCSI_STATUS_HEADER_DIGEST ) {
+		hdr.digest = iscsi_digest ( &hdr.bhs, sizeof ( hdr.bhs ) );
+		len += sizeof ( hdr.digest );
+	}
+
+	return xfer_deliver_raw ( &iscsi->socket, &hdr, len );
 }
 
 /**
@@ -1484,6 +1878,8 @@ static int iscsi_tx_data ( struct iscsi_session *iscsi ) {
 	struct iscsi_bhs_common *common = &iscsi->tx_bhs.common;
 
 	switch ( common->opcode & ISCSI_OPCODE_MASK ) {
+	case ISCSI_OPCODE_SCSI_COMMAND:
+		return iscsi_tx_command ( iscsi );
 	case ISCSI_OPCODE_DATA_OUT:
 		return iscsi_tx_data_out ( iscsi );
 	case ISCSI_OPCODE_LOGIN_REQUEST:
@@ -1520,6 +1916,48 @@ static void iscsi_tx_done ( struct iscsi_session *iscsi ) {
 		/* No action */
 		break;
 	}
+
+	/* Start transmitting next PDU, if any */
+	iscsi->tx_task = NULL;
+	iscsi_tx_next ( iscsi );
+}
+
+/**
+ * Start transmitting next iSCSI PDU, if any
+ *
+ * @v iscsi		iSCSI session
+ *
+ * SCSI command PDUs take priority over data-out PDUs, so that new
+ * commands are not delayed behind large writes.  Commands are
+ * subject to the target's command window.
+ */
+static void iscsi_tx_next ( struct iscsi_session *iscsi ) {
+	struct iscsi_task *task;
+	unsigned int i;
+
+	/* Do nothing if a PDU is already being transmitted */
+	if ( iscsi->tx_state != ISCSI_TX_IDLE )
+		return;
+
+	/* Send any pending SCSI command PDUs */
+	if ( ( ( int32_t ) ( iscsi->max_cmdsn - iscsi->cmdsn ) ) >= 0 ) {
+		for ( i = 0 ; i < ISCSI_MAX_TASKS ; i++ ) {
+			task = &iscsi->task[i];
+			if ( task->flags & ISCSI_TASK_TX_COMMAND ) {
+				iscsi_start_command ( iscsi, task );
+				return;
+			}
+		}
+	}
+
+	/* Send any pending data-out PDUs */
+	for ( i = 0 ; i < ISCSI_MAX_TASKS ; i++ ) {
+		task = &iscsi->task[i];
+		if ( task->transfer_cons != task->transfer_prod ) {
+			iscsi_start_data_out ( iscsi, task );
+			return;
+		}
+	}
 }
 
 /**
@@ -1596,7 +2034,8 @@ static void iscsi_tx_step ( struct iscsi_session *iscsi ) {
 
 /** iSCSI TX process descriptor */
 static struct process_descriptor iscsi_process_desc =
-	PROC_DESC ( struct iscsi_session, process, iscsi_tx_step );
+	PROC_DESC_PRIO ( struct iscsi_session, process, iscsi_tx_step,
+			 PROC_PRIO_NET );
 
 /**
  * Receive basic header segment of an iSCSI PDU
@@ -1639,6 +2078,46 @@ static int iscsi_rx_discard ( struct iscsi_session *iscsi __unused,
 	return 0;
 }
 
+/**
+ * Receive header or data digest of an iSCSI PDU
+ *
+ * @v iscsi		iSCSI session
+ * @v data		Received data
+ * @v len		Length of received data
+ * @v remaining		Data remaining after this data
+ * @ret rc		Return status code
+ *
+ * This verifies the received digest against the CRC32C accumulated
+ * over the preceding header or data segment.
+ */
+static int iscsi_rx_digest ( struct iscsi_session *iscsi, const void *data,
+			     size_t len, size_t remaining ) {
+	int is_header = ( iscsi->rx_state == ISCSI_RX_HEADER_DIGEST );
+	uint32_t expected;
+
+	/* Do nothing unless a digest is present */
+	if ( ! iscsi->rx_len )
+		return 0;
+
+	/* Accumulate received digest */
+	memcpy ( ( ( ( void * ) &iscsi->rx_digest ) + iscsi->rx_offset ),
+		 data, len );
+	if ( remaining )
+		return 0;
+
+	/* Verify digest */
+	expected = cpu_to_le32 ( ~iscsi->rx_crc );
+	if ( iscsi->rx_digest != expected ) {
+		DBGC ( iscsi, "iSCSI %p %s digest mismatch (got %08x, "
+		       "expected %08x)\n", iscsi, ( is_header ? "header" :
+		       "data" ), le32_to_cpu ( iscsi->rx_digest ),
+		       le32_to_cpu ( expected ) );
+		return ( is_header ? -EIO_HEADER_DIGEST : -EIO_DATA_DIGEST );
+	}
+
+	return 0;
+}
+
 /**
  * Receive data segment of an iSCSI PDU
  *
@@ -1655,10 +2134,34 @@ static int iscsi_rx_data ( struct iscsi_session *iscsi, const void *data,
 			   size_t len, size_t remaining ) {
 	struct iscsi_bhs_common_response *response
 		= &iscsi->rx_bhs.common_response;
+	uint32_t max_cmdsn = ntohl ( response->maxcmdsn );
 
-	/* Update cmdsn and statsn */
-	iscsi->cmdsn = ntohl ( response->expcmdsn );
-	iscsi->statsn = ntohl ( response->statsn );
+	/* Update command window.  During login, the next CmdSN is
+	 * dictated by the target; thereafter we maintain it ourselves
+	 * since there may be several commands in flight.
+	 */
+	if ( ( iscsi->status & ISCSI_STATUS_PHASE_MASK ) !=
+	     ISCSI_STATUS_FULL_FEATURE_PHASE ) {
+		iscsi->cmdsn = ntohl ( response->expcmdsn );
+		iscsi->max_cmdsn = max_cmdsn;
+	} else if ( ( ( int32_t ) ( max_cmdsn - iscsi->max_cmdsn ) ) > 0 ) {
+		iscsi->max_cmdsn = max_cmdsn;
+		iscsi_tx_next ( iscsi );
+	}
+
+	/* Update statsn, if this PDU carries status */
+	switch ( response->opcode & ISCSI_OPCODE_MASK ) {
+	case ISCSI_OPCODE_DATA_IN:
+		if ( ! ( response->flags & ISCSI_DATA_FLAG_STATUS ) )
+			break;
+		/* Fall through */
+	case ISCSI_OPCODE_LOGIN_RESPONSE:
+	case ISCSI_OPCODE_SCSI_RESPONSE:
+		iscsi->statsn = ntohl ( response->statsn );
+		break;
+	default:
+		break;
+	}
 
 	switch ( response->opcode & ISCSI_OPCODE_MASK ) {
 	case ISCSI_OPCODE_LOGIN_RESPONSE:
@@ -1694,6 +2197,10 @@ static int iscsi_rx_data ( struct iscsi_session *iscsi, const void *data,
  * portion as it arrives.  The data processing routine therefore
  * always has a full copy of the BHS available, even for portions of
  * the data in different packets to the BHS.
+ *
+ * If a data digest is in use, the data processing routine will not
+ * see the end of the data segment until the digest has been
+ * verified, so that a corrupted PDU can never complete a command.
  */
 static int iscsi_socket_deliver ( struct iscsi_session *iscsi,
 				  struct io_buffer *iobuf,
@@ -1702,30 +2209,61 @@ static int iscsi_socket_deliver ( struct iscsi_session *iscsi,
 	int ( * rx ) ( struct iscsi_session *iscsi, const void *data,
 		       size_t len, size_t remaining );
 	enum iscsi_rx_state next_state;
+	unsigned int digest;
+	size_t data_digest_len;
 	size_t frag_len;
 	size_t remaining;
 	int rc;
 
 	while ( 1 ) {
+
+		/* Record digests in use at start of PDU */
+		if ( ( iscsi->rx_state == ISCSI_RX_BHS ) &&
+		     ( iscsi->rx_offset == 0 ) ) {
+			iscsi->rx_digests = iscsi_digests ( iscsi );
+		}
+		data_digest_len =
+			( ( ( iscsi->rx_digests & ISCSI_STATUS_DATA_DIGEST ) &&
+			    ISCSI_DATA_LEN ( common->lengths ) ) ?
+			  ISCSI_DIGEST_LEN : 0 );
+
 		switch ( iscsi->rx_state ) {
 		case ISCSI_RX_BHS:
 			rx = iscsi_rx_bhs;
 			iscsi->rx_len = sizeof ( iscsi->rx_bhs );
+			digest = ISCSI_STATUS_HEADER_DIGEST;
 			next_state = ISCSI_RX_AHS;			
 			break;
 		case ISCSI_RX_AHS:
 			rx = iscsi_rx_discard;
 			iscsi->rx_len = 4 * ISCSI_AHS_LEN ( common->lengths );
+			digest = ISCSI_STATUS_HEADER_DIGEST;
+			next_state = ISCSI_RX_HEADER_DIGEST;
+			break;
+		case ISCSI_RX_HEADER_DIGEST:
+			rx = iscsi_rx_digest;
+			iscsi->rx_len = ( ( iscsi->rx_digests &
+					    ISCSI_STATUS_HEADER_DIGEST ) ?
+					  ISCSI_DIGEST_LEN : 0 );
+			digest = 0;
 			next_state = ISCSI_RX_DATA;
 			break;
 		case ISCSI_RX_DATA:
 			rx = iscsi_rx_data;
 			iscsi->rx_len = ISCSI_DATA_LEN ( common->lengths );
+			digest = ISCSI_STATUS_DATA_DIGEST;
 			next_state = ISCSI_RX_DATA_PADDING;
 			break;
 		case ISCSI_RX_DATA_PADDING:
 			rx = iscsi_rx_discard;
 			iscsi->rx_len = ISCSI_DATA_PAD_LEN ( common->lengths );
+			digest = ISCSI_STATUS_DATA_DIGEST;
+			next_state = ISCSI_RX_DATA_DIGEST;
+			break;
+		case ISCSI_RX_DATA_DIGEST:
+			rx = iscsi_rx_digest;
+			iscsi->rx_len = data_digest_len;
+			digest = 0;
 			next_state = ISCSI_RX_BHS;
 			break;
 		default:
@@ -1734,10 +2272,23 @@ static int iscsi_socket_deliver ( struct iscsi_session *iscsi,
 			goto done;
 		}
 
+		/* Start accumulating CRC at start of header or data */
+		if ( ( ( iscsi->rx_state == ISCSI_RX_BHS ) ||
+		       ( iscsi->rx_state == ISCSI_RX_DATA ) ) &&
+		     ( iscsi->rx_offset == 0 ) ) {
+			iscsi->rx_crc = 0xffffffffUL;
+		}
+
 		frag_len = iscsi->rx_len - iscsi->rx_offset;
 		if ( frag_len > iob_len ( iobuf ) )
 			frag_len = iob_len ( iobuf );
 		remaining = iscsi->rx_len - iscsi->rx_offset - frag_len;
+		if ( iscsi->rx_state == ISCSI_RX_DATA )
+			remaining += data_digest_len;
+		if ( iscsi->rx_digests & digest ) {
+			iscsi->rx_crc = crc32c_le ( iscsi->rx_crc,
+						    iobuf->data, frag_len );
+		}
 		if ( ( rc = rx ( iscsi, iobuf->data, frag_len,
 				 remaining ) ) != 0 ) {
 			DBGC ( iscsi, "iSCSI %p could not process received "
@@ -1756,6 +2307,22 @@ static int iscsi_socket_deliver ( struct iscsi_session *iscsi,
 			goto done;
 		}
 
+		/* Complete processing of a data segment once its
+		 * digest has been verified.
+		 */
+		if ( ( iscsi->rx_state == ISCSI_RX_DATA_DIGEST ) &&
+		     data_digest_len ) {
+			iscsi->rx_len = ISCSI_DATA_LEN ( common->lengths );
+			iscsi->rx_offset = iscsi->rx_len;
+			rc = iscsi_rx_data ( iscsi, NULL, 0, 0 );
+			if ( rc != 0 ) {
+				DBGC ( iscsi, "iSCSI %p could not process "
+				       "received data: %s\n",
+				       iscsi, strerror ( rc ) );
+				goto done;
+			}
+		}
+
 		iscsi->rx_state = next_state;
 		iscsi->rx_offset = 0;
 	}
@@ -1836,15 +2403,21 @@ static struct interface_descriptor iscsi_socket_desc =
  * @ret len		Length of window
  */
 static size_t iscsi_scsi_window ( struct iscsi_session *iscsi ) {
+	unsigned int i;
+	size_t len = 0;
 
-	if ( ( ( iscsi->status & ISCSI_STATUS_PHASE_MASK ) ==
-	       ISCSI_STATUS_FULL_FEATURE_PHASE ) &&
-	     ( iscsi->command == NULL ) ) {
-		/* We cannot handle concurrent commands */
-		return 1;
-	} else {
+	/* Cannot accept commands before login is complete */
+	if ( ( iscsi->status & ISCSI_STATUS_PHASE_MASK ) !=
+	     ISCSI_STATUS_FULL_FEATURE_PHASE )
 		return 0;
+
+	/* Count unused tasks */
+	for ( i = 0 ; i < ISCSI_MAX_TASKS ; i++ ) {
+		if ( ! ( iscsi->task[i].flags & ISCSI_TASK_ACTIVE ) )
+			len++;
 	}
+
+	return len;
 }
 
 /**
@@ -1858,31 +2431,41 @@ static size_t iscsi_scsi_window ( struct iscsi_session *iscsi ) {
 static int iscsi_scsi_command ( struct iscsi_session *iscsi,
 				struct interface *parent,
 				struct scsi_cmd *command ) {
+	struct iscsi_task *task;
+	unsigned int i;
 
-	/* This iSCSI implementation cannot handle multiple concurrent
-	 * commands or commands arriving before login is complete.
+	/* This iSCSI implementation cannot handle commands arriving
+	 * before login is complete, or more than a fixed number of
+	 * concurrent commands.
 	 */
 	if ( iscsi_scsi_window ( iscsi ) == 0 ) {
-		DBGC ( iscsi, "iSCSI %p cannot handle concurrent commands\n",
-		       iscsi );
+		DBGC ( iscsi, "iSCSI %p cannot handle further concurrent "
+		       "commands\n", iscsi );
 		return -EOPNOTSUPP;
 	}
 
-	/* Store command */
-	iscsi->command = malloc ( sizeof ( *command ) );
-	if ( ! iscsi->command )
-		return -ENOMEM;
-	memcpy ( iscsi->command, command, sizeof ( *command ) );
+	/* Find an unused task */
+	for ( i = 0 ; i < ISCSI_MAX_TASKS ; i++ ) {
+		task = &iscsi->task[i];
+		if ( ! ( task->flags & ISCSI_TASK_ACTIVE ) )
+			break;
+	}
+	assert ( i < ISCSI_MAX_TASKS );
 
-	/* Assign new ITT */
-	iscsi_new_itt ( iscsi );
+	/* Store command and assign new ITT */
+	memcpy ( &task->command, command, sizeof ( task->command ) );
+	task->itt = iscsi_new_itt();
+	task->flags = ( ISCSI_TASK_ACTIVE | ISCSI_TASK_TX_COMMAND );
+	task->transfer_prod = task->transfer_cons = 0;
+	task->transfer_sent = 0;
+	task->datasn = 0;
 
-	/* Start sending command */
-	iscsi_start_command ( iscsi );
+	/* Start sending command, if possible */
+	iscsi_tx_next ( iscsi );
 
 	/* Attach to parent interface and return */
-	intf_plug_plug ( &iscsi->data, parent );
-	return iscsi->itt;
+	intf_plug_plug ( &task->data, parent );
+	return task->itt;
 }
 
 /**
@@ -1929,31 +2512,32 @@ static struct interface_descriptor iscsi_control_desc =
 	INTF_DESC ( struct iscsi_session, control, iscsi_control_op );
 
 /**
- * Close iSCSI command
+ * Close iSCSI task
  *
- * @v iscsi		iSCSI session
+ * @v task		iSCSI task
  * @v rc		Reason for close
  */
-static void iscsi_command_close ( struct iscsi_session *iscsi, int rc ) {
+static void iscsi_task_close ( struct iscsi_task *task, int rc ) {
+	struct iscsi_session *iscsi = task->iscsi;
 
 	/* Restart interface */
-	intf_restart ( &iscsi->data, rc );
+	intf_restart ( &task->data, rc );
 
 	/* Treat unsolicited command closures mid-command as fatal,
 	 * because we have no code to handle partially-completed PDUs.
 	 */
-	if ( iscsi->command != NULL )
+	if ( task->flags & ISCSI_TASK_ACTIVE )
 		iscsi_close ( iscsi, ( ( rc == 0 ) ? -ECANCELED : rc ) );
 }
 
 /** iSCSI SCSI command interface operations */
-static struct interface_operation iscsi_data_op[] = {
-	INTF_OP ( intf_close, struct iscsi_session *, iscsi_command_close ),
+static struct interface_operation iscsi_task_op[] = {
+	INTF_OP ( intf_close, struct iscsi_task *, iscsi_task_close ),
 };
 
 /** iSCSI SCSI command interface descriptor */
-static struct interface_descriptor iscsi_data_desc =
-	INTF_DESC ( struct iscsi_session, data, iscsi_data_op );
+static struct interface_descriptor iscsi_task_desc =
+	INTF_DESC ( struct iscsi_task, data, iscsi_task_op );
 
 /****************************************************************************
  *
@@ -2173,6 +2757,7 @@ static int iscsi_check_auth ( struct iscsi_session *iscsi ) {
  */
 static int iscsi_open ( struct interface *parent, struct uri *uri ) {
 	struct iscsi_session *iscsi;
+	unsigned int i;
 	int rc;
 
 	/* Sanity check */
@@ -2189,8 +2774,12 @@ static int iscsi_open ( struct interface *parent, struct uri *uri ) {
 	}
 	ref_init ( &iscsi->refcnt, iscsi_free );
 	intf_init ( &iscsi->control, &iscsi_control_desc, &iscsi->refcnt );
-	intf_init ( &iscsi->data, &iscsi_data_desc, &iscsi->refcnt );
 	intf_init ( &iscsi->socket, &iscsi_socket_desc, &iscsi->refcnt );
+	for ( i = 0 ; i < ISCSI_MAX_TASKS ; i++ ) {
+		iscsi->task[i].iscsi = iscsi;
+		intf_init ( &iscsi->task[i].data, &iscsi_task_desc,
+			    &iscsi->refcnt );
+	}
 	process_init_stopped ( &iscsi->process, &iscsi_process_desc,
 			       &iscsi->refcnt );
 	acpi_init ( &iscsi->desc, &ibft_model, &iscsi->refcnt );
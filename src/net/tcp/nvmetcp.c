@@ -0,0 +1,1715 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <byteswap.h>
+#include <errno.h>
+#include <assert.h>
+#include <ipxe/uri.h>
+#include <ipxe/iobuf.h>
+#include <ipxe/xfer.h>
+#include <ipxe/open.h>
+#include <ipxe/socket.h>
+#include <ipxe/tcpip.h>
+#include <ipxe/timer.h>
+#include <ipxe/settings.h>
+#include <ipxe/features.h>
+#include <ipxe/blockdev.h>
+#include <ipxe/efi/efi_path.h>
+#include <ipxe/nvmetcp.h>
+
+/** @file
+ *
+ * NVMe over TCP protocol
+ *
+ * This is a minimal NVMe/TCP host, sufficient to expose a single
+ * namespace of an NVMe over Fabrics subsystem as a SAN block device.
+ * The session uses one TCP connection for the admin queue and one
+ * for a single I/O queue, with multiple commands outstanding on the
+ * I/O queue.  Header and data digests are not supported.
+ *
+ * No ACPI description (NVMe Boot Firmware Table) is provided for
+ * NVMe/TCP SAN devices, so an operating system cannot use the
+ * connection details to continue booting from the namespace.  Such
+ * an operating system must be configured to connect to the target
+ * itself.
+ *
+ */
+
+FEATURE ( FEATURE_PROTOCOL, "NVMe/TCP", DHCP_EB_FEATURE_NVME_TCP, 1 );
+
+/* Disambiguate the various error causes */
+#define EINVAL_NO_SUBNQN __einfo_error ( EINFO_EINVAL_NO_SUBNQN )
+#define EINFO_EINVAL_NO_SUBNQN \
+	__einfo_uniqify ( EINFO_EINVAL, 0x01, "No subsystem NQN" )
+#define EINVAL_NO_HOSTNQN __einfo_error ( EINFO_EINVAL_NO_HOSTNQN )
+#define EINFO_EINVAL_NO_HOSTNQN \
+	__einfo_uniqify ( EINFO_EINVAL, 0x02, "No host NQN" )
+#define EINVAL_NQN_TOO_LONG __einfo_error ( EINFO_EINVAL_NQN_TOO_LONG )
+#define EINFO_EINVAL_NQN_TOO_LONG \
+	__einfo_uniqify ( EINFO_EINVAL, 0x03, "NQN too long" )
+#define EIO_STATUS __einfo_error ( EINFO_EIO_STATUS )
+#define EINFO_EIO_STATUS \
+	__einfo_uniqify ( EINFO_EIO, 0x01, "Command failed" )
+#define EIO_FATAL __einfo_error ( EINFO_EIO_FATAL )
+#define EINFO_EIO_FATAL \
+	__einfo_uniqify ( EINFO_EIO, 0x02, "Controller fatal status" )
+#define ENODEV_NAMESPACE __einfo_error ( EINFO_ENODEV_NAMESPACE )
+#define EINFO_ENODEV_NAMESPACE \
+	__einfo_uniqify ( EINFO_ENODEV, 0x01, "Inactive namespace" )
+#define ENOTSUP_BLKSIZE __einfo_error ( EINFO_ENOTSUP_BLKSIZE )
+#define EINFO_ENOTSUP_BLKSIZE \
+	__einfo_uniqify ( EINFO_ENOTSUP, 0x01, "Unsupported block size" )
+#define ENOTSUP_PFV __einfo_error ( EINFO_ENOTSUP_PFV )
+#define EINFO_ENOTSUP_PFV \
+	__einfo_uniqify ( EINFO_ENOTSUP, 0x02, "Unsupported PDU format" )
+#define EPROTO_TERM __einfo_error ( EINFO_EPROTO_TERM )
+#define EINFO_EPROTO_TERM \
+	__einfo_uniqify ( EINFO_EPROTO, 0x01, "Connection terminated" )
+#define EPROTO_BAD_PDU __einfo_error ( EINFO_EPROTO_BAD_PDU )
+#define EINFO_EPROTO_BAD_PDU \
+	__einfo_uniqify ( EINFO_EPROTO, 0x02, "Invalid PDU" )
+#define EPROTO_BAD_CID __einfo_error ( EINFO_EPROTO_BAD_CID )
+#define EINFO_EPROTO_BAD_CID \
+	__einfo_uniqify ( EINFO_EPROTO, 0x03, "Invalid command identifier" )
+
+/** Default host NQN prefix when a system UUID is available */
+#define NVMETCP_UUID_HOSTNQN_PREFIX "nqn.2014-08.org.nvmexpress:uuid:"
+
+/** Default host NQN prefix when only a hostname is available */
+#define NVMETCP_DEFAULT_HOSTNQN_PREFIX "nqn.2010-04.org.ipxe:"
+
+/** Controller ready polling interval */
+#define NVMETCP_READY_POLL_INTERVAL ( TICKS_PER_SEC / 10 )
+
+/** NVMe/TCP host NQN setting */
+const struct setting nvme_hostnqn_setting __setting ( SETTING_SANBOOT_EXTRA,
+						      nvme-hostnqn ) = {
+	.name = "nvme-hostnqn",
+	.description = "NVMe host NQN",
+	.type = &setting_type_string,
+};
+
+static int nvmetcp_open_queue ( struct nvmetcp_session *session,
+				struct nvmetcp_queue *queue );
+
+/**
+ * Free NVMe/TCP session
+ *
+ * @v refcnt		Reference counter
+ */
+static void nvmetcp_free ( struct refcnt *refcnt ) {
+	struct nvmetcp_session *session =
+		container_of ( refcnt, struct nvmetcp_session, refcnt );
+
+	uri_put ( session->uri );
+	free ( session );
+}
+
+/**
+ * Shut down NVMe/TCP queue
+ *
+ * @v queue		NVMe/TCP queue
+ * @v rc		Reason for close
+ */
+static void nvmetcp_close_queue ( struct nvmetcp_queue *queue, int rc ) {
+	struct nvmetcp_command *command;
+	unsigned int i;
+
+	/* Stop transmission process */
+	process_del ( &queue->process );
+
+	/* Shut down all commands */
+	for ( i = 0 ; i < NVMETCP_MAX_COMMANDS ; i++ ) {
+		command = &queue->command[i];
+		command->flags = 0;
+		intf_shutdown ( &command->block, rc );
+	}
+
+	/* Shut down socket */
+	intf_shutdown ( &queue->socket, rc );
+}
+
+/**
+ * Shut down NVMe/TCP session
+ *
+ * @v session		NVMe/TCP session
+ * @v rc		Reason for close
+ */
+static void nvmetcp_close ( struct nvmetcp_session *session, int rc ) {
+
+	/* A TCP graceful close is still an error from our point of view */
+	if ( rc == 0 )
+		rc = -ECONNRESET;
+
+	DBGC ( session, "NVMe/TCP %p closed: %s\n",
+	       session, strerror ( rc ) );
+
+	/* Stop controller ready timer */
+	stop_timer ( &session->timer );
+	session->ready = 0;
+	session->closed = 1;
+
+	/* Shut down queues and block interface */
+	nvmetcp_close_queue ( &session->io, rc );
+	nvmetcp_close_queue ( &session->admin, rc );
+	intf_shutdown ( &session->block, rc );
+}
+
+/**
+ * Calculate aligned PDU data offset
+ *
+ * @v queue		NVMe/TCP queue
+ * @v hlen		PDU header length
+ * @ret pdo		PDU data offset
+ */
+static inline size_t nvmetcp_pdo ( struct nvmetcp_queue *queue,
+				   size_t hlen ) {
+
+	return ( ( hlen + queue->align - 1 ) & ~( queue->align - 1 ) );
+}
+
+/****************************************************************************
+ *
+ * Commands
+ *
+ */
+
+/**
+ * Count free command slots
+ *
+ * @v queue		NVMe/TCP queue
+ * @ret count		Number of free command slots
+ */
+static unsigned int nvmetcp_free_commands ( struct nvmetcp_queue *queue ) {
+	unsigned int count = 0;
+	unsigned int i;
+
+	for ( i = 0 ; i < queue->depth ; i++ ) {
+		if ( ! ( queue->command[i].flags & NVMETCP_CMD_ACTIVE ) )
+			count++;
+	}
+	return count;
+}
+
+/**
+ * Allocate command
+ *
+ * @v queue		NVMe/TCP queue
+ * @v complete		Completion handler
+ * @ret command		NVMe/TCP command, or NULL if no slot is free
+ *
+ * The returned command is zeroed apart from its command identifier.
+ */
+static struct nvmetcp_command *
+nvmetcp_alloc ( struct nvmetcp_queue *queue,
+		void ( * complete ) ( struct nvmetcp_command *command,
+				      int rc, uint64_t result ) ) {
+	struct nvmetcp_command *command;
+	unsigned int i;
+
+	for ( i = 0 ; i < queue->depth ; i++ ) {
+		command = &queue->command[i];
+		if ( command->flags & NVMETCP_CMD_ACTIVE )
+			continue;
+		command->flags = NVMETCP_CMD_ACTIVE;
+		memset ( &command->cmd, 0, sizeof ( command->cmd ) );
+		command->cmd.common.cid = cpu_to_le16 ( i );
+		command->buffer = UNULL;
+		command->len = 0;
+		command->capsule = NULL;
+		command->capsule_len = 0;
+		command->h2c_offset = 0;
+		command->h2c_end = 0;
+		command->complete = complete;
+		return command;
+	}
+	return NULL;
+}
+
+/**
+ * Identify command by command identifier
+ *
+ * @v queue		NVMe/TCP queue
+ * @v cid		Command identifier (in network byte order)
+ * @ret command		NVMe/TCP command, or NULL if not found
+ */
+static struct nvmetcp_command * nvmetcp_command ( struct nvmetcp_queue *queue,
+						  uint16_t cid ) {
+	struct nvmetcp_command *command;
+	unsigned int index = le16_to_cpu ( cid );
+
+	if ( index >= queue->depth )
+		return NULL;
+	command = &queue->command[index];
+	if ( ! ( command->flags & NVMETCP_CMD_ACTIVE ) )
+		return NULL;
+	return command;
+}
+
+/**
+ * Submit command
+ *
+ * @v command		NVMe/TCP command
+ */
+static void nvmetcp_submit ( struct nvmetcp_command *command ) {
+	struct nvme_generic_command *cmd = &command->cmd.common;
+
+	/* Construct data pointer */
+	cmd->flags |= NVME_CMD_SGL;
+	if ( command->capsule_len ) {
+		cmd->sgl.len = cpu_to_le32 ( command->capsule_len );
+		cmd->sgl.type = NVME_SGL_DATA_OFFSET;
+	} else if ( command->len ) {
+		cmd->sgl.len = cpu_to_le32 ( command->len );
+		cmd->sgl.type = NVME_SGL_TRANSPORT;
+	}
+
+	/* Queue for transmission */
+	command->flags |= NVMETCP_CMD_TX_CAPSULE;
+	process_add ( &command->queue->process );
+}
+
+/**
+ * Complete command
+ *
+ * @v command		NVMe/TCP command
+ * @v rc		Return status code
+ * @v result		Command specific result
+ */
+static void nvmetcp_complete ( struct nvmetcp_command *command, int rc,
+			       uint64_t result ) {
+
+	/* Free command slot before calling the completion handler,
+	 * which may immediately reuse it.
+	 */
+	command->flags = 0;
+	command->complete ( command, rc, result );
+}
+
+/**
+ * Close command block interface
+ *
+ * @v command		NVMe/TCP command
+ * @v rc		Reason for close
+ */
+static void nvmetcp_command_close ( struct nvmetcp_command *command,
+				    int rc ) {
+	struct nvmetcp_session *session = command->queue->session;
+
+	/* Restart interface */
+	intf_restart ( &command->block, rc );
+
+	/* Treat unsolicited command closures mid-command as fatal,
+	 * since NVMe/TCP provides no way to abandon a transfer.
+	 */
+	if ( command->flags & NVMETCP_CMD_ACTIVE )
+		nvmetcp_close ( session, ( ( rc == 0 ) ? -ECANCELED : rc ) );
+}
+
+/** NVMe/TCP command block interface operations */
+static struct interface_operation nvmetcp_command_op[] = {
+	INTF_OP ( intf_close, struct nvmetcp_command *, nvmetcp_command_close ),
+};
+
+/** NVMe/TCP command block interface descriptor */
+static struct interface_descriptor nvmetcp_command_desc =
+	INTF_DESC ( struct nvmetcp_command, block, nvmetcp_command_op );
+
+/****************************************************************************
+ *
+ * Controller initialisation
+ *
+ */
+
+/**
+ * Issue property get or set command
+ *
+ * @v session		NVMe/TCP session
+ * @v fctype		Fabrics command type
+ * @v offset		Property offset
+ * @v attrib		Property attributes
+ * @v value		Property value (for property set)
+ * @v complete		Completion handler
+ * @ret rc		Return status code
+ */
+static int nvmetcp_property ( struct nvmetcp_session *session,
+			      unsigned int fctype, unsigned int offset,
+			      unsigned int attrib, uint64_t value,
+			      void ( * complete ) ( struct nvmetcp_command *,
+						    int, uint64_t ) ) {
+	struct nvmetcp_command *command;
+	struct nvmf_property_command *property;
+
+	command = nvmetcp_alloc ( &session->admin, complete );
+	if ( ! command )
+		return -EBUSY;
+	property = &command->cmd.property;
+	property->opcode = NVME_FABRICS;
+	property->fctype = fctype;
+	property->attrib = attrib;
+	property->offset = cpu_to_le32 ( offset );
+	property->value = cpu_to_le64 ( value );
+	nvmetcp_submit ( command );
+	return 0;
+}
+
+/**
+ * Issue identify command
+ *
+ * @v session		NVMe/TCP session
+ * @v cns		Controller or namespace structure
+ * @v nsid		Namespace identifier
+ * @v complete		Completion handler
+ * @ret command		NVMe/TCP command, or NULL if no slot is free
+ *
+ * The caller must submit the returned command.
+ */
+static struct nvmetcp_command *
+nvmetcp_identify ( struct nvmetcp_session *session, unsigned int cns,
+		   unsigned int nsid,
+		   void ( * complete ) ( struct nvmetcp_command *,
+					 int, uint64_t ) ) {
+	struct nvmetcp_command *command;
+	struct nvme_generic_command *cmd;
+
+	command = nvmetcp_alloc ( &session->admin, complete );
+	if ( ! command )
+		return NULL;
+	cmd = &command->cmd.common;
+	cmd->opcode = NVME_IDENTIFY;
+	cmd->nsid = cpu_to_le32 ( nsid );
+	cmd->cdw[0] = cpu_to_le32 ( cns );
+	command->flags |= NVMETCP_CMD_READ;
+	command->buffer = virt_to_user ( &session->identify );
+	command->len = sizeof ( session->identify );
+	return command;
+}
+
+/**
+ * Handle set features (number of queues) completion
+ *
+ * @v command		NVMe/TCP command
+ * @v rc		Return status code
+ * @v result		Command specific result
+ */
+static void nvmetcp_queues_complete ( struct nvmetcp_command *command,
+				      int rc, uint64_t result __unused ) {
+	struct nvmetcp_session *session = command->queue->session;
+
+	if ( rc != 0 )
+		goto err;
+
+	/* Open I/O queue */
+	if ( ( rc = nvmetcp_open_queue ( session, &session->io ) ) != 0 )
+		goto err;
+	return;
+
+ err:
+	nvmetcp_close ( session, rc );
+}
+
+/**
+ * Handle identify controller completion
+ *
+ * @v command		NVMe/TCP command
+ * @v rc		Return status code
+ * @v result		Command specific result
+ */
+static void nvmetcp_ctrl_complete ( struct nvmetcp_command *command, int rc,
+				    uint64_t result __unused ) {
+	struct nvmetcp_session *session = command->queue->session;
+	struct nvme_identify_controller *ctrl = &session->identify.ctrl;
+	struct nvme_generic_command *cmd;
+
+	if ( rc != 0 )
+		goto err;
+
+	/* Record maximum data transfer size (zero meaning unlimited) */
+	if ( ctrl->mdts ) {
+		session->mdts = ( 4096UL << NVME_CAP_MPSMIN ( session->cap ) );
+		session->mdts <<= ( ( ctrl->mdts < 16 ) ? ctrl->mdts : 16 );
+	}
+	DBGC ( session, "NVMe/TCP %p maximum transfer size %zd\n",
+	       session, session->mdts );
+
+	/* Request a single I/O queue */
+	command = nvmetcp_alloc ( &session->admin, nvmetcp_queues_complete );
+	if ( ! command ) {
+		rc = -EBUSY;
+		goto err;
+	}
+	cmd = &command->cmd.common;
+	cmd->opcode = NVME_SET_FEATURES;
+	cmd->cdw[0] = cpu_to_le32 ( NVME_FEAT_NUM_QUEUES );
+	nvmetcp_submit ( command );
+	return;
+
+ err:
+	nvmetcp_close ( session, rc );
+}
+
+/**
+ * Handle controller status completion
+ *
+ * @v command		NVMe/TCP command
+ * @v rc		Return status code
+ * @v result		Controller status
+ */
+static void nvmetcp_csts_complete ( struct nvmetcp_command *command, int rc,
+				    uint64_t result ) {
+	struct nvmetcp_session *session = command->queue->session;
+
+	if ( rc != 0 )
+		goto err;
+
+	/* Check for fatal controller status */
+	if ( result & NVME_CSTS_CFS ) {
+		DBGC ( session, "NVMe/TCP %p controller fatal status\n",
+		       session );
+		rc = -EIO_FATAL;
+		goto err;
+	}
+
+	/* Wait for controller to become ready */
+	if ( ! ( result & NVME_CSTS_RDY ) ) {
+		if ( ( signed long ) ( currticks() - session->deadline ) > 0 ){
+			DBGC ( session, "NVMe/TCP %p timed out waiting for "
+			       "controller\n", session );
+			rc = -ETIMEDOUT;
+			goto err;
+		}
+		start_timer_fixed ( &session->timer,
+				    NVMETCP_READY_POLL_INTERVAL );
+		return;
+	}
+
+	/* Identify controller */
+	command = nvmetcp_identify ( session, NVME_IDENTIFY_CTRL, 0,
+				     nvmetcp_ctrl_complete );
+	if ( ! command ) {
+		rc = -EBUSY;
+		goto err;
+	}
+	nvmetcp_submit ( command );
+	return;
+
+ err:
+	nvmetcp_close ( session, rc );
+}
+
+/**
+ * Poll controller status
+ *
+ * @v timer		Controller ready timer
+ * @v over		Failure indicator
+ */
+static void nvmetcp_expired ( struct retry_timer *timer, int over __unused ) {
+	struct nvmetcp_session *session =
+		container_of ( timer, struct nvmetcp_session, timer );
+	int rc;
+
+	if ( ( rc = nvmetcp_property ( session, NVMF_PROPERTY_GET,
+				       NVME_REG_CSTS, 0, 0,
+				       nvmetcp_csts_complete ) ) != 0 )
+		nvmetcp_close ( session, rc );
+}
+
+/**
+ * Handle controller configuration completion
+ *
+ * @v command		NVMe/TCP command
+ * @v rc		Return status code
+ * @v result		Command specific result
+ */
+static void nvmetcp_cc_complete ( struct nvmetcp_command *command, int rc,
+				  uint64_t result __unused ) {
+	struct nvmetcp_session *session = command->queue->session;
+
+	if ( rc != 0 ) {
+		nvmetcp_close ( session, rc );
+		return;
+	}
+
+	/* Wait for controller to become ready */
+	session->deadline = ( currticks() + ( ( TICKS_PER_SEC / 2 ) *
+				( NVME_CAP_TO ( session->cap ) + 1 ) ) );
+	nvmetcp_expired ( &session->timer, 0 );
+}
+
+/**
+ * Handle controller capabilities completion
+ *
+ * @v command		NVMe/TCP command
+ * @v rc		Return status code
+ * @v result		Controller capabilities
+ */
+static void nvmetcp_cap_complete ( struct nvmetcp_command *command, int rc,
+				   uint64_t result ) {
+	struct nvmetcp_session *session = command->queue->session;
+	unsigned int mqes;
+
+	if ( rc != 0 )
+		goto err;
+
+	/* Record capabilities and size I/O queue accordingly.  MQES
+	 * is a 0's based value, so the controller supports at least
+	 * two queue entries.
+	 */
+	session->cap = result;
+	mqes = ( NVME_CAP_MQES ( result ) + 1 );
+	if ( session->io.depth > mqes )
+		session->io.depth = mqes;
+	DBGC ( session, "NVMe/TCP %p CAP %#llx I/O depth %d\n",
+	       session, ( ( unsigned long long ) result ), session->io.depth );
+
+	/* Enable controller */
+	if ( ( rc = nvmetcp_property ( session, NVMF_PROPERTY_SET, NVME_REG_CC,
+				       0, ( NVME_CC_IOCQES | NVME_CC_IOSQES |
+					    NVME_CC_EN ),
+				       nvmetcp_cc_complete ) ) != 0 )
+		goto err;
+	return;
+
+ err:
+	nvmetcp_close ( session, rc );
+}
+
+/**
+ * Handle fabrics connect completion
+ *
+ * @v command		NVMe/TCP command
+ * @v rc		Return status code
+ * @v result		Command specific result
+ */
+static void nvmetcp_connect_complete ( struct nvmetcp_command *command,
+				       int rc, uint64_t result ) {
+	struct nvmetcp_queue *queue = command->queue;
+	struct nvmetcp_session *session = queue->session;
+
+	if ( rc != 0 )
+		goto err;
+	queue->state = NVMETCP_QUEUE_READY;
+
+	/* Start I/O once the I/O queue is connected */
+	if ( queue->qid ) {
+		DBGC ( session, "NVMe/TCP %p ready\n", session );
+		session->ready = 1;
+		xfer_window_changed ( &session->block );
+		return;
+	}
+
+	/* Record controller identifier for use by the I/O queue */
+	session->connect.cntlid = cpu_to_le16 ( result & 0xffff );
+	DBGC ( session, "NVMe/TCP %p connected as controller %#04x\n",
+	       session, le16_to_cpu ( session->connect.cntlid ) );
+
+	/* Read controller capabilities */
+	if ( ( rc = nvmetcp_property ( session, NVMF_PROPERTY_GET, NVME_REG_CAP,
+				       NVMF_PROPERTY_64BIT, 0,
+				       nvmetcp_cap_complete ) ) != 0 )
+		goto err;
+	return;
+
+ err:
+	nvmetcp_close ( session, rc );
+}
+
+/**
+ * Issue fabrics connect command
+ *
+ * @v queue		NVMe/TCP queue
+ * @ret rc		Return status code
+ */
+static int nvmetcp_connect ( struct nvmetcp_queue *queue ) {
+	struct nvmetcp_session *session = queue->session;
+	struct nvmetcp_command *command;
+	struct nvmf_connect_command *connect;
+
+	command = nvmetcp_alloc ( queue, nvmetcp_connect_complete );
+	if ( ! command )
+		return -EBUSY;
+	connect = &command->cmd.connect;
+	connect->opcode = NVME_FABRICS;
+	connect->fctype = NVMF_CONNECT;
+	connect->qid = cpu_to_le16 ( queue->qid );
+	connect->sqsize = cpu_to_le16 ( queue->qid ? ( queue->depth - 1 ) :
+					NVMETCP_ADMIN_SQSIZE );
+	command->capsule = &session->connect;
+	command->capsule_len = sizeof ( session->connect );
+	nvmetcp_submit ( command );
+	return 0;
+}
+
+/****************************************************************************
+ *
+ * Transmission
+ *
+ */
+
+/**
+ * Transmit initialize connection request
+ *
+ * @v queue		NVMe/TCP queue
+ * @ret rc		Return status code
+ */
+static int nvmetcp_tx_icreq ( struct nvmetcp_queue *queue ) {
+	struct io_buffer *iobuf;
+	struct nvmetcp_ic *icreq;
+
+	iobuf = xfer_alloc_iob ( &queue->socket, sizeof ( *icreq ) );
+	if ( ! iobuf )
+		return -ENOMEM;
+	icreq = iob_put ( iobuf, sizeof ( *icreq ) );
+	memset ( icreq, 0, sizeof ( *icreq ) );
+	icreq->hdr.type = NVMETCP_ICREQ;
+	icreq->hdr.hlen = sizeof ( *icreq );
+	icreq->hdr.plen = cpu_to_le32 ( sizeof ( *icreq ) );
+	queue->state = NVMETCP_QUEUE_ICRESP;
+	return xfer_deliver_iob ( &queue->socket, iobuf );
+}
+
+/**
+ * Transmit command capsule
+ *
+ * @v command		NVMe/TCP command
+ * @ret rc		Return status code
+ */
+static int nvmetcp_tx_capsule ( struct nvmetcp_command *command ) {
+	struct nvmetcp_queue *queue = command->queue;
+	struct nvmetcp_capsule_cmd *capsule;
+	struct io_buffer *iobuf;
+	size_t hlen = sizeof ( *capsule );
+	size_t pdo = 0;
+	size_t plen = hlen;
+
+	/* Calculate PDU layout */
+	if ( command->capsule_len ) {
+		pdo = nvmetcp_pdo ( queue, hlen );
+		plen = ( pdo + command->capsule_len );
+	}
+
+	/* Construct PDU */
+	iobuf = xfer_alloc_iob ( &queue->socket, plen );
+	if ( ! iobuf )
+		return -ENOMEM;
+	capsule = iob_put ( iobuf, sizeof ( *capsule ) );
+	memset ( &capsule->hdr, 0, sizeof ( capsule->hdr ) );
+	capsule->hdr.type = NVMETCP_CAPSULE_CMD;
+	capsule->hdr.hlen = hlen;
+	capsule->hdr.pdo = pdo;
+	capsule->hdr.plen = cpu_to_le32 ( plen );
+	memcpy ( &capsule->cmd, &command->cmd, sizeof ( capsule->cmd ) );
+	if ( command->capsule_len ) {
+		memset ( iob_put ( iobuf, ( pdo - hlen ) ), 0, ( pdo - hlen ) );
+		memcpy ( iob_put ( iobuf, command->capsule_len ),
+			 command->capsule, command->capsule_len );
+	}
+	command->flags &= ~NVMETCP_CMD_TX_CAPSULE;
+
+	return xfer_deliver_iob ( &queue->socket, iobuf );
+}
+
+/**
+ * Transmit host to controller data
+ *
+ * @v command		NVMe/TCP command
+ * @ret rc		Return status code
+ */
+static int nvmetcp_tx_h2c ( struct nvmetcp_command *command ) {
+	struct nvmetcp_queue *queue = command->queue;
+	struct nvmetcp_data *data;
+	struct io_buffer *iobuf;
+	size_t hlen = sizeof ( *data );
+	size_t pdo = nvmetcp_pdo ( queue, hlen );
+	size_t len;
+
+	/* Calculate data length */
+	len = ( command->h2c_end - command->h2c_offset );
+	if ( len > queue->maxh2cdata )
+		len = queue->maxh2cdata;
+
+	/* Construct PDU */
+	iobuf = xfer_alloc_iob ( &queue->socket, ( pdo + len ) );
+	if ( ! iobuf )
+		return -ENOMEM;
+	data = iob_put ( iobuf, sizeof ( *data ) );
+	memset ( data, 0, sizeof ( *data ) );
+	data->hdr.type = NVMETCP_H2C_DATA;
+	if ( ( command->h2c_offset + len ) == command->h2c_end )
+		data->hdr.flags = NVMETCP_FL_LAST;
+	data->hdr.hlen = hlen;
+	data->hdr.pdo = pdo;
+	data->hdr.plen = cpu_to_le32 ( pdo + len );
+	data->cccid = command->cmd.common.cid;
+	data->ttag = command->ttag;
+	data->offset = cpu_to_le32 ( command->h2c_offset );
+	data->len = cpu_to_le32 ( len );
+	memset ( iob_put ( iobuf, ( pdo - hlen ) ), 0, ( pdo - hlen ) );
+	copy_from_user ( iob_put ( iobuf, len ), command->buffer,
+			 command->h2c_offset, len );
+	command->h2c_offset += len;
+
+	return xfer_deliver_iob ( &queue->socket, iobuf );
+}
+
+/**
+ * Transmit pending PDUs
+ *
+ * @v queue		NVMe/TCP queue
+ */
+static void nvmetcp_tx_step ( struct nvmetcp_queue *queue ) {
+	struct nvmetcp_command *command;
+	unsigned int i;
+	int rc;
+
+	/* Transmit as much as the socket window allows */
+	while ( xfer_window ( &queue->socket ) ) {
+
+		/* Send initialize connection request, if applicable */
+		if ( queue->state == NVMETCP_QUEUE_ICREQ ) {
+			if ( ( rc = nvmetcp_tx_icreq ( queue ) ) != 0 )
+				goto err;
+			continue;
+		}
+
+		/* Send command capsules in preference to data, so
+		 * that new commands are not stuck behind bulk writes.
+		 */
+		for ( i = 0 ; i < queue->depth ; i++ ) {
+			command = &queue->command[i];
+			if ( command->flags & NVMETCP_CMD_TX_CAPSULE ) {
+				if ( ( rc = nvmetcp_tx_capsule ( command ) ) )
+					goto err;
+				goto next;
+			}
+		}
+		for ( i = 0 ; i < queue->depth ; i++ ) {
+			command = &queue->command[i];
+			if ( command->h2c_offset < command->h2c_end ) {
+				if ( ( rc = nvmetcp_tx_h2c ( command ) ) != 0 )
+					goto err;
+				goto next;
+			}
+		}
+
+		/* Nothing left to send */
+		return;
+
+	next:
+		continue;
+	}
+	return;
+
+ err:
+	DBGC ( queue->session, "NVMe/TCP %p qid %d could not transmit: %s\n",
+	       queue->session, queue->qid, strerror ( rc ) );
+	nvmetcp_close ( queue->session, rc );
+}
+
+/** NVMe/TCP transmit process descriptor */
+static struct process_descriptor nvmetcp_process_desc =
+	PROC_DESC_ONCE_PRIO ( struct nvmetcp_queue, process, nvmetcp_tx_step,
+			     PROC_PRIO_NET );
+
+/****************************************************************************
+ *
+ * Reception
+ *
+ */
+
+/**
+ * Receive initialize connection response
+ *
+ * @v queue		NVMe/TCP queue
+ * @ret rc		Return status code
+ */
+static int nvmetcp_rx_icresp ( struct nvmetcp_queue *queue ) {
+	struct nvmetcp_session *session = queue->session;
+	struct nvmetcp_ic *icresp = &queue->rx.ic;
+	size_t maxh2cdata;
+
+	/* Sanity checks */
+	if ( queue->state != NVMETCP_QUEUE_ICRESP ) {
+		DBGC ( session, "NVMe/TCP %p qid %d unexpected ICResp\n",
+		       session, queue->qid );
+		return -EPROTO_BAD_PDU;
+	}
+	if ( icresp->pfv != 0 ) {
+		DBGC ( session, "NVMe/TCP %p qid %d unsupported PFV %d\n",
+		       session, queue->qid, le16_to_cpu ( icresp->pfv ) );
+		return -ENOTSUP_PFV;
+	}
+	if ( icresp->dgst != 0 ) {
+		DBGC ( session, "NVMe/TCP %p qid %d unrequested digests %#02x\n",
+		       session, queue->qid, icresp->dgst );
+		return -EPROTO_BAD_PDU;
+	}
+	maxh2cdata = le32_to_cpu ( icresp->max );
+	if ( ! maxh2cdata ) {
+		DBGC ( session, "NVMe/TCP %p qid %d invalid MAXH2CDATA\n",
+		       session, queue->qid );
+		return -EPROTO_BAD_PDU;
+	}
+
+	/* Record transfer parameters */
+	queue->align = ( ( icresp->pda + 1 ) * 4 );
+	queue->maxh2cdata = maxh2cdata;
+	if ( queue->maxh2cdata > NVMETCP_MAX_H2C_LEN )
+		queue->maxh2cdata = NVMETCP_MAX_H2C_LEN;
+	DBGC ( session, "NVMe/TCP %p qid %d alignment %zd MAXH2CDATA %zd\n",
+	       session, queue->qid, queue->align, maxh2cdata );
+
+	/* Connect queue */
+	queue->state = NVMETCP_QUEUE_CONNECT;
+	return nvmetcp_connect ( queue );
+}
+
+/**
+ * Receive response capsule
+ *
+ * @v queue		NVMe/TCP queue
+ * @ret rc		Return status code
+ */
+static int nvmetcp_rx_resp ( struct nvmetcp_queue *queue ) {
+	struct nvmetcp_session *session = queue->session;
+	struct nvme_completion *cqe = &queue->rx.resp.cqe;
+	struct nvmetcp_command *command;
+	unsigned int status;
+	int rc;
+
+	/* Identify command */
+	command = nvmetcp_command ( queue, cqe->cid );
+	if ( ! command ) {
+		DBGC ( session, "NVMe/TCP %p qid %d unknown CID %#04x\n",
+		       session, queue->qid, le16_to_cpu ( cqe->cid ) );
+		return -EPROTO_BAD_CID;
+	}
+
+	/* Check status */
+	status = NVME_STATUS ( le16_to_cpu ( cqe->status ) );
+	if ( status ) {
+		DBGC ( session, "NVMe/TCP %p qid %d CID %#04x opcode %#02x "
+		       "status %#03x\n", session, queue->qid,
+		       le16_to_cpu ( cqe->cid ), command->cmd.common.opcode,
+		       status );
+		rc = -EIO_STATUS;
+	} else {
+		rc = 0;
+	}
+
+	/* Complete command */
+	nvmetcp_complete ( command, rc, le64_to_cpu ( cqe->result ) );
+	return 0;
+}
+
+/**
+ * Receive controller to host data header
+ *
+ * @v queue		NVMe/TCP queue
+ * @ret rc		Return status code
+ */
+static int nvmetcp_rx_c2h ( struct nvmetcp_queue *queue ) {
+	struct nvmetcp_session *session = queue->session;
+	struct nvmetcp_data *data = &queue->rx.data;
+	struct nvmetcp_command *command;
+	size_t pdo = ( data->hdr.pdo ? data->hdr.pdo : data->hdr.hlen );
+	size_t offset = le32_to_cpu ( data->offset );
+	size_t len = le32_to_cpu ( data->len );
+
+	/* Identify command */
+	command = nvmetcp_command ( queue, data->cccid );
+	if ( ( ! command ) || ( ! ( command->flags & NVMETCP_CMD_READ ) ) ) {
+		DBGC ( session, "NVMe/TCP %p qid %d unexpected C2HData for "
+		       "CID %#04x\n", session, queue->qid,
+		       le16_to_cpu ( data->cccid ) );
+		return -EPROTO_BAD_CID;
+	}
+
+	/* Sanity checks */
+	if ( ( len != ( le32_to_cpu ( data->hdr.plen ) - pdo ) ) ||
+	     ( offset > command->len ) || ( len > ( command->len - offset ) ) ){
+		DBGC ( session, "NVMe/TCP %p qid %d CID %#04x invalid C2HData "
+		       "[%#zx,%#zx)\n", session, queue->qid,
+		       le16_to_cpu ( data->cccid ), offset, ( offset + len ) );
+		return -EPROTO_BAD_PDU;
+	}
+
+	/* Record data destination */
+	queue->rx_command = command;
+	queue->rx_data_offset = offset;
+	return 0;
+}
+
+/**
+ * Receive ready to transfer
+ *
+ * @v queue		NVMe/TCP queue
+ * @ret rc		Return status code
+ */
+static int nvmetcp_rx_r2t ( struct nvmetcp_queue *queue ) {
+	struct nvmetcp_session *session = queue->session;
+	struct nvmetcp_data *r2t = &queue->rx.data;
+	struct nvmetcp_command *command;
+	size_t offset = le32_to_cpu ( r2t->offset );
+	size_t len = le32_to_cpu ( r2t->len );
+
+	/* Identify command */
+	command = nvmetcp_command ( queue, r2t->cccid );
+	if ( ( ! command ) || ( ! ( command->flags & NVMETCP_CMD_WRITE ) ) ) {
+		DBGC ( session, "NVMe/TCP %p qid %d unexpected R2T for CID "
+		       "%#04x\n", session, queue->qid,
+		       le16_to_cpu ( r2t->cccid ) );
+		return -EPROTO_BAD_CID;
+	}
+
+	/* Sanity checks */
+	if ( ( command->h2c_offset < command->h2c_end ) || ( ! len ) ||
+	     ( offset > command->len ) || ( len > ( command->len - offset ) ) ){
+		DBGC ( session, "NVMe/TCP %p qid %d CID %#04x invalid R2T "
+		       "[%#zx,%#zx)\n", session, queue->qid,
+		       le16_to_cpu ( r2t->cccid ), offset, ( offset + len ) );
+		return -EPROTO_BAD_PDU;
+	}
+
+	/* Schedule data transmission */
+	command->ttag = r2t->ttag;
+	command->h2c_offset = offset;
+	command->h2c_end = ( offset + len );
+	process_add ( &queue->process );
+	return 0;
+}
+
+/**
+ * Receive termination request
+ *
+ * @v queue		NVMe/TCP queue
+ * @ret rc		Return status code
+ */
+static int nvmetcp_rx_term ( struct nvmetcp_queue *queue ) {
+	struct nvmetcp_term *term = &queue->rx.term;
+
+	DBGC ( queue->session, "NVMe/TCP %p qid %d terminated (FES %#04x FEI "
+	       "%#08x)\n", queue->session, queue->qid,
+	       le16_to_cpu ( term->fes ), le32_to_cpu ( term->fei ) );
+	return -EPROTO_TERM;
+}
+
+/**
+ * Validate received PDU common header
+ *
+ * @v queue		NVMe/TCP queue
+ * @ret rc		Return status code
+ */
+static int nvmetcp_rx_common ( struct nvmetcp_queue *queue ) {
+	struct nvmetcp_header *hdr = &queue->rx.hdr;
+	size_t plen = le32_to_cpu ( hdr->plen );
+	size_t hlen;
+
+	/* Determine expected header length */
+	switch ( hdr->type ) {
+	case NVMETCP_ICRESP:
+		hlen = sizeof ( queue->rx.ic );
+		break;
+	case NVMETCP_CAPSULE_RESP:
+		hlen = sizeof ( queue->rx.resp );
+		break;
+	case NVMETCP_C2H_DATA:
+	case NVMETCP_R2T:
+		hlen = sizeof ( queue->rx.data );
+		break;
+	case NVMETCP_C2H_TERM:
+		hlen = sizeof ( queue->rx.term );
+		break;
+	default:
+		DBGC ( queue->session, "NVMe/TCP %p qid %d unknown PDU type "
+		       "%#02x\n", queue->session, queue->qid, hdr->type );
+		return -EPROTO_BAD_PDU;
+	}
+
+	/* Check lengths */
+	if ( ( hdr->hlen != hlen ) || ( plen < hlen ) ||
+	     ( hdr->pdo && ( ( hdr->pdo < hlen ) || ( hdr->pdo > plen ) ) ) ) {
+		DBGC ( queue->session, "NVMe/TCP %p qid %d invalid PDU type "
+		       "%#02x lengths %d/%d/%zd\n", queue->session, queue->qid,
+		       hdr->type, hdr->hlen, hdr->pdo, plen );
+		return -EPROTO_BAD_PDU;
+	}
+
+	return 0;
+}
+
+/**
+ * Receive PDU header
+ *
+ * @v queue		NVMe/TCP queue
+ * @ret rc		Return status code
+ */
+static int nvmetcp_rx_header ( struct nvmetcp_queue *queue ) {
+
+	switch ( queue->rx.hdr.type ) {
+	case NVMETCP_ICRESP:
+		return nvmetcp_rx_icresp ( queue );
+	case NVMETCP_CAPSULE_RESP:
+		return nvmetcp_rx_resp ( queue );
+	case NVMETCP_C2H_DATA:
+		return nvmetcp_rx_c2h ( queue );
+	case NVMETCP_R2T:
+		return nvmetcp_rx_r2t ( queue );
+	case NVMETCP_C2H_TERM:
+		return nvmetcp_rx_term ( queue );
+	default:
+		/* Cannot happen; type has already been validated */
+		assert ( 0 );
+		return -EPROTO_BAD_PDU;
+	}
+}
+
+/**
+ * Receive PDU data
+ *
+ * @v queue		NVMe/TCP queue
+ * @v data		Data
+ * @v offset		Offset within PDU data
+ * @v len		Length of data
+ */
+static void nvmetcp_rx_data ( struct nvmetcp_queue *queue, const void *data,
+			      size_t offset, size_t len ) {
+	struct nvmetcp_command *command = queue->rx_command;
+
+	/* Ignore data other than controller to host data */
+	if ( ! command )
+		return;
+
+	/* Copy to command buffer */
+	copy_to_user ( command->buffer, ( queue->rx_data_offset + offset ),
+		       data, len );
+}
+
+/**
+ * Complete received PDU
+ *
+ * @v queue		NVMe/TCP queue
+ */
+static void nvmetcp_rx_done ( struct nvmetcp_queue *queue ) {
+	struct nvmetcp_command *command = queue->rx_command;
+	unsigned int flags = queue->rx.hdr.flags;
+
+	/* Complete read commands for which no response capsule will
+	 * be sent.
+	 */
+	queue->rx_command = NULL;
+	if ( command && ( flags & NVMETCP_FL_LAST ) &&
+	     ( flags & NVMETCP_FL_SUCCESS ) ) {
+		nvmetcp_complete ( command, 0, 0 );
+	}
+}
+
+/**
+ * Receive new data
+ *
+ * @v queue		NVMe/TCP queue
+ * @v iobuf		I/O buffer
+ * @v meta		Data transfer metadata
+ * @ret rc		Return status code
+ *
+ * PDU headers are accumulated into the receive buffer; controller to
+ * host data is copied directly into the command's data buffer.
+ */
+static int nvmetcp_socket_deliver ( struct nvmetcp_queue *queue,
+				    struct io_buffer *iobuf,
+				    struct xfer_metadata *meta __unused ) {
+	struct nvmetcp_header *hdr = &queue->rx.hdr;
+	void *rx = &queue->rx;
+	size_t frag_len;
+	size_t pdo;
+	size_t end;
+	int rc;
+
+	while ( iob_len ( iobuf ) ) {
+
+		/* Determine extent of current PDU section */
+		pdo = ( hdr->pdo ? hdr->pdo : hdr->hlen );
+		if ( queue->rx_offset < sizeof ( *hdr ) ) {
+			end = sizeof ( *hdr );
+		} else if ( queue->rx_offset < hdr->hlen ) {
+			end = hdr->hlen;
+		} else if ( queue->rx_offset < pdo ) {
+			end = pdo;
+		} else {
+			end = le32_to_cpu ( hdr->plen );
+		}
+		frag_len = ( end - queue->rx_offset );
+		if ( frag_len > iob_len ( iobuf ) )
+			frag_len = iob_len ( iobuf );
+
+		/* Accumulate header, discard padding, or consume data */
+		if ( ( queue->rx_offset < sizeof ( *hdr ) ) ||
+		     ( queue->rx_offset < hdr->hlen ) ) {
+			memcpy ( ( rx + queue->rx_offset ), iobuf->data,
+				 frag_len );
+		} else if ( queue->rx_offset >= pdo ) {
+			nvmetcp_rx_data ( queue, iobuf->data,
+					  ( queue->rx_offset - pdo ), frag_len );
+		}
+		queue->rx_offset += frag_len;
+		iob_pull ( iobuf, frag_len );
+
+		/* Process completed sections */
+		if ( queue->rx_offset < sizeof ( *hdr ) )
+			continue;
+		if ( ( queue->rx_offset == sizeof ( *hdr ) ) &&
+		     ( ( rc = nvmetcp_rx_common ( queue ) ) != 0 ) )
+			goto err;
+		if ( ( queue->rx_offset == hdr->hlen ) &&
+		     ( ( rc = nvmetcp_rx_header ( queue ) ) != 0 ) )
+			goto err;
+		if ( ( queue->rx_offset >= hdr->hlen ) &&
+		     ( queue->rx_offset == le32_to_cpu ( hdr->plen ) ) ) {
+			nvmetcp_rx_done ( queue );
+			queue->rx_offset = 0;
+		}
+
+		/* Stop parsing if a handler has closed the session */
+		if ( queue->session->closed )
+			break;
+	}
+
+	free_iob ( iobuf );
+	return 0;
+
+ err:
+	free_iob ( iobuf );
+	nvmetcp_close ( queue->session, rc );
+	return rc;
+}
+
+/**
+ * Handle socket window change
+ *
+ * @v queue		NVMe/TCP queue
+ */
+static void nvmetcp_socket_window_changed ( struct nvmetcp_queue *queue ) {
+
+	process_add ( &queue->process );
+}
+
+/**
+ * Handle socket closure
+ *
+ * @v queue		NVMe/TCP queue
+ * @v rc		Reason for close
+ */
+static void nvmetcp_socket_close ( struct nvmetcp_queue *queue, int rc ) {
+
+	nvmetcp_close ( queue->session, rc );
+}
+
+/** NVMe/TCP socket interface operations */
+static struct interface_operation nvmetcp_socket_op[] = {
+	INTF_OP ( xfer_deliver, struct nvmetcp_queue *,
+		  nvmetcp_socket_deliver ),
+	INTF_OP ( xfer_window_changed, struct nvmetcp_queue *,
+		  nvmetcp_socket_window_changed ),
+	INTF_OP ( intf_close, struct nvmetcp_queue *, nvmetcp_socket_close ),
+};
+
+/** NVMe/TCP socket interface descriptor */
+static struct interface_descriptor nvmetcp_socket_desc =
+	INTF_DESC ( struct nvmetcp_queue, socket, nvmetcp_socket_op );
+
+/**
+ * Open NVMe/TCP queue
+ *
+ * @v session		NVMe/TCP session
+ * @v queue		NVMe/TCP queue
+ * @ret rc		Return status code
+ */
+static int nvmetcp_open_queue ( struct nvmetcp_session *session,
+				struct nvmetcp_queue *queue ) {
+	struct sockaddr_tcpip target;
+	int rc;
+
+	/* Open socket */
+	memset ( &target, 0, sizeof ( target ) );
+	target.st_port = htons ( session->target_port );
+	if ( ( rc = xfer_open_named_socket ( &queue->socket, SOCK_STREAM,
+					     ( struct sockaddr * ) &target,
+					     session->uri->host,
+					     NULL ) ) != 0 ) {
+		DBGC ( session, "NVMe/TCP %p qid %d could not open socket: "
+		       "%s\n", session, queue->qid, strerror ( rc ) );
+		return rc;
+	}
+
+	/* Send initialize connection request once connected */
+	queue->state = NVMETCP_QUEUE_ICREQ;
+	process_add ( &queue->process );
+
+	return 0;
+}
+
+/****************************************************************************
+ *
+ * Block device interface
+ *
+ */
+
+/**
+ * Check NVMe/TCP flow-control window
+ *
+ * @v session		NVMe/TCP session
+ * @ret len		Length of window
+ */
+static size_t nvmetcp_window ( struct nvmetcp_session *session ) {
+
+	/* Cannot accept commands until the I/O queue is connected */
+	if ( ! session->ready )
+		return 0;
+
+	return nvmetcp_free_commands ( &session->io );
+}
+
+/**
+ * Handle block command completion
+ *
+ * @v command		NVMe/TCP command
+ * @v rc		Return status code
+ * @v result		Command specific result
+ */
+static void nvmetcp_block_complete ( struct nvmetcp_command *command, int rc,
+				     uint64_t result __unused ) {
+	struct nvmetcp_session *session = command->queue->session;
+
+	intf_restart ( &command->block, rc );
+	xfer_window_changed ( &session->block );
+}
+
+/**
+ * Issue read or write command
+ *
+ * @v session		NVMe/TCP session
+ * @v data		Data interface
+ * @v opcode		Opcode
+ * @v flags		Data direction flags
+ * @v lba		Starting logical block address
+ * @v count		Number of logical blocks
+ * @v buffer		Data buffer
+ * @v len		Length of data buffer
+ * @ret rc		Return status code
+ */
+static int nvmetcp_block_rw ( struct nvmetcp_session *session,
+			      struct interface *data, unsigned int opcode,
+			      unsigned int flags, uint64_t lba,
+			      unsigned int count, userptr_t buffer,
+			      size_t len ) {
+	struct nvmetcp_command *command;
+	struct nvme_generic_command *cmd;
+
+	/* This implementation cannot handle commands arriving before
+	 * the I/O queue is connected, or more than a fixed number of
+	 * concurrent commands.
+	 */
+	if ( ( ! session->ready ) ||
+	     ( ! ( command = nvmetcp_alloc ( &session->io,
+					      nvmetcp_block_complete ) ) ) ) {
+		DBGC ( session, "NVMe/TCP %p cannot handle further concurrent "
+		       "commands\n", session );
+		return -EOPNOTSUPP;
+	}
+
+	/* Construct command */
+	cmd = &command->cmd.common;
+	cmd->opcode = opcode;
+	cmd->nsid = cpu_to_le32 ( session->nsid );
+	cmd->cdw[0] = cpu_to_le32 ( lba & 0xffffffffUL );
+	cmd->cdw[1] = cpu_to_le32 ( lba >> 32 );
+	cmd->cdw[2] = cpu_to_le32 ( count - 1 );
+	command->flags |= flags;
+	command->buffer = buffer;
+	command->len = len;
+
+	/* Attach to parent interface and submit */
+	intf_plug_plug ( &command->block, data );
+	nvmetcp_submit ( command );
+	return 0;
+}
+
+/**
+ * Read from block device
+ *
+ * @v session		NVMe/TCP session
+ * @v data		Data interface
+ * @v lba		Starting logical block address
+ * @v count		Number of logical blocks
+ * @v buffer		Data buffer
+ * @v len		Length of data buffer
+ * @ret rc		Return status code
+ */
+static int nvmetcp_block_read ( struct nvmetcp_session *session,
+				struct interface *data, uint64_t lba,
+				unsigned int count, userptr_t buffer,
+				size_t len ) {
+
+	return nvmetcp_block_rw ( session, data, NVME_READ, NVMETCP_CMD_READ,
+				  lba, count, buffer, len );
+}
+
+/**
+ * Write to block device
+ *
+ * @v session		NVMe/TCP session
+ * @v data		Data interface
+ * @v lba		Starting logical block address
+ * @v count		Number of logical blocks
+ * @v buffer		Data buffer
+ * @v len		Length of data buffer
+ * @ret rc		Return status code
+ */
+static int nvmetcp_block_write ( struct nvmetcp_session *session,
+				 struct interface *data, uint64_t lba,
+				 unsigned int count, userptr_t buffer,
+				 size_t len ) {
+
+	return nvmetcp_block_rw ( session, data, NVME_WRITE,
+				  NVMETCP_CMD_WRITE, lba, count, buffer, len );
+}
+
+/**
+ * Handle identify namespace completion
+ *
+ * @v command		NVMe/TCP command
+ * @v rc		Return status code
+ * @v result		Command specific result
+ */
+static void nvmetcp_ns_complete ( struct nvmetcp_command *command, int rc,
+				  uint64_t result __unused ) {
+	struct nvmetcp_session *session = command->queue->session;
+	struct nvme_identify_namespace *ns = &session->identify.ns;
+	struct block_device_capacity capacity;
+	unsigned int lbads;
+	uint32_t lbaf;
+	size_t max_len;
+
+	if ( rc != 0 )
+		goto done;
+
+	/* An inactive namespace is reported as all zeroes */
+	if ( ! ns->nsze ) {
+		DBGC ( session, "NVMe/TCP %p namespace %d is inactive\n",
+		       session, session->nsid );
+		rc = -ENODEV_NAMESPACE;
+		goto done;
+	}
+
+	/* Determine block size */
+	lbaf = le32_to_cpu ( ns->lbaf[ NVME_FLBAS_INDEX ( ns->flbas ) ] );
+	lbads = NVME_LBAF_LBADS ( lbaf );
+	if ( ( lbads < 9 ) || ( lbads > 16 ) ) {
+		DBGC ( session, "NVMe/TCP %p unsupported LBADS %d\n",
+		       session, lbads );
+		rc = -ENOTSUP_BLKSIZE;
+		goto done;
+	}
+
+	/* Report capacity */
+	max_len = NVMETCP_MAX_TRANSFER_LEN;
+	if ( session->mdts && ( max_len > session->mdts ) )
+		max_len = session->mdts;
+	capacity.blocks = le64_to_cpu ( ns->nsze );
+	capacity.blksize = ( 1UL << lbads );
+	capacity.max_count = ( max_len >> lbads );
+	DBGC ( session, "NVMe/TCP %p namespace %d has %#llx blocks of %zd "
+	       "bytes\n", session, session->nsid,
+	       ( ( unsigned long long ) capacity.blocks ), capacity.blksize );
+	block_capacity ( &command->block, &capacity );
+
+ done:
+	intf_restart ( &command->block, rc );
+}
+
+/**
+ * Read block device capacity
+ *
+ * @v session		NVMe/TCP session
+ * @v data		Data interface
+ * @ret rc		Return status code
+ */
+static int nvmetcp_block_read_capacity ( struct nvmetcp_session *session,
+					 struct interface *data ) {
+	struct nvmetcp_command *command;
+
+	/* Identify namespace */
+	if ( ( ! session->ready ) ||
+	     ( ! ( command = nvmetcp_identify ( session, NVME_IDENTIFY_NS,
+						session->nsid,
+						nvmetcp_ns_complete ) ) ) ) {
+		DBGC ( session, "NVMe/TCP %p cannot read capacity\n",
+		       session );
+		return -EOPNOTSUPP;
+	}
+
+	/* Attach to parent interface and submit */
+	intf_plug_plug ( &command->block, data );
+	nvmetcp_submit ( command );
+	return 0;
+}
+
+/**
+ * Describe as an EFI device path
+ *
+ * @v session		NVMe/TCP session
+ * @ret path		EFI device path, or NULL on error
+ */
+static EFI_DEVICE_PATH_PROTOCOL *
+nvmetcp_efi_describe ( struct nvmetcp_session *session ) {
+
+	return efi_uri_path ( session->uri );
+}
+
+/** NVMe/TCP block control interface operations */
+static struct interface_operation nvmetcp_block_op[] = {
+	INTF_OP ( block_read, struct nvmetcp_session *, nvmetcp_block_read ),
+	INTF_OP ( block_write, struct nvmetcp_session *,
+		  nvmetcp_block_write ),
+	INTF_OP ( block_read_capacity, struct nvmetcp_session *,
+		  nvmetcp_block_read_capacity ),
+	INTF_OP ( xfer_window, struct nvmetcp_session *, nvmetcp_window ),
+	INTF_OP ( intf_close, struct nvmetcp_session *, nvmetcp_close ),
+	EFI_INTF_OP ( efi_describe, struct nvmetcp_session *,
+		      nvmetcp_efi_describe ),
+};
+
+/** NVMe/TCP block control interface descriptor */
+static struct interface_descriptor nvmetcp_block_desc =
+	INTF_DESC ( struct nvmetcp_session, block, nvmetcp_block_op );
+
+/****************************************************************************
+ *
+ * Instantiator
+ *
+ */
+
+/**
+ * Parse NVMe/TCP URI path
+ *
+ * @v session		NVMe/TCP session
+ * @v path		URI path ("/<subnqn>[/<nsid>]")
+ * @ret rc		Return status code
+ */
+static int nvmetcp_parse_path ( struct nvmetcp_session *session,
+				const char *path ) {
+	const char *subnqn;
+	const char *sep;
+	char *end;
+	size_t len;
+
+	/* Extract subsystem NQN */
+	subnqn = ( path ? path : "" );
+	while ( *subnqn == '/' )
+		subnqn++;
+	sep = strchr ( subnqn, '/' );
+	len = ( sep ? ( ( size_t ) ( sep - subnqn ) ) : strlen ( subnqn ) );
+	if ( ! len ) {
+		DBGC ( session, "NVMe/TCP %p no subsystem NQN\n", session );
+		return -EINVAL_NO_SUBNQN;
+	}
+	if ( len >= sizeof ( session->connect.subnqn ) ) {
+		DBGC ( session, "NVMe/TCP %p subsystem NQN too long\n",
+		       session );
+		return -EINVAL_NQN_TOO_LONG;
+	}
+	memcpy ( session->connect.subnqn, subnqn, len );
+
+	/* Extract namespace identifier, if present */
+	session->nsid = 1;
+	if ( sep && sep[1] ) {
+		session->nsid = strtoul ( ( sep + 1 ), &end, 0 );
+		if ( *end || ( ! session->nsid ) ) {
+			DBGC ( session, "NVMe/TCP %p invalid namespace \"%s\"\n",
+			       session, ( sep + 1 ) );
+			return -EINVAL;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Fetch NVMe/TCP host identity from settings
+ *
+ * @v session		NVMe/TCP session
+ * @ret rc		Return status code
+ */
+static int nvmetcp_fetch_settings ( struct nvmetcp_session *session ) {
+	struct nvmf_connect_data *connect = &session->connect;
+	char *hostnqn = NULL;
+	char *hostname = NULL;
+	union uuid uuid;
+	int have_uuid;
+	int len;
+
+	/* Use system UUID as host identifier, if available */
+	have_uuid = ( fetch_uuid_setting ( NULL, &uuid_setting, &uuid ) >= 0 );
+	if ( have_uuid )
+		memcpy ( &connect->hostid, &uuid, sizeof ( connect->hostid ) );
+
+	/* Use explicit host NQN if provided, otherwise construct one
+	 * from the UUID or hostname.
+	 */
+	fetch_string_setting_copy ( NULL, &nvme_hostnqn_setting, &hostnqn );
+	if ( ! hostnqn ) {
+		if ( have_uuid ) {
+			len = asprintf ( &hostnqn,
+					 NVMETCP_UUID_HOSTNQN_PREFIX "%s",
+					 uuid_ntoa ( &uuid ) );
+		} else {
+			fetch_string_setting_copy ( NULL, &hostname_setting,
+						    &hostname );
+			if ( ! hostname ) {
+				DBGC ( session, "NVMe/TCP %p has no suitable "
+				       "host NQN\n", session );
+				return -EINVAL_NO_HOSTNQN;
+			}
+			len = asprintf ( &hostnqn,
+					 NVMETCP_DEFAULT_HOSTNQN_PREFIX "%s",
+					 hostname );
+			free ( hostname );
+		}
+		if ( len < 0 )
+			return -ENOMEM;
+	}
+	assert ( hostnqn );
+
+	/* Record host NQN */
+	len = strlen ( hostnqn );
+	if ( ( ( size_t ) len ) >= sizeof ( connect->hostnqn ) ) {
+		DBGC ( session, "NVMe/TCP %p host NQN too long\n", session );
+		free ( hostnqn );
+		return -EINVAL_NQN_TOO_LONG;
+	}
+	memcpy ( connect->hostnqn, hostnqn, len );
+	free ( hostnqn );
+
+	return 0;
+}
+
+/**
+ * Initialise NVMe/TCP queue
+ *
+ * @v session		NVMe/TCP session
+ * @v queue		NVMe/TCP queue
+ * @v qid		Queue identifier
+ * @v depth		Number of usable command slots
+ */
+static void nvmetcp_init_queue ( struct nvmetcp_session *session,
+				 struct nvmetcp_queue *queue,
+				 unsigned int qid, unsigned int depth ) {
+	unsigned int i;
+
+	queue->session = session;
+	queue->qid = qid;
+	queue->depth = depth;
+	queue->align = 4;
+	intf_init ( &queue->socket, &nvmetcp_socket_desc, &session->refcnt );
+	process_init_stopped ( &queue->process, &nvmetcp_process_desc,
+			       &session->refcnt );
+	for ( i = 0 ; i < NVMETCP_MAX_COMMANDS ; i++ ) {
+		queue->command[i].queue = queue;
+		intf_init ( &queue->command[i].block, &nvmetcp_command_desc,
+			    &session->refcnt );
+	}
+}
+
+/**
+ * Open NVMe/TCP URI
+ *
+ * @v parent		Parent interface
+ * @v uri		URI
+ * @ret rc		Return status code
+ */
+static int nvmetcp_open ( struct interface *parent, struct uri *uri ) {
+	struct nvmetcp_session *session;
+	int rc;
+
+	/* Sanity check */
+	if ( ! uri->host ) {
+		rc = -EINVAL;
+		goto err_sanity_uri;
+	}
+
+	/* Allocate and initialise structure */
+	session = zalloc ( sizeof ( *session ) );
+	if ( ! session ) {
+		rc = -ENOMEM;
+		goto err_zalloc;
+	}
+	ref_init ( &session->refcnt, nvmetcp_free );
+	intf_init ( &session->block, &nvmetcp_block_desc, &session->refcnt );
+	nvmetcp_init_queue ( session, &session->admin, 0, 1 );
+	nvmetcp_init_queue ( session, &session->io, 1, NVMETCP_MAX_COMMANDS );
+	timer_init ( &session->timer, nvmetcp_expired, &session->refcnt );
+	session->uri = uri_get ( uri );
+	session->target_port = uri_port ( uri, NVMETCP_PORT );
+	session->connect.cntlid = cpu_to_le16 ( NVMF_CNTLID_DYNAMIC );
+
+	/* Parse URI path and fetch host identity */
+	if ( ( rc = nvmetcp_parse_path ( session, uri->path ) ) != 0 )
+		goto err_parse_path;
+	if ( ( rc = nvmetcp_fetch_settings ( session ) ) != 0 )
+		goto err_fetch_settings;
+	DBGC ( session, "NVMe/TCP %p host %s\n",
+	       session, session->connect.hostnqn );
+	DBGC ( session, "NVMe/TCP %p target %s:%d %s namespace %d\n",
+	       session, uri->host, session->target_port,
+	       session->connect.subnqn, session->nsid );
+
+	/* Open admin queue */
+	if ( ( rc = nvmetcp_open_queue ( session, &session->admin ) ) != 0 )
+		goto err_open_queue;
+
+	/* Attach to parent interface, mortalise self, and return */
+	intf_plug_plug ( &session->block, parent );
+	ref_put ( &session->refcnt );
+	return 0;
+
+ err_open_queue:
+ err_fetch_settings:
+ err_parse_path:
+	nvmetcp_close ( session, rc );
+	ref_put ( &session->refcnt );
+ err_zalloc:
+ err_sanity_uri:
+	return rc;
+}
+
+/** NVMe/TCP URI opener */
+struct uri_opener nvmetcp_uri_opener __uri_opener = {
+	.scheme = "nvme-tcp",
+	.open = nvmetcp_open,
+};
@@ -51,6 +51,7 @@ FILE_LICENCE ( GPL2_OR_LATER );
 #include <ipxe/job.h>
 #include <ipxe/dhe.h>
 #include <ipxe/tls.h>
+#include <ipxe/timeline.h>
 #include <config/crypto.h>
 
 /* Disambiguate the various error causes */
@@ -194,6 +195,12 @@ FILE_LICENCE ( GPL2_OR_LATER );
 /** List of TLS session */
 static LIST_HEAD ( tls_sessions );
 
+/** TLS negotiation timeline phase */
+static struct timeline_phase tls_timeline
+	__timeline_phase ( TIMELINE_TLS ) = {
+	.name = "tls",
+};
+
 static void tls_tx_resume_all ( struct tls_session *session );
 static int tls_send_plaintext ( struct tls_connection *tls, unsigned int type,
 				const void *data, size_t len );
@@ -414,6 +421,10 @@ static void free_tls ( struct refcnt *refcnt ) {
  */
 static void tls_close ( struct tls_connection *tls, int rc ) {
 
+	/* Record end of any incomplete negotiation */
+	if ( ! tls_ready ( tls ) )
+		timeline_end ( &tls_timeline );
+
 	/* Remove pending operations, if applicable */
 	pending_put ( &tls->client_negotiation );
 	pending_put ( &tls->server_negotiation );
@@ -1121,6 +1132,7 @@ static void tls_restart ( struct tls_connection *tls ) {
 	tls_tx_resume ( tls );
 	pending_get ( &tls->client_negotiation );
 	pending_get ( &tls->server_negotiation );
+	timeline_begin ( &tls_timeline );
 }
 
 /**
@@ -1947,6 +1959,8 @@ static int tls_send_finished ( struct tls_connection *tls ) {
 
 	/* Mark client as finished */
 	pending_put ( &tls->client_negotiation );
+	if ( tls_ready ( tls ) )
+		timeline_end ( &tls_timeline );
 
 	return 0;
 }
@@ -2581,6 +2595,8 @@ static int tls_new_finished ( struct tls_connection *tls,
 
 	/* Mark server as finished */
 	pending_put ( &tls->server_negotiation );
+	if ( tls_ready ( tls ) )
+		timeline_end ( &tls_timeline );
 
 	/* If we are resuming a session (i.e. if the server Finished
 	 * arrives before the client Finished is sent), then schedule
@@ -3737,7 +3753,8 @@ static void tls_tx_step ( struct tls_connection *tls ) {
 
 /** TLS TX process descriptor */
 static struct process_descriptor tls_process_desc =
-	PROC_DESC_ONCE ( struct tls_connection, process, tls_tx_step );
+	PROC_DESC_ONCE_PRIO ( struct tls_connection, process, tls_tx_step,
+			     PROC_PRIO_NET );
 
 /******************************************************************************
  *
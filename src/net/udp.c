@@ -48,21 +48,38 @@ static struct interface_descriptor udp_xfer_desc;
 struct tcpip_protocol udp_protocol __tcpip_protocol;
 
 /**
- * Check if local UDP port is available
+ * Check if local UDP port is available within a scope
  *
  * @v port		Local port number
+ * @v scope_id		Scope ID, or zero for all scopes
  * @ret port		Local port number, or negative error
+ *
+ * Connections bound to the same port may coexist only if they are
+ * bound to different (non-zero) scopes, i.e. to different network
+ * devices.
  */
-static int udp_port_available ( int port ) {
+static int udp_scope_port_available ( int port, unsigned int scope_id ) {
 	struct udp_connection *udp;
 
 	list_for_each_entry ( udp, &udp_conns, list ) {
-		if ( udp->local.st_port == htons ( port ) )
+		if ( ( udp->local.st_port == htons ( port ) ) &&
+		     ( ( ! scope_id ) || ( ! udp->local.st_scope_id ) ||
+		       ( udp->local.st_scope_id == scope_id ) ) )
 			return -EADDRINUSE;
 	}
 	return port;
 }
 
+/**
+ * Check if local UDP port is available
+ *
+ * @v port		Local port number
+ * @ret port		Local port number, or negative error
+ */
+static int udp_port_available ( int port ) {
+	return udp_scope_port_available ( port, 0 );
+}
+
 /**
  * Open a UDP connection
  *
@@ -95,7 +112,14 @@ static int udp_open_common ( struct interface *xfer,
 
 	/* Bind to local port */
 	if ( ! promisc ) {
-		port = tcpip_bind ( st_local, udp_port_available );
+		if ( st_local && st_local->st_port &&
+		     st_local->st_scope_id ) {
+			port = ntohs ( st_local->st_port );
+			port = udp_scope_port_available ( port,
+							  st_local->st_scope_id );
+		} else {
+			port = tcpip_bind ( st_local, udp_port_available );
+		}
 		if ( port < 0 ) {
 			rc = port;
 			DBGC ( udp, "UDP %p could not bind: %s\n",
@@ -222,9 +246,11 @@ static int udp_tx ( struct udp_connection *udp, struct io_buffer *iobuf,
  * Identify UDP connection by local address
  *
  * @v local		Local address
+ * @v netdev		Network device
  * @ret udp		UDP connection, or NULL
  */
-static struct udp_connection * udp_demux ( struct sockaddr_tcpip *local ) {
+static struct udp_connection * udp_demux ( struct sockaddr_tcpip *local,
+					   struct net_device *netdev ) {
 	static const struct sockaddr_tcpip empty_sockaddr = { .pad = { 0, } };
 	struct udp_connection *udp;
 
@@ -233,6 +259,8 @@ static struct udp_connection * udp_demux ( struct sockaddr_tcpip *local ) {
 		       ( udp->local.st_family == 0 ) ) &&
 		     ( ( udp->local.st_port == local->st_port ) ||
 		       ( udp->local.st_port == 0 ) ) &&
+		     ( ( udp->local.st_scope_id == 0 ) ||
+		       ( udp->local.st_scope_id == netdev->scope_id ) ) &&
 		     ( ( memcmp ( udp->local.pad, local->pad,
 				  sizeof ( udp->local.pad ) ) == 0 ) ||
 		       ( memcmp ( udp->local.pad, empty_sockaddr.pad,
@@ -254,7 +282,7 @@ static struct udp_connection * udp_demux ( struct sockaddr_tcpip *local ) {
  * @ret rc		Return status code
  */
 static int udp_rx ( struct io_buffer *iobuf,
-		    struct net_device *netdev __unused,
+		    struct net_device *netdev,
 		    struct sockaddr_tcpip *st_src,
 		    struct sockaddr_tcpip *st_dest, uint16_t pshdr_csum ) {
 	struct udp_header *udphdr = iobuf->data;
@@ -298,7 +326,7 @@ static int udp_rx ( struct io_buffer *iobuf,
 	/* Parse parameters from header and strip header */
 	st_src->st_port = udphdr->src;
 	st_dest->st_port = udphdr->dest;
-	udp = udp_demux ( st_dest );
+	udp = udp_demux ( st_dest, netdev );
 	iob_unput ( iobuf, ( iob_len ( iobuf ) - ulen ) );
 	iob_pull ( iobuf, sizeof ( *udphdr ) );
 
@@ -32,6 +32,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <byteswap.h>
 #include <ipxe/if_ether.h>
 #include <ipxe/iobuf.h>
+#include <ipxe/list.h>
 #include <ipxe/netdevice.h>
 #include <ipxe/device.h>
 #include <ipxe/xfer.h>
@@ -48,6 +49,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/dhcppkt.h>
 #include <ipxe/dhcparch.h>
 #include <ipxe/features.h>
+#include <ipxe/timeline.h>
 #include <config/dhcp.h>
 
 /** @file
@@ -116,13 +118,24 @@ const struct setting dhcp_server_setting __setting ( SETTING_MISC,
 };
 
 /**
- * Most recent DHCP transaction ID
+ * Most recent successful DHCP transaction ID
  *
- * This is exposed for use by the fakedhcp code when reconstructing
- * DHCP packets for PXE NBPs.
+ * This is recorded when a DHCPACK is accepted, so that it matches
+ * the registered DHCP settings even when several DHCP sessions run
+ * in parallel.  It is exposed for use by the fakedhcp code when
+ * reconstructing DHCP packets for PXE NBPs.
  */
 uint32_t dhcp_last_xid;
 
+/** Active DHCP sessions (excluding PXE Boot Server Discovery) */
+static LIST_HEAD ( dhcp_sessions );
+
+/** DHCP timeline phase */
+static struct timeline_phase dhcp_timeline
+	__timeline_phase ( TIMELINE_DHCP ) = {
+	.name = "dhcp",
+};
+
 /**
  * Name a DHCP packet type
  *
@@ -204,6 +217,8 @@ struct dhcp_session {
 	struct interface job;
 	/** Data transfer interface */
 	struct interface xfer;
+	/** List of active DHCP sessions */
+	struct list_head list;
 
 	/** Network device being configured */
 	struct net_device *netdev;
@@ -220,6 +235,8 @@ struct dhcp_session {
 	struct in_addr server;
 	/** DHCP offer priority */
 	int priority;
+	/** Session has claimed the global DHCP state */
+	int claimed;
 
 	/** ProxyDHCP protocol extensions should be ignored */
 	int no_pxedhcp;
@@ -267,14 +284,59 @@ static void dhcp_free ( struct refcnt *refcnt ) {
  */
 static void dhcp_finished ( struct dhcp_session *dhcp, int rc ) {
 
+	/* Record end of DHCP phase */
+	timeline_end ( &dhcp_timeline );
+
 	/* Stop retry timer */
 	stop_timer ( &dhcp->timer );
 
+	/* Remove from list of active sessions */
+	list_del ( &dhcp->list );
+	INIT_LIST_HEAD ( &dhcp->list );
+
 	/* Shut down interfaces */
 	intf_shutdown ( &dhcp->xfer, rc );
 	intf_shutdown ( &dhcp->job, rc );
 }
 
+/**
+ * Claim global DHCP state
+ *
+ * @v dhcp		DHCP session
+ * @ret rc		Return status code
+ *
+ * The ProxyDHCP and PXEBS settings blocks and the recorded
+ * transaction ID are global.  When several network devices are
+ * configured in parallel, only the first session to accept a lease
+ * may update them, and all other active sessions are cancelled.
+ */
+static int dhcp_claim ( struct dhcp_session *dhcp ) {
+	struct dhcp_session *other;
+	struct dhcp_session *tmp;
+
+	/* Fail if another session has already claimed the global state */
+	list_for_each_entry ( other, &dhcp_sessions, list ) {
+		if ( other->claimed ) {
+			DBGC ( dhcp, "DHCP %p superseded by DHCP %p\n",
+			       dhcp, other );
+			return -ECANCELED;
+		}
+	}
+
+	/* Claim global state */
+	dhcp->claimed = 1;
+
+	/* Cancel all other sessions */
+	list_for_each_entry_safe ( other, tmp, &dhcp_sessions, list ) {
+		if ( other == dhcp )
+			continue;
+		DBGC ( other, "DHCP %p cancelled by DHCP %p\n", other, dhcp );
+		dhcp_finished ( other, -ECANCELED );
+	}
+
+	return 0;
+}
+
 /**
  * Transition to new DHCP session state
  *
@@ -588,6 +650,12 @@ static void dhcp_request_rx ( struct dhcp_session *dhcp,
 	if ( ip.s_addr != dhcp->offer.s_addr )
 		return;
 
+	/* Claim global DHCP state */
+	if ( ( rc = dhcp_claim ( dhcp ) ) != 0 ) {
+		dhcp_finished ( dhcp, rc );
+		return;
+	}
+
 	/* Record assigned address */
 	dhcp->local.sin_addr = ip;
 
@@ -602,6 +670,9 @@ static void dhcp_request_rx ( struct dhcp_session *dhcp,
 		return;
 	}
 
+	/* Store DHCP transaction ID for fakedhcp code */
+	dhcp_last_xid = dhcp->xid;
+
 	/* Unregister any existing ProxyDHCP or PXEBS settings */
 	if ( ( settings = find_settings ( PROXYDHCP_SETTINGS_NAME ) ) != NULL )
 		unregister_settings ( settings );
@@ -1362,18 +1433,18 @@ int start_dhcp ( struct interface *job, struct net_device *netdev ) {
 	dhcp = zalloc ( sizeof ( *dhcp ) );
 	if ( ! dhcp )
 		return -ENOMEM;
+	timeline_begin ( &dhcp_timeline );
 	ref_init ( &dhcp->refcnt, dhcp_free );
 	intf_init ( &dhcp->job, &dhcp_job_desc, &dhcp->refcnt );
 	intf_init ( &dhcp->xfer, &dhcp_xfer_desc, &dhcp->refcnt );
 	timer_init ( &dhcp->timer, dhcp_timer_expired, &dhcp->refcnt );
+	list_add_tail ( &dhcp->list, &dhcp_sessions );
 	dhcp->netdev = netdev_get ( netdev );
 	dhcp->local.sin_family = AF_INET;
 	dhcp->local.sin_port = htons ( BOOTPC_PORT );
+	dhcp->local.sin_scope_id = netdev->scope_id;
 	dhcp->xid = random();
 
-	/* Store DHCP transaction ID for fakedhcp code */
-	dhcp_last_xid = dhcp->xid;
-
 	/* Instantiate child objects and attach to our interfaces */
 	if ( ( rc = xfer_open_socket ( &dhcp->xfer, SOCK_DGRAM, &dhcp_peer,
 				  ( struct sockaddr * ) &dhcp->local ) ) != 0 )
@@ -1470,15 +1541,18 @@ int start_pxebs ( struct interface *job, struct net_device *netdev,
 			sizeof ( *ip ) /* terminator */ );
 	if ( ! dhcp )
 		return -ENOMEM;
+	timeline_begin ( &dhcp_timeline );
 	ref_init ( &dhcp->refcnt, dhcp_free );
 	intf_init ( &dhcp->job, &dhcp_job_desc, &dhcp->refcnt );
 	intf_init ( &dhcp->xfer, &dhcp_xfer_desc, &dhcp->refcnt );
 	timer_init ( &dhcp->timer, dhcp_timer_expired, &dhcp->refcnt );
+	INIT_LIST_HEAD ( &dhcp->list );
 	dhcp->netdev = netdev_get ( netdev );
 	dhcp->local.sin_family = AF_INET;
 	fetch_ipv4_setting ( netdev_settings ( netdev ), &ip_setting,
 			     &dhcp->local.sin_addr );
 	dhcp->local.sin_port = htons ( BOOTPC_PORT );
+	dhcp->local.sin_scope_id = netdev->scope_id;
 	dhcp->pxe_type = cpu_to_le16 ( pxe_type );
 
 	/* Construct PXE boot server IP address lists */
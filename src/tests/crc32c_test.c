@@ -0,0 +1,183 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * CRC32C tests
+ *
+ * The 32-byte test vectors are taken from RFC 3720 section B.4.  The
+ * RFC lists the final inverted CRC values; the expected values here
+ * are the uninverted CRC values, as returned by crc32c_le().
+ *
+ */
+
+/* Forcibly enable assertions */
+#undef NDEBUG
+
+#include <stdint.h>
+#include <string.h>
+#include <ipxe/crc32c.h>
+#include <ipxe/test.h>
+
+/** Define inline data */
+#define DATA(...) { __VA_ARGS__ }
+
+/** A CRC32C test */
+struct crc32c_test {
+	/** Test data */
+	const void *data;
+	/** Length of test data */
+	size_t len;
+	/** Seed */
+	uint32_t seed;
+	/** Expected CRC32C */
+	uint32_t crc32c;
+};
+
+/**
+ * Define a CRC32C test
+ *
+ * @v name		Test name
+ * @v DATA		Test data
+ * @v SEED		Seed
+ * @v CRC32C		Expected CRC32C
+ * @ret test		CRC32C test
+ */
+#define CRC32C_TEST( name, DATA, SEED, CRC32C )				\
+	static const uint8_t name ## _data[] = DATA;			\
+	static struct crc32c_test name = {				\
+		.data = name ## _data,					\
+		.len = sizeof ( name ## _data ),			\
+		.seed = SEED,						\
+		.crc32c = CRC32C,					\
+	};
+
+/**
+ * Report a CRC32C test result
+ *
+ * @v test		CRC32C test
+ */
+#define crc32c_ok( test ) do {						\
+	uint32_t crc32c;						\
+	crc32c = crc32c_le ( (test)->seed, (test)->data, (test)->len );	\
+	ok ( crc32c == (test)->crc32c );				\
+	crc32c = generic_crc32c_le ( (test)->seed, (test)->data,	\
+				     (test)->len );			\
+	ok ( crc32c == (test)->crc32c );				\
+	} while ( 0 )
+
+/* CRC32C tests */
+CRC32C_TEST ( empty_test,
+	      DATA ( ),
+	      0x12345678UL, 0x12345678UL );
+CRC32C_TEST ( zeros_test,
+	      DATA ( 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 ),
+	      0xffffffffUL, 0x756ec955UL );
+CRC32C_TEST ( ones_test,
+	      DATA ( 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		     0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		     0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		     0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff ),
+	      0xffffffffUL, 0x9d5754bcUL );
+CRC32C_TEST ( incrementing_test,
+	      DATA ( 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+		     0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+		     0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17,
+		     0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f ),
+	      0xffffffffUL, 0xb92286b1UL );
+CRC32C_TEST ( decrementing_test,
+	      DATA ( 0x1f, 0x1e, 0x1d, 0x1c, 0x1b, 0x1a, 0x19, 0x18,
+		     0x17, 0x16, 0x15, 0x14, 0x13, 0x12, 0x11, 0x10,
+		     0x0f, 0x0e, 0x0d, 0x0c, 0x0b, 0x0a, 0x09, 0x08,
+		     0x07, 0x06, 0x05, 0x04, 0x03, 0x02, 0x01, 0x00 ),
+	      0xffffffffUL, 0xeec024a3UL );
+CRC32C_TEST ( hw_test,
+	      DATA ( 'h', 'e', 'l', 'l', 'o', ' ', 'w', 'o', 'r', 'l', 'd' ),
+	      0xffffffffUL, 0x366b9a55UL );
+CRC32C_TEST ( hw_split_part1_test,
+	      DATA ( 'h', 'e', 'l', 'l', 'o' ),
+	      0xffffffffUL, 0x658e44b3UL );
+CRC32C_TEST ( hw_split_part2_test,
+	      DATA ( ' ', 'w', 'o', 'r', 'l', 'd' ),
+	      0x658e44b3UL, 0x366b9a55UL );
+
+/**
+ * Check that CRC32C implementation agrees with generic implementation
+ *
+ * Exercise all combinations of alignment and length (including
+ * partial trailing words) for any accelerated implementation.
+ */
+static void crc32c_consistency_ok ( void ) {
+	static uint8_t data[ 16 + 128 ];
+	unsigned int offset;
+	unsigned int len;
+	unsigned int i;
+	uint32_t expected;
+	uint32_t crc32c;
+	int fail = 0;
+
+	/* Construct pseudo-random test data */
+	for ( i = 0 ; i < sizeof ( data ) ; i++ )
+		data[i] = ( ( i * 0x9d ) ^ ( i >> 3 ) );
+
+	/* Compare implementations */
+	for ( offset = 0 ; offset < 16 ; offset++ ) {
+		for ( len = 0 ; len <= 128 ; len++ ) {
+			expected = generic_crc32c_le ( 0xffffffffUL,
+						       &data[offset], len );
+			crc32c = crc32c_le ( 0xffffffffUL,
+					     &data[offset], len );
+			if ( crc32c != expected )
+				fail = 1;
+		}
+	}
+	ok ( ! fail );
+}
+
+/**
+ * Perform CRC32C self-tests
+ *
+ */
+static void crc32c_test_exec ( void ) {
+
+	crc32c_ok ( &empty_test );
+	crc32c_ok ( &zeros_test );
+	crc32c_ok ( &ones_test );
+	crc32c_ok ( &incrementing_test );
+	crc32c_ok ( &decrementing_test );
+	crc32c_ok ( &hw_test );
+	crc32c_ok ( &hw_split_part1_test );
+	crc32c_ok ( &hw_split_part2_test );
+	crc32c_consistency_ok();
+}
+
+/** CRC32C self-test */
+struct self_test crc32c_test __self_test = {
+	.name = "crc32c",
+	.exec = crc32c_test_exec,
+};
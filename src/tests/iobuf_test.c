@@ -99,6 +99,79 @@ static inline void alloc_iob_fail_okx ( size_t len, size_t align, size_t offset,
 #define alloc_iob_fail_ok( len, align, offset ) \
 	alloc_iob_fail_okx ( len, align, offset, __FILE__, __LINE__ )
 
+/**
+ * Report receive I/O buffer pool test result
+ *
+ * @v len		Length of each buffer
+ * @v count		Number of buffers
+ * @v file		Test code file
+ * @v line		Test code line
+ */
+static void iob_pool_okx ( size_t len, unsigned int count,
+			   const char *file, unsigned int line ) {
+	static struct dma_device dma;
+	struct io_buffer *iobuf[ count + 1 ];
+	struct io_buffer *large;
+	struct iob_pool *pool;
+	void *region;
+	unsigned int i;
+
+	/* Allocate pool */
+	pool = alloc_iob_pool ( &dma, len, count );
+	okx ( pool != NULL, file, line );
+	if ( ! pool )
+		return;
+
+	/* Allocate all buffers from pool */
+	for ( i = 0 ; i < count ; i++ ) {
+		iobuf[i] = iob_pool_alloc ( pool, len, &dma );
+		okx ( iobuf[i] != NULL, file, line );
+		okx ( iobuf[i]->pool == pool, file, line );
+		okx ( iob_len ( iobuf[i] ) == 0, file, line );
+		okx ( iob_tailroom ( iobuf[i] ) >= len, file, line );
+		okx ( ! dma_mapped ( &iobuf[i]->map ), file, line );
+		okx ( ( virt_to_phys ( iobuf[i]->data ) &
+			( pool->stride - 1 ) ) == 0, file, line );
+		memset ( iob_put ( iobuf[i], len ), i, len );
+	}
+
+	/* Check fallback when pool is exhausted */
+	iobuf[count] = iob_pool_alloc ( pool, len, &dma );
+	okx ( iobuf[count] != NULL, file, line );
+	okx ( iobuf[count]->pool == NULL, file, line );
+
+	/* Check fallback for oversized buffers */
+	free_iob ( iobuf[0] );
+	large = iob_pool_alloc ( pool, ( pool->len + 1 ), &dma );
+	okx ( large != NULL, file, line );
+	okx ( large->pool == NULL, file, line );
+	free_rx_iob ( large );
+
+	/* Check that freed buffers are reused, with contents reset */
+	iobuf[0] = iob_pool_alloc ( pool, len, &dma );
+	okx ( iobuf[0] != NULL, file, line );
+	okx ( iobuf[0]->pool == pool, file, line );
+	okx ( iob_len ( iobuf[0] ) == 0, file, line );
+
+	/* Release pool while buffers are still outstanding */
+	memset ( iob_put ( iobuf[0], len ), 0xa5, len );
+	region = pool->data;
+	free_iob_pool ( pool );
+	okx ( ( iobuf[0]->head < region ) ||
+	      ( iobuf[0]->head >= ( region + ( count * pool->stride ) ) ),
+	      file, line );
+	okx ( iob_len ( iobuf[0] ) == len, file, line );
+	for ( i = 0 ; i < len ; i++ ) {
+		if ( ( ( uint8_t * ) iobuf[0]->data )[i] != 0xa5 )
+			break;
+	}
+	okx ( i == len, file, line );
+	for ( i = 0 ; i <= count ; i++ )
+		free_rx_iob ( iobuf[i] );
+}
+#define iob_pool_ok( len, count ) \
+	iob_pool_okx ( len, count, __FILE__, __LINE__ )
+
 /**
  * Perform I/O buffer self-tests
  *
@@ -127,6 +200,12 @@ static void iobuf_test_exec ( void ) {
 	alloc_iob_fail_ok ( -1UL, 1024, 0 );
 	alloc_iob_fail_ok ( 0, -1UL, 0 );
 	alloc_iob_fail_ok ( 1024, -1UL, 0 );
+
+	/* Check receive buffer pools */
+	iob_pool_ok ( 0, 1 );
+	iob_pool_ok ( 1522, 4 );
+	iob_pool_ok ( 2048, 8 );
+	iob_pool_ok ( 9728, 3 );
 }
 
 /** I/O buffer self-test */
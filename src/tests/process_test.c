@@ -0,0 +1,155 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * Process scheduler tests
+ *
+ */
+
+/* Forcibly enable assertions */
+#undef NDEBUG
+
+#include <ipxe/process.h>
+#include <ipxe/test.h>
+
+/** Number of steps used for scheduling tests */
+#define PROCESS_TEST_STEPS 1000
+
+/** A process test */
+struct process_test {
+	/** Process */
+	struct process process;
+	/** Number of steps executed */
+	unsigned int count;
+	/** Sequence number of most recent step */
+	unsigned int seq;
+};
+
+/** Process test sequence counter */
+static unsigned int process_test_seq;
+
+/**
+ * Single-step test process
+ *
+ * @v test		Process test
+ */
+static void process_test_step ( struct process_test *test ) {
+	test->count++;
+	test->seq = ++process_test_seq;
+}
+
+/** Network data path one-shot test process descriptor */
+static struct process_descriptor process_test_net_once_desc =
+	PROC_DESC_ONCE_PRIO ( struct process_test, process, process_test_step,
+			      PROC_PRIO_NET );
+
+/** Normal one-shot test process descriptor */
+static struct process_descriptor process_test_normal_once_desc =
+	PROC_DESC_ONCE ( struct process_test, process, process_test_step );
+
+/** Network data path test process descriptor */
+static struct process_descriptor process_test_net_desc =
+	PROC_DESC_PRIO ( struct process_test, process, process_test_step,
+			 PROC_PRIO_NET );
+
+/** Normal test process descriptor */
+static struct process_descriptor process_test_normal_desc =
+	PROC_DESC ( struct process_test, process, process_test_step );
+
+/** Background test process descriptor */
+static struct process_descriptor process_test_background_desc =
+	PROC_DESC_PRIO ( struct process_test, process, process_test_step,
+			 PROC_PRIO_BACKGROUND );
+
+/**
+ * Initialise and start test process
+ *
+ * @v test		Process test
+ * @v desc		Process descriptor
+ */
+static void process_test_init ( struct process_test *test,
+				struct process_descriptor *desc ) {
+
+	test->count = 0;
+	test->seq = 0;
+	process_init ( &test->process, desc, NULL );
+}
+
+/**
+ * Perform process scheduler self-tests
+ *
+ */
+static void process_test_exec ( void ) {
+	struct process_test high;
+	struct process_test normal;
+	struct process_test low;
+	unsigned int i;
+
+	/* A higher priority process runs first, even if started last */
+	process_test_init ( &normal, &process_test_normal_once_desc );
+	process_test_init ( &high, &process_test_net_once_desc );
+	for ( i = 0 ; ( process_running ( &high.process ) ||
+			process_running ( &normal.process ) ) &&
+		      ( i < PROCESS_TEST_STEPS ) ; i++ ) {
+		step();
+	}
+	ok ( high.count == 1 );
+	ok ( normal.count == 1 );
+	ok ( high.seq < normal.seq );
+
+	/* Lower priority classes are not starved */
+	process_test_init ( &high, &process_test_net_desc );
+	process_test_init ( &normal, &process_test_normal_desc );
+	process_test_init ( &low, &process_test_background_desc );
+	for ( i = 0 ; i < PROCESS_TEST_STEPS ; i++ )
+		step();
+	ok ( high.count > normal.count );
+	ok ( normal.count > low.count );
+	ok ( low.count > 0 );
+
+	/* A lower priority class runs freely once higher classes sleep */
+	process_del ( &high.process );
+	process_del ( &normal.process );
+	low.count = 0;
+	for ( i = 0 ; i < PROCESS_TEST_STEPS ; i++ )
+		step();
+	ok ( low.count > ( PROCESS_TEST_STEPS / 2 ) );
+
+	/* Stopped processes are no longer stepped */
+	process_del ( &low.process );
+	high.count = normal.count = low.count = 0;
+	for ( i = 0 ; i < PROCESS_TEST_STEPS ; i++ )
+		step();
+	ok ( high.count == 0 );
+	ok ( normal.count == 0 );
+	ok ( low.count == 0 );
+}
+
+/** Process scheduler self-test */
+struct self_test process_test __self_test = {
+	.name = "process",
+	.exec = process_test_exec,
+};
@@ -47,13 +47,19 @@ struct profile_test {
 	unsigned long mean;
 	/** Expected standard deviation */
 	unsigned long stddev;
+	/** Expected median (upper bound) */
+	unsigned long p50;
+	/** Expected 99th percentile (upper bound) */
+	unsigned long p99;
+	/** Expected maximum sample value */
+	unsigned long max;
 };
 
 /** Define inline data */
 #define DATA(...) { __VA_ARGS__ }
 
 /** Define a profiling test */
-#define PROFILE_TEST( name, MEAN, STDDEV, SAMPLES )			\
+#define PROFILE_TEST( name, MEAN, STDDEV, P50, P99, MAX, SAMPLES )	\
 	static const unsigned long name ## _samples[] = SAMPLES;	\
 	static struct profile_test name = {				\
 		.samples = name ## _samples,				\
@@ -61,31 +67,40 @@ struct profile_test {
 			   sizeof ( name ## _samples [0] ) ),		\
 		.mean = MEAN,						\
 		.stddev = STDDEV,					\
+		.p50 = P50,						\
+		.p99 = P99,						\
+		.max = MAX,						\
 	}
 
 /** Empty data set */
-PROFILE_TEST ( empty, 0, 0, DATA() );
+PROFILE_TEST ( empty, 0, 0, 0, 0, 0, DATA() );
 
 /** Single-element data set (zero) */
-PROFILE_TEST ( zero, 0, 0, DATA ( 0 ) );
+PROFILE_TEST ( zero, 0, 0, 0, 0, 0, DATA ( 0 ) );
 
 /** Single-element data set (non-zero) */
-PROFILE_TEST ( single, 42, 0, DATA ( 42 ) );
+PROFILE_TEST ( single, 42, 0, 42, 42, 42, DATA ( 42 ) );
 
 /** Multiple identical element data set */
-PROFILE_TEST ( identical, 69, 0, DATA ( 69, 69, 69, 69, 69, 69, 69 ) );
+PROFILE_TEST ( identical, 69, 0, 69, 69, 69,
+	       DATA ( 69, 69, 69, 69, 69, 69, 69 ) );
 
 /** Small element data set */
-PROFILE_TEST ( small, 5, 2, DATA ( 3, 5, 9, 4, 3, 2, 5, 7 ) );
+PROFILE_TEST ( small, 5, 2, 7, 9, 9, DATA ( 3, 5, 9, 4, 3, 2, 5, 7 ) );
+
+/** Skewed data set */
+PROFILE_TEST ( skewed, 101, 315, 1, 1000, 1000,
+	       DATA ( 1, 1, 1, 1, 1, 1, 1, 1, 1, 1000 ) );
 
 /** Random data set */
-PROFILE_TEST ( random, 70198, 394,
+PROFILE_TEST ( random, 70198, 394, 71078, 71078, 71078,
 	       DATA ( 69772, 70068, 70769, 69653, 70663, 71078, 70101, 70341,
 		      70215, 69600, 70020, 70456, 70421, 69972, 70267, 69999,
 		      69972 ) );
 
 /** Large-valued random data set */
-PROFILE_TEST ( large, 93533894UL, 25538UL,
+PROFILE_TEST ( large, 93533894UL, 25538UL, 93586731UL, 93586731UL,
+	       93586731UL,
 	       DATA ( 93510333UL, 93561169UL, 93492361UL, 93528647UL,
 		      93557566UL, 93503465UL, 93540126UL, 93549020UL,
 		      93502307UL, 93527320UL, 93537152UL, 93540125UL,
@@ -103,6 +118,8 @@ static void profile_okx ( struct profile_test *test, const char *file,
 	struct profiler profiler;
 	unsigned long mean;
 	unsigned long stddev;
+	unsigned long p50;
+	unsigned long p99;
 	unsigned int i;
 
 	/* Initialise profiler */
@@ -115,9 +132,29 @@ static void profile_okx ( struct profile_test *test, const char *file,
 	/* Check resulting statistics */
 	mean = profile_mean ( &profiler );
 	stddev = profile_stddev ( &profiler );
-	DBGC ( test, "PROFILE calculated mean %ld stddev %ld\n", mean, stddev );
+	p50 = profile_percentile ( &profiler, 50 );
+	p99 = profile_percentile ( &profiler, 99 );
+	DBGC ( test, "PROFILE calculated mean %ld stddev %ld p50 %ld p99 %ld "
+	       "max %ld\n", mean, stddev, p50, p99, profiler.max );
 	okx ( mean == test->mean, file, line );
 	okx ( stddev == test->stddev, file, line );
+	okx ( p50 == test->p50, file, line );
+	okx ( p99 == test->p99, file, line );
+	okx ( profiler.max == test->max, file, line );
+
+	/* Check that reset discards all statistics */
+	profile_reset ( &profiler );
+	okx ( profiler.count == 0, file, line );
+	okx ( profiler.max == 0, file, line );
+	okx ( profile_mean ( &profiler ) == 0, file, line );
+	okx ( profile_percentile ( &profiler, 99 ) == 0, file, line );
+
+	/* Check that a disabled profiler ignores samples */
+	profiler.disabled = 1;
+	for ( i = 0 ; i < test->count ; i++ )
+		profile_update ( &profiler, test->samples[i] );
+	okx ( profiler.count == 0, file, line );
+	okx ( profile_percentile ( &profiler, 50 ) == 0, file, line );
 }
 #define profile_ok( test ) profile_okx ( test, __FILE__, __LINE__ )
 
@@ -133,6 +170,7 @@ static void profile_test_exec ( void ) {
 	profile_ok ( &single );
 	profile_ok ( &identical );
 	profile_ok ( &small );
+	profile_ok ( &skewed );
 	profile_ok ( &random );
 	profile_ok ( &large );
 }
@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * Retry timer tests
+ *
+ */
+
+/* Forcibly enable assertions */
+#undef NDEBUG
+
+#include <string.h>
+#include <ipxe/timer.h>
+#include <ipxe/retry.h>
+#include <ipxe/test.h>
+
+/** Maximum time to wait for a test timer to expire */
+#define RETRY_TEST_MAX_WAIT ( TICKS_PER_SEC / 2 )
+
+/** A retry timer test */
+struct retry_test {
+	/** Retry timer */
+	struct retry_timer timer;
+	/** Number of expiries */
+	unsigned int expired;
+	/** Time of most recent expiry */
+	unsigned long when;
+	/** Timer to be stopped on expiry, if any */
+	struct retry_test *victim;
+	/** Restart timer with no delay on expiry */
+	int restart;
+};
+
+/**
+ * Handle test timer expiry
+ *
+ * @v timer		Retry timer
+ * @v over		Failure indicator
+ */
+static void retry_test_expired ( struct retry_timer *timer,
+				 int over __unused ) {
+	struct retry_test *test =
+		container_of ( timer, struct retry_test, timer );
+
+	test->expired++;
+	test->when = currticks();
+	if ( test->victim )
+		stop_timer ( &test->victim->timer );
+	if ( test->restart )
+		start_timer_nodelay ( &test->timer );
+}
+
+/**
+ * Initialise test timer
+ *
+ * @v test		Retry timer test
+ */
+static void retry_test_init ( struct retry_test *test ) {
+
+	memset ( test, 0, sizeof ( *test ) );
+	timer_init ( &test->timer, retry_test_expired, NULL );
+}
+
+/**
+ * Poll retry timers until a test timer has expired
+ *
+ * @v test		Retry timer test
+ */
+static void retry_test_wait ( struct retry_test *test ) {
+	unsigned long start = currticks();
+
+	while ( timer_running ( &test->timer ) &&
+		( ( currticks() - start ) < RETRY_TEST_MAX_WAIT ) ) {
+		retry_poll();
+	}
+}
+
+/**
+ * Perform retry timer self-tests
+ *
+ */
+static void retry_test_exec ( void ) {
+	struct retry_test immediate;
+	struct retry_test shorter;
+	struct retry_test longer;
+	struct retry_test victim;
+	unsigned long start;
+
+	/* Timers expire in order, including timers beyond one
+	 * rotation of the timing wheel.
+	 */
+	retry_test_init ( &immediate );
+	retry_test_init ( &shorter );
+	retry_test_init ( &longer );
+	start = currticks();
+	start_timer_fixed ( &longer.timer, 150 );
+	start_timer_fixed ( &shorter.timer, 5 );
+	start_timer_nodelay ( &immediate.timer );
+	retry_poll();
+	ok ( immediate.expired == 1 );
+	ok ( timer_running ( &shorter.timer ) );
+	retry_test_wait ( &longer );
+	ok ( shorter.expired == 1 );
+	ok ( longer.expired == 1 );
+	ok ( ( shorter.when - start ) >= 5 );
+	ok ( ( longer.when - start ) >= 150 );
+	ok ( ( longer.when - shorter.when ) > 0 );
+
+	/* Restarting a running timer moves its expiry */
+	retry_test_init ( &shorter );
+	start_timer_fixed ( &shorter.timer, ( 10 * TICKS_PER_SEC ) );
+	start_timer_fixed ( &shorter.timer, 2 );
+	retry_test_wait ( &shorter );
+	ok ( shorter.expired == 1 );
+
+	/* Stopped timers do not expire */
+	retry_test_init ( &shorter );
+	start_timer_fixed ( &shorter.timer, 2 );
+	stop_timer ( &shorter.timer );
+	start = currticks();
+	while ( ( currticks() - start ) < 5 )
+		retry_poll();
+	ok ( shorter.expired == 0 );
+
+	/* An expiry may stop another due timer */
+	retry_test_init ( &immediate );
+	retry_test_init ( &victim );
+	immediate.victim = &victim;
+	start_timer_nodelay ( &immediate.timer );
+	start_timer_nodelay ( &victim.timer );
+	retry_poll();
+	ok ( immediate.expired == 1 );
+	ok ( victim.expired == 0 );
+	ok ( ! timer_running ( &victim.timer ) );
+
+	/* A timer restarted by its own expiry expires once per poll */
+	retry_test_init ( &immediate );
+	immediate.restart = 1;
+	start_timer_nodelay ( &immediate.timer );
+	retry_poll();
+	ok ( immediate.expired == 1 );
+	retry_poll();
+	ok ( immediate.expired == 2 );
+	stop_timer ( &immediate.timer );
+}
+
+/** Retry timer self-test */
+struct self_test retry_test __self_test = {
+	.name = "retry",
+	.exec = retry_test_exec,
+};
@@ -0,0 +1,482 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * SAN device tests
+ *
+ */
+
+/* Forcibly enable assertions */
+#undef NDEBUG
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <ipxe/refcnt.h>
+#include <ipxe/interface.h>
+#include <ipxe/process.h>
+#include <ipxe/xfer.h>
+#include <ipxe/blockdev.h>
+#include <ipxe/open.h>
+#include <ipxe/uri.h>
+#include <ipxe/uaccess.h>
+#include <ipxe/umalloc.h>
+#include <ipxe/iso9660.h>
+#include <ipxe/sanboot.h>
+#include <ipxe/test.h>
+
+/** Test SAN device block size */
+#define SANBOOT_TEST_BLKSIZE 512
+
+/** Test SAN device number of blocks */
+#define SANBOOT_TEST_BLOCKS 4096
+
+/** Test SAN device maximum number of blocks per transfer */
+#define SANBOOT_TEST_MAX_COUNT 64
+
+/** Test SAN device maximum number of concurrent commands */
+#define SANBOOT_TEST_MAX_COMMANDS ( ( 2 * SAN_MAX_QUEUE_DEPTH ) + 1 )
+
+/** Test SAN drive number */
+#define SANBOOT_TEST_DRIVE 0xe0
+
+/** A test SAN device command */
+struct sanboot_test_command {
+	/** Data interface */
+	struct interface data;
+	/** Command is in use */
+	int active;
+	/** Command is a read capacity command */
+	int capacity;
+	/** Command is a write command */
+	int write;
+	/** Starting logical block address */
+	uint64_t lba;
+	/** Data buffer */
+	userptr_t buffer;
+	/** Length of data buffer */
+	size_t len;
+};
+
+/** A test SAN device */
+struct sanboot_test_device {
+	/** Reference count */
+	struct refcnt refcnt;
+	/** Block device interface */
+	struct interface block;
+	/** Command completion process */
+	struct process process;
+	/** Commands */
+	struct sanboot_test_command command[SANBOOT_TEST_MAX_COMMANDS];
+};
+
+/** Test SAN device contents */
+static uint8_t *sanboot_test_image;
+
+/**
+ * Close test SAN device command
+ *
+ * @v command		Command
+ * @v rc		Reason for close
+ */
+static void sanboot_test_command_close ( struct sanboot_test_command *command,
+					 int rc ) {
+
+	intf_restart ( &command->data, rc );
+	command->active = 0;
+}
+
+/** Test SAN device command data interface operations */
+static struct interface_operation sanboot_test_command_op[] = {
+	INTF_OP ( intf_close, struct sanboot_test_command *,
+		  sanboot_test_command_close ),
+};
+
+/** Test SAN device command data interface descriptor */
+static struct interface_descriptor sanboot_test_command_desc =
+	INTF_DESC ( struct sanboot_test_command, data,
+		    sanboot_test_command_op );
+
+/**
+ * Start test SAN device command
+ *
+ * @v dev		Test SAN device
+ * @v data		Data interface
+ * @ret command		Command, or NULL if no command is available
+ */
+static struct sanboot_test_command *
+sanboot_test_command ( struct sanboot_test_device *dev,
+		       struct interface *data ) {
+	struct sanboot_test_command *command;
+	unsigned int i;
+
+	for ( i = 0 ; i < SANBOOT_TEST_MAX_COMMANDS ; i++ ) {
+		command = &dev->command[i];
+		if ( command->active )
+			continue;
+		memset ( ( ( ( void * ) command ) + sizeof ( command->data ) ),
+			 0, ( sizeof ( *command ) - sizeof ( command->data ) ));
+		command->active = 1;
+		intf_plug_plug ( &command->data, data );
+		return command;
+	}
+	return NULL;
+}
+
+/**
+ * Issue test SAN device read or write command
+ *
+ * @v dev		Test SAN device
+ * @v data		Data interface
+ * @v lba		Starting logical block address
+ * @v count		Number of logical blocks
+ * @v buffer		Data buffer
+ * @v len		Length of data buffer
+ * @v write		Command is a write command
+ * @ret rc		Return status code
+ */
+static int sanboot_test_rw ( struct sanboot_test_device *dev,
+			     struct interface *data, uint64_t lba,
+			     unsigned int count, userptr_t buffer, size_t len,
+			     int write ) {
+	struct sanboot_test_command *command;
+
+	/* Sanity checks */
+	assert ( len == ( count * SANBOOT_TEST_BLKSIZE ) );
+	assert ( count <= SANBOOT_TEST_MAX_COUNT );
+	assert ( ( lba + count ) <= SANBOOT_TEST_BLOCKS );
+
+	/* Start command */
+	command = sanboot_test_command ( dev, data );
+	if ( ! command )
+		return -EBUSY;
+	command->write = write;
+	command->lba = lba;
+	command->buffer = buffer;
+	command->len = len;
+
+	return 0;
+}
+
+/**
+ * Issue test SAN device read command
+ *
+ * @v dev		Test SAN device
+ * @v data		Data interface
+ * @v lba		Starting logical block address
+ * @v count		Number of logical blocks
+ * @v buffer		Data buffer
+ * @v len		Length of data buffer
+ * @ret rc		Return status code
+ */
+static int sanboot_test_read ( struct sanboot_test_device *dev,
+			       struct interface *data, uint64_t lba,
+			       unsigned int count, userptr_t buffer,
+			       size_t len ) {
+	return sanboot_test_rw ( dev, data, lba, count, buffer, len, 0 );
+}
+
+/**
+ * Issue test SAN device write command
+ *
+ * @v dev		Test SAN device
+ * @v data		Data interface
+ * @v lba		Starting logical block address
+ * @v count		Number of logical blocks
+ * @v buffer		Data buffer
+ * @v len		Length of data buffer
+ * @ret rc		Return status code
+ */
+static int sanboot_test_write ( struct sanboot_test_device *dev,
+				struct interface *data, uint64_t lba,
+				unsigned int count, userptr_t buffer,
+				size_t len ) {
+	return sanboot_test_rw ( dev, data, lba, count, buffer, len, 1 );
+}
+
+/**
+ * Issue test SAN device read capacity command
+ *
+ * @v dev		Test SAN device
+ * @v data		Data interface
+ * @ret rc		Return status code
+ */
+static int sanboot_test_read_capacity ( struct sanboot_test_device *dev,
+					struct interface *data ) {
+	struct sanboot_test_command *command;
+
+	/* Start command */
+	command = sanboot_test_command ( dev, data );
+	if ( ! command )
+		return -EBUSY;
+	command->capacity = 1;
+
+	return 0;
+}
+
+/**
+ * Check test SAN device flow control window
+ *
+ * @v dev		Test SAN device
+ * @ret len		Length of window
+ */
+static size_t sanboot_test_window ( struct sanboot_test_device *dev ) {
+	size_t len = 0;
+	unsigned int i;
+
+	for ( i = 0 ; i < SANBOOT_TEST_MAX_COMMANDS ; i++ ) {
+		if ( ! dev->command[i].active )
+			len++;
+	}
+	return len;
+}
+
+/**
+ * Close test SAN device
+ *
+ * @v dev		Test SAN device
+ * @v rc		Reason for close
+ */
+static void sanboot_test_close ( struct sanboot_test_device *dev, int rc ) {
+	struct sanboot_test_command *command;
+	unsigned int i;
+
+	process_del ( &dev->process );
+	for ( i = 0 ; i < SANBOOT_TEST_MAX_COMMANDS ; i++ ) {
+		command = &dev->command[i];
+		intf_shutdown ( &command->data, rc );
+		command->active = 0;
+	}
+	intf_shutdown ( &dev->block, rc );
+}
+
+/**
+ * Complete test SAN device commands
+ *
+ * @v dev		Test SAN device
+ */
+static void sanboot_test_step ( struct sanboot_test_device *dev ) {
+	struct block_device_capacity capacity;
+	struct sanboot_test_command *command;
+	userptr_t image = virt_to_user ( sanboot_test_image );
+	size_t offset;
+	unsigned int i;
+
+	for ( i = 0 ; i < SANBOOT_TEST_MAX_COMMANDS ; i++ ) {
+		command = &dev->command[i];
+		if ( ! command->active )
+			continue;
+
+		/* Perform command */
+		if ( command->capacity ) {
+			capacity.blocks = SANBOOT_TEST_BLOCKS;
+			capacity.blksize = SANBOOT_TEST_BLKSIZE;
+			capacity.max_count = SANBOOT_TEST_MAX_COUNT;
+			block_capacity ( &command->data, &capacity );
+		} else {
+			offset = ( command->lba * SANBOOT_TEST_BLKSIZE );
+			if ( command->write ) {
+				memcpy_user ( image, offset, command->buffer,
+					      0, command->len );
+			} else {
+				memcpy_user ( command->buffer, 0, image,
+					      offset, command->len );
+			}
+		}
+
+		/* Complete command.  The command remains marked as
+		 * active until shutdown is complete, so that it cannot
+		 * be reused by any command issued in response.
+		 */
+		intf_shutdown ( &command->data, 0 );
+		command->active = 0;
+	}
+}
+
+/** Test SAN device block interface operations */
+static struct interface_operation sanboot_test_block_op[] = {
+	INTF_OP ( block_read, struct sanboot_test_device *,
+		  sanboot_test_read ),
+	INTF_OP ( block_write, struct sanboot_test_device *,
+		  sanboot_test_write ),
+	INTF_OP ( block_read_capacity, struct sanboot_test_device *,
+		  sanboot_test_read_capacity ),
+	INTF_OP ( xfer_window, struct sanboot_test_device *,
+		  sanboot_test_window ),
+	INTF_OP ( intf_close, struct sanboot_test_device *,
+		  sanboot_test_close ),
+};
+
+/** Test SAN device block interface descriptor */
+static struct interface_descriptor sanboot_test_block_desc =
+	INTF_DESC ( struct sanboot_test_device, block, sanboot_test_block_op );
+
+/** Test SAN device process descriptor */
+static struct process_descriptor sanboot_test_process_desc =
+	PROC_DESC ( struct sanboot_test_device, process, sanboot_test_step );
+
+/**
+ * Open test SAN device
+ *
+ * @v parent		Parent interface
+ * @v uri		URI
+ * @ret rc		Return status code
+ */
+static int sanboot_test_open ( struct interface *parent,
+			       struct uri *uri __unused ) {
+	struct sanboot_test_device *dev;
+	unsigned int i;
+
+	/* Allocate and initialise structure */
+	dev = zalloc ( sizeof ( *dev ) );
+	if ( ! dev )
+		return -ENOMEM;
+	ref_init ( &dev->refcnt, NULL );
+	intf_init ( &dev->block, &sanboot_test_block_desc, &dev->refcnt );
+	for ( i = 0 ; i < SANBOOT_TEST_MAX_COMMANDS ; i++ ) {
+		intf_init ( &dev->command[i].data, &sanboot_test_command_desc,
+			    &dev->refcnt );
+	}
+	process_init ( &dev->process, &sanboot_test_process_desc,
+		       &dev->refcnt );
+
+	/* Attach to parent interface, mortalise self, and return */
+	intf_plug_plug ( &dev->block, parent );
+	ref_put ( &dev->refcnt );
+	return 0;
+}
+
+/** Test SAN device URI opener */
+struct uri_opener sanboot_test_uri_opener __uri_opener = {
+	.scheme = "sanboottest",
+	.open = sanboot_test_open,
+};
+
+/**
+ * Report SAN device read test result
+ *
+ * @v sandev		SAN device
+ * @v lba		Starting logical block address
+ * @v count		Number of logical blocks
+ * @v file		Test code file
+ * @v line		Test code line
+ */
+static void sanboot_read_okx ( struct san_device *sandev, uint64_t lba,
+			       unsigned int count, const char *file,
+			       unsigned int line ) {
+	size_t blksize = sandev_blksize ( sandev );
+	size_t len = ( count * blksize );
+	uint8_t *buf;
+
+	/* Allocate buffer */
+	buf = malloc ( len );
+	okx ( buf != NULL, file, line );
+	if ( ! buf )
+		return;
+
+	/* Read and verify data */
+	memset ( buf, 0, len );
+	okx ( sandev_read ( sandev, lba, count, virt_to_user ( buf ) ) == 0,
+	      file, line );
+	okx ( memcmp ( buf, ( sanboot_test_image + ( lba * blksize ) ),
+		       len ) == 0, file, line );
+
+	free ( buf );
+}
+#define sanboot_read_ok( sandev, lba, count ) \
+	sanboot_read_okx ( sandev, lba, count, __FILE__, __LINE__ )
+
+/**
+ * Perform SAN device self-tests
+ *
+ */
+static void sanboot_test_exec ( void ) {
+	static const struct iso9660_primary_descriptor_fixed primary = {
+		.type = ISO9660_TYPE_PRIMARY,
+		.id = ISO9660_ID,
+	};
+	size_t len = ( SANBOOT_TEST_BLOCKS * SANBOOT_TEST_BLKSIZE );
+	struct san_device *sandev;
+	struct uri *uri;
+	userptr_t image;
+	uint32_t *word;
+	unsigned int i;
+
+	/* Construct device contents containing an ISO9660 filesystem */
+	image = umalloc ( len );
+	ok ( image != UNULL );
+	if ( ! image )
+		return;
+	sanboot_test_image = user_to_virt ( image, 0 );
+	word = ( ( uint32_t * ) sanboot_test_image );
+	for ( i = 0 ; i < ( len / sizeof ( *word ) ) ; i++ )
+		word[i] = ( i * sizeof ( *word ) );
+	memcpy ( ( sanboot_test_image +
+		   ( ISO9660_PRIMARY_LBA * ISO9660_BLKSIZE ) ),
+		 &primary, sizeof ( primary ) );
+
+	/* Create SAN device */
+	uri = parse_uri ( "sanboottest:disk" );
+	ok ( uri != NULL );
+	sandev = alloc_sandev ( &uri, 1, 0 );
+	ok ( sandev != NULL );
+	uri_put ( uri );
+	if ( ! sandev )
+		goto err_alloc;
+
+	/* Register device, probing for an ISO9660 filesystem */
+	ok ( register_sandev ( sandev, SANBOOT_TEST_DRIVE,
+			       SAN_NO_DESCRIBE ) == 0 );
+	ok ( sandev->is_cdrom );
+	ok ( sandev_blksize ( sandev ) == ISO9660_BLKSIZE );
+
+	/* Read blocks that were read by the probe via the block cache */
+	sanboot_read_ok ( sandev, 0, 1 );
+	sanboot_read_ok ( sandev, ISO9660_PRIMARY_LBA, 1 );
+	sanboot_read_ok ( sandev, 40, 2 );
+
+	/* Read sequentially, using read-ahead across many cache lines */
+	for ( i = 64 ; i < 512 ; i += 4 )
+		sanboot_read_ok ( sandev, i, 4 );
+
+	/* Read randomly, including the final block */
+	sanboot_read_ok ( sandev, 1000, 3 );
+	sanboot_read_ok ( sandev, 200, 1 );
+	sanboot_read_ok ( sandev, 1023, 1 );
+
+	/* Unregister device */
+	unregister_sandev ( sandev );
+	sandev_put ( sandev );
+ err_alloc:
+	ufree ( image );
+	sanboot_test_image = NULL;
+}
+
+/** SAN device self-test */
+struct self_test sanboot_test __self_test = {
+	.name = "sanboot",
+	.exec = sanboot_test_exec,
+};
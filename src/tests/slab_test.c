@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * Fixed-size object cache tests
+ *
+ */
+
+/* Forcibly enable assertions */
+#undef NDEBUG
+
+#include <string.h>
+#include <ipxe/slab.h>
+#include <ipxe/test.h>
+
+/** A test object */
+struct slab_test_object {
+	/** Data */
+	uint8_t data[48];
+};
+
+/** Test object cache */
+static struct slab_cache slab_test_cache __slab_cache =
+	SLAB_CACHE_INIT ( "test", sizeof ( struct slab_test_object ) );
+
+/** Tiny test object cache */
+static struct slab_cache slab_test_tiny __slab_cache =
+	SLAB_CACHE_INIT ( "tiny", 1 );
+
+/**
+ * Perform fixed-size object cache self-tests
+ *
+ */
+static void slab_test_exec ( void ) {
+	struct slab_cache *cache = &slab_test_cache;
+	struct slab_test_object *objects[ SLAB_MAX_FREE + 1 ];
+	struct slab_test_object *object;
+	unsigned int allocated;
+	unsigned int i;
+
+	/* Objects are never smaller than a free list entry */
+	ok ( slab_test_tiny.size == sizeof ( struct slab_object ) );
+
+	/* First allocation must come from the heap */
+	object = slab_alloc ( cache );
+	ok ( object != NULL );
+	ok ( cache->used == 1 );
+	ok ( cache->stats.allocs == 1 );
+	ok ( cache->stats.hits == 0 );
+
+	/* Freed object is reused by the next allocation */
+	memset ( object, 0xeb, sizeof ( *object ) );
+	slab_free ( cache, object );
+	ok ( cache->used == 0 );
+	ok ( cache->count == 1 );
+	ok ( slab_zalloc ( cache ) == object );
+	ok ( cache->stats.hits == 1 );
+	ok ( cache->count == 0 );
+	ok ( object->data[0] == 0 );
+	ok ( object->data[ sizeof ( object->data ) - 1 ] == 0 );
+	slab_free ( cache, object );
+
+	/* Freeing NULL has no effect */
+	slab_free ( cache, NULL );
+	ok ( cache->stats.frees == 2 );
+
+	/* Free list is limited in length */
+	allocated = 0;
+	for ( i = 0 ; i < ( sizeof ( objects ) /
+			    sizeof ( objects[0] ) ) ; i++ ) {
+		objects[i] = slab_alloc ( cache );
+		if ( objects[i] )
+			allocated++;
+	}
+	ok ( allocated == ( SLAB_MAX_FREE + 1 ) );
+	ok ( cache->used == ( SLAB_MAX_FREE + 1 ) );
+	for ( i = 0 ; i < ( sizeof ( objects ) /
+			    sizeof ( objects[0] ) ) ; i++ ) {
+		slab_free ( cache, objects[i] );
+	}
+	ok ( cache->used == 0 );
+	ok ( cache->count == SLAB_MAX_FREE );
+	ok ( cache->stats.allocs == ( SLAB_MAX_FREE + 3 ) );
+	ok ( cache->stats.frees == ( SLAB_MAX_FREE + 3 ) );
+}
+
+/** Fixed-size object cache self-test */
+struct self_test slab_test __self_test = {
+	.name = "slab",
+	.exec = slab_test_exec,
+};
@@ -123,6 +123,41 @@ TCPIP_RANDOM_TEST ( random_aligned_truncated, 0x12345678UL, 4095, 0 );
 /** Random data (unaligned start and finish) */
 TCPIP_RANDOM_TEST ( partial, 0xcafebabe, 121, 5 );
 
+/** Random data (one byte short of a whole vector block) */
+TCPIP_RANDOM_TEST ( block_short, 0xdeadbeef, 63, 0 );
+
+/** Random data (exactly one whole vector block) */
+TCPIP_RANDOM_TEST ( block_exact, 0xdeadbeef, 64, 0 );
+
+/** Random data (whole vector blocks plus an odd tail, unaligned) */
+TCPIP_RANDOM_TEST ( block_tail, 0xdeadbeef, 193, 3 );
+
+/** Random data (typical TCP segment, unaligned) */
+TCPIP_RANDOM_TEST ( segment, 0xfeedface, 1460, 6 );
+
+/** All ones (maximising carries) */
+TCPIP_TEST ( all_ones,
+	     DATA ( 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		    0xff, 0xff ) );
+
+/** All zeros (one whole vector block) */
+TCPIP_TEST ( all_zeros,
+	     DATA ( 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 ) );
+
 /**
  * Calculate TCP/IP checksum
  *
@@ -233,6 +268,45 @@ static void tcpip_random_okx ( struct tcpip_random_test *test,
 }
 #define tcpip_random_ok( test ) tcpip_random_okx ( test, __FILE__, __LINE__ )
 
+/**
+ * Measure TCP/IP checksum throughput
+ *
+ * Compares the optimised tcpip_continue_chksum() against the generic
+ * implementation over the whole of the pseudorandom-data buffer.
+ */
+static void tcpip_throughput ( void ) {
+	struct profiler generic;
+	struct profiler optimised;
+	size_t len = ( sizeof ( tcpip_data ) & ~7UL );
+	uint16_t generic_sum = 0;
+	uint16_t sum = 0;
+	unsigned int i;
+
+	/* Generate random data */
+	srandom ( 0x0badcafe );
+	for ( i = 0 ; i < len ; i++ )
+		tcpip_data[i] = random();
+
+	/* Profile both implementations */
+	memset ( &generic, 0, sizeof ( generic ) );
+	memset ( &optimised, 0, sizeof ( optimised ) );
+	for ( i = 0 ; i < PROFILE_COUNT ; i++ ) {
+		profile_start ( &generic );
+		generic_sum = generic_tcpip_continue_chksum ( TCPIP_EMPTY_CSUM,
+							      tcpip_data, len );
+		profile_stop ( &generic );
+		profile_start ( &optimised );
+		sum = tcpip_continue_chksum ( TCPIP_EMPTY_CSUM,
+					      tcpip_data, len );
+		profile_stop ( &optimised );
+	}
+	ok ( sum == generic_sum );
+	DBG ( "TCPIP throughput over %zd bytes: generic %ld ticks, optimised "
+	      "%ld ticks (%ld bytes per 1000 ticks)\n", len,
+	      profile_mean ( &generic ), profile_mean ( &optimised ),
+	      ( ( len * 1000 ) / ( profile_mean ( &optimised ) + 1 ) ) );
+}
+
 /**
  * Perform TCP/IP self-tests
  *
@@ -251,6 +325,13 @@ static void tcpip_test_exec ( void ) {
 	tcpip_random_ok ( &random_unaligned_2 );
 	tcpip_random_ok ( &random_aligned_truncated );
 	tcpip_random_ok ( &partial );
+	tcpip_ok ( &all_ones );
+	tcpip_ok ( &all_zeros );
+	tcpip_random_ok ( &block_short );
+	tcpip_random_ok ( &block_exact );
+	tcpip_random_ok ( &block_tail );
+	tcpip_random_ok ( &segment );
+	tcpip_throughput();
 }
 
 /** TCP/IP self-test */
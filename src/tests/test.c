@@ -139,7 +139,7 @@ static int run_all_tests ( void ) {
 		return -EINPROGRESS;
 	} else {
 		printf ( "OK: all %d tests passed\n", total );
-		profstat();
+		profstat ( 0 );
 		return 0;
 	}
 }
@@ -46,6 +46,7 @@ REQUIRE_OBJECT ( tcpip_test );
 REQUIRE_OBJECT ( ipv4_test );
 REQUIRE_OBJECT ( ipv6_test );
 REQUIRE_OBJECT ( crc32_test );
+REQUIRE_OBJECT ( crc32c_test );
 REQUIRE_OBJECT ( md4_test );
 REQUIRE_OBJECT ( md5_test );
 REQUIRE_OBJECT ( sha1_test );
@@ -86,3 +87,10 @@ REQUIRE_OBJECT ( des_test );
 REQUIRE_OBJECT ( mschapv2_test );
 REQUIRE_OBJECT ( uuid_test );
 REQUIRE_OBJECT ( editstring_test );
+REQUIRE_OBJECT ( retry_test );
+REQUIRE_OBJECT ( process_test );
+REQUIRE_OBJECT ( slab_test );
+REQUIRE_OBJECT ( tracepoint_test );
+REQUIRE_OBJECT ( timeline_test );
+REQUIRE_OBJECT ( sanboot_test );
+REQUIRE_OBJECT ( udp_test );
@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * Boot timeline tests
+ *
+ */
+
+/* Forcibly enable assertions */
+#undef NDEBUG
+
+#include <stddef.h>
+#include <string.h>
+#include <unistd.h>
+#include <ipxe/timeline.h>
+#include <ipxe/test.h>
+
+/** Test delay (in milliseconds) */
+#define TIMELINE_TEST_DELAY_MS 50
+
+/**
+ * Perform boot timeline self-tests
+ *
+ */
+static void timeline_test_exec ( void ) {
+	struct timeline_phase phase;
+	struct timeline_phase *startup;
+	unsigned long start;
+	unsigned long elapsed;
+
+	/* Initialise phase (not registered in the phase table) */
+	memset ( &phase, 0, sizeof ( phase ) );
+	phase.name = "test";
+
+	/* Unmatched end is ignored */
+	ok ( ! timeline_reached ( &phase ) );
+	timeline_end ( &phase );
+	ok ( ! timeline_reached ( &phase ) );
+	ok ( phase.count == 0 );
+
+	/* Overlapping instances count as a single active period */
+	timeline_begin ( &phase );
+	ok ( timeline_reached ( &phase ) );
+	ok ( phase.active == 1 );
+	start = timeline_start ( &phase );
+	timeline_begin ( &phase );
+	ok ( phase.active == 2 );
+	ok ( timeline_start ( &phase ) == start );
+	timeline_end ( &phase );
+	ok ( phase.active == 1 );
+	ok ( phase.count == 1 );
+	mdelay ( TIMELINE_TEST_DELAY_MS );
+	ok ( timeline_elapsed ( &phase ) >= ( TIMELINE_TEST_DELAY_MS / 2 ) );
+	timeline_end ( &phase );
+	ok ( phase.active == 0 );
+	ok ( phase.count == 2 );
+	elapsed = timeline_elapsed ( &phase );
+	ok ( elapsed >= ( TIMELINE_TEST_DELAY_MS / 2 ) );
+
+	/* Elapsed time does not increase while inactive */
+	mdelay ( TIMELINE_TEST_DELAY_MS );
+	ok ( timeline_elapsed ( &phase ) == elapsed );
+	ok ( timeline_start ( &phase ) == start );
+
+	/* Phases may be found by name */
+	startup = find_timeline_phase ( "startup" );
+	ok ( startup != NULL );
+	ok ( startup && ( strcmp ( startup->name, "startup" ) == 0 ) );
+	ok ( find_timeline_phase ( "nonexistent" ) == NULL );
+}
+
+/** Boot timeline self-test */
+struct self_test timeline_test __self_test = {
+	.name = "timeline",
+	.exec = timeline_test_exec,
+};
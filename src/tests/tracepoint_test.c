@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * Tracepoint tests
+ *
+ */
+
+/* Forcibly enable assertions */
+#undef NDEBUG
+
+#include <stddef.h>
+#include <ipxe/tracepoint.h>
+#include <ipxe/test.h>
+
+/** Test tracepoint */
+static struct tracepoint trace_test_tracepoint __tracepoint = {
+	.name = "test",
+};
+
+/** Number of test trace records */
+#define TRACE_TEST_COUNT 4
+
+/**
+ * Perform tracepoint self-tests
+ *
+ */
+static void trace_test_exec ( void ) {
+	struct trace_ring *ring = &trace_ring;
+	struct trace_record *records;
+	struct trace_record *record;
+	struct trace_record *prev;
+	unsigned long index;
+	unsigned int i;
+
+	/* Ring size must be a power of two */
+	ok ( trace_start ( 0 ) != 0 );
+	ok ( trace_start ( 3 ) != 0 );
+
+	/* Excessive ring sizes must be rejected */
+	ok ( trace_start ( TRACE_MAX_COUNT << 1 ) != 0 );
+	ok ( ! trace_active );
+
+	/* Events are recorded only while tracing is active */
+	trace ( &trace_test_tracepoint, 0 );
+	ok ( trace_start ( TRACE_TEST_COUNT ) == 0 );
+	ok ( trace_active );
+	ok ( ring->count == TRACE_TEST_COUNT );
+	ok ( ring->prod == 0 );
+	ok ( trace_first ( ring ) == 0 );
+	trace ( &trace_test_tracepoint, 0x1234 );
+	ok ( ring->prod == 1 );
+	record = trace_record_at ( ring, 0 );
+	ok ( record->tracepoint == &trace_test_tracepoint );
+	ok ( record->value == 0x1234 );
+
+	/* Oldest records are overwritten once ring is full */
+	for ( i = 1 ; i < ( TRACE_TEST_COUNT + 2 ) ; i++ )
+		trace ( &trace_test_tracepoint, i );
+	ok ( ring->prod == ( TRACE_TEST_COUNT + 2 ) );
+	ok ( trace_first ( ring ) == 2 );
+	prev = NULL;
+	for ( index = trace_first ( ring ) ; index < ring->prod ; index++ ) {
+		record = trace_record_at ( ring, index );
+		ok ( record->tracepoint == &trace_test_tracepoint );
+		ok ( record->value == index );
+		if ( prev )
+			ok ( record->timestamp >= prev->timestamp );
+		prev = record;
+	}
+
+	/* Stopped trace is retained but not extended */
+	trace_stop();
+	ok ( ! trace_active );
+	trace ( &trace_test_tracepoint, 0 );
+	ok ( ring->prod == ( TRACE_TEST_COUNT + 2 ) );
+
+	/* Restarting discards records but reuses the ring */
+	records = ring->records;
+	ok ( trace_start ( TRACE_TEST_COUNT ) == 0 );
+	ok ( ring->records == records );
+	ok ( ring->prod == 0 );
+	trace_stop();
+}
+
+/** Tracepoint self-test */
+struct self_test trace_test __self_test = {
+	.name = "trace",
+	.exec = trace_test_exec,
+};
@@ -0,0 +1,227 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+/** @file
+ *
+ * UDP tests
+ *
+ */
+
+/* Forcibly enable assertions */
+#undef NDEBUG
+
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <byteswap.h>
+#include <ipxe/in.h>
+#include <ipxe/iobuf.h>
+#include <ipxe/interface.h>
+#include <ipxe/xfer.h>
+#include <ipxe/netdevice.h>
+#include <ipxe/tcpip.h>
+#include <ipxe/ip.h>
+#include <ipxe/ipstat.h>
+#include <ipxe/udp.h>
+#include <ipxe/test.h>
+
+/** Test local port */
+#define UDP_TEST_PORT 6969
+
+/** A UDP test connection */
+struct udp_test_connection {
+	/** Data transfer interface */
+	struct interface xfer;
+	/** Number of datagrams received */
+	unsigned int rx_count;
+};
+
+/**
+ * Receive datagram
+ *
+ * @v conn		UDP test connection
+ * @v iobuf		I/O buffer
+ * @v meta		Data transfer metadata
+ * @ret rc		Return status code
+ */
+static int udp_test_deliver ( struct udp_test_connection *conn,
+			      struct io_buffer *iobuf,
+			      struct xfer_metadata *meta __unused ) {
+
+	free_iob ( iobuf );
+	conn->rx_count++;
+	return 0;
+}
+
+/** UDP test connection data transfer interface operations */
+static struct interface_operation udp_test_xfer_op[] = {
+	INTF_OP ( xfer_deliver, struct udp_test_connection *,
+		  udp_test_deliver ),
+};
+
+/** UDP test connection data transfer interface descriptor */
+static struct interface_descriptor udp_test_xfer_desc =
+	INTF_DESC ( struct udp_test_connection, xfer, udp_test_xfer_op );
+
+/** UDP test connections */
+static struct udp_test_connection udp_test_conns[3];
+
+/** First scoped test network device */
+static struct net_device udp_test_netdev_a = {
+	.scope_id = 0x101,
+};
+
+/** Second scoped test network device */
+static struct net_device udp_test_netdev_b = {
+	.scope_id = 0x102,
+};
+
+/** Third scoped test network device */
+static struct net_device udp_test_netdev_c = {
+	.scope_id = 0x103,
+};
+
+/**
+ * Open UDP test connection
+ *
+ * @v conn		UDP test connection
+ * @v scope_id		Local scope ID, or zero for all scopes
+ * @ret rc		Return status code
+ */
+static int udp_test_open ( struct udp_test_connection *conn,
+			   unsigned int scope_id ) {
+	struct sockaddr_in peer;
+	struct sockaddr_in local;
+
+	/* Construct addresses */
+	memset ( &peer, 0, sizeof ( peer ) );
+	peer.sin_family = AF_INET;
+	peer.sin_port = htons ( UDP_TEST_PORT );
+	memset ( &local, 0, sizeof ( local ) );
+	local.sin_family = AF_INET;
+	local.sin_port = htons ( UDP_TEST_PORT );
+	local.sin_scope_id = scope_id;
+
+	/* Open connection */
+	intf_init ( &conn->xfer, &udp_test_xfer_desc, NULL );
+	conn->rx_count = 0;
+	return udp_open ( &conn->xfer, ( struct sockaddr * ) &peer,
+			  ( struct sockaddr * ) &local );
+}
+
+/**
+ * Close UDP test connection
+ *
+ * @v conn		UDP test connection
+ */
+static void udp_test_close ( struct udp_test_connection *conn ) {
+
+	intf_shutdown ( &conn->xfer, 0 );
+}
+
+/**
+ * Receive UDP test datagram via network device
+ *
+ * @v netdev		Network device
+ * @ret rc		Return status code
+ */
+static int udp_test_rx ( struct net_device *netdev ) {
+	struct ip_statistics stats;
+	struct sockaddr_in src;
+	struct sockaddr_in dest;
+	struct udp_header *udphdr;
+	struct io_buffer *iobuf;
+
+	/* Construct datagram (with no checksum) */
+	iobuf = alloc_iob ( sizeof ( *udphdr ) );
+	assert ( iobuf != NULL );
+	udphdr = iob_put ( iobuf, sizeof ( *udphdr ) );
+	udphdr->src = htons ( UDP_TEST_PORT );
+	udphdr->dest = htons ( UDP_TEST_PORT );
+	udphdr->len = htons ( sizeof ( *udphdr ) );
+	udphdr->chksum = 0;
+
+	/* Construct addresses */
+	memset ( &src, 0, sizeof ( src ) );
+	src.sin_family = AF_INET;
+	memset ( &dest, 0, sizeof ( dest ) );
+	dest.sin_family = AF_INET;
+	memset ( &stats, 0, sizeof ( stats ) );
+
+	/* Hand off to UDP */
+	return tcpip_rx ( iobuf, netdev, IP_UDP,
+			  ( struct sockaddr_tcpip * ) &src,
+			  ( struct sockaddr_tcpip * ) &dest, 0, &stats );
+}
+
+/**
+ * Perform UDP self-tests
+ *
+ */
+static void udp_test_exec ( void ) {
+	struct udp_test_connection *first = &udp_test_conns[0];
+	struct udp_test_connection *second = &udp_test_conns[1];
+	struct udp_test_connection *third = &udp_test_conns[2];
+
+	/* An unscoped connection conflicts with all other connections */
+	ok ( udp_test_open ( first, 0 ) == 0 );
+	ok ( udp_test_open ( second, 0 ) != 0 );
+	ok ( udp_test_open ( second, udp_test_netdev_a.scope_id ) != 0 );
+
+	/* An unscoped connection receives via any network device */
+	ok ( udp_test_rx ( &udp_test_netdev_a ) == 0 );
+	ok ( udp_test_rx ( &udp_test_netdev_b ) == 0 );
+	ok ( first->rx_count == 2 );
+	udp_test_close ( first );
+
+	/* Connections bound to different scopes may coexist */
+	ok ( udp_test_open ( first, udp_test_netdev_a.scope_id ) == 0 );
+	ok ( udp_test_open ( second, udp_test_netdev_b.scope_id ) == 0 );
+	ok ( udp_test_open ( third, udp_test_netdev_a.scope_id ) != 0 );
+	ok ( udp_test_open ( third, 0 ) != 0 );
+
+	/* Scoped connections receive only via their own network device */
+	ok ( udp_test_rx ( &udp_test_netdev_a ) == 0 );
+	ok ( first->rx_count == 1 );
+	ok ( second->rx_count == 0 );
+	ok ( udp_test_rx ( &udp_test_netdev_b ) == 0 );
+	ok ( first->rx_count == 1 );
+	ok ( second->rx_count == 1 );
+	ok ( udp_test_rx ( &udp_test_netdev_c ) != 0 );
+	ok ( first->rx_count == 1 );
+	ok ( second->rx_count == 1 );
+	udp_test_close ( first );
+	udp_test_close ( second );
+
+	/* Port is available again once all connections are closed */
+	ok ( udp_test_open ( first, 0 ) == 0 );
+	udp_test_close ( first );
+}
+
+/** UDP self-test */
+struct self_test udp_test __self_test = {
+	.name = "udp",
+	.exec = udp_test_exec,
+};
@@ -100,6 +100,10 @@ static void vsprintf_test_exec ( void ) {
 	snprintf_ok ( 16, "-072", "%04d", -72 );
 	snprintf_ok ( 16, "4", "%zd", sizeof ( uint32_t ) );
 	snprintf_ok ( 16, "123456789", "%d", 123456789 );
+	snprintf_ok ( 16, "4294967295", "%u", 4294967295U );
+	snprintf_ok ( 16, "0042", "%04lu", 42UL );
+	snprintf_ok ( 32, "18446744073709551615", "%llu",
+		      18446744073709551615ULL );
 
 	/* Realistic combinations */
 	snprintf_ok ( 64, "DBG 0x1234 thingy at 0x0003f0c0+0x5c\n",
@@ -136,8 +136,10 @@ int uriboot ( struct uri *filename, struct uri **root_paths,
 	/* Hook SAN device, if applicable */
 	if ( root_path_count ) {
 		drive = san_hook ( drive, root_paths, root_path_count,
-				   ( ( flags & URIBOOT_NO_SAN_DESCRIBE ) ?
-				     SAN_NO_DESCRIBE : 0 ) );
+				   ( ( ( flags & URIBOOT_NO_SAN_DESCRIBE ) ?
+				       SAN_NO_DESCRIBE : 0 ) |
+				     ( ( flags & URIBOOT_SAN_MEMDISK ) ?
+				       SAN_MEMDISK : 0 ) ) );
 		if ( drive < 0 ) {
 			rc = drive;
 			printf ( "Could not open SAN device: %s\n",
@@ -383,29 +385,55 @@ static int have_pxe_menu ( void ) {
 }
 
 /**
- * Boot from a network device
+ * Identify settings block from which to fetch a boot setting
+ *
+ * @v netdev		Network device
+ * @v setting		Setting
+ * @ret settings	Settings block, or NULL to search all blocks
+ *
+ * Boot settings are normally fetched from all settings blocks, so
+ * that values provided via ProxyDHCP, PXE boot server discovery or
+ * the "set" command are honoured.  A value found only within another
+ * network device's settings (e.g. left over from an earlier or
+ * competing configuration attempt) is ignored in favour of the boot
+ * network device's own settings.
+ */
+static struct settings * netboot_settings ( struct net_device *netdev,
+					    const struct setting *setting ) {
+	struct net_device *other;
+	struct settings *origin;
+
+	/* Identify settings block that would provide the setting */
+	fetch_setting ( NULL, setting, &origin, NULL, NULL, 0 );
+
+	/* Use own settings if setting belongs to another device */
+	for ( ; origin ; origin = origin->parent ) {
+		for_each_netdev ( other ) {
+			if ( origin == netdev_settings ( other ) ) {
+				return ( ( other == netdev ) ?
+					 NULL : netdev_settings ( netdev ) );
+			}
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * Boot from a configured network device
  *
  * @v netdev		Network device
  * @ret rc		Return status code
  */
-int netboot ( struct net_device *netdev ) {
+static int netboot_configured ( struct net_device *netdev ) {
 	struct san_boot_config san_config;
+	struct settings *settings;
 	struct uri *filename;
 	struct uri *root_path;
 	char *san_filename;
 	int rc;
 
-	/* Close all other network devices */
-	close_other_netdevs ( netdev );
-
-	/* Open device and display device status */
-	if ( ( rc = ifopen ( netdev ) ) != 0 )
-		goto err_ifopen;
-	ifstat ( netdev );
-
-	/* Configure device */
-	if ( ( rc = ifconf ( netdev, NULL, 0 ) ) != 0 )
-		goto err_dhcp;
+	/* Display routing table */
 	route();
 
 	/* Try PXE menu boot, if applicable */
@@ -416,13 +444,16 @@ int netboot ( struct net_device *netdev ) {
 	}
 
 	/* Fetch next server and filename (if any) */
-	filename = fetch_next_server_and_filename ( NULL );
+	settings = netboot_settings ( netdev, &filename_setting );
+	filename = fetch_next_server_and_filename ( settings );
 
 	/* Fetch root path (if any) */
-	root_path = fetch_root_path ( NULL );
+	settings = netboot_settings ( netdev, &root_path_setting );
+	root_path = fetch_root_path ( settings );
 
 	/* Fetch SAN filename (if any) */
-	san_filename = fetch_san_filename ( NULL );
+	settings = netboot_settings ( netdev, &san_filename_setting );
+	san_filename = fetch_san_filename ( settings );
 
 	/* Construct SAN boot configuration parameters */
 	memset ( &san_config, 0, sizeof ( san_config ) );
@@ -459,8 +490,72 @@ int netboot ( struct net_device *netdev ) {
 	uri_put ( root_path );
 	uri_put ( filename );
  err_pxe_menu_boot:
- err_dhcp:
- err_ifopen:
+	return rc;
+}
+
+/**
+ * Boot from a network device
+ *
+ * @v netdev		Network device
+ * @ret rc		Return status code
+ */
+int netboot ( struct net_device *netdev ) {
+	int rc;
+
+	/* Close all other network devices */
+	close_other_netdevs ( netdev );
+
+	/* Open device and display device status */
+	if ( ( rc = ifopen ( netdev ) ) != 0 )
+		return rc;
+	ifstat ( netdev );
+
+	/* Configure device */
+	if ( ( rc = ifconf ( netdev, NULL, 0 ) ) != 0 )
+		return rc;
+
+	/* Boot from configured device */
+	return netboot_configured ( netdev );
+}
+
+/**
+ * Boot from any of several network devices
+ *
+ * @v netdevs		Network devices
+ * @v count		Number of network devices
+ * @ret rc		Return status code
+ *
+ * All devices are brought up and configured in parallel, and the
+ * first device to be configured successfully is used for booting.
+ * If booting fails, the remaining devices are tried in the same way.
+ * The list of network devices will be modified.
+ */
+int netboot_any ( struct net_device **netdevs, unsigned int count ) {
+	struct net_device *netdev;
+	unsigned int i;
+	int rc = -ENODEV;
+
+	while ( count ) {
+
+		/* Close all network devices */
+		close_other_netdevs ( NULL );
+
+		/* Configure any device */
+		if ( ( rc = ifconf_parallel ( netdevs, count, NULL, 0,
+					      &netdev ) ) != 0 )
+			return rc;
+		ifstat ( netdev );
+
+		/* Boot from configured device */
+		rc = netboot_configured ( netdev );
+
+		/* Remove device from list of candidates */
+		for ( i = 0 ; netdevs[i] != netdev ; i++ ) {}
+		count--;
+		memmove ( &netdevs[i], &netdevs[ i + 1 ],
+			  ( ( count - i ) * sizeof ( netdevs[0] ) ) );
+	}
+
 	return rc;
 }
 
@@ -537,20 +632,37 @@ void set_autoboot_ll_addr ( const void *ll_addr, size_t len,
  */
 static int autoboot ( void ) {
 	struct net_device *netdev;
+	unsigned int count = 0;
 	int rc = -ENODEV;
 
-	/* Try booting from each network device.  If we have a
-	 * specified autoboot device location, then use only devices
-	 * matching that location.
-	 */
-	for_each_netdev ( netdev ) {
+	/* Count network devices */
+	for_each_netdev ( netdev )
+		count++;
+
+	{
+		struct net_device *netdevs[ count ? count : 1 ];
 
-		/* Skip any non-matching devices, if applicable */
-		if ( is_autoboot_device && ( ! is_autoboot_device ( netdev ) ) )
-			continue;
+		/* Try booting from all network devices.  If we have a
+		 * specified autoboot device location, then use only
+		 * devices matching that location.
+		 */
+		count = 0;
+		for_each_netdev ( netdev ) {
 
-		/* Attempt booting from this device */
-		rc = netboot ( netdev );
+			/* Skip any non-matching devices, if applicable */
+			if ( is_autoboot_device &&
+			     ( ! is_autoboot_device ( netdev ) ) )
+				continue;
+
+			netdevs[count++] = netdev;
+		}
+
+		/* Attempt booting from these devices */
+		if ( count > 1 ) {
+			rc = netboot_any ( netdevs, count );
+		} else if ( count == 1 ) {
+			rc = netboot ( netdevs[0] );
+		}
 	}
 
 	printf ( "No more network devices\n" );
@@ -25,6 +25,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 
 #include <string.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <unistd.h>
 #include <errno.h>
 #include <ipxe/console.h>
@@ -34,6 +35,8 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/monojob.h>
 #include <ipxe/timer.h>
 #include <ipxe/errortab.h>
+#include <ipxe/settings.h>
+#include <ipxe/dhcp.h>
 #include <usr/ifmgmt.h>
 
 /** @file
@@ -102,6 +105,32 @@ static void ifstat_errors ( struct net_device_stats *stats,
 	}
 }
 
+/**
+ * Print network device latency histogram
+ *
+ * @v latency		Network device latency histogram
+ * @v prefix		Histogram name prefix
+ */
+static void ifstat_latency ( struct net_device_latency *latency,
+			     const char *prefix ) {
+	unsigned int total = 0;
+	unsigned int i;
+
+	/* Do nothing unless samples have been recorded */
+	for ( i = 0 ; i < NETDEV_LATENCY_BUCKETS ; i++ )
+		total += latency->count[i];
+	if ( ! total )
+		return;
+
+	/* Print non-empty buckets */
+	printf ( "  [%s:", prefix );
+	for ( i = 0 ; i < NETDEV_LATENCY_BUCKETS ; i++ ) {
+		if ( latency->count[i] )
+			printf ( " 2^%d:%d", i, latency->count[i] );
+	}
+	printf ( "]\n" );
+}
+
 /**
  * Print status of network device
  *
@@ -118,14 +147,30 @@ void ifstat ( struct net_device *netdev ) {
 		 ( netdev_link_blocked ( netdev ) ? " (blocked)" : "" ),
 		 netdev->tx_stats.good, netdev->tx_stats.bad,
 		 netdev->rx_stats.good, netdev->rx_stats.bad );
+	printf ( "  [TXB:%llu TXF:%d RXB:%llu RXF:%d]\n",
+		 netdev->tx_stats.bytes, netdev->tx_stats.full,
+		 netdev->rx_stats.bytes, netdev->rx_stats.full );
 	if ( ! netdev_link_ok ( netdev ) ) {
 		printf ( "  [Link status: %s]\n",
 			 strerror ( netdev->link_rc ) );
 	}
 	ifstat_errors ( &netdev->tx_stats, "TXE" );
 	ifstat_errors ( &netdev->rx_stats, "RXE" );
+	ifstat_latency ( &netdev->rx_processing, "RX processing" );
 }
 
+/** A candidate network device for a parallel operation */
+struct ifcandidate {
+	/** Network device */
+	struct net_device *netdev;
+	/** Network device was already open */
+	int was_open;
+	/** Configuration has been started */
+	int started;
+	/** Status code, or -EINPROGRESS if not yet known */
+	int rc;
+};
+
 /** Network device poller */
 struct ifpoller {
 	/** Job control interface */
@@ -134,6 +179,12 @@ struct ifpoller {
 	struct net_device *netdev;
 	/** Network device configurator (if applicable) */
 	struct net_device_configurator *configurator;
+	/** Candidate network devices (for parallel operations) */
+	struct ifcandidate *candidates;
+	/** Number of candidate network devices */
+	unsigned int count;
+	/** Time at which polling started */
+	unsigned long started;
 	/**
 	 * Check progress
 	 *
@@ -171,12 +222,15 @@ static struct interface_descriptor ifpoller_job_desc =
  *
  * @v netdev		Network device
  * @v configurator	Network device configurator (if applicable)
+ * @v candidates	Candidate network devices (if applicable)
+ * @v count		Number of candidate network devices
  * @v timeout		Timeout period, in ticks
  * @v progress		Method to check progress
  * @ret rc		Return status code
  */
 static int ifpoller_wait ( struct net_device *netdev,
 			   struct net_device_configurator *configurator,
+			   struct ifcandidate *candidates, unsigned int count,
 			   unsigned long timeout,
 			   int ( * progress ) ( struct ifpoller *ifpoller ) ) {
 	static struct ifpoller ifpoller = {
@@ -185,6 +239,9 @@ static int ifpoller_wait ( struct net_device *netdev,
 
 	ifpoller.netdev = netdev;
 	ifpoller.configurator = configurator;
+	ifpoller.candidates = candidates;
+	ifpoller.count = count;
+	ifpoller.started = currticks();
 	ifpoller.progress = progress;
 	intf_plug_plug ( &monojob, &ifpoller.job );
 	return monojob_wait ( "", timeout );
@@ -231,7 +288,8 @@ int iflinkwait ( struct net_device *netdev, unsigned long timeout,
 
 	/* Wait for link-up */
 	printf ( "Waiting for link-up on %s", netdev->name );
-	return ifpoller_wait ( netdev, NULL, timeout, iflinkwait_progress );
+	return ifpoller_wait ( netdev, NULL, NULL, 0, timeout,
+			       iflinkwait_progress );
 }
 
 /**
@@ -302,5 +360,302 @@ int ifconf ( struct net_device *netdev,
 		 ( configurator ? configurator->name : "" ),
 		 ( configurator ? "] " : "" ),
 		 netdev->name, netdev->ll_protocol->ntoa ( netdev->ll_addr ) );
-	return ifpoller_wait ( netdev, configurator, timeout, ifconf_progress );
+	return ifpoller_wait ( netdev, configurator, NULL, 0, timeout,
+			       ifconf_progress );
+}
+
+/**
+ * Open candidate network devices
+ *
+ * @v netdevs		Network devices
+ * @v count		Number of network devices
+ * @ret candidates	Candidate network devices, or NULL on error
+ */
+static struct ifcandidate * ifcandidates_open ( struct net_device **netdevs,
+						unsigned int count ) {
+	struct ifcandidate *candidates;
+	unsigned int i;
+
+	/* Allocate candidate list */
+	candidates = zalloc ( count * sizeof ( candidates[0] ) );
+	if ( ! candidates )
+		return NULL;
+
+	/* Open all devices */
+	for ( i = 0 ; i < count ; i++ ) {
+		candidates[i].netdev = netdevs[i];
+		candidates[i].was_open = netdev_is_open ( netdevs[i] );
+		candidates[i].rc = ifopen ( netdevs[i] );
+		if ( candidates[i].rc == 0 )
+			candidates[i].rc = -EINPROGRESS;
+	}
+
+	return candidates;
+}
+
+/**
+ * Print names of candidate network devices
+ *
+ * @v candidates	Candidate network devices
+ * @v count		Number of candidate network devices
+ */
+static void ifcandidates_print ( struct ifcandidate *candidates,
+				 unsigned int count ) {
+	const char *sep = "";
+	unsigned int i;
+
+	for ( i = 0 ; i < count ; i++ ) {
+		if ( candidates[i].rc != -EINPROGRESS )
+			continue;
+		printf ( "%s%s", sep, candidates[i].netdev->name );
+		sep = " ";
+	}
+}
+
+/**
+ * Close candidate network devices
+ *
+ * @v candidates	Candidate network devices
+ * @v count		Number of candidate network devices
+ * @v configurator	Network device configurator, or NULL to use all
+ * @ret netdev		Successful network device, or NULL
+ *
+ * All devices other than the successful device (if any) are closed,
+ * unless they were already open before the parallel operation began.
+ * Any configuration still in progress on an unsuccessful device is
+ * cancelled, and unsuccessful devices on which DHCP was started lose
+ * their DHCP settings, so that these cannot be mistaken for those of
+ * the successful device.
+ */
+static struct net_device *
+ifcandidates_close ( struct ifcandidate *candidates, unsigned int count,
+		     struct net_device_configurator *configurator ) {
+	struct net_device *netdev = NULL;
+	struct net_device *other;
+	struct settings *settings;
+	int dhcp;
+	unsigned int i;
+
+	/* Identify whether or not DHCP was used */
+	dhcp = ( ( ! configurator ) ||
+		 ( configurator == find_netdev_configurator ( "dhcp" ) ) );
+
+	/* Clean up all unsuccessful devices */
+	for ( i = 0 ; i < count ; i++ ) {
+
+		/* Record successful device */
+		other = candidates[i].netdev;
+		if ( candidates[i].rc == 0 ) {
+			netdev = other;
+			continue;
+		}
+
+		/* Cancel any ongoing configuration */
+		if ( candidates[i].started )
+			netdev_configure_cancel ( other );
+
+		/* Discard any DHCP settings */
+		if ( dhcp && candidates[i].started ) {
+			settings = find_child_settings ( netdev_settings ( other ),
+							 DHCP_SETTINGS_NAME );
+			if ( settings )
+				unregister_settings ( settings );
+		}
+
+		/* Close device, if opened by this operation */
+		if ( ! candidates[i].was_open )
+			ifclose ( other );
+	}
+
+	/* Free candidate list */
+	free ( candidates );
+
+	return netdev;
+}
+
+/**
+ * Check parallel link-up progress
+ *
+ * @v ifpoller		Network device poller
+ * @ret ongoing_rc	Ongoing job status code (if known)
+ */
+static int iflinkwait_parallel_progress ( struct ifpoller *ifpoller ) {
+	struct ifcandidate *candidate;
+	int ongoing_rc = -ENODEV;
+	unsigned int i;
+
+	/* Terminate successfully if any link is up */
+	for ( i = 0 ; i < ifpoller->count ; i++ ) {
+		candidate = &ifpoller->candidates[i];
+		if ( candidate->rc != -EINPROGRESS )
+			continue;
+		ongoing_rc = candidate->netdev->link_rc;
+		if ( ongoing_rc == 0 ) {
+			candidate->rc = 0;
+			intf_close ( &ifpoller->job, 0 );
+			return 0;
+		}
+	}
+
+	/* Fail if no devices remain */
+	if ( ongoing_rc == -ENODEV )
+		intf_close ( &ifpoller->job, ongoing_rc );
+
+	/* Otherwise, report link status as ongoing job status */
+	return ongoing_rc;
+}
+
+/**
+ * Wait for link-up on any of several network devices
+ *
+ * @v netdevs		Network devices
+ * @v count		Number of network devices
+ * @v timeout		Timeout period, in ticks
+ * @ret netdev		Network device with link up
+ * @ret rc		Return status code
+ *
+ * All devices are opened, and the link is awaited on all devices
+ * simultaneously.  All devices opened by this call, other than the
+ * first device to achieve link-up, are then closed.
+ */
+int iflinkwait_parallel ( struct net_device **netdevs, unsigned int count,
+			  unsigned long timeout, struct net_device **netdev ) {
+	struct ifcandidate *candidates;
+	int rc;
+
+	/* Open all devices */
+	candidates = ifcandidates_open ( netdevs, count );
+	if ( ! candidates )
+		return -ENOMEM;
+	printf ( "Waiting for link-up on " );
+	ifcandidates_print ( candidates, count );
+
+	/* Wait for link-up on any device */
+	rc = ifpoller_wait ( NULL, NULL, candidates, count, timeout,
+			     iflinkwait_parallel_progress );
+
+	/* Close all other devices */
+	*netdev = ifcandidates_close ( candidates, count, NULL );
+	if ( *netdev )
+		printf ( "Using %s\n", ( *netdev )->name );
+
+	return rc;
+}
+
+/**
+ * Check parallel configuration progress
+ *
+ * @v ifpoller		Network device poller
+ * @ret ongoing_rc	Ongoing job status code (if known)
+ */
+static int ifconf_parallel_progress ( struct ifpoller *ifpoller ) {
+	struct net_device_configurator *configurator = ifpoller->configurator;
+	struct net_device_configuration *config;
+	unsigned long elapsed = ( currticks() - ifpoller->started );
+	struct ifcandidate *candidate;
+	struct net_device *netdev;
+	unsigned int remaining = 0;
+	int rc = -ENODEV;
+	unsigned int i;
+
+	for ( i = 0 ; i < ifpoller->count ; i++ ) {
+		candidate = &ifpoller->candidates[i];
+		netdev = candidate->netdev;
+
+		/* Skip devices that have already failed */
+		if ( candidate->rc != -EINPROGRESS ) {
+			rc = candidate->rc;
+			continue;
+		}
+
+		/* Start configuration once link is up */
+		if ( ! candidate->started ) {
+			if ( ! netdev_link_ok ( netdev ) ) {
+				if ( elapsed >= LINK_WAIT_TIMEOUT ) {
+					rc = candidate->rc = netdev->link_rc;
+				} else {
+					remaining++;
+				}
+				continue;
+			}
+			if ( configurator ) {
+				rc = netdev_configure ( netdev, configurator );
+			} else {
+				rc = netdev_configure_all ( netdev );
+			}
+			if ( rc != 0 ) {
+				candidate->rc = rc;
+				continue;
+			}
+			candidate->started = 1;
+		}
+
+		/* Wait for configuration to complete */
+		if ( netdev_configuration_in_progress ( netdev ) ) {
+			remaining++;
+			continue;
+		}
+
+		/* Terminate successfully if configuration succeeded */
+		if ( configurator ) {
+			config = netdev_configuration ( netdev, configurator );
+			rc = config->rc;
+		} else {
+			rc = ( netdev_configuration_ok ( netdev ) ?
+			       0 : -EADDRNOTAVAIL_CONFIG );
+		}
+		candidate->rc = rc;
+		if ( rc == 0 ) {
+			intf_close ( &ifpoller->job, 0 );
+			return 0;
+		}
+	}
+
+	/* Fail if no devices remain */
+	if ( ! remaining )
+		intf_close ( &ifpoller->job, rc );
+
+	return 0;
+}
+
+/**
+ * Perform configuration of any of several network devices
+ *
+ * @v netdevs		Network devices
+ * @v count		Number of network devices
+ * @v configurator	Network device configurator, or NULL to use all
+ * @v timeout		Timeout period, in ticks
+ * @ret netdev		Configured network device
+ * @ret rc		Return status code
+ *
+ * All devices are opened, and each device is configured as soon as
+ * its link is up.  All devices opened by this call, other than the
+ * first device to be configured successfully, are then closed.
+ */
+int ifconf_parallel ( struct net_device **netdevs, unsigned int count,
+		      struct net_device_configurator *configurator,
+		      unsigned long timeout, struct net_device **netdev ) {
+	struct ifcandidate *candidates;
+	int rc;
+
+	/* Open all devices */
+	candidates = ifcandidates_open ( netdevs, count );
+	if ( ! candidates )
+		return -ENOMEM;
+	printf ( "Configuring %s%s%s(", ( configurator ? "[" : "" ),
+		 ( configurator ? configurator->name : "" ),
+		 ( configurator ? "] " : "" ) );
+	ifcandidates_print ( candidates, count );
+	printf ( ")" );
+
+	/* Wait for configuration of any device */
+	rc = ifpoller_wait ( NULL, configurator, candidates, count, timeout,
+			     ifconf_parallel_progress );
+
+	/* Close all other devices */
+	*netdev = ifcandidates_close ( candidates, count, configurator );
+	if ( *netdev )
+		printf ( "Using %s\n", ( *netdev )->name );
+
+	return rc;
 }
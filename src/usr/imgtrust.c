@@ -32,6 +32,7 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 #include <ipxe/cms.h>
 #include <ipxe/validator.h>
 #include <ipxe/monojob.h>
+#include <ipxe/timeline.h>
 #include <usr/imgtrust.h>
 
 /** @file
@@ -40,6 +41,12 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
  *
  */
 
+/** Image verification timeline phase */
+static struct timeline_phase verify_timeline
+	__timeline_phase ( TIMELINE_VERIFY ) = {
+	.name = "verify",
+};
+
 /**
  * Verify image using downloaded signature
  *
@@ -59,6 +66,7 @@ int imgverify ( struct image *image, struct image *signature,
 
 	/* Mark image as untrusted */
 	image_untrust ( image );
+	timeline_begin ( &verify_timeline );
 
 	/* Get raw signature data */
 	next = image_asn1 ( signature, 0, &data );
@@ -97,6 +105,7 @@ int imgverify ( struct image *image, struct image *signature,
 	/* Mark image as trusted */
 	image_trust ( image );
 	syslog ( LOG_NOTICE, "Image \"%s\" signature OK\n", image->name );
+	timeline_end ( &verify_timeline );
 
 	return 0;
 
@@ -109,5 +118,6 @@ int imgverify ( struct image *image, struct image *signature,
  err_asn1:
 	syslog ( LOG_ERR, "Image \"%s\" signature bad: %s\n",
 		 image->name, strerror ( rc ) );
+	timeline_end ( &verify_timeline );
 	return rc;
 }
@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+#include <stdio.h>
+#include <ipxe/malloc.h>
+#include <ipxe/slab.h>
+#include <usr/memstat.h>
+
+/** @file
+ *
+ * Memory allocator statistics
+ *
+ */
+
+/**
+ * Print heap allocation profile
+ *
+ * @v profile		Heap allocation profile
+ */
+static void memstat_profile ( struct malloc_profile *profile ) {
+	struct malloc_site *site;
+	struct malloc_site *best;
+	unsigned int shown[ ( MALLOC_SITES + 31 ) / 32 ] = { 0 };
+	unsigned int class;
+	unsigned int i;
+
+	/* Print live memory blocks by size class */
+	printf ( "Live blocks by size:" );
+	for ( class = 0 ; class < MALLOC_SIZES ; class++ ) {
+		if ( profile->size[class] ) {
+			printf ( " %s%d:%d",
+				 ( ( class == ( MALLOC_SIZES - 1 ) ) ?
+				   ">2^" : "2^" ),
+				 ( ( class == ( MALLOC_SIZES - 1 ) ) ?
+				   ( class - 1 ) : class ),
+				 profile->size[class] );
+		}
+	}
+	printf ( "\n" );
+
+	/* Print call sites in descending order of live bytes */
+	printf ( "Allocation call sites by live bytes:\n" );
+	while ( 1 ) {
+		best = NULL;
+		for ( i = 0 ; i < MALLOC_SITES ; i++ ) {
+			site = &profile->site[i];
+			if ( ( ! site->total ) ||
+			     ( shown[ i / 32 ] & ( 1U << ( i % 32 ) ) ) )
+				continue;
+			if ( ( ! best ) || ( site->len > best->len ) )
+				best = site;
+		}
+		if ( ! best )
+			break;
+		i = ( best - profile->site );
+		shown[ i / 32 ] |= ( 1U << ( i % 32 ) );
+		if ( best->caller ) {
+			printf ( "  %p:", best->caller );
+		} else {
+			printf ( "  (other):" );
+		}
+		printf ( " %zd bytes in %d blocks (max %zd bytes, %ld "
+			 "allocations)\n", best->len, best->count, best->max,
+			 best->total );
+	}
+}
+
+/**
+ * Print memory allocator statistics
+ *
+ */
+void memstat ( void ) {
+	struct malloc_profile *profile;
+	struct slab_cache *cache;
+	unsigned int blocks;
+	size_t largest;
+	unsigned int fragmentation;
+
+	/* Print heap usage and fragmentation */
+	mfreestat ( &blocks, &largest );
+	fragmentation = ( freemem ? ( 100 - ( ( ( unsigned long long )
+						 largest * 100 ) / freemem ) )
+			  : 0 );
+	printf ( "Heap: %zdkB used (max %zdkB), %zdkB free in %d blocks\n",
+		 ( usedmem >> 10 ), ( maxusedmem >> 10 ), ( freemem >> 10 ),
+		 blocks );
+	printf ( "Largest free block %zdkB, fragmentation %d%%\n",
+		 ( largest >> 10 ), fragmentation );
+
+	/* Print object cache statistics */
+	for_each_table_entry ( cache, SLAB_CACHES ) {
+		printf ( "Cache %s: %d used, %d free, %ld allocations (%ld "
+			 "cached, %ld failed), %ld discarded\n", cache->name,
+			 cache->used, cache->count, cache->stats.allocs,
+			 cache->stats.hits, cache->stats.fails,
+			 cache->stats.discards );
+	}
+
+	/* Print heap allocation profile, if available */
+	profile = mprofile();
+	if ( profile )
+		memstat_profile ( profile );
+}
@@ -36,13 +36,31 @@ FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
 /**
  * Print profiling statistics
  *
+ * @v csv		Print as comma-separated values
  */
-void profstat ( void ) {
+void profstat ( int csv ) {
 	struct profiler *profiler;
 
+	if ( csv )
+		printf ( "name,samples,mean,stddev,p50,p99,max,enabled\n" );
 	for_each_table_entry ( profiler, PROFILERS ) {
-		printf ( "%s: %ld +/- %ld ticks (%d samples)\n",
-			 profiler->name, profile_mean ( profiler ),
-			 profile_stddev ( profiler ), profiler->count );
+		if ( csv ) {
+			printf ( "%s,%d,%ld,%ld,%ld,%ld,%ld,%d\n",
+				 profiler->name, profiler->count,
+				 profile_mean ( profiler ),
+				 profile_stddev ( profiler ),
+				 profile_percentile ( profiler, 50 ),
+				 profile_percentile ( profiler, 99 ),
+				 profiler->max, ( ! profiler->disabled ) );
+		} else {
+			printf ( "%s: %ld +/- %ld ticks (%d samples) p50 %ld "
+				 "p99 %ld max %ld%s\n", profiler->name,
+				 profile_mean ( profiler ),
+				 profile_stddev ( profiler ), profiler->count,
+				 profile_percentile ( profiler, 50 ),
+				 profile_percentile ( profiler, 99 ),
+				 profiler->max,
+				 ( profiler->disabled ? " (disabled)" : "" ) );
+		}
 	}
 }
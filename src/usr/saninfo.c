@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <ipxe/sanboot.h>
+#include <usr/saninfo.h>
+
+/** @file
+ *
+ * SAN device information
+ *
+ */
+
+/** SAN command type names */
+static const char *saninfo_names[SAN_NUM_COMMAND_TYPES] = {
+	[SAN_READ] = "Read",
+	[SAN_WRITE] = "Write",
+	[SAN_CAPACITY] = "Capacity",
+};
+
+/**
+ * Print SAN command statistics
+ *
+ * @v stats		Command statistics
+ * @v name		Command type name
+ */
+static void saninfo_command ( struct san_command_stats *stats,
+			      const char *name ) {
+	unsigned int total = ( stats->good + stats->bad );
+	unsigned int i;
+
+	/* Do nothing unless commands have been issued */
+	if ( ! total )
+		return;
+
+	/* Print counters */
+	printf ( "  [%s: %d ok, %d err, %llu bytes, mean %llums, max %lums]\n",
+		 name, stats->good, stats->bad, stats->bytes,
+		 ( stats->latency / total ), stats->max );
+
+	/* Print non-empty latency histogram buckets */
+	printf ( "  [%s latency (ms):", name );
+	for ( i = 0 ; i < SAN_LATENCY_BUCKETS ; i++ ) {
+		if ( stats->count[i] )
+			printf ( " 2^%d:%d", i, stats->count[i] );
+	}
+	printf ( "]\n" );
+}
+
+/**
+ * Print SAN device information
+ *
+ * @v sandev		SAN device
+ */
+void saninfo ( struct san_device *sandev ) {
+	struct san_memdisk *memdisk = &sandev->memdisk;
+	struct san_path *sanpath;
+	unsigned int filled;
+	unsigned int i;
+
+	/* Print device geometry */
+	printf ( "%s: drive %#02x, %llu x %zd-byte blocks%s\n",
+		 sandev->settings_name, sandev->drive,
+		 ( ( unsigned long long ) sandev_capacity ( sandev ) ),
+		 sandev_blksize ( sandev ),
+		 ( sandev->is_cdrom ? " (CD-ROM)" : "" ) );
+
+	/* Print path status */
+	for ( i = 0 ; i < sandev->paths ; i++ ) {
+		sanpath = &sandev->path[i];
+		printf ( "  [Path %d: %s]\n", sanpath->index,
+			 ( ( sanpath == sandev->active ) ? "active" :
+			   ( sanpath->path_rc == 0 ) ? "ready" :
+			   ( sanpath->path_rc == -EINPROGRESS ) ? "opening" :
+			   strerror ( sanpath->path_rc ) ) );
+	}
+
+	/* Print memdisk status, if applicable */
+	if ( memdisk->data ) {
+		for ( filled = 0, i = 0 ; i < memdisk->chunks ; i++ )
+			filled += bitmap_test ( &memdisk->filled, i );
+		printf ( "  [Memdisk: %d/%d chunks%s]\n", filled,
+			 memdisk->chunks, ( memdisk->paused ? " (paused)" : "" ));
+	}
+
+	/* Print command statistics */
+	for ( i = 0 ; i < SAN_NUM_COMMAND_TYPES ; i++ )
+		saninfo_command ( &sandev->stats.command[i], saninfo_names[i] );
+	printf ( "  [Retries: %d Reopens: %d]\n",
+		 sandev->stats.retries, sandev->stats.reopens );
+}
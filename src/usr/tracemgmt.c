@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2026 agent <agent@local>.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ *
+ * You can also choose to distribute this program under the terms of
+ * the Unmodified Binary Distribution Licence (as given in the file
+ * COPYING.UBDL), provided that you have satisfied its requirements.
+ */
+
+FILE_LICENCE ( GPL2_OR_LATER_OR_UBDL );
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <ipxe/vsprintf.h>
+#include <ipxe/uaccess.h>
+#include <ipxe/image.h>
+#include <ipxe/tracepoint.h>
+#include <usr/tracemgmt.h>
+
+/** @file
+ *
+ * Tracepoint management
+ *
+ */
+
+/**
+ * Format trace records
+ *
+ * @v buf		Buffer
+ * @v len		Length of buffer
+ * @v prod		Producer index at which to stop
+ * @ret len		Length of formatted trace (excluding NUL)
+ */
+static size_t trace_format ( char *buf, size_t len, unsigned long prod ) {
+	struct trace_record *record;
+	unsigned long first = trace_first ( &trace_ring );
+	uint64_t prev;
+	unsigned long index;
+	size_t used;
+
+	/* Describe trace */
+	used = ssnprintf ( buf, len, "%ld records (%ld lost)%s\n",
+			   ( prod - first ), first,
+			   ( trace_active ? "" : ", stopped" ) );
+
+	/* Describe each record */
+	for ( index = first ; index < prod ; index++ ) {
+		record = trace_record_at ( &trace_ring, index );
+		prev = ( ( index == first ) ? record->timestamp :
+			 trace_record_at ( &trace_ring,
+					   ( index - 1 ) )->timestamp );
+		used += ssnprintf ( ( buf + used ), ( len - used ),
+				    "%llu +%llu %s %#lx\n",
+				    ( ( unsigned long long ) record->timestamp ),
+				    ( ( unsigned long long )
+				      ( record->timestamp - prev ) ),
+				    record->tracepoint->name, record->value );
+	}
+
+	return used;
+}
+
+/**
+ * Format trace records into a newly allocated buffer
+ *
+ * @ret buf		Formatted trace, or NULL on error
+ * @ret len		Length of formatted trace (excluding NUL)
+ */
+static char * trace_alloc_format ( size_t *len ) {
+	unsigned long prod = trace_ring.prod;
+	char *buf;
+
+	/* Calculate length and allocate buffer */
+	*len = trace_format ( NULL, 0, prod );
+	buf = malloc ( *len + 1 /* NUL */ );
+	if ( ! buf )
+		return NULL;
+
+	/* Format trace */
+	trace_format ( buf, ( *len + 1 /* NUL */ ), prod );
+
+	return buf;
+}
+
+/**
+ * Print trace records
+ *
+ * @ret rc		Return status code
+ */
+int tracestat ( void ) {
+	char *buf;
+	size_t len;
+
+	/* Format trace */
+	buf = trace_alloc_format ( &len );
+	if ( ! buf ) {
+		printf ( "Could not format trace\n" );
+		return -ENOMEM;
+	}
+
+	/* Print trace */
+	printf ( "%s", buf );
+	free ( buf );
+
+	return 0;
+}
+
+/**
+ * Export trace records as an image
+ *
+ * @v name		Image name
+ * @ret rc		Return status code
+ *
+ * The image will be made available to the booted operating system
+ * in the same way as any other registered image.
+ */
+int traceimage ( const char *name ) {
+	struct image *image;
+	char *buf;
+	size_t len;
+	int rc;
+
+	/* Format trace */
+	buf = trace_alloc_format ( &len );
+	if ( ! buf ) {
+		rc = -ENOMEM;
+		goto err_format;
+	}
+
+	/* Create image */
+	image = image_memory ( name, virt_to_user ( buf ), len );
+	if ( ! image ) {
+		rc = -ENOMEM;
+		goto err_image;
+	}
+
+	free ( buf );
+	return 0;
+
+ err_image:
+	free ( buf );
+ err_format:
+	printf ( "Could not create trace image \"%s\": %s\n",
+		 name, strerror ( rc ) );
+	return rc;
+}